@@ -27,7 +27,7 @@
  * @{
  */
 
-#define LTO_API_VERSION 4
+#define LTO_API_VERSION 5
 
 typedef enum {
     LTO_SYMBOL_ALIGNMENT_MASK              = 0x0000001F, /* log2 of alignment */
@@ -284,6 +284,19 @@ lto_codegen_compile(lto_code_gen_t cg, size_t* length);
 extern bool
 lto_codegen_compile_to_file(lto_code_gen_t cg, const char** name);
 
+/**
+ * Generates code for all added modules into the given number of native
+ * object files, on as many threads.  Every object file must be linked.  The
+ * names of the files are written to names, which is owned by the
+ * lto_code_gen_t and is valid until lto_codegen_dispose() is called, and
+ * their number to count.  Returns true on error.
+ *
+ * \since LTO_API_VERSION=5
+ */
+extern bool
+lto_codegen_compile_to_files(lto_code_gen_t cg, unsigned partitions,
+                             const char*** names, unsigned* count);
+
 
 /**
  * Sets options to help debug codegen bugs.
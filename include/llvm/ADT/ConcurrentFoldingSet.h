@@ -0,0 +1,250 @@
+//===-- llvm/ADT/ConcurrentFoldingSet.h - Thread-safe uniquing set -*- C++ -*-=//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+//
+// This file defines a variant of FoldingSet that can be queried and updated
+// from several threads at once.
+//
+// Nodes are kept in hash chains spread over a number of independently locked
+// shards.  Lookups that find a node never take a lock: they walk the chains
+// directly, and only a miss, which usually precedes an insertion anyway, is
+// confirmed under the lock.  Insertions and removals lock only the shard the
+// node hashes to.  Every node caches its full hash, so walking a chain only
+// re-profiles nodes whose hash matches, and growing a shard never re-profiles
+// anything.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef LLVM_ADT_CONCURRENTFOLDINGSET_H
+#define LLVM_ADT_CONCURRENTFOLDINGSET_H
+
+#include "llvm/ADT/FoldingSet.h"
+#include "llvm/Support/Compiler.h"
+#include "llvm/Support/type_traits.h"
+
+namespace llvm {
+
+//===----------------------------------------------------------------------===//
+/// ConcurrentFoldingSetImpl - Implements the thread-safe folding set
+/// functionality, independent of the node type.
+///
+/// FindNodeOrInsertPos and GetOrInsertNode may be called concurrently with
+/// each other and with InsertNode and RemoveNode.  A node that is passed to
+/// RemoveNode must not be deleted while other threads may still be looking
+/// it up, and iteration and clear() require that no other thread modifies
+/// the set at the same time.
+class ConcurrentFoldingSetImpl {
+public:
+  //===--------------------------------------------------------------------===//
+  /// Node - This class is used to maintain the bucket chains in a concurrent
+  /// folding set.  It also caches the hash of the node's profile.
+  ///
+  class Node {
+    friend class ConcurrentFoldingSetImpl;
+
+    // NextInFoldingSetBucket - next link in the bucket chain.  This is null if
+    // the node is not in a folding set.
+    Node *volatile NextInFoldingSetBucket;
+
+    // HashValue - the hash of the node's profile, valid while it is in a set.
+    unsigned HashValue;
+
+  public:
+    Node() : NextInFoldingSetBucket(0), HashValue(0) {}
+
+    // Accessors
+    Node *getNextInBucket() const { return NextInFoldingSetBucket; }
+    unsigned getHashValue() const { return HashValue; }
+  };
+
+  explicit ConcurrentFoldingSetImpl(unsigned Log2InitSize = 6,
+                                    unsigned Log2NumShards = 4);
+  virtual ~ConcurrentFoldingSetImpl();
+
+  /// clear - Remove all nodes from the folding set.
+  void clear();
+
+  /// RemoveNode - Remove a node from the folding set, returning true if one
+  /// was removed or false if the node was not in the folding set.
+  bool RemoveNode(Node *N);
+
+  /// GetOrInsertNode - If there is an existing simple Node exactly
+  /// equal to the specified node, return it.  Otherwise, insert 'N' and return
+  /// it instead.  This is atomic with respect to other insertions.
+  Node *GetOrInsertNode(Node *N);
+
+  /// FindNodeOrInsertPos - Look up the node specified by ID.  If it exists,
+  /// return it.  If not, return the insertion token that will make insertion
+  /// faster.  Another thread may insert an equal node between this call and
+  /// InsertNode; clients that race on the same ID should use GetOrInsertNode.
+  Node *FindNodeOrInsertPos(const FoldingSetNodeID &ID, void *&InsertPos);
+
+  /// InsertNode - Insert the specified node into the folding set, knowing that
+  /// it is not already in the folding set.  InsertPos must be obtained from
+  /// FindNodeOrInsertPos.
+  void InsertNode(Node *N, void *InsertPos);
+
+  /// InsertNode - Insert the specified node into the folding set, knowing that
+  /// it is not already in the folding set.
+  void InsertNode(Node *N) {
+    Node *Inserted = GetOrInsertNode(N);
+    (void)Inserted;
+    assert(Inserted == N && "Node already inserted!");
+  }
+
+  /// size - Returns the number of nodes in the folding set.
+  unsigned size() const;
+
+  /// empty - Returns true if there are no nodes in the folding set.
+  bool empty() const { return size() == 0; }
+
+protected:
+  /// getFirstNode - Return the first node in iteration order, or null.
+  Node *getFirstNode() const;
+
+  /// getNextNode - Return the node after N in iteration order, or null.
+  Node *getNextNode(const Node *N) const;
+
+  /// GetNodeProfile - Instantiations of the ConcurrentFoldingSet template
+  /// implement this function to gather data bits for the given node.
+  virtual void GetNodeProfile(Node *N, FoldingSetNodeID &ID) const = 0;
+
+private:
+  struct Shard;
+
+  /// Shards - Array of 1 << Log2NumShards independently locked hash tables.
+  Shard *Shards;
+  unsigned Log2NumShards;
+
+  Shard &getShardFor(unsigned Hash) const;
+
+  /// FindNode - Look up the node with the given ID and hash without taking
+  /// any locks.
+  Node *FindNode(const Shard &S, const FoldingSetNodeID &ID, unsigned IDHash,
+                 FoldingSetNodeID &TempID) const;
+
+  /// FindNodeLocked - Look up the node with the given ID and hash.  The
+  /// shard's lock must be held.
+  Node *FindNodeLocked(const Shard &S, const FoldingSetNodeID &ID,
+                       unsigned IDHash, FoldingSetNodeID &TempID) const;
+
+  /// InsertNodeLocked - Insert N, whose HashValue is already set, into S.
+  /// The shard's lock must be held.
+  void InsertNodeLocked(Shard &S, Node *N);
+
+  /// GrowShard - Double the size of the shard's hash table and rehash
+  /// everything.  The shard's lock must be held.
+  void GrowShard(Shard &S);
+
+  /// NodeEquals - Compare a node against an ID, checking the cached hash
+  /// before profiling the node.
+  bool NodeEquals(Node *N, const FoldingSetNodeID &ID, unsigned IDHash,
+                  FoldingSetNodeID &TempID) const;
+
+  ConcurrentFoldingSetImpl(const ConcurrentFoldingSetImpl &)
+    LLVM_DELETED_FUNCTION;
+  void operator=(const ConcurrentFoldingSetImpl &) LLVM_DELETED_FUNCTION;
+};
+
+/// ConcurrentFoldingSetNode - Nodes stored in a ConcurrentFoldingSet must be
+/// subclasses of this class and implement a Profile method, just as nodes
+/// stored in a FoldingSet derive from FoldingSetNode.
+typedef ConcurrentFoldingSetImpl::Node ConcurrentFoldingSetNode;
+
+template<class T> class ConcurrentFoldingSetIterator;
+
+//===----------------------------------------------------------------------===//
+/// ConcurrentFoldingSet - This template class is used to instantiate a
+/// specialized implementation of the concurrent folding set to the node class
+/// T.  T must be a subclass of ConcurrentFoldingSetNode and implement a
+/// Profile function.
+///
+template<class T> class ConcurrentFoldingSet : public ConcurrentFoldingSetImpl {
+  /// GetNodeProfile - Each instantiatation of the ConcurrentFoldingSet needs
+  /// to provide a way to convert nodes into a unique specifier.
+  virtual void GetNodeProfile(Node *N, FoldingSetNodeID &ID) const {
+    T *TN = static_cast<T *>(N);
+    FoldingSetTrait<T>::Profile(*TN, ID);
+  }
+
+public:
+  explicit ConcurrentFoldingSet(unsigned Log2InitSize = 6,
+                                unsigned Log2NumShards = 4)
+    : ConcurrentFoldingSetImpl(Log2InitSize, Log2NumShards) {}
+
+  typedef ConcurrentFoldingSetIterator<T> iterator;
+  iterator begin() { return iterator(this, getFirstNode()); }
+  iterator end() { return iterator(this, 0); }
+
+  typedef ConcurrentFoldingSetIterator<const T> const_iterator;
+  const_iterator begin() const { return const_iterator(this, getFirstNode()); }
+  const_iterator end() const { return const_iterator(this, 0); }
+
+  /// GetOrInsertNode - If there is an existing simple Node exactly
+  /// equal to the specified node, return it.  Otherwise, insert 'N' and
+  /// return it instead.
+  T *GetOrInsertNode(Node *N) {
+    return static_cast<T *>(ConcurrentFoldingSetImpl::GetOrInsertNode(N));
+  }
+
+  /// FindNodeOrInsertPos - Look up the node specified by ID.  If it exists,
+  /// return it.  If not, return the insertion token that will make insertion
+  /// faster.
+  T *FindNodeOrInsertPos(const FoldingSetNodeID &ID, void *&InsertPos) {
+    return static_cast<T *>(
+      ConcurrentFoldingSetImpl::FindNodeOrInsertPos(ID, InsertPos));
+  }
+
+private:
+  template<class U> friend class ConcurrentFoldingSetIterator;
+
+  Node *next(const Node *N) const { return getNextNode(N); }
+};
+
+//===----------------------------------------------------------------------===//
+/// ConcurrentFoldingSetIterator - Walks every node in a ConcurrentFoldingSet.
+/// The set must not be modified while it is being iterated over.
+template<class T>
+class ConcurrentFoldingSetIterator {
+  typedef typename remove_const<T>::type NodeT;
+
+  const ConcurrentFoldingSet<NodeT> *Set;
+  ConcurrentFoldingSetImpl::Node *NodePtr;
+
+public:
+  ConcurrentFoldingSetIterator(const ConcurrentFoldingSet<NodeT> *S,
+                               ConcurrentFoldingSetImpl::Node *N)
+    : Set(S), NodePtr(N) {}
+
+  T &operator*() const {
+    return *static_cast<T*>(NodePtr);
+  }
+
+  T *operator->() const {
+    return static_cast<T*>(NodePtr);
+  }
+
+  bool operator==(const ConcurrentFoldingSetIterator &RHS) const {
+    return NodePtr == RHS.NodePtr;
+  }
+  bool operator!=(const ConcurrentFoldingSetIterator &RHS) const {
+    return NodePtr != RHS.NodePtr;
+  }
+
+  inline ConcurrentFoldingSetIterator &operator++() {          // Preincrement
+    NodePtr = Set->next(NodePtr);
+    return *this;
+  }
+  ConcurrentFoldingSetIterator operator++(int) {        // Postincrement
+    ConcurrentFoldingSetIterator tmp = *this; ++*this; return tmp;
+  }
+};
+
+} // End of namespace llvm.
+
+#endif
@@ -0,0 +1,704 @@
+//===- llvm/ADT/FlatDenseMap.h - Group-probed flat hash table ---*- C++ -*-===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+//
+// This file defines the FlatDenseMap class, an open-addressing hash table
+// with the same interface as DenseMap.
+//
+// Instead of storing empty and tombstone sentinel keys in the bucket array,
+// FlatDenseMap keeps a separate array with one control byte per bucket.  A
+// control byte is either "empty", "deleted" or holds the low seven bits of the
+// hash of the key stored in the bucket.  Buckets are probed sixteen at a time:
+// a single SSE2 compare finds every bucket in a group whose control byte
+// matches the hash, so most lookups compare at most one key and touch a single
+// cache line of the bucket array.
+//
+// The hottest maps in the IR and code generator can be switched over to this
+// implementation with the LLVM_USE_FLAT_DENSEMAP build flag; see HotDenseMap
+// at the end of this file.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef LLVM_ADT_FLATDENSEMAP_H
+#define LLVM_ADT_FLATDENSEMAP_H
+
+#include "llvm/ADT/DenseMap.h"
+#include "llvm/Support/AlignOf.h"
+#include "llvm/Support/Compiler.h"
+#include "llvm/Support/MathExtras.h"
+#include "llvm/Support/type_traits.h"
+#include <algorithm>
+#include <cassert>
+#include <cstddef>
+#include <cstring>
+#include <iterator>
+#include <new>
+#include <utility>
+
+#if defined(__SSE2__) || defined(_M_X64) || \
+    (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define LLVM_FLATDENSEMAP_SSE2 1
+#include <emmintrin.h>
+#endif
+
+#ifndef LLVM_USE_FLAT_DENSEMAP
+#define LLVM_USE_FLAT_DENSEMAP 0
+#endif
+
+namespace llvm {
+
+namespace flat_densemap_detail {
+
+/// Control byte values.  Any byte with the high bit clear marks a full bucket
+/// and holds the low seven bits of the key's hash.
+enum {
+  CtrlEmpty = 0x80,
+  CtrlDeleted = 0xFE,
+  GroupWidth = 16
+};
+
+/// Group - A view of the GroupWidth control bytes starting at Ctrl.  Each of
+/// the match functions returns a bitmask with bit I set if the I'th byte of
+/// the group satisfies the predicate.
+class Group {
+#ifdef LLVM_FLATDENSEMAP_SSE2
+  __m128i Ctrl;
+public:
+  explicit Group(const unsigned char *Pos)
+    : Ctrl(_mm_loadu_si128(reinterpret_cast<const __m128i *>(Pos))) {}
+
+  unsigned match(unsigned char H2) const {
+    return _mm_movemask_epi8(_mm_cmpeq_epi8(_mm_set1_epi8(char(H2)), Ctrl));
+  }
+  unsigned matchEmpty() const {
+    return match(CtrlEmpty);
+  }
+  unsigned matchEmptyOrDeleted() const {
+    // Both empty and deleted have the high bit set, full buckets do not.
+    return _mm_movemask_epi8(Ctrl);
+  }
+#else
+  const unsigned char *Ctrl;
+public:
+  explicit Group(const unsigned char *Pos) : Ctrl(Pos) {}
+
+  unsigned match(unsigned char H2) const {
+    unsigned Mask = 0;
+    for (unsigned i = 0; i != GroupWidth; ++i)
+      if (Ctrl[i] == H2)
+        Mask |= 1U << i;
+    return Mask;
+  }
+  unsigned matchEmpty() const {
+    return match(CtrlEmpty);
+  }
+  unsigned matchEmptyOrDeleted() const {
+    unsigned Mask = 0;
+    for (unsigned i = 0; i != GroupWidth; ++i)
+      if (Ctrl[i] & 0x80)
+        Mask |= 1U << i;
+    return Mask;
+  }
+#endif
+};
+
+} // end namespace flat_densemap_detail
+
+template<typename KeyT, typename ValueT,
+         typename KeyInfoT = DenseMapInfo<KeyT>,
+         bool IsConst = false>
+class FlatDenseMapIterator;
+
+/// FlatDenseMap - A drop-in replacement for DenseMap that probes groups of
+/// buckets with SIMD compares on a side array of control bytes.  Unlike
+/// DenseMap, keys are only constructed in occupied buckets, so KeyInfoT's
+/// empty and tombstone keys are never materialized.
+template<typename KeyT, typename ValueT,
+         typename KeyInfoT = DenseMapInfo<KeyT> >
+class FlatDenseMap {
+  typedef std::pair<KeyT, ValueT> BucketT;
+  enum {
+    CtrlEmpty = flat_densemap_detail::CtrlEmpty,
+    CtrlDeleted = flat_densemap_detail::CtrlDeleted,
+    GroupWidth = flat_densemap_detail::GroupWidth
+  };
+  typedef flat_densemap_detail::Group Group;
+
+  /// Ctrl - NumBuckets control bytes, followed (in the same allocation) by the
+  /// bucket array that Buckets points to.
+  unsigned char *Ctrl;
+  BucketT *Buckets;
+  unsigned NumEntries;
+  unsigned NumTombstones;
+  unsigned NumBuckets;
+
+public:
+  typedef KeyT key_type;
+  typedef ValueT mapped_type;
+  typedef BucketT value_type;
+
+  typedef FlatDenseMapIterator<KeyT, ValueT, KeyInfoT> iterator;
+  typedef FlatDenseMapIterator<KeyT, ValueT, KeyInfoT, true> const_iterator;
+
+  explicit FlatDenseMap(unsigned NumInitBuckets = 0) {
+    init(NumInitBuckets);
+  }
+
+  FlatDenseMap(const FlatDenseMap &other) {
+    init(0);
+    copyFrom(other);
+  }
+
+#if LLVM_USE_RVALUE_REFERENCES
+  FlatDenseMap(FlatDenseMap &&other) {
+    init(0);
+    swap(other);
+  }
+#endif
+
+  template<typename InputIt>
+  FlatDenseMap(const InputIt &I, const InputIt &E) {
+    init(std::distance(I, E) * 2);
+    this->insert(I, E);
+  }
+
+  ~FlatDenseMap() {
+    destroyAll();
+    operator delete(Ctrl);
+  }
+
+  void swap(FlatDenseMap &RHS) {
+    std::swap(Ctrl, RHS.Ctrl);
+    std::swap(Buckets, RHS.Buckets);
+    std::swap(NumEntries, RHS.NumEntries);
+    std::swap(NumTombstones, RHS.NumTombstones);
+    std::swap(NumBuckets, RHS.NumBuckets);
+  }
+
+  FlatDenseMap &operator=(const FlatDenseMap &other) {
+    if (&other != this)
+      copyFrom(other);
+    return *this;
+  }
+
+#if LLVM_USE_RVALUE_REFERENCES
+  FlatDenseMap &operator=(FlatDenseMap &&other) {
+    destroyAll();
+    operator delete(Ctrl);
+    init(0);
+    swap(other);
+    return *this;
+  }
+#endif
+
+  inline iterator begin() {
+    // When the map is empty, avoid the overhead of AdvancePastEmptyBuckets().
+    return empty() ? end() : iterator(Buckets, getBucketsEnd(), Ctrl);
+  }
+  inline iterator end() {
+    return iterator(getBucketsEnd(), getBucketsEnd(), Ctrl + NumBuckets, true);
+  }
+  inline const_iterator begin() const {
+    return empty() ? end() : const_iterator(Buckets, getBucketsEnd(), Ctrl);
+  }
+  inline const_iterator end() const {
+    return const_iterator(getBucketsEnd(), getBucketsEnd(), Ctrl + NumBuckets,
+                          true);
+  }
+
+  bool empty() const { return NumEntries == 0; }
+  unsigned size() const { return NumEntries; }
+
+  /// Grow the map so that it has at least Size buckets. Does not shrink
+  void resize(size_t Size) {
+    if (Size > NumBuckets)
+      grow(Size);
+  }
+
+  void clear() {
+    if (NumEntries == 0 && NumTombstones == 0) return;
+
+    // If the capacity of the array is huge, and the # elements used is small,
+    // shrink the array.
+    if (NumEntries * 4 < NumBuckets && NumBuckets > 64) {
+      shrink_and_clear();
+      return;
+    }
+
+    destroyAll();
+    NumEntries = 0;
+    NumTombstones = 0;
+  }
+
+  /// count - Return true if the specified key is in the map.
+  bool count(const KeyT &Val) const {
+    const BucketT *TheBucket;
+    return LookupBucketFor(Val, getHashValue(Val), TheBucket);
+  }
+
+  iterator find(const KeyT &Val) {
+    return find_as(Val);
+  }
+  const_iterator find(const KeyT &Val) const {
+    return find_as(Val);
+  }
+
+  /// Alternate version of find() which allows a different, and possibly
+  /// less expensive, key type.
+  /// The KeyInfoT is responsible for supplying methods
+  /// getHashValue(LookupKeyT) and isEqual(LookupKeyT, KeyT) for each key
+  /// type used.
+  template<class LookupKeyT>
+  iterator find_as(const LookupKeyT &Val) {
+    BucketT *TheBucket;
+    if (LookupBucketFor(Val, getHashValue(Val), TheBucket))
+      return iterator(TheBucket, getBucketsEnd(), getCtrlFor(TheBucket), true);
+    return end();
+  }
+  template<class LookupKeyT>
+  const_iterator find_as(const LookupKeyT &Val) const {
+    const BucketT *TheBucket;
+    if (LookupBucketFor(Val, getHashValue(Val), TheBucket))
+      return const_iterator(TheBucket, getBucketsEnd(), getCtrlFor(TheBucket),
+                            true);
+    return end();
+  }
+
+  /// lookup - Return the entry for the specified key, or a default
+  /// constructed value if no such entry exists.
+  ValueT lookup(const KeyT &Val) const {
+    const BucketT *TheBucket;
+    if (LookupBucketFor(Val, getHashValue(Val), TheBucket))
+      return TheBucket->second;
+    return ValueT();
+  }
+
+  // Inserts key,value pair into the map if the key isn't already in the map.
+  // If the key is already in the map, it returns false and doesn't update the
+  // value.
+  std::pair<iterator, bool> insert(const std::pair<KeyT, ValueT> &KV) {
+    unsigned Hash = getHashValue(KV.first);
+    BucketT *TheBucket;
+    if (LookupBucketFor(KV.first, Hash, TheBucket))
+      return std::make_pair(iterator(TheBucket, getBucketsEnd(),
+                                     getCtrlFor(TheBucket), true),
+                            false); // Already in map.
+
+    // Otherwise, insert the new element.
+    TheBucket = InsertIntoBucket(KV.first, KV.second, Hash, TheBucket);
+    return std::make_pair(iterator(TheBucket, getBucketsEnd(),
+                                   getCtrlFor(TheBucket), true),
+                          true);
+  }
+
+  /// insert - Range insertion of pairs.
+  template<typename InputIt>
+  void insert(InputIt I, InputIt E) {
+    for (; I != E; ++I)
+      insert(*I);
+  }
+
+  bool erase(const KeyT &Val) {
+    BucketT *TheBucket;
+    if (!LookupBucketFor(Val, getHashValue(Val), TheBucket))
+      return false; // not in map.
+
+    eraseBucket(TheBucket);
+    return true;
+  }
+  void erase(iterator I) {
+    eraseBucket(&*I);
+  }
+
+  value_type &FindAndConstruct(const KeyT &Key) {
+    unsigned Hash = getHashValue(Key);
+    BucketT *TheBucket;
+    if (LookupBucketFor(Key, Hash, TheBucket))
+      return *TheBucket;
+
+    return *InsertIntoBucket(Key, ValueT(), Hash, TheBucket);
+  }
+
+  ValueT &operator[](const KeyT &Key) {
+    return FindAndConstruct(Key).second;
+  }
+
+  /// isPointerIntoBucketsArray - Return true if the specified pointer points
+  /// somewhere into the map's array of buckets (i.e. either to a key or
+  /// value in the map).
+  bool isPointerIntoBucketsArray(const void *Ptr) const {
+    return Ptr >= Buckets && Ptr < getBucketsEnd();
+  }
+
+  /// getPointerIntoBucketsArray() - Return an opaque pointer into the buckets
+  /// array.  In conjunction with the previous method, this can be used to
+  /// determine whether an insertion caused the map to reallocate.
+  const void *getPointerIntoBucketsArray() const { return Buckets; }
+
+  /// Return the approximate size (in bytes) of the actual map, including the
+  /// control bytes.
+  /// If entries are pointers to objects, the size of the referenced objects
+  /// are not included.
+  size_t getMemorySize() const {
+    return NumBuckets ? getAllocationSize(NumBuckets) : 0;
+  }
+
+private:
+  static unsigned getHashValue(const KeyT &Val) {
+    return KeyInfoT::getHashValue(Val);
+  }
+  template<typename LookupKeyT>
+  static unsigned getHashValue(const LookupKeyT &Val) {
+    return KeyInfoT::getHashValue(Val);
+  }
+
+  /// getH1 - The part of the hash that selects the first group to probe.
+  static unsigned getH1(unsigned Hash) { return Hash >> 7; }
+  /// getH2 - The part of the hash that is stored in the control byte.
+  static unsigned char getH2(unsigned Hash) { return Hash & 0x7F; }
+
+  static bool isFull(unsigned char C) { return (C & 0x80) == 0; }
+
+  const BucketT *getBucketsEnd() const { return Buckets + NumBuckets; }
+  BucketT *getBucketsEnd() { return Buckets + NumBuckets; }
+
+  const unsigned char *getCtrlFor(const BucketT *B) const {
+    return Ctrl + (B - Buckets);
+  }
+
+  /// getCtrlSize - The control bytes are padded so that the bucket array that
+  /// follows them is suitably aligned.
+  static size_t getCtrlSize(unsigned Num) {
+    return RoundUpToAlignment(Num, AlignOf<BucketT>::Alignment);
+  }
+  static size_t getAllocationSize(unsigned Num) {
+    return getCtrlSize(Num) + sizeof(BucketT) * Num;
+  }
+
+  void allocateBuckets(unsigned Num) {
+    NumBuckets = Num;
+    NumEntries = 0;
+    NumTombstones = 0;
+    if (Num == 0) {
+      Ctrl = 0;
+      Buckets = 0;
+      return;
+    }
+
+    assert((Num & (Num - 1)) == 0 && Num >= GroupWidth &&
+           "# buckets must be a power of two no smaller than a group!");
+    Ctrl = static_cast<unsigned char*>(operator new(getAllocationSize(Num)));
+    Buckets = reinterpret_cast<BucketT*>(Ctrl + getCtrlSize(Num));
+    memset(Ctrl, CtrlEmpty, Num);
+  }
+
+  /// getNumBucketsFor - Return the bucket count to use for a table that must
+  /// hold at least AtLeast buckets.
+  static unsigned getNumBucketsFor(unsigned AtLeast) {
+    unsigned Num = GroupWidth;
+    while (Num < AtLeast)
+      Num <<= 1;
+    return Num;
+  }
+
+  void init(unsigned InitBuckets) {
+    allocateBuckets(InitBuckets ? getNumBucketsFor(InitBuckets) : 0);
+  }
+
+  /// destroyAll - Run the destructors of all live entries and mark every
+  /// bucket empty.  The entry counts are left for the caller to reset.
+  void destroyAll() {
+    if (NumBuckets == 0) // Nothing to do.
+      return;
+
+    if (!isPodLike<KeyT>::value || !isPodLike<ValueT>::value)
+      for (unsigned i = 0; i != NumBuckets; ++i)
+        if (isFull(Ctrl[i])) {
+          Buckets[i].second.~ValueT();
+          Buckets[i].first.~KeyT();
+        }
+    memset(Ctrl, CtrlEmpty, NumBuckets);
+  }
+
+  void copyFrom(const FlatDenseMap &other) {
+    destroyAll();
+    operator delete(Ctrl);
+    allocateBuckets(other.NumBuckets);
+    if (NumBuckets == 0)
+      return;
+
+    NumEntries = other.NumEntries;
+    NumTombstones = other.NumTombstones;
+    memcpy(Ctrl, other.Ctrl, NumBuckets);
+    if (isPodLike<KeyT>::value && isPodLike<ValueT>::value) {
+      memcpy(Buckets, other.Buckets, NumBuckets * sizeof(BucketT));
+      return;
+    }
+    for (unsigned i = 0; i != NumBuckets; ++i)
+      if (isFull(Ctrl[i])) {
+        new (&Buckets[i].first) KeyT(other.Buckets[i].first);
+        new (&Buckets[i].second) ValueT(other.Buckets[i].second);
+      }
+  }
+
+  void grow(unsigned AtLeast) {
+    unsigned char *OldCtrl = Ctrl;
+    BucketT *OldBuckets = Buckets;
+    unsigned OldNumBuckets = NumBuckets;
+
+    allocateBuckets(getNumBucketsFor(AtLeast));
+    if (!OldCtrl)
+      return;
+
+    // Insert all the old elements.  The new table has no tombstones, so the
+    // first empty-or-deleted bucket on each probe sequence is the right one.
+    for (unsigned i = 0; i != OldNumBuckets; ++i) {
+      if (!isFull(OldCtrl[i]))
+        continue;
+      BucketT *B = OldBuckets + i;
+      unsigned Hash = getHashValue(B->first);
+      BucketT *DestBucket = findInsertSlot(Hash);
+      Ctrl[DestBucket - Buckets] = getH2(Hash);
+      new (&DestBucket->first) KeyT(llvm_move(B->first));
+      new (&DestBucket->second) ValueT(llvm_move(B->second));
+      ++NumEntries;
+
+      B->second.~ValueT();
+      B->first.~KeyT();
+    }
+
+    // Free the old table.
+    operator delete(OldCtrl);
+  }
+
+  void shrink_and_clear() {
+    unsigned OldNumEntries = NumEntries;
+    destroyAll();
+
+    // Reduce the number of buckets.
+    unsigned NewNumBuckets = 0;
+    if (OldNumEntries)
+      NewNumBuckets = std::max(64, 1 << (Log2_32_Ceil(OldNumEntries) + 1));
+    if (NewNumBuckets == NumBuckets) {
+      NumEntries = 0;
+      NumTombstones = 0;
+      return;
+    }
+
+    operator delete(Ctrl);
+    init(NewNumBuckets);
+  }
+
+  void eraseBucket(BucketT *TheBucket) {
+    TheBucket->second.~ValueT();
+    TheBucket->first.~KeyT();
+    --NumEntries;
+
+    // If the group this bucket lives in still has an empty bucket, no probe
+    // sequence has ever continued past it, so the bucket can be made empty
+    // again instead of leaving a tombstone behind.
+    unsigned Idx = TheBucket - Buckets;
+    if (Group(Ctrl + (Idx & ~(GroupWidth - 1))).matchEmpty()) {
+      Ctrl[Idx] = CtrlEmpty;
+      return;
+    }
+    Ctrl[Idx] = CtrlDeleted;
+    ++NumTombstones;
+  }
+
+  BucketT *InsertIntoBucket(const KeyT &Key, const ValueT &Value,
+                            unsigned Hash, BucketT *TheBucket) {
+    TheBucket = InsertIntoBucketImpl(Hash, TheBucket);
+
+    new (&TheBucket->first) KeyT(Key);
+    new (&TheBucket->second) ValueT(Value);
+    return TheBucket;
+  }
+
+  BucketT *InsertIntoBucketImpl(unsigned Hash, BucketT *TheBucket) {
+    // Grow the table if the load is more than 3/4, or rehash it in place if
+    // fewer than 1/8 of the buckets are empty, for the same reasons as
+    // DenseMap: a table full of tombstones makes failing lookups slow.
+    unsigned NewNumEntries = NumEntries + 1;
+    if (NewNumEntries*4 >= NumBuckets*3) {
+      this->grow(NumBuckets * 2);
+      TheBucket = findInsertSlot(Hash);
+    } else if (NumBuckets-(NewNumEntries+NumTombstones) <= NumBuckets/8) {
+      this->grow(NumBuckets);
+      TheBucket = findInsertSlot(Hash);
+    }
+    assert(TheBucket);
+
+    ++NumEntries;
+    unsigned char &C = Ctrl[TheBucket - Buckets];
+    // If we are writing over a tombstone, remember this.
+    if (C == CtrlDeleted)
+      --NumTombstones;
+    C = getH2(Hash);
+    return TheBucket;
+  }
+
+  /// findInsertSlot - Return the first empty or deleted bucket on the probe
+  /// sequence for Hash.  The key must not already be in the map.
+  BucketT *findInsertSlot(unsigned Hash) {
+    const unsigned GroupMask = NumBuckets / GroupWidth - 1;
+    unsigned GroupNo = getH1(Hash) & GroupMask;
+    unsigned ProbeAmt = 1;
+    while (1) {
+      unsigned Base = GroupNo * GroupWidth;
+      if (unsigned Mask = Group(Ctrl + Base).matchEmptyOrDeleted())
+        return Buckets + Base + CountTrailingZeros_32(Mask);
+      GroupNo = (GroupNo + ProbeAmt++) & GroupMask;
+    }
+  }
+
+  /// LookupBucketFor - Lookup the appropriate bucket for Val, whose hash is
+  /// Hash, returning it in FoundBucket.  If the bucket contains the key and a
+  /// value, this returns true, otherwise it returns an empty or deleted bucket
+  /// suitable for inserting Val and returns false.
+  template<typename LookupKeyT>
+  bool LookupBucketFor(const LookupKeyT &Val, unsigned Hash,
+                       const BucketT *&FoundBucket) const {
+    if (NumBuckets == 0) {
+      FoundBucket = 0;
+      return false;
+    }
+
+    // Groups are probed quadratically, which visits every group because the
+    // number of groups is a power of two.
+    const unsigned GroupMask = NumBuckets / GroupWidth - 1;
+    const unsigned char H2 = getH2(Hash);
+    const BucketT *InsertSlot = 0;
+    unsigned GroupNo = getH1(Hash) & GroupMask;
+    unsigned ProbeAmt = 1;
+    while (1) {
+      unsigned Base = GroupNo * GroupWidth;
+      Group G(Ctrl + Base);
+
+      // Compare the key against every bucket whose control byte matches.
+      for (unsigned Mask = G.match(H2); Mask; Mask &= Mask - 1) {
+        const BucketT *ThisBucket = Buckets + Base + CountTrailingZeros_32(Mask);
+        if (KeyInfoT::isEqual(Val, ThisBucket->first)) {
+          FoundBucket = ThisBucket;
+          return true;
+        }
+      }
+
+      // Remember the first bucket Val could be inserted into.
+      if (!InsertSlot)
+        if (unsigned Mask = G.matchEmptyOrDeleted())
+          InsertSlot = Buckets + Base + CountTrailingZeros_32(Mask);
+
+      // An empty bucket in the group terminates the probe sequence.
+      if (G.matchEmpty()) {
+        FoundBucket = InsertSlot;
+        return false;
+      }
+
+      GroupNo = (GroupNo + ProbeAmt++) & GroupMask;
+    }
+  }
+
+  template <typename LookupKeyT>
+  bool LookupBucketFor(const LookupKeyT &Val, unsigned Hash,
+                       BucketT *&FoundBucket) {
+    const BucketT *ConstFoundBucket;
+    bool Result = const_cast<const FlatDenseMap *>(this)
+      ->LookupBucketFor(Val, Hash, ConstFoundBucket);
+    FoundBucket = const_cast<BucketT *>(ConstFoundBucket);
+    return Result;
+  }
+};
+
+template<typename KeyT, typename ValueT,
+         typename KeyInfoT, bool IsConst>
+class FlatDenseMapIterator {
+  typedef std::pair<KeyT, ValueT> Bucket;
+  typedef FlatDenseMapIterator<KeyT, ValueT,
+                               KeyInfoT, true> ConstIterator;
+  friend class FlatDenseMapIterator<KeyT, ValueT, KeyInfoT, true>;
+public:
+  typedef ptrdiff_t difference_type;
+  typedef typename conditional<IsConst, const Bucket, Bucket>::type value_type;
+  typedef value_type *pointer;
+  typedef value_type &reference;
+  typedef std::forward_iterator_tag iterator_category;
+private:
+  pointer Ptr, End;
+  const unsigned char *Ctrl;
+public:
+  FlatDenseMapIterator() : Ptr(0), End(0), Ctrl(0) {}
+
+  FlatDenseMapIterator(pointer Pos, pointer E, const unsigned char *C,
+                       bool NoAdvance = false)
+    : Ptr(Pos), End(E), Ctrl(C) {
+    if (!NoAdvance) AdvancePastEmptyBuckets();
+  }
+
+  // If IsConst is true this is a converting constructor from iterator to
+  // const_iterator and the default copy constructor is used.
+  // Otherwise this is a copy constructor for iterator.
+  FlatDenseMapIterator(const FlatDenseMapIterator<KeyT, ValueT,
+                                                  KeyInfoT, false>& I)
+    : Ptr(I.Ptr), End(I.End), Ctrl(I.Ctrl) {}
+
+  reference operator*() const {
+    return *Ptr;
+  }
+  pointer operator->() const {
+    return Ptr;
+  }
+
+  bool operator==(const ConstIterator &RHS) const {
+    return Ptr == RHS.operator->();
+  }
+  bool operator!=(const ConstIterator &RHS) const {
+    return Ptr != RHS.operator->();
+  }
+
+  inline FlatDenseMapIterator& operator++() {  // Preincrement
+    ++Ptr;
+    ++Ctrl;
+    AdvancePastEmptyBuckets();
+    return *this;
+  }
+  FlatDenseMapIterator operator++(int) {  // Postincrement
+    FlatDenseMapIterator tmp = *this; ++*this; return tmp;
+  }
+
+private:
+  void AdvancePastEmptyBuckets() {
+    while (Ptr != End && (*Ctrl & 0x80)) {
+      ++Ptr;
+      ++Ctrl;
+    }
+  }
+};
+
+template<typename KeyT, typename ValueT, typename KeyInfoT>
+static inline size_t
+capacity_in_bytes(const FlatDenseMap<KeyT, ValueT, KeyInfoT> &X) {
+  return X.getMemorySize();
+}
+
+/// HotDenseMap - Selects the map implementation for the hottest maps in the
+/// IR and code generator.  These are FlatDenseMaps when LLVM is built with
+/// LLVM_USE_FLAT_DENSEMAP, and plain DenseMaps otherwise.
+template<typename KeyT, typename ValueT,
+         typename KeyInfoT = DenseMapInfo<KeyT> >
+struct HotDenseMap {
+#if LLVM_USE_FLAT_DENSEMAP
+  typedef FlatDenseMap<KeyT, ValueT, KeyInfoT> type;
+#else
+  typedef DenseMap<KeyT, ValueT, KeyInfoT> type;
+#endif
+};
+
+} // end namespace llvm
+
+#endif
@@ -17,6 +17,7 @@
 #include "llvm/ADT/StringRef.h"
 #include "llvm/Support/Allocator.h"
 #include <cstring>
+#include <iterator>
 
 namespace llvm {
   template<typename ValueT>
@@ -71,17 +72,25 @@ protected:
   StringMapImpl(unsigned InitSize, unsigned ItemSize);
   void RehashTable();
 
+  /// ReserveTable - Grow the table so that it can hold NumEntries items
+  /// without being rehashed.
+  void ReserveTable(unsigned NumEntries);
+
   /// LookupBucketFor - Look up the bucket that the specified string should end
   /// up in.  If it already exists as a key in the map, the Item pointer for the
   /// specified bucket will be non-null.  Otherwise, it will be null.  In either
   /// case, the FullHashValue field of the bucket will be set to the hash value
   /// of the string.
-  unsigned LookupBucketFor(StringRef Key);
+  unsigned LookupBucketFor(StringRef Key) {
+    return LookupBucketFor(Key, hash(Key));
+  }
+  unsigned LookupBucketFor(StringRef Key, unsigned FullHashValue);
 
   /// FindKey - Look up the bucket that contains the specified key. If it exists
   /// in the map, return the bucket number of the key.  Otherwise return -1.
   /// This does not modify the map.
-  int FindKey(StringRef Key) const;
+  int FindKey(StringRef Key) const { return FindKey(Key, hash(Key)); }
+  int FindKey(StringRef Key, unsigned FullHashValue) const;
 
   /// RemoveKey - Remove the specified StringMapEntry from the table, but do not
   /// delete it.  This aborts if the value isn't in the table.
@@ -92,11 +101,19 @@ protected:
   StringMapEntryBase *RemoveKey(StringRef Key);
 private:
   void init(unsigned Size);
+  void ResizeTable(unsigned NewSize);
 public:
   static StringMapEntryBase *getTombstoneVal() {
     return (StringMapEntryBase*)-1;
   }
 
+  /// hash - Return the hash value StringMap uses for Key.  Clients that look
+  /// up the same string in several maps, or repeatedly in one map, can compute
+  /// this once and pass it to the lookup methods that take a FullHashValue.
+  /// When LLVM is built with LLVM_STRINGMAP_FAST_HASH this is a multiply-based
+  /// hash that consumes eight bytes at a time instead of HashString.
+  static unsigned hash(StringRef Key);
+
   unsigned getNumBuckets() const { return NumBuckets; }
   unsigned getNumItems() const { return NumItems; }
 
@@ -279,13 +296,22 @@ public:
   }
 
   iterator find(StringRef Key) {
-    int Bucket = FindKey(Key);
+    return find(Key, hash(Key));
+  }
+
+  const_iterator find(StringRef Key) const {
+    return find(Key, hash(Key));
+  }
+
+  /// find - Look up Key, whose hash() has already been computed.
+  iterator find(StringRef Key, unsigned FullHashValue) {
+    int Bucket = FindKey(Key, FullHashValue);
     if (Bucket == -1) return end();
     return iterator(TheTable+Bucket, true);
   }
 
-  const_iterator find(StringRef Key) const {
-    int Bucket = FindKey(Key);
+  const_iterator find(StringRef Key, unsigned FullHashValue) const {
+    int Bucket = FindKey(Key, FullHashValue);
     if (Bucket == -1) return end();
     return const_iterator(TheTable+Bucket, true);
   }
@@ -293,7 +319,11 @@ public:
    /// lookup - Return the entry for the specified key, or a default
   /// constructed value if no such entry exists.
   ValueTy lookup(StringRef Key) const {
-    const_iterator it = find(Key);
+    return lookup(Key, hash(Key));
+  }
+
+  ValueTy lookup(StringRef Key, unsigned FullHashValue) const {
+    const_iterator it = find(Key, FullHashValue);
     if (it != end())
       return it->second;
     return ValueTy();
@@ -307,6 +337,16 @@ public:
     return find(Key) == end() ? 0 : 1;
   }
 
+  size_type count(StringRef Key, unsigned FullHashValue) const {
+    return find(Key, FullHashValue) == end() ? 0 : 1;
+  }
+
+  /// reserve - Grow the table so that NumEntries items can be inserted without
+  /// it being rehashed.
+  void reserve(unsigned NumEntries) {
+    ReserveTable(NumEntries);
+  }
+
   /// insert - Insert the specified key/value pair into the map.  If the key
   /// already exists in the map, return false and ignore the request, otherwise
   /// insert it and return true.
@@ -326,6 +366,16 @@ public:
     return true;
   }
 
+  /// insert - Range insertion of (key, value) pairs.  The table is sized for
+  /// the whole range up front, and keys that are already in the map keep their
+  /// current value.
+  template<typename InputIt>
+  void insert(InputIt I, InputIt E) {
+    reserve(NumItems + static_cast<unsigned>(std::distance(I, E)));
+    for (; I != E; ++I)
+      GetOrCreateValue(I->first, I->second);
+  }
+
   // clear - Empties out the StringMap
   void clear() {
     if (empty()) return;
@@ -349,7 +399,19 @@ public:
   /// return.
   template <typename InitTy>
   MapEntryTy &GetOrCreateValue(StringRef Key, InitTy Val) {
-    unsigned BucketNo = LookupBucketFor(Key);
+    return GetOrCreateValueWithHash(Key, hash(Key), Val);
+  }
+
+  MapEntryTy &GetOrCreateValue(StringRef Key) {
+    return GetOrCreateValue(Key, ValueTy());
+  }
+
+  /// GetOrCreateValueWithHash - Like GetOrCreateValue, for a key whose hash()
+  /// has already been computed.
+  template <typename InitTy>
+  MapEntryTy &GetOrCreateValueWithHash(StringRef Key, unsigned FullHashValue,
+                                       InitTy Val) {
+    unsigned BucketNo = LookupBucketFor(Key, FullHashValue);
     StringMapEntryBase *&Bucket = TheTable[BucketNo];
     if (Bucket && Bucket != getTombstoneVal())
       return *static_cast<MapEntryTy*>(Bucket);
@@ -370,8 +432,8 @@ public:
     return *NewItem;
   }
 
-  MapEntryTy &GetOrCreateValue(StringRef Key) {
-    return GetOrCreateValue(Key, ValueTy());
+  MapEntryTy &GetOrCreateValueWithHash(StringRef Key, unsigned FullHashValue) {
+    return GetOrCreateValueWithHash(Key, FullHashValue, ValueTy());
   }
 
   /// remove - Remove the specified key/value pair from the map, but do not
@@ -26,7 +26,7 @@
 #ifndef LLVM_ADT_VALUEMAP_H
 #define LLVM_ADT_VALUEMAP_H
 
-#include "llvm/ADT/DenseMap.h"
+#include "llvm/ADT/FlatDenseMap.h"
 #include "llvm/Support/ValueHandle.h"
 #include "llvm/Support/type_traits.h"
 #include "llvm/Support/Mutex.h"
@@ -76,7 +76,8 @@ template<typename KeyT, typename ValueT, typename Config =ValueMapConfig<KeyT> >
 class ValueMap {
   friend class ValueMapCallbackVH<KeyT, ValueT, Config>;
   typedef ValueMapCallbackVH<KeyT, ValueT, Config> ValueMapCVH;
-  typedef DenseMap<ValueMapCVH, ValueT, DenseMapInfo<ValueMapCVH> > MapT;
+  typedef typename HotDenseMap<ValueMapCVH, ValueT,
+                               DenseMapInfo<ValueMapCVH> >::type MapT;
   typedef typename Config::ExtraData ExtraData;
   MapT Map;
   ExtraData Data;
@@ -23,10 +23,15 @@ namespace llvm {
   class Function;
   class Instruction;
   class TargetData;
+  class TargetTransformInfo;
   class Value;
 
   /// \brief Check whether an instruction is likely to be "free" when lowered.
-  bool isInstructionFree(const Instruction *I, const TargetData *TD = 0);
+  ///
+  /// If the target's cost model is given, it is also consulted for casts and
+  /// for address computations that loads and stores can fold.
+  bool isInstructionFree(const Instruction *I, const TargetData *TD = 0,
+                         const TargetTransformInfo *TTI = 0);
 
   /// \brief Check whether a call will lower to something small.
   ///
@@ -85,7 +90,8 @@ namespace llvm {
                     NumRets(0) {}
 
     /// \brief Add information about a block to the current state.
-    void analyzeBasicBlock(const BasicBlock *BB, const TargetData *TD = 0);
+    void analyzeBasicBlock(const BasicBlock *BB, const TargetData *TD = 0,
+                           const TargetTransformInfo *TTI = 0);
 
     /// \brief Add information about a function to the current state.
     void analyzeFunction(Function *F, const TargetData *TD = 0);
@@ -39,6 +39,11 @@ namespace llvm {
     /// Do not inline functions which allocate this many bytes on the stack
     /// when the caller is recursive.
     const unsigned TotalAllocaSizeRecursiveCaller = 1024;
+    /// A call site is hot if the loaded profile says it ran at least
+    /// 1/HotCallSiteRatio as often as the hottest block of the module, and
+    /// cold if it ran less than 1/ColdCallSiteRatio as often.
+    const unsigned HotCallSiteRatio = 100;
+    const unsigned ColdCallSiteRatio = 10000;
   }
 
   /// \brief Represents the cost of inlining a function.
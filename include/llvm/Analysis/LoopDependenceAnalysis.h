@@ -45,9 +45,17 @@ class LoopDependenceAnalysis : public LoopPass {
   /// TODO: doc
   enum DependenceResult { Independent = 0, Dependent = 1, Unknown = 2 };
 
-  /// TODO: doc
+  /// Subscript - The result of testing a pair of subscripts.  L is the loop
+  /// both subscripts are induction variables of, or null if they are
+  /// invariant in the loop nest, and Distance is the number of iterations of
+  /// L from an access through the first subscript to an access through the
+  /// second one with the same value.
   struct Subscript {
-    /// TODO: Add distance, direction, breaking conditions, ...
+    /// TODO: Add direction, breaking conditions, ...
+    const Loop *L;
+    int64_t Distance;
+
+    Subscript() : L(0), Distance(0) {}
   };
 
   /// DependencePair - Represents a data dependence relation between to memory
@@ -104,6 +112,16 @@ public:
   /// between two instructions.
   bool depends(Value*, Value*);
 
+  /// getDistances - Return true if the data dependence between two
+  /// instructions was analysed subscript by subscript, and collect the
+  /// dependence distance in each loop some subscript depends on: the number
+  /// of iterations of that loop from an access of the first instruction to an
+  /// access of the second one to the same location.  The accesses may
+  /// conflict at any distance in the loops that are not listed.  Return false
+  /// if the instructions are independent or the distances are unknown.
+  bool getDistances(Value*, Value*,
+                    SmallVectorImpl<std::pair<const Loop*, int64_t> >&);
+
   bool runOnLoop(Loop*, LPPassManager&);
   virtual void releaseMemory();
   virtual void getAnalysisUsage(AnalysisUsage&) const;
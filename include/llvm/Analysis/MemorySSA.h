@@ -0,0 +1,251 @@
+//===- llvm/Analysis/MemorySSA.h - Memory SSA form -------------*- C++ -*-===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+//
+// This file defines the MemorySSA analysis pass, which builds a sparse SSA
+// form for the memory state of a function.  Every instruction that may write
+// memory is a MemoryDef that produces a new version of memory, every
+// instruction that may only read memory is a MemoryUse of the version it
+// observes, and MemoryPhis merge the versions reaching a join point.  The
+// whole of memory is treated as a single variable, so the form is built once
+// per function in linear time, and clients refine it on demand with alias
+// analysis by walking the def chains (getClobberingMemoryAccess).
+//
+// Unlike MemoryDependenceAnalysis, queries never scan the instructions of a
+// block: only the accesses on the def chain are visited, and the walk crosses
+// block boundaries through the MemoryPhis.
+//
+// Clients that delete or move read-only instructions keep the form up to date
+// with removeInstruction and createMemoryUse.  Clients that make other changes
+// call reset, and the form is rebuilt when it is next queried.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef LLVM_ANALYSIS_MEMORYSSA_H
+#define LLVM_ANALYSIS_MEMORYSSA_H
+
+#include "llvm/Pass.h"
+#include "llvm/Analysis/AliasAnalysis.h"
+#include "llvm/ADT/DenseMap.h"
+#include "llvm/ADT/SmallPtrSet.h"
+#include "llvm/ADT/SmallVector.h"
+
+namespace llvm {
+  class BasicBlock;
+  class DominatorTree;
+  class Instruction;
+  class MemoryPhi;
+  class MemorySSA;
+  class raw_ostream;
+
+  /// MemoryAccess - A node of the memory SSA graph: the live-on-entry
+  /// definition, a MemoryDef, a MemoryUse or a MemoryPhi.
+  class MemoryAccess {
+  public:
+    enum AccessKind { LiveOnEntryKind, DefKind, UseKind, PhiKind };
+
+    typedef SmallPtrSet<MemoryAccess*, 8>::const_iterator user_iterator;
+
+  private:
+    AccessKind Kind;
+    BasicBlock *Block;
+    /// ID - The number of a MemoryDef or MemoryPhi.  The live-on-entry
+    /// definition is 0, and uses are not numbered.
+    unsigned ID;
+    /// Users - The accesses whose defining access or phi operand this is.
+    SmallPtrSet<MemoryAccess*, 8> Users;
+
+    MemoryAccess(const MemoryAccess &) LLVM_DELETED_FUNCTION;
+    void operator=(const MemoryAccess &) LLVM_DELETED_FUNCTION;
+
+    friend class MemorySSA;
+
+  protected:
+    MemoryAccess(AccessKind K, BasicBlock *BB) : Kind(K), Block(BB), ID(0) {}
+
+  public:
+    virtual ~MemoryAccess() {}
+
+    AccessKind getKind() const { return Kind; }
+    BasicBlock *getBlock() const { return Block; }
+    unsigned getID() const { return ID; }
+
+    user_iterator user_begin() const { return Users.begin(); }
+    user_iterator user_end() const { return Users.end(); }
+    bool user_empty() const { return Users.empty(); }
+
+    void print(raw_ostream &OS) const;
+    void dump() const;
+  };
+
+  /// MemoryUseOrDef - An access made by an instruction, together with the
+  /// memory version it starts from.
+  class MemoryUseOrDef : public MemoryAccess {
+    Instruction *MemoryInst;
+    MemoryAccess *DefiningAccess;
+
+    friend class MemorySSA;
+
+  protected:
+    MemoryUseOrDef(AccessKind K, Instruction *I, BasicBlock *BB)
+      : MemoryAccess(K, BB), MemoryInst(I), DefiningAccess(0) {}
+
+  public:
+    /// getMemoryInst - Return the instruction making the access, or null for
+    /// the live-on-entry definition.
+    Instruction *getMemoryInst() const { return MemoryInst; }
+
+    /// getDefiningAccess - Return the nearest MemoryDef or MemoryPhi that
+    /// dominates this access.
+    MemoryAccess *getDefiningAccess() const { return DefiningAccess; }
+
+    static bool classof(const MemoryAccess *MA) {
+      return MA->getKind() != PhiKind;
+    }
+  };
+
+  /// MemoryDef - An instruction that may write memory, or the live-on-entry
+  /// definition.
+  class MemoryDef : public MemoryUseOrDef {
+  public:
+    MemoryDef(Instruction *I, BasicBlock *BB)
+      : MemoryUseOrDef(I ? DefKind : LiveOnEntryKind, I, BB) {}
+
+    static bool classof(const MemoryAccess *MA) {
+      return MA->getKind() == DefKind || MA->getKind() == LiveOnEntryKind;
+    }
+  };
+
+  /// MemoryUse - An instruction that may read but not write memory.
+  class MemoryUse : public MemoryUseOrDef {
+  public:
+    MemoryUse(Instruction *I, BasicBlock *BB)
+      : MemoryUseOrDef(UseKind, I, BB) {}
+
+    static bool classof(const MemoryAccess *MA) {
+      return MA->getKind() == UseKind;
+    }
+  };
+
+  /// MemoryPhi - The merge of the memory versions reaching a join point.
+  class MemoryPhi : public MemoryAccess {
+    SmallVector<std::pair<MemoryAccess*, BasicBlock*>, 4> Operands;
+
+    friend class MemorySSA;
+
+  public:
+    explicit MemoryPhi(BasicBlock *BB) : MemoryAccess(PhiKind, BB) {}
+
+    unsigned getNumIncomingValues() const { return Operands.size(); }
+    MemoryAccess *getIncomingValue(unsigned i) const {
+      return Operands[i].first;
+    }
+    BasicBlock *getIncomingBlock(unsigned i) const {
+      return Operands[i].second;
+    }
+
+    static bool classof(const MemoryAccess *MA) {
+      return MA->getKind() == PhiKind;
+    }
+  };
+
+  /// MemorySSA - The memory SSA form of a function.
+  class MemorySSA : public FunctionPass {
+    Function *F;
+    AliasAnalysis *AA;
+    DominatorTree *DT;
+
+    MemoryDef *LiveOnEntry;
+    DenseMap<const Instruction*, MemoryUseOrDef*> InstructionAccesses;
+    DenseMap<const BasicBlock*, MemoryPhi*> BlockPhis;
+
+    /// ClobberCache - The answers of getClobberingMemoryAccess for
+    /// instructions.  Cleared when a definition is removed.
+    DenseMap<const Instruction*, MemoryAccess*> ClobberCache;
+
+    /// Stale - Set by reset; the form is rebuilt by the next query.
+    bool Stale;
+
+    struct ClobberWalk;
+
+    void buildMemorySSA();
+    void ensureBuilt() {
+      if (Stale)
+        buildMemorySSA();
+    }
+    void deleteAccesses();
+    void placePhis(const SmallPtrSet<BasicBlock*, 32> &DefBlocks);
+    void renameAccesses();
+    MemoryAccess *getLastDefAtBlockEnd(BasicBlock *BB) const;
+    MemoryAccess *walkToClobber(MemoryAccess *MA, ClobberWalk &W);
+    void setDefiningAccess(MemoryUseOrDef *MA, MemoryAccess *Def);
+
+  public:
+    static char ID; // Pass identification, replacement for typeid
+    MemorySSA();
+    ~MemorySSA();
+
+    virtual bool runOnFunction(Function &F);
+    virtual void releaseMemory();
+    virtual void getAnalysisUsage(AnalysisUsage &AU) const;
+    virtual void print(raw_ostream &OS, const Module *M = 0) const;
+    virtual void verifyAnalysis() const;
+
+    /// getMemoryAccess - Return the access made by I, or null if I does not
+    /// touch memory.
+    MemoryUseOrDef *getMemoryAccess(const Instruction *I) {
+      ensureBuilt();
+      return InstructionAccesses.lookup(I);
+    }
+
+    /// getMemoryPhi - Return the MemoryPhi at the start of BB, if any.
+    MemoryPhi *getMemoryPhi(const BasicBlock *BB) {
+      ensureBuilt();
+      return BlockPhis.lookup(BB);
+    }
+
+    /// getLiveOnEntryDef - Return the definition standing for the memory
+    /// state on entry to the function.
+    MemoryDef *getLiveOnEntryDef() {
+      ensureBuilt();
+      return LiveOnEntry;
+    }
+
+    bool isLiveOnEntryDef(const MemoryAccess *MA) const {
+      return MA == LiveOnEntry;
+    }
+
+    /// getClobberingMemoryAccess - Return the nearest access that may modify
+    /// the memory read by I: a MemoryDef, a MemoryPhi whose incoming paths
+    /// disagree, or the live-on-entry definition.  For instructions other
+    /// than loads and stores, whose location is not known, this is the
+    /// defining access.  Returns null if I does not touch memory.
+    MemoryAccess *getClobberingMemoryAccess(Instruction *I);
+
+    /// getClobberingMemoryAccess - Walk up from Start to the nearest access
+    /// that may modify Loc.
+    MemoryAccess *getClobberingMemoryAccess(MemoryAccess *Start,
+                                            const AliasAnalysis::Location &Loc);
+
+    /// removeInstruction - Remove the access made by I, which is about to be
+    /// deleted or moved.  The users of a removed MemoryDef are attached to
+    /// its defining access.
+    void removeInstruction(Instruction *I);
+
+    /// createMemoryUse - Create the access for a read-only instruction that
+    /// has been inserted or moved to a new position.
+    MemoryUse *createMemoryUse(Instruction *I);
+
+    /// reset - Drop the form after changes that removeInstruction and
+    /// createMemoryUse cannot describe.  It is rebuilt by the next query.
+    void reset();
+  };
+
+} // End llvm namespace
+
+#endif
@@ -93,6 +93,13 @@ namespace llvm {
   //
   ImmutablePass *createObjCARCAliasAnalysisPass();
 
+  //===--------------------------------------------------------------------===//
+  //
+  // createNoTargetTransformInfoPass - This pass implements a conservative
+  // target cost model that knows nothing about the target.
+  //
+  ImmutablePass *createNoTargetTransformInfoPass();
+
   //===--------------------------------------------------------------------===//
   //
   // createProfileLoaderPass - This pass loads information from a profile dump
@@ -208,6 +215,13 @@ namespace llvm {
   // information and prints it with -analyze.
   //
   FunctionPass *createMemDepPrinter();
+
+  //===--------------------------------------------------------------------===//
+  //
+  // createMemorySSAPass - This pass builds the memory SSA form of a function
+  // and prints it with -analyze.
+  //
+  FunctionPass *createMemorySSAPass();
 }
 
 #endif
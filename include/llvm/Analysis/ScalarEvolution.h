@@ -253,6 +253,14 @@ namespace llvm {
     /// Mark predicate values currently being processed by isImpliedCond.
     DenseSet<Value*> PendingLoopPredicates;
 
+    /// CreateSCEVDepth - The number of createSCEV calls currently active.
+    /// Past the depth budget, values are left as SCEVUnknown.
+    unsigned CreateSCEVDepth;
+
+    /// NumValuesAnalyzed - The number of instructions analyzed by createSCEV
+    /// in this function, checked against the per-function budget.
+    unsigned NumValuesAnalyzed;
+
     /// ExitLimit - Information about the number of loop iterations for
     /// which a loop exit's branch condition evaluates to the not-taken path.
     /// This is a temporary pair of exact and max expressions that are
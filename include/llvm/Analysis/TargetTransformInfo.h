@@ -0,0 +1,145 @@
+//===- llvm/Analysis/TargetTransformInfo.h - Target cost model --*- C++ -*-===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+//
+// This file defines the TargetTransformInfo analysis group, which lets
+// IR-level transformations ask the target how expensive an instruction will
+// be once it is lowered, and how wide its vector registers are.
+//
+// Like AliasAnalysis, implementations chain: a query that an implementation
+// does not answer is forwarded to the previous one, ending in the
+// conservative default (-no-tti).  Code generators add their implementation
+// through TargetMachine::addAnalysisPasses.
+//
+// Costs are in abstract units where a simple scalar instruction costs one.
+// Besides costs, the interface answers the structural questions that IR
+// transformations used to ask TargetLowering directly: which types are legal,
+// how many registers there are, and which addressing modes a load or store
+// can fold.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef LLVM_ANALYSIS_TARGETTRANSFORMINFO_H
+#define LLVM_ANALYSIS_TARGETTRANSFORMINFO_H
+
+#include "llvm/Support/DataTypes.h"
+
+namespace llvm {
+
+class AnalysisUsage;
+class GlobalValue;
+class Pass;
+class Type;
+
+class TargetTransformInfo {
+protected:
+  /// PrevTTI - The implementation that queries are forwarded to.  This is
+  /// null only for the default implementation at the end of the chain.
+  TargetTransformInfo *PrevTTI;
+
+  /// InitializeTargetTransformInfo - Subclasses must call this method to
+  /// initialize the TargetTransformInfo interface before any other methods
+  /// are called.  This is typically called by the run* methods of these
+  /// subclasses.  This may be called multiple times.
+  ///
+  void InitializeTargetTransformInfo(Pass *P);
+
+  /// getAnalysisUsage - All target information implementations should invoke
+  /// this directly (using TargetTransformInfo::getAnalysisUsage(AU)).
+  virtual void getAnalysisUsage(AnalysisUsage &AU) const;
+
+public:
+  static char ID; // Class identification, replacement for typeinfo
+  TargetTransformInfo() : PrevTTI(0) {}
+  virtual ~TargetTransformInfo();
+
+  /// ShuffleKind - The kinds of shuffles that getShuffleCost knows about.
+  enum ShuffleKind {
+    SK_Broadcast,       ///< Splat lane 0 into every lane.
+    SK_Reverse,         ///< Reverse the order of the lanes.
+    SK_InsertSubvector, ///< Insert a subvector at lane Index.
+    SK_ExtractSubvector ///< Extract a subvector starting at lane Index.
+  };
+
+  /// PopcntSupportKind - How well the target counts the set bits of an
+  /// integer.
+  enum PopcntSupportKind {
+    PSK_Software,     ///< Expanded into a sequence of bitwise operations.
+    PSK_SlowHardware, ///< Custom lowered, e.g. through a vector unit.
+    PSK_FastHardware  ///< A native population count instruction.
+  };
+
+  //===--------------------------------------------------------------------===//
+  /// Legality and register queries
+  ///
+
+  /// isTypeLegal - Return true if values of type Ty live in a single
+  /// register of the target and are operated on directly.
+  virtual bool isTypeLegal(Type *Ty) const;
+
+  /// isLegalAddressingMode - Return true if a load or store of type Ty can
+  /// fold the address BaseGV + BaseOffset + BaseReg + Scale*ScaleReg, where
+  /// any of the parts may be absent (a null BaseGV, a zero offset or scale,
+  /// or no base register).
+  virtual bool isLegalAddressingMode(Type *Ty, GlobalValue *BaseGV,
+                                     int64_t BaseOffset, bool HasBaseReg,
+                                     int64_t Scale) const;
+
+  /// getNumberOfRegisters - Return the number of registers of the given kind
+  /// that are available for allocation.  Zero means that the target has no
+  /// vector registers.
+  virtual unsigned getNumberOfRegisters(bool Vector) const;
+
+  /// getRegisterBitWidth - Return the width in bits of the widest register
+  /// of the given kind.  A vector width of zero means that the target has
+  /// no vector registers.
+  virtual unsigned getRegisterBitWidth(bool Vector) const;
+
+  /// getPopcntSupport - Return how well the target supports llvm.ctpop on
+  /// integers of the given width.
+  virtual PopcntSupportKind getPopcntSupport(unsigned IntTyWidthInBit) const;
+
+  //===--------------------------------------------------------------------===//
+  /// Cost queries
+  ///
+
+  /// getArithmeticInstrCost - Return the cost of a binary operator with the
+  /// given IR opcode on values of type Ty, which may be a vector.
+  virtual unsigned getArithmeticInstrCost(unsigned Opcode, Type *Ty) const;
+
+  /// getShuffleCost - Return the cost of a shuffle of the given kind on a
+  /// vector of type Tp.  For subvector shuffles, Index is the first lane and
+  /// SubTp the type of the subvector.
+  virtual unsigned getShuffleCost(ShuffleKind Kind, Type *Tp, int Index = 0,
+                                  Type *SubTp = 0) const;
+
+  /// getCastInstrCost - Return the cost of a cast with the given IR opcode
+  /// from Src to Dst.
+  virtual unsigned getCastInstrCost(unsigned Opcode, Type *Dst,
+                                    Type *Src) const;
+
+  /// getCmpSelInstrCost - Return the cost of a compare or select on values
+  /// of type ValTy.  For a select, CondTy is the type of the condition.
+  virtual unsigned getCmpSelInstrCost(unsigned Opcode, Type *ValTy,
+                                      Type *CondTy = 0) const;
+
+  /// getVectorInstrCost - Return the cost of an insertelement or
+  /// extractelement of lane Index of a vector of type Val.
+  virtual unsigned getVectorInstrCost(unsigned Opcode, Type *Val,
+                                      unsigned Index) const;
+
+  /// getMemoryOpCost - Return the cost of a load or store of a value of type
+  /// Src with the given alignment in the given address space.
+  virtual unsigned getMemoryOpCost(unsigned Opcode, Type *Src,
+                                   unsigned Alignment,
+                                   unsigned AddressSpace) const;
+};
+
+} // End llvm namespace
+
+#endif
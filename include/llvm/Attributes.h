@@ -94,6 +94,7 @@ DECLARE_LLVM_ATTRIBUTE(NonLazyBind,1U<<31) ///< Function is called early and/or
                                             /// often, so lazy binding isn't
                                             /// worthwhile.
 DECLARE_LLVM_ATTRIBUTE(AddressSafety,1ULL<<32) ///< Address safety checking is on.
+DECLARE_LLVM_ATTRIBUTE(Cold,1ULL<<33) ///< Function is rarely or never executed.
 
 #undef DECLARE_LLVM_ATTRIBUTE
 
@@ -119,7 +120,7 @@ const AttrConst FunctionOnly = {NoReturn_i | NoUnwind_i | ReadNone_i |
   ReadOnly_i | NoInline_i | AlwaysInline_i | OptimizeForSize_i |
   StackProtect_i | StackProtectReq_i | NoRedZone_i | NoImplicitFloat_i |
   Naked_i | InlineHint_i | StackAlignment_i |
-  UWTable_i | NonLazyBind_i | ReturnsTwice_i | AddressSafety_i};
+  UWTable_i | NonLazyBind_i | ReturnsTwice_i | AddressSafety_i | Cold_i};
 
 /// @brief Parameter attributes that do not apply to vararg call arguments.
 const AttrConst VarArgsIncompatible = {StructRet_i};
@@ -232,6 +233,9 @@ public:
     void addAddressSafetyAttr() {
       Bits |= Attribute::AddressSafety_i;
     }
+    void addColdAttr() {
+      Bits |= Attribute::Cold_i;
+    }
     void addAlignmentAttr(unsigned Align) {
       if (Align == 0) return;
       assert(isPowerOf2_32(Align) && "Alignment must be a power of two.");
@@ -342,6 +346,9 @@ public:
   bool hasAddressSafetyAttr() const {
     return Bits & Attribute::AddressSafety_i;
   }
+  bool hasColdAttr() const {
+    return Bits & Attribute::Cold_i;
+  }
 
   /// This returns the alignment field of an attribute as a byte alignment
   /// value.
@@ -433,7 +440,7 @@ public:
     if (Attrs.hasAlignmentAttr())
       EncodedAttrs |= (1ULL << 16) <<
         (((Attrs.Bits & Attribute::Alignment_i) - 1) >> 16);
-    EncodedAttrs |= (Attrs.Raw() & (0xfffULL << 21)) << 11;
+    EncodedAttrs |= (Attrs.Raw() & (0x1fffULL << 21)) << 11;
     return EncodedAttrs;
   }
 
@@ -450,7 +457,7 @@ public:
     Attributes Attrs(EncodedAttrs & 0xffff);
     if (Alignment)
       Attrs |= Attributes::constructAlignmentFromInt(Alignment);
-    Attrs |= Attributes((EncodedAttrs & (0xfffULL << 32)) >> 11);
+    Attrs |= Attributes((EncodedAttrs & (0x1fffULL << 32)) >> 11);
     return Attrs;
   }
 
@@ -23,6 +23,7 @@ namespace llvm {
 class AllocaInst;
 class Constant;
 class ConstantFP;
+class Function;
 class FunctionLoweringInfo;
 class Instruction;
 class LoadInst;
@@ -71,6 +72,10 @@ protected:
   /// it makes sense (for example, on function calls)
   MachineInstr *EmitStartPt;
 
+  /// SelectingFunction - True if FastISel selects the whole function
+  /// (-global-isel), rather than whatever it can of each block.
+  bool SelectingFunction;
+
 public:
   /// getLastLocalValue - Return the position of the last instruction
   /// emitted for materializing constants for use in the current block.
@@ -88,6 +93,14 @@ public:
   ///
   void startNewBlock();
 
+  /// canSelectFunction - Return true if the target expects to select every
+  /// instruction of F, so F should be selected as a whole by FastISel even
+  /// when optimizing.  The default is to return false.
+  virtual bool canSelectFunction(const Function &) { return false; }
+
+  /// setSelectingFunction - Tell FastISel that it selects the whole function.
+  void setSelectingFunction(bool Value) { SelectingFunction = Value; }
+
   /// getCurDebugLoc() - Return current debug location information.
   DebugLoc getCurDebugLoc() const { return DL; }
 
@@ -113,6 +126,13 @@ public:
   /// defined locally.
   unsigned lookUpRegForValue(const Value *V);
 
+  /// canFoldAcrossBlocks - Return true if I, which is defined in another block
+  /// than the one being selected, can be folded into an instruction of the
+  /// current block.  This requires whole-function selection, and I's operands
+  /// must be available in every block I dominates: constants, static allocas
+  /// and values already assigned a virtual register for use in other blocks.
+  bool canFoldAcrossBlocks(const Instruction *I) const;
+
   /// getRegForGEPIndex - This is a wrapper around getRegForValue that also
   /// takes care of truncating or sign-extending the given getelementptr
   /// index value.
@@ -338,6 +358,11 @@ protected:
   /// the CFG.
   void FastEmitBranch(MachineBasicBlock *MBB, DebugLoc DL);
 
+  /// FastEmitTryRange - Bracket the instructions emitted after Prev (or from
+  /// the start of the block if Prev is null) with EH labels, and record them
+  /// as an invoke that unwinds to LandingPad.
+  void FastEmitTryRange(MachineInstr *Prev, MachineBasicBlock *LandingPad);
+
   void UpdateValueMap(const Value* I, unsigned Reg, unsigned NumRegs = 1);
 
   unsigned createResultReg(const TargetRegisterClass *RC);
@@ -373,6 +398,8 @@ private:
 
   bool SelectExtractValue(const User *I);
 
+  bool SelectLandingPad(const User *I);
+
   bool SelectInsertValue(const User *I);
 
   /// HandlePHINodesInSuccessorBlocks - Handle PHI nodes in successor blocks.
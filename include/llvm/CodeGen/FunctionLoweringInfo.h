@@ -62,6 +62,10 @@ public:
   /// registers.
   bool CanLowerReturn;
 
+  /// UsesFastISel - true if FastISel may select part of the function, so
+  /// SelectionDAG can't assume that it sees whole blocks.
+  bool UsesFastISel;
+
   /// DemoteRegister - if CanLowerReturn is false, DemoteRegister is a vreg
   /// allocated to hold a pointer to the hidden sret parameter.
   unsigned DemoteRegister;
@@ -566,6 +566,62 @@ namespace llvm {
     }
   };
 
+  /// PackedLiveSegments - A read-only copy of the segments of a LiveInterval
+  /// for intervals that are queried many times without changing, such as the
+  /// fixed register unit intervals during register allocation.
+  ///
+  /// The segment boundaries are stored as raw index numbers in a single
+  /// sorted array: start0, end0, start1, end1, ...  A lookup is a binary
+  /// search over contiguous integers instead of a search that dereferences
+  /// the index list entry behind every SlotIndex it compares.  A position is
+  /// live when the number of boundaries at or before it is odd.
+  ///
+  /// Raw index numbers change when the SlotIndexes are renumbered, so the copy
+  /// is stamped with the numbering generation it was made in.  It must be
+  /// recomputed when isCurrent() returns false, and whenever the original
+  /// interval changes.
+  class PackedLiveSegments {
+    SmallVector<unsigned, 8> Bounds;
+    SmallVector<VNInfo*, 4> Values;
+    unsigned Generation;
+
+    /// Return the position of the first boundary after Idx.
+    unsigned upperBound(SlotIndex Idx) const;
+
+  public:
+    PackedLiveSegments() : Generation(~0u) {}
+
+    /// init - Copy the segments of LI, numbered by Indexes.
+    void init(const LiveInterval &LI, const SlotIndexes &Indexes);
+
+    /// isCurrent - Return true if the copy was made in the current numbering
+    /// generation of Indexes.
+    bool isCurrent(const SlotIndexes &Indexes) const {
+      return Generation == Indexes.getGeneration();
+    }
+
+    bool empty() const { return Values.empty(); }
+
+    /// size - Return the number of segments.
+    unsigned size() const { return Values.size(); }
+
+    /// find - Return the number of the first segment that ends after Idx, or
+    /// size().  This is the same segment as LiveInterval::find returns.
+    unsigned find(SlotIndex Idx) const { return upperBound(Idx) / 2; }
+
+    /// liveAt - Return true if Idx is inside a segment.
+    bool liveAt(SlotIndex Idx) const { return upperBound(Idx) & 1; }
+
+    /// getVNInfoAt - Return the value live at Idx, or NULL.
+    VNInfo *getVNInfoAt(SlotIndex Idx) const {
+      unsigned Pos = upperBound(Idx);
+      return Pos & 1 ? Values[Pos / 2] : 0;
+    }
+
+    /// overlaps - Return true if any segment of LI overlaps this copy.
+    bool overlaps(const LiveInterval &LI) const;
+  };
+
   /// ConnectedVNInfoEqClasses - Helper class that can divide VNInfos in a
   /// LiveInterval into equivalence clases of connected components. A
   /// LiveInterval that has multiple connected components can be broken into
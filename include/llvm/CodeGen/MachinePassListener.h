@@ -0,0 +1,75 @@
+//===-- llvm/CodeGen/MachinePassListener.h - Codegen pass profile -*- C++ -*-=//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+//
+// This file defines the MachinePassListener interface.  A listener installed on
+// a TargetMachine is told how long every MachineFunctionPass took on every
+// function, and how large the function was afterwards.  Unlike -time-passes,
+// which sums the time of a pass over the whole module, this attributes compile
+// time to individual functions, so functions whose compile time is out of
+// proportion to their size can be found.
+//
+// JIT clients install a listener with ExecutionEngine::setMachinePassListener.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef LLVM_CODEGEN_MACHINEPASSLISTENER_H
+#define LLVM_CODEGEN_MACHINEPASSLISTENER_H
+
+#include "llvm/Support/Mutex.h"
+
+namespace llvm {
+
+class MachineFunction;
+class Pass;
+class raw_ostream;
+
+/// MachinePassRecord - The cost of running one pass over one function.  The
+/// sizes are measured after the pass has run.
+struct MachinePassRecord {
+  const MachineFunction *MF;
+  const Pass *P;
+
+  /// WallTime - Elapsed time in the pass, in seconds.
+  double WallTime;
+
+  unsigned NumInstrs;
+  unsigned NumVirtRegs;
+  unsigned NumBlocks;
+};
+
+/// MachinePassListener - Called by MachineFunctionPass::runOnFunction after
+/// each pass when a listener is installed on the TargetMachine.  Without a
+/// listener no time is measured and nothing is counted.
+class MachinePassListener {
+public:
+  virtual ~MachinePassListener();
+
+  /// passRun - A machine function pass has run.
+  virtual void passRun(const MachinePassRecord &Record) = 0;
+};
+
+/// CSVMachinePassListener - Print the records as CSV to a stream, one line per
+/// record, after a header line naming the columns:
+///
+///   function,pass,seconds,instructions,vregs,blocks
+///
+/// Records may come from several threads at once, for instance when the
+/// listener is installed on every target machine passed to splitCodeGen.
+class CSVMachinePassListener : public MachinePassListener {
+  raw_ostream &OS;
+  sys::Mutex Lock;
+
+public:
+  explicit CSVMachinePassListener(raw_ostream &OS);
+  virtual void passRun(const MachinePassRecord &Record);
+};
+
+} // End llvm namespace
+
+#endif
@@ -279,18 +279,17 @@ public:
   }
 
   /// getIssueWidth - Return the max instructions per scheduling group.
-  unsigned getIssueWidth() const {
-    return (InstrItins && InstrItins->SchedModel)
-      ? InstrItins->SchedModel->IssueWidth : 1;
-  }
+  unsigned getIssueWidth() const { return SchedModel.getIssueWidth(); }
 
   /// getNumMicroOps - Return the number of issue slots required for this MI.
   unsigned getNumMicroOps(MachineInstr *MI) const {
-    if (!InstrItins) return 1;
-    int UOps = InstrItins->getNumMicroOps(MI->getDesc().getSchedClass());
-    return (UOps >= 0) ? UOps : TII->getNumMicroOps(InstrItins, MI);
+    return SchedModel.getNumMicroOps(MI);
   }
 
+  /// getSchedModel - Return the machine model used for latencies, issue
+  /// width and processor resources.
+  const TargetSchedModel *getSchedModel() const { return &SchedModel; }
+
 protected:
   // Top-Level entry points for the schedule() driver...
 
@@ -0,0 +1,51 @@
+//===-- llvm/CodeGen/ParallelCodeGen.h - Parallel codegen -------*- C++ -*-===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+//
+// This file declares splitCodeGen, which generates code for a module on
+// several threads at once.  The module is divided into partitions by
+// ModuleSplitter and each partition is compiled to its own output, which the
+// linker then combines like the objects of separate translation units.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef LLVM_CODEGEN_PARALLELCODEGEN_H
+#define LLVM_CODEGEN_PARALLELCODEGEN_H
+
+#include "llvm/ADT/ArrayRef.h"
+#include "llvm/Target/TargetMachine.h"
+#include <string>
+
+namespace llvm {
+
+class Module;
+class formatted_raw_ostream;
+
+/// splitCodeGen - Split M into one partition for each of TMs and emit the
+/// code for partition i with TMs[i] to Outs[i], each on its own thread.
+///
+/// Every partition gets a copy of the module in its own LLVMContext, so M is
+/// only read, apart from naming unnamed symbols.  Some partitions may be
+/// empty, in which case their output defines no symbols.  The target
+/// machines must not be shared and must have been configured alike; a
+/// MachinePassListener installed on them must be thread-safe.
+///
+/// If LLVM is not multithreaded yet, this runs the threads in multithreaded
+/// mode and catches fatal errors on them, which requires that no fatal error
+/// handler is installed.  Otherwise a fatal error exits the process.
+///
+/// Returns true and sets ErrMsg if the target cannot emit FileType or a
+/// partition hit a fatal error.
+bool splitCodeGen(Module &M, ArrayRef<TargetMachine*> TMs,
+                  ArrayRef<formatted_raw_ostream*> Outs,
+                  TargetMachine::CodeGenFileType FileType,
+                  bool DisableVerify, std::string &ErrMsg);
+
+} // End llvm namespace
+
+#endif
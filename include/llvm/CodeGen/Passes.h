@@ -22,6 +22,7 @@
 namespace llvm {
 
   class FunctionPass;
+  class ImmutablePass;
   class MachineFunctionPass;
   class PassInfo;
   class PassManagerBase;
@@ -366,6 +367,13 @@ namespace llvm {
   ///
   FunctionPass *createGreedyRegisterAllocator();
 
+  /// LinearScanRegisterAllocation Pass - This pass visits the live ranges in
+  /// order of their start points, and only splits them around basic blocks.
+  /// It is faster than the greedy allocator and produces much better code than
+  /// the fast allocator.
+  ///
+  FunctionPass *createLinearScanRegisterAllocator();
+
   /// PBQPRegisterAllocation Pass - This pass implements the Partitioned Boolean
   /// Quadratic Prograaming (PBQP) based register allocator.
   ///
@@ -424,6 +432,11 @@ namespace llvm {
   /// headers to target specific alignment boundary.
   extern char &CodePlacementOptID;
 
+  /// createBasicTargetTransformInfoPass - This pass implements the
+  /// TargetTransformInfo interface using the target's legal types and
+  /// operation actions.
+  ImmutablePass *createBasicTargetTransformInfoPass(const TargetLowering *TLI);
+
   /// GCLowering Pass - Performs target-independent LLVM IR transformations for
   /// highly portable strategies.
   ///
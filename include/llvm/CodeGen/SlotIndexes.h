@@ -76,6 +76,7 @@ namespace llvm {
   /// SlotIndex - An opaque wrapper around machine indexes.
   class SlotIndex {
     friend class SlotIndexes;
+    friend class PackedLiveSegments;
 
     enum Slot {
       /// Basic block boundary.  Used for live ranges entering and leaving a
@@ -324,6 +325,32 @@ namespace llvm {
     /// and MBB id.
     SmallVector<IdxMBBPair, 8> idx2MBBMap;
 
+    /// Generation - Incremented whenever the indexes are numbered or
+    /// renumbered.  Raw index numbers cached outside the index list are only
+    /// valid for one generation.
+    unsigned Generation;
+
+    /// MBBStarts - The raw numbers of the block start indexes in idx2MBBMap,
+    /// in the same order.  Block lookups binary search this dense array
+    /// instead of dereferencing an index list entry for every comparison.
+    /// It is rebuilt on demand after renumbering.
+    mutable SmallVector<unsigned, 8> MBBStarts;
+    mutable unsigned MBBStartsGeneration;
+
+    /// Rebuild MBBStarts from idx2MBBMap.
+    void computeMBBStarts() const;
+
+    /// Return the first idx2MBBMap entry whose start index is not before
+    /// index, like std::lower_bound.
+    SmallVectorImpl<IdxMBBPair>::const_iterator
+    lowerBoundMBB(SlotIndex index) const {
+      if (MBBStartsGeneration != Generation)
+        computeMBBStarts();
+      return idx2MBBMap.begin() +
+        (std::lower_bound(MBBStarts.begin(), MBBStarts.end(),
+                          unsigned(index.getIndex())) - MBBStarts.begin());
+    }
+
     // IndexListEntry allocator.
     BumpPtrAllocator ileAllocator;
 
@@ -344,7 +371,8 @@ namespace llvm {
   public:
     static char ID;
 
-    SlotIndexes() : MachineFunctionPass(ID) {
+    SlotIndexes()
+      : MachineFunctionPass(ID), Generation(0), MBBStartsGeneration(~0u) {
       initializeSlotIndexesPass(*PassRegistry::getPassRegistry());
     }
 
@@ -359,6 +387,10 @@ namespace llvm {
     /// Renumber the index list, providing space for new instructions.
     void renumberIndexes();
 
+    /// Returns the current numbering generation.  Raw index numbers copied
+    /// out of the index list stay valid while the generation is unchanged.
+    unsigned getGeneration() const { return Generation; }
+
     /// Returns the zero index for this analysis.
     SlotIndex getZeroIndex() {
       assert(indexList.front().getIndex() == 0 && "First index is not 0?");
@@ -468,8 +500,13 @@ namespace llvm {
     MachineBasicBlock* getMBBFromIndex(SlotIndex index) const {
       if (MachineInstr *MI = getInstructionFromIndex(index))
         return MI->getParent();
-      SmallVectorImpl<IdxMBBPair>::const_iterator I =
-        std::lower_bound(idx2MBBMap.begin(), idx2MBBMap.end(), index);
+      return lookupMBB(index);
+    }
+
+    /// Returns the basic block which the given index falls in by searching
+    /// the block boundaries, without looking at the instruction at index.
+    MachineBasicBlock* lookupMBB(SlotIndex index) const {
+      SmallVectorImpl<IdxMBBPair>::const_iterator I = lowerBoundMBB(index);
       // Take the pair containing the index
       SmallVectorImpl<IdxMBBPair>::const_iterator J =
         ((I != idx2MBBMap.end() && I->first > index) ||
@@ -483,8 +520,7 @@ namespace llvm {
 
     bool findLiveInMBBs(SlotIndex start, SlotIndex end,
                         SmallVectorImpl<MachineBasicBlock*> &mbbs) const {
-      SmallVectorImpl<IdxMBBPair>::const_iterator itr =
-        std::lower_bound(idx2MBBMap.begin(), idx2MBBMap.end(), start);
+      SmallVectorImpl<IdxMBBPair>::const_iterator itr = lowerBoundMBB(start);
       bool resVal = false;
 
       while (itr != idx2MBBMap.end()) {
@@ -503,8 +539,7 @@ namespace llvm {
 
       assert(start < end && "Backwards ranges not allowed.");
 
-      SmallVectorImpl<IdxMBBPair>::const_iterator itr =
-        std::lower_bound(idx2MBBMap.begin(), idx2MBBMap.end(), start);
+      SmallVectorImpl<IdxMBBPair>::const_iterator itr = lowerBoundMBB(start);
 
       if (itr == idx2MBBMap.end()) {
         itr = prior(itr);
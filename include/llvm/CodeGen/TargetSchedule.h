@@ -51,6 +51,34 @@ public:
   /// data. This models scheduling at each stage in the processor pipeline.
   bool hasInstrItineraries() const { return !InstrItins.isEmpty(); }
 
+  /// Return the maximum number of micro-ops that may be issued per cycle.
+  unsigned getIssueWidth() const { return SchedModel.IssueWidth; }
+
+  /// Return the number of issue slots required for this MI.
+  unsigned getNumMicroOps(const MachineInstr *MI) const;
+
+  /// Get the number of kinds of resources for this target.
+  unsigned getNumProcResourceKinds() const {
+    return SchedModel.getNumProcResourceKinds();
+  }
+
+  /// Get a processor resource by ID for convenience.
+  const MCProcResourceDesc *getProcResource(unsigned PIdx) const {
+    return SchedModel.getProcResource(PIdx);
+  }
+
+  typedef const MCWriteProcResEntry *ProcResIter;
+
+  /// Get an iterator into the processor resources consumed by this
+  /// scheduling class.
+  ProcResIter getWriteProcResBegin(const MCSchedClassDesc *SC) const;
+  ProcResIter getWriteProcResEnd(const MCSchedClassDesc *SC) const;
+
+  /// Return the MCSchedClassDesc for this instruction. Variant classes are
+  /// resolved by looking at the instruction. The machine model does not
+  /// describe the instruction if the class is invalid or has no writes.
+  const MCSchedClassDesc *resolveSchedClass(const MachineInstr *MI) const;
+
   /// computeOperandLatency - Compute and return the latency of the given data
   /// dependent def and use when the operand indices are already known. UseMI
   /// may be NULL for an unknown user.
@@ -69,9 +97,6 @@ private:
   /// instruction's latency if operand lookup is not required.
   /// Otherwise return -1.
   int getDefLatency(const MachineInstr *DefMI, bool FindMin) const;
-
-  /// Return the MCSchedClassDesc for this instruction.
-  const MCSchedClassDesc *resolveSchedClass(const MachineInstr *MI) const;
 };
 
 } // namespace llvm
@@ -40,6 +40,7 @@ class GlobalValue;
 class JITEventListener;
 class JITMemoryManager;
 class MachineCodeInfo;
+class MachinePassListener;
 class Module;
 class MutexGuard;
 class TargetData;
@@ -364,6 +365,12 @@ public:
   virtual void RegisterJITEventListener(JITEventListener *) {}
   virtual void UnregisterJITEventListener(JITEventListener *) {}
 
+  /// setMachinePassListener - Install a listener that is told the compile time
+  /// and size of every function after every machine function pass.  See
+  /// MachinePassListener.h.  Does not take ownership of the argument, which
+  /// may be NULL to remove the listener.
+  virtual void setMachinePassListener(MachinePassListener *) {}
+
   /// DisableLazyCompilation - When lazy compilation is off (the default), the
   /// JIT will eagerly compile every function reachable from the argument to
   /// getPointerToFunction.  If lazy compilation is turned on, the JIT will only
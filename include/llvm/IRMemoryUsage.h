@@ -0,0 +1,72 @@
+//===-- llvm/IRMemoryUsage.h - Memory footprint of a Module -----*- C++ -*-===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+//
+// This file declares IRMemoryUsage, which estimates how much memory a Module
+// and its LLVMContext use, broken down by category, and the pass that prints
+// it (opt -print-ir-memory).
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef LLVM_IRMEMORYUSAGE_H
+#define LLVM_IRMEMORYUSAGE_H
+
+#include <cstddef>
+#include <vector>
+
+namespace llvm {
+
+class Function;
+class Module;
+class ModulePass;
+class raw_ostream;
+
+/// IRMemoryUsage - The number of bytes used by a module, by category.  The
+/// sizes are computed from the sizes of the objects and the arrays they own,
+/// without allocator overhead.  Types and metadata are owned by the context
+/// and shared by every module in it, so those two categories cover the whole
+/// context; everything else covers only the module.
+class IRMemoryUsage {
+public:
+  /// FunctionUsage - The bytes directly owned by one function: its
+  /// arguments, blocks, instructions, operands, names and symbol table.
+  struct FunctionUsage {
+    const Function *F;
+    size_t Bytes;
+    unsigned NumInstructions;
+  };
+
+  size_t Instructions;  ///< Instruction objects.
+  size_t Uses;          ///< Operand arrays, including PHI incoming blocks.
+  size_t Constants;     ///< Constants referenced by the module.
+  size_t Globals;       ///< Functions, globals, aliases, arguments and blocks.
+  size_t Types;         ///< Types in the context.
+  size_t Metadata;      ///< MDNodes, MDStrings and instruction attachments.
+  size_t ValueNames;    ///< Name entries of named values.
+  size_t SymbolTables;  ///< Symbol table buckets.
+
+  /// Functions - Per-function usage of the defined functions, largest first.
+  std::vector<FunctionUsage> Functions;
+
+  explicit IRMemoryUsage(const Module &M);
+
+  /// getTotal - Return the sum of all the categories.
+  size_t getTotal() const;
+
+  /// print - Print the breakdown followed by the NumFunctions largest
+  /// functions.
+  void print(raw_ostream &OS, unsigned NumFunctions = 10) const;
+};
+
+/// createIRMemoryUsagePrinterPass - Create a pass that prints the memory
+/// usage of the module it runs on to OS.
+ModulePass *createIRMemoryUsagePrinterPass(raw_ostream &OS);
+
+} // End llvm namespace
+
+#endif
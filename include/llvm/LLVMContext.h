@@ -16,6 +16,7 @@
 #define LLVM_LLVMCONTEXT_H
 
 #include "llvm/Support/Compiler.h"
+#include <cstddef>
 
 namespace llvm {
 
@@ -56,6 +57,16 @@ public:
   /// getMDKindNames - Populate client supplied SmallVector with the name for
   /// custom metadata IDs registered in this LLVMContext.
   void getMDKindNames(SmallVectorImpl<StringRef> &Result) const;
+
+  /// purgeUnusedMetadata - Destroy every MDNode in this context that is no
+  /// longer referenced by an instruction, a named metadata node, a value
+  /// handle or another live MDNode, and return the number of nodes destroyed.
+  /// Clients must not hold plain MDNode pointers across this call.
+  unsigned purgeUnusedMetadata();
+
+  /// getMetadataMemoryUsage - Return the number of bytes currently used by
+  /// MDNodes and MDStrings in this context.
+  size_t getMetadataMemoryUsage() const;
   
   
   typedef void (*InlineAsmDiagHandlerTy)(const SMDiagnostic&, void *Context,
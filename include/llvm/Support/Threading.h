@@ -54,6 +54,22 @@ namespace llvm {
   /// the thread stack.
   void llvm_execute_on_thread(void (*UserFn)(void*), void *UserData,
                               unsigned RequestedStackSize = 0);
+
+  /// llvm_execute_on_threads - Execute \p UserFn once for each of the
+  /// \p NumThreads entries of \p UserData, all at the same time on separate
+  /// threads, and wait for all of them to finish.
+  ///
+  /// Work for which no thread can be created is executed on the calling
+  /// thread, so every call is made even where threads are not available.
+  ///
+  /// \param UserFn - The callback to execute.
+  /// \param UserData - The argument to pass to each call.
+  /// \param NumThreads - The number of calls to make.
+  /// \param RequestedStackSize - If non-zero, a requested size (in bytes) for
+  /// each thread stack.
+  void llvm_execute_on_threads(void (*UserFn)(void*), void *const *UserData,
+                               unsigned NumThreads,
+                               unsigned RequestedStackSize = 0);
 }
 
 #endif
@@ -29,6 +29,7 @@ class GlobalValue;
 class MCAsmInfo;
 class MCCodeGenInfo;
 class MCContext;
+class MachinePassListener;
 class PassManagerBase;
 class Target;
 class TargetData;
@@ -85,6 +86,10 @@ protected: // Can only create subclasses.
   unsigned MCUseCFI : 1;
   unsigned MCUseDwarfDirectory : 1;
 
+  /// PassListener - Receives the compile time and size of every function
+  /// after every machine function pass, or null.
+  MachinePassListener *PassListener;
+
 public:
   virtual ~TargetMachine();
 
@@ -189,6 +194,15 @@ public:
   /// with explicit directories.
   void setMCUseDwarfDirectory(bool Value) { MCUseDwarfDirectory = Value; }
 
+  /// getMachinePassListener - Return the listener profiling the machine
+  /// function passes, or null.
+  MachinePassListener *getMachinePassListener() const { return PassListener; }
+
+  /// setMachinePassListener - Install a listener that is told the compile
+  /// time and size of every function after every machine function pass, or
+  /// remove it with null.  The TargetMachine does not take ownership.
+  void setMachinePassListener(MachinePassListener *L) { PassListener = L; }
+
   /// getRelocationModel - Returns the code generation relocation model. The
   /// choices are static, PIC, and dynamic-no-pic, and target default.
   Reloc::Model getRelocationModel() const;
@@ -232,6 +246,11 @@ public:
   /// sections.
   static void setFunctionSections(bool);
 
+  /// addAnalysisPasses - Register analysis passes for this target with a
+  /// pass manager, so that IR-level transformations can query the target's
+  /// cost model through TargetTransformInfo.
+  virtual void addAnalysisPasses(PassManagerBase &) {}
+
   /// CodeGenFileType - These enums are meant to be passed into
   /// addPassesToEmitFile to indicate what type of file to emit, and returned by
   /// it to indicate what type of file could actually be made.
@@ -294,6 +313,10 @@ public:
   /// addPassToEmitX methods for generating a pipeline of CodeGen passes.
   virtual TargetPassConfig *createPassConfig(PassManagerBase &PM);
 
+  /// addAnalysisPasses - Register the TargetTransformInfo implementation
+  /// backed by this target's TargetLowering.
+  virtual void addAnalysisPasses(PassManagerBase &PM);
+
   /// addPassesToEmitFile - Add passes to the specified pass manager to get the
   /// specified file emitted.  Typically this will involve several steps of code
   /// generation.
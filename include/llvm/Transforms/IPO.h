@@ -192,6 +192,12 @@ ModulePass *createMergeFunctionsPass();
 /// createPartialInliningPass - This pass inlines parts of functions.
 ///
 ModulePass *createPartialInliningPass();
+
+//===----------------------------------------------------------------------===//
+/// createFunctionOrderingPass - This pass reorders the functions of a module
+/// so that functions which often call each other are emitted close together.
+///
+ModulePass *createFunctionOrderingPass();
   
 //===----------------------------------------------------------------------===//
 // createMetaRenamerPass - Rename everything with metasyntatic names.
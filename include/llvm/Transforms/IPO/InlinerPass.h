@@ -18,13 +18,19 @@
 #define LLVM_TRANSFORMS_IPO_INLINERPASS_H
 
 #include "llvm/CallGraphSCCPass.h"
+#include "llvm/ADT/DenseMap.h"
 
 namespace llvm {
+  class BasicBlock;
   class CallSite;
+  class Instruction;
   class TargetData;
   class InlineCost;
   template<class PtrType, unsigned SmallSize>
   class SmallPtrSet;
+  template<class FType, class BType>
+  class ProfileInfoT;
+  typedef ProfileInfoT<Function, BasicBlock> ProfileInfo;
 
 /// Inliner - This class contains all of the helper code which is used to
 /// perform the inlining operations that do not depend on the policy.
@@ -54,7 +60,8 @@ struct Inliner : public CallGraphSCCPass {
   /// Calculate the inline threshold for given Caller. This threshold is lower
   /// if the caller is marked with OptimizeForSize and -inline-threshold is not
   /// given on the comand line. It is higher if the callee is marked with the
-  /// inlinehint attribute.
+  /// inlinehint attribute.  When a profile is loaded, it is higher for call
+  /// sites that are hot in the profile and lower for cold ones.
   ///
   unsigned getInlineThreshold(CallSite CS) const;
 
@@ -80,9 +87,34 @@ private:
   // InsertLifetime - Insert @llvm.lifetime intrinsics.
   bool InsertLifetime;
 
+  // PI - The loaded execution profile, or null if there is none.
+  ProfileInfo *PI;
+
+  // MaxBlockCount - The execution count of the hottest block in the module
+  // according to PI, or a negative value if it has not been computed.
+  double MaxBlockCount;
+
+  // CallSiteCounts - The execution count of each call site of the current
+  // SCC, recorded before inlining splits the blocks that hold them.
+  DenseMap<const Instruction*, double> CallSiteCounts;
+
+  enum CallSiteHotness { NormalCallSite, HotCallSite, ColdCallSite };
+
+  /// getCallSiteCount - Return how often CS ran according to the loaded
+  /// profile, or ProfileInfo::MissingValue if that is not known.
+  double getCallSiteCount(CallSite CS) const;
+
+  /// getCallSiteHotness - Classify CS by how often it ran in the loaded
+  /// profile relative to the hottest block of the module.
+  CallSiteHotness getCallSiteHotness(CallSite CS) const;
+
   /// shouldInline - Return true if the inliner should attempt to
   /// inline at the given CallSite.
   bool shouldInline(CallSite CS);
+
+  /// isInlineProfitable - Return true if inlining CS, whose cost is IC, does
+  /// not block more profitable inlining of its caller.
+  bool isInlineProfitable(CallSite CS, InlineCost IC);
 };
 
 } // End llvm namespace
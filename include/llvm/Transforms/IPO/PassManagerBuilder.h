@@ -104,6 +104,8 @@ public:
   bool DisableUnitAtATime;
   bool DisableUnrollLoops;
   bool Vectorize;
+  bool LoopVectorize;
+  bool SLPVectorize;
 
 private:
   /// ExtensionList - This is list of all of the extensions that are registered.
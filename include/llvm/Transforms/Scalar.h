@@ -152,6 +152,21 @@ Pass *createLoopRotatePass();
 // LoopIdiom - This pass recognizes and replaces idioms in loops.
 //
 Pass *createLoopIdiomPass();
+
+//===----------------------------------------------------------------------===//
+//
+// LoopInterchange - This pass interchanges the loops of a perfect loop nest
+// when this makes the accesses of the inner loop walk memory with a smaller
+// stride.
+//
+Pass *createLoopInterchangePass();
+
+//===----------------------------------------------------------------------===//
+//
+// LoopDistribute - This pass splits a loop into several loops to separate
+// the vectorizable statements from the others.
+//
+Pass *createLoopDistributePass();
   
 //===----------------------------------------------------------------------===//
 //
@@ -0,0 +1,81 @@
+//===-- SplitModule.h - Split a module into partitions ----------*- C++ -*-===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+//
+// This file defines the ModuleSplitter class, which divides the definitions of
+// a module between a number of partitions so that code can be generated for
+// each partition separately, for example on separate threads.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef LLVM_TRANSFORMS_UTILS_SPLITMODULE_H
+#define LLVM_TRANSFORMS_UTILS_SPLITMODULE_H
+
+#include "llvm/ADT/DenseMap.h"
+#include "llvm/ADT/SmallVector.h"
+
+namespace llvm {
+
+class GlobalValue;
+class GlobalVariable;
+class Module;
+
+/// ModuleSplitter - Assign every definition in a module to one of a fixed
+/// number of partitions, and create a module for each partition that defines
+/// the symbols of the partition and declares everything else it refers to.
+///
+/// The partitions can be linked together like the objects of separate
+/// translation units:
+///
+///  - A symbol with local linkage that is used by another partition is
+///    renamed and becomes an external symbol with hidden visibility.  A local
+///    constant with an insignificant address that refers to no other symbol,
+///    such as a string literal, is copied into every partition using it.
+///  - An alias of a declaration is in the same partition as every definition
+///    that refers to it.
+///  - An alias is in the same partition as its aliasee, and a function is in
+///    the same partition as every blockaddress of it.
+///  - Each element of a special appending array such as llvm.global_ctors
+///    or llvm.used goes to the partition of the definition it refers to.
+///  - Module-level inline asm is only emitted by partition 0.
+///
+/// The assignment balances the number of instructions in each partition and
+/// depends only on the module, so the same module is always split the same
+/// way.  Some partitions may be empty.
+class ModuleSplitter {
+  Module &M;
+  unsigned NumPartitions;
+
+  /// Partition - The partition of each definition in M.
+  DenseMap<const GlobalValue*, unsigned> Partition;
+
+  /// ElementPartition - The partition of each element of each appending array
+  /// in M.  Arrays that are not a ConstantArray belong to partition 0.
+  DenseMap<const GlobalVariable*, SmallVector<unsigned, 4> > ElementPartition;
+
+public:
+  /// ModuleSplitter - Assign the definitions of M to NumPartitions
+  /// partitions.  Unnamed symbols in M that other partitions may refer to are
+  /// given names, and local symbols that other partitions refer to are
+  /// promoted.
+  ModuleSplitter(Module &M, unsigned NumPartitions);
+
+  unsigned getNumPartitions() const { return NumPartitions; }
+
+  /// getPartition - Return the partition that defines GV, which must be a
+  /// definition in the module.
+  unsigned getPartition(const GlobalValue *GV) const;
+
+  /// createPartition - Return a new module for partition I.  The caller takes
+  /// ownership.
+  Module *createPartition(unsigned I) const;
+};
+
+} // End llvm namespace
+
+#endif
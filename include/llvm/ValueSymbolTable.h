@@ -77,6 +77,9 @@ public:
   /// @brief The number of name/type pairs is returned.
   inline unsigned size() const { return unsigned(vmap.size()); }
 
+  /// @brief The number of buckets allocated in the underlying hash table.
+  inline unsigned getNumBuckets() const { return vmap.getNumBuckets(); }
+
   /// This function can be used from the debugger to display the
   /// content of the symbol table while debugging.
   /// @brief Print out symbol table on stderr
@@ -50,6 +50,7 @@ void llvm::initializeAnalysis(PassRegistry &Registry) {
   initializeLoopInfoPass(Registry);
   initializeMemDepPrinterPass(Registry);
   initializeMemoryDependenceAnalysisPass(Registry);
+  initializeMemorySSAPass(Registry);
   initializeModuleDebugInfoPrinterPass(Registry);
   initializePostDominatorTreePass(Registry);
   initializeProfileEstimatorPassPass(Registry);
@@ -69,6 +70,8 @@ void llvm::initializeAnalysis(PassRegistry &Registry) {
   initializeRegionOnlyPrinterPass(Registry);
   initializeScalarEvolutionPass(Registry);
   initializeScalarEvolutionAliasAnalysisPass(Registry);
+  initializeTargetTransformInfoAnalysisGroup(Registry);
+  initializeNoTTIPass(Registry);
   initializeTypeBasedAliasAnalysisPass(Registry);
 }
 
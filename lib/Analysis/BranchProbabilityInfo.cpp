@@ -179,16 +179,34 @@ bool BranchProbabilityInfo::calcMetadataWeights(BasicBlock *BB) {
   uint32_t WeightLimit = getMaxWeightFor(BB);
   SmallVector<uint32_t, 2> Weights;
   Weights.reserve(TI->getNumSuccessors());
+  uint32_t MinNonZeroWeight = 0, MaxWeight = 0;
+  bool HasZeroWeight = false;
   for (unsigned i = 1, e = WeightsNode->getNumOperands(); i != e; ++i) {
     ConstantInt *Weight = dyn_cast<ConstantInt>(WeightsNode->getOperand(i));
     if (!Weight)
       return false;
-    Weights.push_back(
-      std::max<uint32_t>(1, Weight->getLimitedValue(WeightLimit)));
+    uint32_t W = Weight->getLimitedValue(WeightLimit);
+    Weights.push_back(W);
+    if (!W) {
+      HasZeroWeight = true;
+      continue;
+    }
+    if (!MinNonZeroWeight || W < MinNonZeroWeight)
+      MinNonZeroWeight = W;
+    MaxWeight = std::max(MaxWeight, W);
   }
   assert(Weights.size() == TI->getNumSuccessors() && "Checked above");
+
+  // A zero weight comes from a profile that never saw the edge taken. Scale
+  // the taken edges up so that it is as unlikely as an edge into unreachable
+  // code, rather than clamping it to a weight comparable to small counts.
+  uint32_t Scale = 1;
+  if (HasZeroWeight && MinNonZeroWeight)
+    Scale = std::max<uint32_t>(1, std::min(UR_NONTAKEN_WEIGHT /
+                                             MinNonZeroWeight,
+                                           WeightLimit / MaxWeight));
   for (unsigned i = 0, e = TI->getNumSuccessors(); i != e; ++i)
-    setEdgeWeight(BB, i, Weights[i]);
+    setEdgeWeight(BB, i, Weights[i] ? Weights[i] * Scale : UR_TAKEN_WEIGHT);
 
   return true;
 }
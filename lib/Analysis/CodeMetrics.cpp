@@ -12,8 +12,10 @@
 //===----------------------------------------------------------------------===//
 
 #include "llvm/Analysis/CodeMetrics.h"
+#include "llvm/Analysis/TargetTransformInfo.h"
 #include "llvm/Function.h"
 #include "llvm/Support/CallSite.h"
+#include "llvm/Support/GetElementPtrTypeIterator.h"
 #include "llvm/IntrinsicInst.h"
 #include "llvm/Target/TargetData.h"
 
@@ -54,14 +56,65 @@ bool llvm::callIsSmall(ImmutableCallSite CS) {
   return false;
 }
 
-bool llvm::isInstructionFree(const Instruction *I, const TargetData *TD) {
+/// isFoldedIntoAddressingMode - Return true if GEP is only used as the
+/// address of loads and stores, and the target can fold the address it
+/// computes into each of them.
+static bool isFoldedIntoAddressingMode(const GetElementPtrInst *GEP,
+                                       const TargetData &TD,
+                                       const TargetTransformInfo &TTI) {
+  if (GEP->getType()->isVectorTy())
+    return false;
+
+  // Split the address into base + offset + scale * index, allowing a single
+  // variable index.
+  int64_t Offset = 0, Scale = 0;
+  gep_type_iterator GTI = gep_type_begin(GEP);
+  for (User::const_op_iterator I = GEP->idx_begin(), E = GEP->idx_end();
+       I != E; ++I, ++GTI) {
+    if (StructType *STy = dyn_cast<StructType>(*GTI)) {
+      unsigned Field = cast<ConstantInt>(*I)->getZExtValue();
+      Offset += TD.getStructLayout(STy)->getElementOffset(Field);
+      continue;
+    }
+    int64_t Size = TD.getTypeAllocSize(GTI.getIndexedType());
+    if (const ConstantInt *CI = dyn_cast<ConstantInt>(*I)) {
+      Offset += CI->getSExtValue() * Size;
+      continue;
+    }
+    if (Scale)
+      return false;
+    Scale = Size;
+  }
+
+  for (Value::const_use_iterator UI = GEP->use_begin(), UE = GEP->use_end();
+       UI != UE; ++UI) {
+    Type *AccessTy;
+    if (const LoadInst *LI = dyn_cast<LoadInst>(*UI))
+      AccessTy = LI->getType();
+    else if (const StoreInst *SI = dyn_cast<StoreInst>(*UI)) {
+      if (SI->getValueOperand() == GEP)
+        return false;
+      AccessTy = SI->getValueOperand()->getType();
+    } else
+      return false;
+    if (!TTI.isLegalAddressingMode(AccessTy, 0, Offset, true, Scale))
+      return false;
+  }
+  return true;
+}
+
+bool llvm::isInstructionFree(const Instruction *I, const TargetData *TD,
+                             const TargetTransformInfo *TTI) {
   if (isa<PHINode>(I))
     return true;
 
   // If a GEP has all constant indices, it will probably be folded with
-  // a load/store.
-  if (const GetElementPtrInst *GEP = dyn_cast<GetElementPtrInst>(I))
-    return GEP->hasAllConstantIndices();
+  // a load/store.  The target may be able to fold a scaled index as well.
+  if (const GetElementPtrInst *GEP = dyn_cast<GetElementPtrInst>(I)) {
+    if (GEP->hasAllConstantIndices())
+      return true;
+    return TD && TTI && isFoldedIntoAddressingMode(GEP, *TD, *TTI);
+  }
 
   if (const IntrinsicInst *II = dyn_cast<IntrinsicInst>(I)) {
     switch (II->getIntrinsicID()) {
@@ -111,6 +164,12 @@ bool llvm::isInstructionFree(const Instruction *I, const TargetData *TD) {
     // nop on most sane targets.
     if (isa<CmpInst>(CI->getOperand(0)))
       return true;
+
+    // Otherwise ask the target, which knows which of its extensions and
+    // truncations are free.
+    if (TTI && TTI->getCastInstrCost(CI->getOpcode(), CI->getType(),
+                                     Op->getType()) == 0)
+      return true;
   }
 
   return false;
@@ -119,12 +178,13 @@ bool llvm::isInstructionFree(const Instruction *I, const TargetData *TD) {
 /// analyzeBasicBlock - Fill in the current structure with information gleaned
 /// from the specified block.
 void CodeMetrics::analyzeBasicBlock(const BasicBlock *BB,
-                                    const TargetData *TD) {
+                                    const TargetData *TD,
+                                    const TargetTransformInfo *TTI) {
   ++NumBlocks;
   unsigned NumInstsBeforeThisBB = NumInsts;
   for (BasicBlock::const_iterator II = BB->begin(), E = BB->end();
        II != E; ++II) {
-    if (isInstructionFree(II, TD))
+    if (isInstructionFree(II, TD, TTI))
       continue;
 
     // Special handling for calls.
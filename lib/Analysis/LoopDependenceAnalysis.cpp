@@ -176,7 +176,38 @@ LoopDependenceAnalysis::DependenceResult
 LoopDependenceAnalysis::analyseSIV(const SCEV *A,
                                    const SCEV *B,
                                    Subscript *S) const {
-  return Unknown; // TODO: Implement.
+  assert(isSIVPair(A, B) && "Attempted to SIV-test non-SIV SCEVs!");
+  const SCEVAddRecExpr *aRec = dyn_cast<SCEVAddRecExpr>(A);
+  const SCEVAddRecExpr *bRec = dyn_cast<SCEVAddRecExpr>(B);
+  if (!aRec || !bRec || aRec->getLoop() != bRec->getLoop())
+    return Unknown; // TODO: Implement the weak-zero SIV test.
+  if (!isLoopInvariant(aRec->getStart()) || !isLoopInvariant(bRec->getStart()))
+    return Unknown;
+
+  // Strong SIV test: both subscripts advance by the same constant step, so
+  // they are equal exactly when the iterations are (aStart - bStart) / Step
+  // apart.
+  const SCEV *Step = aRec->getStepRecurrence(*SE);
+  if (Step != bRec->getStepRecurrence(*SE))
+    return Unknown; // TODO: Implement the weak-crossing SIV test.
+  const SCEVConstant *StepC = dyn_cast<SCEVConstant>(Step);
+  const SCEVConstant *DiffC =
+    dyn_cast<SCEVConstant>(SE->getMinusSCEV(aRec->getStart(),
+                                            bRec->getStart()));
+  if (!StepC || !DiffC || StepC->getValue()->isZero() ||
+      StepC->getValue()->getBitWidth() > 64)
+    return Unknown;
+
+  int64_t step = StepC->getValue()->getSExtValue();
+  int64_t diff = DiffC->getValue()->getSExtValue();
+  if (diff % step != 0) {
+    DEBUG(dbgs() << "  -> [I] strong SIV, distance not integral\n");
+    return Independent;
+  }
+  S->L = aRec->getLoop();
+  S->Distance = diff / step;
+  DEBUG(dbgs() << "  -> [D] strong SIV, distance " << S->Distance << "\n");
+  return Dependent;
 }
 
 LoopDependenceAnalysis::DependenceResult
@@ -192,7 +223,9 @@ LoopDependenceAnalysis::analyseSubscript(const SCEV *A,
                                          Subscript *S) const {
   DEBUG(dbgs() << "  Testing subscript: " << *A << ", " << *B << "\n");
 
-  if (A == B) {
+  // Identical induction variables are left to the SIV test, which computes
+  // their (zero) distance.
+  if (A == B && isLoopInvariant(A)) {
     DEBUG(dbgs() << "  -> [D] same SCEV\n");
     return Dependent;
   }
@@ -247,6 +280,12 @@ LoopDependenceAnalysis::analysePair(DependencePair *P) const {
   if (!aGEP || !bGEP)
     return Unknown;
 
+  // Subscripts of different base pointers index different types.
+  if (aGEP->getPointerOperand() != bGEP->getPointerOperand()) {
+    DEBUG(dbgs() << "---> [?] different base pointers\n");
+    return Unknown;
+  }
+
   // FIXME: Is filtering coupled subscripts necessary?
 
   // Collect GEP operand pairs (FIXME: use GetGEPOperands from BasicAA), adding
@@ -284,6 +323,14 @@ LoopDependenceAnalysis::analysePair(DependencePair *P) const {
       // Further subscripts will not improve the situation, so abort early.
       return result;
     }
+    // Two subscripts requiring different distances in the same loop can never
+    // be satisfied at once.
+    for (unsigned j = 0, e = P->Subscripts.size(); j != e; ++j)
+      if (subscript.L && P->Subscripts[j].L == subscript.L &&
+          P->Subscripts[j].Distance != subscript.Distance) {
+        DEBUG(dbgs() << "---> [I] inconsistent distances\n");
+        return Independent;
+      }
     P->Subscripts.push_back(subscript);
   }
   // We successfully analysed all subscripts but failed to prove independence.
@@ -307,6 +354,29 @@ bool LoopDependenceAnalysis::depends(Value *A, Value *B) {
   return p->Result != Independent;
 }
 
+bool LoopDependenceAnalysis::getDistances(Value *A, Value *B,
+                     SmallVectorImpl<std::pair<const Loop*, int64_t> > &Dists) {
+  if (!depends(A, B))
+    return false;
+
+  DependencePair *p;
+  findOrInsertDependencePair(A, B, p);
+  if (p->Result != Dependent)
+    return false;
+
+  for (SmallVectorImpl<Subscript>::const_iterator i = p->Subscripts.begin(),
+       end = p->Subscripts.end(); i != end; ++i) {
+    if (!i->L)
+      continue;
+    bool Seen = false;
+    for (unsigned j = 0, e = Dists.size(); j != e && !Seen; ++j)
+      Seen = Dists[j].first == i->L;
+    if (!Seen)
+      Dists.push_back(std::make_pair(i->L, i->Distance));
+  }
+  return true;
+}
+
 //===----------------------------------------------------------------------===//
 //                   LoopDependenceAnalysis Implementation
 //===----------------------------------------------------------------------===//
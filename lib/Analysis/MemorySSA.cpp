@@ -0,0 +1,583 @@
+//===- MemorySSA.cpp - Memory SSA form ------------------------------------===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+//
+// This file implements the MemorySSA analysis.  The form is built with the
+// classic SSA construction of Cytron et al.: MemoryPhis are placed at the
+// iterated dominance frontier of the blocks containing MemoryDefs, and the
+// accesses are then renamed in a preorder walk of the dominator tree.
+//
+//===----------------------------------------------------------------------===//
+
+#define DEBUG_TYPE "memoryssa"
+#include "llvm/Analysis/MemorySSA.h"
+#include "llvm/Function.h"
+#include "llvm/Instructions.h"
+#include "llvm/Analysis/Dominators.h"
+#include "llvm/Analysis/Passes.h"
+#include "llvm/Assembly/AssemblyAnnotationWriter.h"
+#include "llvm/Assembly/Writer.h"
+#include "llvm/ADT/STLExtras.h"
+#include "llvm/ADT/Statistic.h"
+#include "llvm/Support/CFG.h"
+#include "llvm/Support/CommandLine.h"
+#include "llvm/Support/Debug.h"
+#include "llvm/Support/ErrorHandling.h"
+#include "llvm/Support/FormattedStream.h"
+using namespace llvm;
+
+STATISTIC(NumMemoryPhis, "Number of MemoryPhis placed");
+STATISTIC(NumClobberQueries, "Number of clobber queries");
+STATISTIC(NumCachedClobbers, "Number of clobber queries answered from cache");
+
+// Limit for the number of definitions and phis visited by one clobber query.
+static cl::opt<unsigned>
+ClobberWalkLimit("memoryssa-walk-limit", cl::init(100), cl::Hidden,
+                 cl::desc("Maximum number of accesses visited by a MemorySSA "
+                          "clobber query (default = 100)"));
+
+static cl::opt<bool>
+VerifyMemorySSA("verify-memoryssa", cl::init(false), cl::Hidden,
+                cl::desc("Verify the MemorySSA form after it is built and "
+                         "whenever it is preserved"));
+
+char MemorySSA::ID = 0;
+INITIALIZE_PASS_BEGIN(MemorySSA, "memoryssa", "Memory SSA", false, true)
+INITIALIZE_PASS_DEPENDENCY(DominatorTree)
+INITIALIZE_AG_DEPENDENCY(AliasAnalysis)
+INITIALIZE_PASS_END(MemorySSA, "memoryssa", "Memory SSA", false, true)
+
+FunctionPass *llvm::createMemorySSAPass() { return new MemorySSA(); }
+
+//===----------------------------------------------------------------------===//
+// MemoryAccess printing
+//===----------------------------------------------------------------------===//
+
+static void printAccessName(raw_ostream &OS, const MemoryAccess *MA) {
+  if (MA->getKind() == MemoryAccess::LiveOnEntryKind)
+    OS << "liveOnEntry";
+  else
+    OS << MA->getID();
+}
+
+void MemoryAccess::print(raw_ostream &OS) const {
+  switch (getKind()) {
+  case LiveOnEntryKind:
+    OS << "liveOnEntry";
+    return;
+  case DefKind:
+    OS << getID() << " = MemoryDef(";
+    printAccessName(OS, cast<MemoryDef>(this)->getDefiningAccess());
+    OS << ')';
+    return;
+  case UseKind:
+    OS << "MemoryUse(";
+    printAccessName(OS, cast<MemoryUse>(this)->getDefiningAccess());
+    OS << ')';
+    return;
+  case PhiKind: {
+    const MemoryPhi *Phi = cast<MemoryPhi>(this);
+    OS << getID() << " = MemoryPhi(";
+    for (unsigned i = 0, e = Phi->getNumIncomingValues(); i != e; ++i) {
+      if (i)
+        OS << ',';
+      OS << '{';
+      BasicBlock *BB = Phi->getIncomingBlock(i);
+      if (BB->hasName())
+        OS << BB->getName();
+      else
+        WriteAsOperand(OS, BB, false);
+      OS << ',';
+      printAccessName(OS, Phi->getIncomingValue(i));
+      OS << '}';
+    }
+    OS << ')';
+    return;
+  }
+  }
+  llvm_unreachable("Unknown memory access kind");
+}
+
+void MemoryAccess::dump() const {
+  print(dbgs());
+  dbgs() << '\n';
+}
+
+//===----------------------------------------------------------------------===//
+// MemorySSA construction
+//===----------------------------------------------------------------------===//
+
+MemorySSA::MemorySSA()
+  : FunctionPass(ID), F(0), AA(0), DT(0), LiveOnEntry(0), Stale(false) {
+  initializeMemorySSAPass(*PassRegistry::getPassRegistry());
+}
+
+MemorySSA::~MemorySSA() {
+  deleteAccesses();
+}
+
+void MemorySSA::getAnalysisUsage(AnalysisUsage &AU) const {
+  AU.setPreservesAll();
+  AU.addRequiredTransitive<DominatorTree>();
+  AU.addRequiredTransitive<AliasAnalysis>();
+}
+
+bool MemorySSA::runOnFunction(Function &Fn) {
+  F = &Fn;
+  AA = &getAnalysis<AliasAnalysis>();
+  DT = &getAnalysis<DominatorTree>();
+  buildMemorySSA();
+  if (VerifyMemorySSA)
+    verifyAnalysis();
+  return false;
+}
+
+void MemorySSA::releaseMemory() {
+  deleteAccesses();
+  Stale = false;
+}
+
+void MemorySSA::deleteAccesses() {
+  for (DenseMap<const Instruction*, MemoryUseOrDef*>::iterator
+       I = InstructionAccesses.begin(), E = InstructionAccesses.end();
+       I != E; ++I)
+    delete I->second;
+  for (DenseMap<const BasicBlock*, MemoryPhi*>::iterator
+       I = BlockPhis.begin(), E = BlockPhis.end(); I != E; ++I)
+    delete I->second;
+  delete LiveOnEntry;
+  LiveOnEntry = 0;
+  InstructionAccesses.clear();
+  BlockPhis.clear();
+  ClobberCache.clear();
+}
+
+void MemorySSA::reset() {
+  deleteAccesses();
+  Stale = true;
+}
+
+void MemorySSA::setDefiningAccess(MemoryUseOrDef *MA, MemoryAccess *Def) {
+  MA->DefiningAccess = Def;
+  Def->Users.insert(MA);
+}
+
+void MemorySSA::buildMemorySSA() {
+  deleteAccesses();
+  Stale = false;
+
+  BasicBlock *Entry = &F->getEntryBlock();
+  LiveOnEntry = new MemoryDef(0, Entry);
+
+  // Create the accesses of the instructions, and find the blocks that define
+  // a new memory version.
+  SmallPtrSet<BasicBlock*, 32> DefBlocks;
+  for (Function::iterator BB = F->begin(), E = F->end(); BB != E; ++BB)
+    for (BasicBlock::iterator I = BB->begin(), IE = BB->end(); I != IE; ++I) {
+      if (I->mayWriteToMemory()) {
+        InstructionAccesses[I] = new MemoryDef(I, BB);
+        if (DT->isReachableFromEntry(BB))
+          DefBlocks.insert(BB);
+      } else if (I->mayReadFromMemory()) {
+        InstructionAccesses[I] = new MemoryUse(I, BB);
+      }
+    }
+
+  placePhis(DefBlocks);
+  renameAccesses();
+
+  // Number the definitions and phis in program order, so that printed forms
+  // are stable.
+  unsigned NextID = 1;
+  for (Function::iterator BB = F->begin(), E = F->end(); BB != E; ++BB) {
+    if (MemoryPhi *Phi = BlockPhis.lookup(BB))
+      Phi->ID = NextID++;
+    for (BasicBlock::iterator I = BB->begin(), IE = BB->end(); I != IE; ++I)
+      if (MemoryUseOrDef *MA = InstructionAccesses.lookup(I))
+        if (isa<MemoryDef>(MA))
+          MA->ID = NextID++;
+  }
+}
+
+/// placePhis - Place a MemoryPhi at each block of the iterated dominance
+/// frontier of DefBlocks.
+void MemorySSA::placePhis(const SmallPtrSet<BasicBlock*, 32> &DefBlocks) {
+  // Compute the dominance frontiers: a join point J is in the frontier of
+  // every block on the dominator tree path from each predecessor of J up to,
+  // but excluding, the immediate dominator of J.
+  DenseMap<BasicBlock*, SmallVector<BasicBlock*, 4> > Frontiers;
+  for (Function::iterator BB = F->begin(), E = F->end(); BB != E; ++BB) {
+    DomTreeNode *Node = DT->getNode(BB);
+    if (!Node || !Node->getIDom())
+      continue;
+    pred_iterator PI = pred_begin(BB), PE = pred_end(BB);
+    if (PI == PE || llvm::next(PI) == PE)
+      continue;
+
+    BasicBlock *IDom = Node->getIDom()->getBlock();
+    for (; PI != PE; ++PI) {
+      DomTreeNode *Runner = DT->getNode(*PI);
+      while (Runner && Runner->getBlock() != IDom) {
+        SmallVector<BasicBlock*, 4> &Frontier = Frontiers[Runner->getBlock()];
+        if (Frontier.empty() || Frontier.back() != BB)
+          Frontier.push_back(BB);
+        Runner = Runner->getIDom();
+      }
+    }
+  }
+
+  // Take the iterated frontier; each new phi is itself a definition.
+  SmallVector<BasicBlock*, 32> Worklist(DefBlocks.begin(), DefBlocks.end());
+  while (!Worklist.empty()) {
+    BasicBlock *BB = Worklist.pop_back_val();
+    DenseMap<BasicBlock*, SmallVector<BasicBlock*, 4> >::iterator FI =
+      Frontiers.find(BB);
+    if (FI == Frontiers.end())
+      continue;
+    for (unsigned i = 0, e = FI->second.size(); i != e; ++i) {
+      BasicBlock *Join = FI->second[i];
+      MemoryPhi *&Phi = BlockPhis[Join];
+      if (Phi)
+        continue;
+      Phi = new MemoryPhi(Join);
+      ++NumMemoryPhis;
+      if (!DefBlocks.count(Join))
+        Worklist.push_back(Join);
+    }
+  }
+}
+
+/// renameAccesses - Link every access to the memory version reaching it, in a
+/// preorder walk of the dominator tree.
+void MemorySSA::renameAccesses() {
+  SmallVector<std::pair<DomTreeNode*, MemoryAccess*>, 32> Worklist;
+  Worklist.push_back(std::make_pair(DT->getRootNode(),
+                                    (MemoryAccess*)LiveOnEntry));
+  while (!Worklist.empty()) {
+    DomTreeNode *Node = Worklist.back().first;
+    MemoryAccess *Incoming = Worklist.back().second;
+    Worklist.pop_back();
+    BasicBlock *BB = Node->getBlock();
+
+    if (MemoryPhi *Phi = BlockPhis.lookup(BB))
+      Incoming = Phi;
+    for (BasicBlock::iterator I = BB->begin(), E = BB->end(); I != E; ++I)
+      if (MemoryUseOrDef *MA = InstructionAccesses.lookup(I)) {
+        setDefiningAccess(MA, Incoming);
+        if (isa<MemoryDef>(MA))
+          Incoming = MA;
+      }
+
+    for (succ_iterator SI = succ_begin(BB), SE = succ_end(BB); SI != SE; ++SI)
+      if (MemoryPhi *Phi = BlockPhis.lookup(*SI)) {
+        Phi->Operands.push_back(std::make_pair(Incoming, BB));
+        Incoming->Users.insert(Phi);
+      }
+
+    for (DomTreeNode::iterator CI = Node->begin(), CE = Node->end();
+         CI != CE; ++CI)
+      Worklist.push_back(std::make_pair(*CI, Incoming));
+  }
+
+  // Unreachable code is never executed; give its accesses the entry state so
+  // that every access has a definition.
+  for (DenseMap<const Instruction*, MemoryUseOrDef*>::iterator
+       I = InstructionAccesses.begin(), E = InstructionAccesses.end();
+       I != E; ++I)
+    if (!I->second->getDefiningAccess())
+      setDefiningAccess(I->second, LiveOnEntry);
+}
+
+//===----------------------------------------------------------------------===//
+// Clobber queries
+//===----------------------------------------------------------------------===//
+
+/// ClobberWalk - The state of one clobber query.
+struct MemorySSA::ClobberWalk {
+  const AliasAnalysis::Location &Loc;
+  /// Budget - The number of definitions and phis that may still be visited.
+  unsigned Budget;
+  /// PhiResults - The answers for the phis already walked by this query.
+  DenseMap<MemoryPhi*, MemoryAccess*> PhiResults;
+  /// Active - The phis whose operands are being walked.
+  SmallPtrSet<MemoryPhi*, 16> Active;
+
+  ClobberWalk(const AliasAnalysis::Location &Loc, unsigned Budget)
+    : Loc(Loc), Budget(Budget) {}
+};
+
+/// walkToClobber - Return the nearest access at or above MA that may modify
+/// the location of W, or null if every path from MA leads back to a phi that
+/// is being walked, so that the location is not modified around that cycle.
+///
+/// Where the paths through a phi reach different clobbers, the phi itself is
+/// the answer.  The answer is also conservative once the budget runs out: the
+/// definition where the walk stopped, or the nearest phi.
+MemoryAccess *MemorySSA::walkToClobber(MemoryAccess *MA, ClobberWalk &W) {
+  while (MemoryDef *Def = dyn_cast<MemoryDef>(MA)) {
+    if (isLiveOnEntryDef(Def) || W.Budget == 0)
+      return Def;
+    --W.Budget;
+    if (AA->getModRefInfo(Def->getMemoryInst(), W.Loc) & AliasAnalysis::Mod)
+      return Def;
+    MA = Def->getDefiningAccess();
+  }
+
+  MemoryPhi *Phi = cast<MemoryPhi>(MA);
+  DenseMap<MemoryPhi*, MemoryAccess*>::iterator Cached =
+    W.PhiResults.find(Phi);
+  if (Cached != W.PhiResults.end())
+    return Cached->second;
+  if (!W.Active.insert(Phi))
+    return 0;
+
+  MemoryAccess *Result = 0;
+  if (W.Budget != 0) {
+    --W.Budget;
+    for (unsigned i = 0, e = Phi->getNumIncomingValues(); i != e; ++i) {
+      MemoryAccess *Clobber = walkToClobber(Phi->getIncomingValue(i), W);
+      if (!Clobber || Clobber == Result)
+        continue;
+      if (Result) {
+        Result = Phi;
+        break;
+      }
+      Result = Clobber;
+    }
+  }
+  if (!Result || W.Budget == 0)
+    Result = Phi;
+
+  W.Active.erase(Phi);
+  W.PhiResults[Phi] = Result;
+  return Result;
+}
+
+MemoryAccess *
+MemorySSA::getClobberingMemoryAccess(MemoryAccess *Start,
+                                     const AliasAnalysis::Location &Loc) {
+  ensureBuilt();
+  ClobberWalk W(Loc, ClobberWalkLimit);
+  MemoryAccess *Clobber = walkToClobber(Start, W);
+  return Clobber ? Clobber : Start;
+}
+
+MemoryAccess *MemorySSA::getClobberingMemoryAccess(Instruction *I) {
+  MemoryUseOrDef *MA = getMemoryAccess(I);
+  if (!MA)
+    return 0;
+
+  ++NumClobberQueries;
+  MemoryAccess *&Cached = ClobberCache[I];
+  if (Cached) {
+    ++NumCachedClobbers;
+    return Cached;
+  }
+
+  MemoryAccess *Clobber;
+  if (LoadInst *LI = dyn_cast<LoadInst>(I))
+    Clobber = getClobberingMemoryAccess(MA->getDefiningAccess(),
+                                        AA->getLocation(LI));
+  else if (StoreInst *SI = dyn_cast<StoreInst>(I))
+    Clobber = getClobberingMemoryAccess(MA->getDefiningAccess(),
+                                        AA->getLocation(SI));
+  else
+    Clobber = MA->getDefiningAccess();
+
+  // The walk does not touch the cache, so the reference is still valid.
+  Cached = Clobber;
+  return Clobber;
+}
+
+//===----------------------------------------------------------------------===//
+// Updates
+//===----------------------------------------------------------------------===//
+
+void MemorySSA::removeInstruction(Instruction *I) {
+  if (Stale)
+    return;
+  DenseMap<const Instruction*, MemoryUseOrDef*>::iterator It =
+    InstructionAccesses.find(I);
+  if (It == InstructionAccesses.end())
+    return;
+  MemoryUseOrDef *MA = It->second;
+  InstructionAccesses.erase(It);
+
+  MemoryAccess *Def = MA->getDefiningAccess();
+  Def->Users.erase(MA);
+  if (isa<MemoryUse>(MA)) {
+    ClobberCache.erase(I);
+    delete MA;
+    return;
+  }
+
+  // Attach the users of the definition to the version it replaced.
+  for (MemoryAccess::user_iterator UI = MA->user_begin(), UE = MA->user_end();
+       UI != UE; ++UI) {
+    MemoryAccess *User = *UI;
+    if (MemoryUseOrDef *UD = dyn_cast<MemoryUseOrDef>(User)) {
+      UD->DefiningAccess = Def;
+    } else {
+      MemoryPhi *Phi = cast<MemoryPhi>(User);
+      for (unsigned i = 0, e = Phi->getNumIncomingValues(); i != e; ++i)
+        if (Phi->Operands[i].first == MA)
+          Phi->Operands[i].first = Def;
+    }
+    Def->Users.insert(User);
+  }
+  ClobberCache.clear();
+  delete MA;
+}
+
+/// getLastDefAtBlockEnd - Return the memory version live at the end of BB.
+MemoryAccess *MemorySSA::getLastDefAtBlockEnd(BasicBlock *BB) const {
+  for (DomTreeNode *Node = DT->getNode(BB); Node; Node = Node->getIDom()) {
+    BasicBlock *Block = Node->getBlock();
+    for (BasicBlock::iterator I = Block->end(); I != Block->begin(); ) {
+      MemoryUseOrDef *MA = InstructionAccesses.lookup(--I);
+      if (MA && isa<MemoryDef>(MA))
+        return MA;
+    }
+    if (MemoryPhi *Phi = BlockPhis.lookup(Block))
+      return Phi;
+  }
+  return LiveOnEntry;
+}
+
+MemoryUse *MemorySSA::createMemoryUse(Instruction *I) {
+  assert(!I->mayWriteToMemory() && "Only read-only accesses can be created!");
+  assert(I->mayReadFromMemory() && "Instruction does not access memory!");
+  if (Stale)
+    return 0;
+  assert(!InstructionAccesses.count(I) && "Instruction already has an access!");
+
+  // Find the nearest definition above I in its block, then the memory
+  // version on entry to the block.
+  BasicBlock *BB = I->getParent();
+  MemoryAccess *Def = 0;
+  for (BasicBlock::iterator It = I; It != BB->begin(); ) {
+    MemoryUseOrDef *MA = InstructionAccesses.lookup(--It);
+    if (MA && isa<MemoryDef>(MA)) {
+      Def = MA;
+      break;
+    }
+  }
+  if (!Def)
+    Def = BlockPhis.lookup(BB);
+  if (!Def) {
+    DomTreeNode *Node = DT->getNode(BB);
+    if (Node && Node->getIDom())
+      Def = getLastDefAtBlockEnd(Node->getIDom()->getBlock());
+    else
+      Def = LiveOnEntry;
+  }
+
+  MemoryUse *Use = new MemoryUse(I, BB);
+  setDefiningAccess(Use, Def);
+  InstructionAccesses[I] = Use;
+  return Use;
+}
+
+//===----------------------------------------------------------------------===//
+// Printing and verification
+//===----------------------------------------------------------------------===//
+
+namespace {
+  /// MemorySSAAnnotatedWriter - Print the accesses as comments in the IR.
+  class MemorySSAAnnotatedWriter : public AssemblyAnnotationWriter {
+    const DenseMap<const Instruction*, MemoryUseOrDef*> &Accesses;
+    const DenseMap<const BasicBlock*, MemoryPhi*> &Phis;
+
+  public:
+    MemorySSAAnnotatedWriter(
+        const DenseMap<const Instruction*, MemoryUseOrDef*> &Accesses,
+        const DenseMap<const BasicBlock*, MemoryPhi*> &Phis)
+      : Accesses(Accesses), Phis(Phis) {}
+
+    virtual void emitBasicBlockStartAnnot(const BasicBlock *BB,
+                                          formatted_raw_ostream &OS) {
+      if (MemoryPhi *Phi = Phis.lookup(BB)) {
+        OS << "; ";
+        Phi->print(OS);
+        OS << '\n';
+      }
+    }
+
+    virtual void emitInstructionAnnot(const Instruction *I,
+                                      formatted_raw_ostream &OS) {
+      if (MemoryUseOrDef *MA = Accesses.lookup(I)) {
+        OS << "; ";
+        MA->print(OS);
+        OS << '\n';
+      }
+    }
+  };
+}
+
+void MemorySSA::print(raw_ostream &OS, const Module *) const {
+  if (Stale) {
+    OS << "MemorySSA for function '" << F->getName()
+       << "' has been reset and not rebuilt\n";
+    return;
+  }
+  MemorySSAAnnotatedWriter Writer(InstructionAccesses, BlockPhis);
+  F->print(OS, &Writer);
+}
+
+/// verifyAnalysis - Check that the form matches a fresh renaming: every
+/// instruction that touches memory has an access of the right kind, and
+/// every access is linked to the version that reaches it.
+void MemorySSA::verifyAnalysis() const {
+  if (!VerifyMemorySSA || Stale)
+    return;
+
+  for (Function::iterator BB = F->begin(), E = F->end(); BB != E; ++BB) {
+    if (!DT->isReachableFromEntry(BB))
+      continue;
+
+    MemoryAccess *Incoming;
+    if (MemoryPhi *Phi = BlockPhis.lookup(BB)) {
+      Incoming = Phi;
+      unsigned NumPreds = 0;
+      for (pred_iterator PI = pred_begin(BB), PE = pred_end(BB); PI != PE;
+           ++PI)
+        if (DT->isReachableFromEntry(*PI))
+          ++NumPreds;
+      if (NumPreds != Phi->getNumIncomingValues())
+        report_fatal_error("MemoryPhi does not match the predecessors of '" +
+                           BB->getName() + "'");
+      for (unsigned i = 0, e = Phi->getNumIncomingValues(); i != e; ++i)
+        if (Phi->getIncomingValue(i) !=
+            getLastDefAtBlockEnd(Phi->getIncomingBlock(i)))
+          report_fatal_error("Wrong MemoryPhi operand in '" +
+                             BB->getName() + "'");
+    } else if (DT->getNode(BB)->getIDom()) {
+      Incoming = getLastDefAtBlockEnd(DT->getNode(BB)->getIDom()->getBlock());
+    } else {
+      Incoming = LiveOnEntry;
+    }
+
+    for (BasicBlock::iterator I = BB->begin(), IE = BB->end(); I != IE; ++I) {
+      MemoryUseOrDef *MA = InstructionAccesses.lookup(I);
+      bool Writes = I->mayWriteToMemory();
+      if (!Writes && !I->mayReadFromMemory()) {
+        if (MA)
+          report_fatal_error("Access for an instruction without memory "
+                             "effects in '" + BB->getName() + "'");
+        continue;
+      }
+      if (!MA || isa<MemoryDef>(MA) != Writes || MA->getBlock() != BB)
+        report_fatal_error("Missing or wrong MemorySSA access in '" +
+                           BB->getName() + "'");
+      if (MA->getDefiningAccess() != Incoming)
+        report_fatal_error("Wrong defining access in '" + BB->getName() + "'");
+      if (Writes)
+        Incoming = MA;
+    }
+  }
+}
@@ -8,7 +8,7 @@
 //===----------------------------------------------------------------------===//
 //
 // This pass loads profiling data from a dump file and sets branch weight
-// metadata.
+// metadata.  Functions that were never entered are marked cold.
 //
 // TODO: Replace all "profile-metadata-loader" strings with "profile-loader"
 // once ProfileInfo etc. has been removed.
@@ -35,6 +35,7 @@ using namespace llvm;
 
 STATISTIC(NumEdgesRead, "The # of edges read.");
 STATISTIC(NumTermsAnnotated, "The # of terminator instructions annotated.");
+STATISTIC(NumFunctionsCold, "The # of functions marked cold.");
 
 static cl::opt<std::string>
 ProfileMetadataFilename("profile-file", cl::init("llvmprof.out"),
@@ -43,7 +44,7 @@ ProfileMetadataFilename("profile-file", cl::init("llvmprof.out"),
 
 namespace {
   /// This pass loads profiling data from a dump file and sets branch weight
-  /// metadata.
+  /// metadata.  Functions that were never entered are marked cold.
   class ProfileMetadataLoaderPass : public ModulePass {
     std::string Filename;
   public:
@@ -66,6 +67,7 @@ namespace {
                           ArrayRef<unsigned>);
     virtual unsigned matchEdges(Module&, ProfileData&, ArrayRef<unsigned>);
     virtual void setBranchWeightMetadata(Module&, ProfileData&);
+    virtual void setColdAttributes(Module&, ProfileData&);
 
     virtual bool runOnModule(Module &M);
   };
@@ -168,6 +170,20 @@ void ProfileMetadataLoaderPass::setBranchWeightMetadata(Module &M,
   }
 }
 
+/// setColdAttributes - Mark the functions whose entry edge was never executed
+/// with the cold attribute, so that code generators can keep them away from
+/// the code that did run.
+void ProfileMetadataLoaderPass::setColdAttributes(Module &M, ProfileData &PB) {
+  for (Module::iterator F = M.begin(), E = M.end(); F != E; ++F) {
+    if (F->isDeclaration()) continue;
+    if (PB.getEdgeWeight(PB.getEdge(0, &F->getEntryBlock())) != 0) continue;
+
+    DEBUG(dbgs() << "Marking '" << F->getName() << "' cold\n");
+    F->addFnAttr(Attribute::Cold);
+    NumFunctionsCold++;
+  }
+}
+
 bool ProfileMetadataLoaderPass::runOnModule(Module &M) {
   ProfileDataLoader PDL("profile-data-loader", Filename);
   ProfileData PB;
@@ -184,5 +200,9 @@ bool ProfileMetadataLoaderPass::runOnModule(Module &M) {
 
   setBranchWeightMetadata(M, PB);
 
+  // Only trust the absence of counts if every counter matched an edge.
+  if (ReadCount > 0 && ReadCount == Counters.size())
+    setColdAttributes(M, PB);
+
   return ReadCount > 0;
 }
@@ -97,6 +97,10 @@ STATISTIC(NumTripCountsNotComputed,
           "Number of loops without predictable loop counts");
 STATISTIC(NumBruteForceTripCountsComputed,
           "Number of loops with trip counts computed by force");
+STATISTIC(NumDepthLimitHits,
+          "Number of values left unknown by the expression depth limit");
+STATISTIC(NumBudgetLimitHits,
+          "Number of values left unknown by the per-function budget");
 
 static cl::opt<unsigned>
 MaxBruteForceIterations("scalar-evolution-max-iterations", cl::ReallyHidden,
@@ -105,6 +109,20 @@ MaxBruteForceIterations("scalar-evolution-max-iterations", cl::ReallyHidden,
                                  "derived loop"),
                         cl::init(100));
 
+// Compile-time budgets.  Generated code with very large blocks can make the
+// recursive construction of expressions arbitrarily deep and expensive; past
+// these limits values are treated as opaque SCEVUnknowns instead.
+static cl::opt<unsigned>
+MaxSCEVDepth("scalar-evolution-max-depth", cl::Hidden,
+             cl::desc("Maximum depth of recursive SCEV construction"),
+             cl::init(512));
+
+static cl::opt<unsigned>
+MaxSCEVValues("scalar-evolution-max-values", cl::Hidden,
+              cl::desc("Maximum number of instructions analyzed by SCEV "
+                       "per function (0 = unlimited)"),
+              cl::init(0));
+
 INITIALIZE_PASS_BEGIN(ScalarEvolution, "scalar-evolution",
                 "Scalar Evolution Analysis", false, true)
 INITIALIZE_PASS_DEPENDENCY(LoopInfo)
@@ -2716,7 +2734,9 @@ const SCEV *ScalarEvolution::getSCEV(Value *V) {
 
   ValueExprMapType::const_iterator I = ValueExprMap.find_as(V);
   if (I != ValueExprMap.end()) return I->second;
+  ++CreateSCEVDepth;
   const SCEV *S = createSCEV(V);
+  --CreateSCEVDepth;
 
   // The process of creating a SCEV for V may have caused other SCEVs
   // to have been created, so it's necessary to insert the new entry
@@ -3583,6 +3603,20 @@ const SCEV *ScalarEvolution::createSCEV(Value *V) {
   else
     return getUnknown(V);
 
+  // Give up on instructions once the compile-time budgets are spent.  An
+  // unknown is always a correct, if imprecise, answer.
+  if (isa<Instruction>(V)) {
+    if (CreateSCEVDepth > MaxSCEVDepth) {
+      ++NumDepthLimitHits;
+      return getUnknown(V);
+    }
+    if (MaxSCEVValues && NumValuesAnalyzed >= MaxSCEVValues) {
+      ++NumBudgetLimitHits;
+      return getUnknown(V);
+    }
+    ++NumValuesAnalyzed;
+  }
+
   Operator *U = cast<Operator>(V);
   switch (Opcode) {
   case Instruction::Add: {
@@ -6583,7 +6617,8 @@ ScalarEvolution::SCEVCallbackVH::SCEVCallbackVH(Value *V, ScalarEvolution *se)
 //===----------------------------------------------------------------------===//
 
 ScalarEvolution::ScalarEvolution()
-  : FunctionPass(ID), FirstUnknown(0) {
+  : FunctionPass(ID), CreateSCEVDepth(0), NumValuesAnalyzed(0),
+    FirstUnknown(0) {
   initializeScalarEvolutionPass(*PassRegistry::getPassRegistry());
 }
 
@@ -6593,6 +6628,8 @@ bool ScalarEvolution::runOnFunction(Function &F) {
   TD = getAnalysisIfAvailable<TargetData>();
   TLI = &getAnalysis<TargetLibraryInfo>();
   DT = &getAnalysis<DominatorTree>();
+  CreateSCEVDepth = 0;
+  NumValuesAnalyzed = 0;
   return false;
 }
 
@@ -0,0 +1,241 @@
+//===- TargetTransformInfo.cpp - Target cost model interface --------------===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+//
+// This file implements the generic TargetTransformInfo interface, which simply
+// forwards every query to the previous implementation in the chain, and the
+// conservative default implementation used when no target is available.
+//
+//===----------------------------------------------------------------------===//
+
+#include "llvm/Analysis/TargetTransformInfo.h"
+#include "llvm/Analysis/Passes.h"
+#include "llvm/DerivedTypes.h"
+#include "llvm/Pass.h"
+#include "llvm/Target/TargetData.h"
+using namespace llvm;
+
+// Register the TargetTransformInfo interface, providing a nice name to refer
+// to.
+INITIALIZE_ANALYSIS_GROUP(TargetTransformInfo, "Target Transform Info", NoTTI)
+char TargetTransformInfo::ID = 0;
+
+// TargetTransformInfo destructor: DO NOT move this to the header file for
+// TargetTransformInfo or else clients of the TargetTransformInfo class may not
+// depend on the TargetTransformInfo.o file in the current .a file, causing
+// the default implementation to not be included in the tool correctly!
+//
+TargetTransformInfo::~TargetTransformInfo() {}
+
+/// InitializeTargetTransformInfo - Subclasses must call this method to
+/// initialize the TargetTransformInfo interface before any other methods are
+/// called.
+///
+void TargetTransformInfo::InitializeTargetTransformInfo(Pass *P) {
+  PrevTTI = &P->getAnalysis<TargetTransformInfo>();
+}
+
+// getAnalysisUsage - All target information implementations should invoke
+// this directly (using TargetTransformInfo::getAnalysisUsage(AU)).
+void TargetTransformInfo::getAnalysisUsage(AnalysisUsage &AU) const {
+  AU.addRequired<TargetTransformInfo>();   // All TTI's chain
+}
+
+//===----------------------------------------------------------------------===//
+// Default chaining methods
+//===----------------------------------------------------------------------===//
+
+bool TargetTransformInfo::isTypeLegal(Type *Ty) const {
+  assert(PrevTTI && "TTI didn't call InitializeTargetTransformInfo!");
+  return PrevTTI->isTypeLegal(Ty);
+}
+
+bool TargetTransformInfo::isLegalAddressingMode(Type *Ty, GlobalValue *BaseGV,
+                                                int64_t BaseOffset,
+                                                bool HasBaseReg,
+                                                int64_t Scale) const {
+  assert(PrevTTI && "TTI didn't call InitializeTargetTransformInfo!");
+  return PrevTTI->isLegalAddressingMode(Ty, BaseGV, BaseOffset, HasBaseReg,
+                                        Scale);
+}
+
+unsigned TargetTransformInfo::getNumberOfRegisters(bool Vector) const {
+  assert(PrevTTI && "TTI didn't call InitializeTargetTransformInfo!");
+  return PrevTTI->getNumberOfRegisters(Vector);
+}
+
+unsigned TargetTransformInfo::getRegisterBitWidth(bool Vector) const {
+  assert(PrevTTI && "TTI didn't call InitializeTargetTransformInfo!");
+  return PrevTTI->getRegisterBitWidth(Vector);
+}
+
+TargetTransformInfo::PopcntSupportKind
+TargetTransformInfo::getPopcntSupport(unsigned IntTyWidthInBit) const {
+  assert(PrevTTI && "TTI didn't call InitializeTargetTransformInfo!");
+  return PrevTTI->getPopcntSupport(IntTyWidthInBit);
+}
+
+unsigned TargetTransformInfo::getArithmeticInstrCost(unsigned Opcode,
+                                                     Type *Ty) const {
+  assert(PrevTTI && "TTI didn't call InitializeTargetTransformInfo!");
+  return PrevTTI->getArithmeticInstrCost(Opcode, Ty);
+}
+
+unsigned TargetTransformInfo::getShuffleCost(ShuffleKind Kind, Type *Tp,
+                                             int Index, Type *SubTp) const {
+  assert(PrevTTI && "TTI didn't call InitializeTargetTransformInfo!");
+  return PrevTTI->getShuffleCost(Kind, Tp, Index, SubTp);
+}
+
+unsigned TargetTransformInfo::getCastInstrCost(unsigned Opcode, Type *Dst,
+                                               Type *Src) const {
+  assert(PrevTTI && "TTI didn't call InitializeTargetTransformInfo!");
+  return PrevTTI->getCastInstrCost(Opcode, Dst, Src);
+}
+
+unsigned TargetTransformInfo::getCmpSelInstrCost(unsigned Opcode, Type *ValTy,
+                                                 Type *CondTy) const {
+  assert(PrevTTI && "TTI didn't call InitializeTargetTransformInfo!");
+  return PrevTTI->getCmpSelInstrCost(Opcode, ValTy, CondTy);
+}
+
+unsigned TargetTransformInfo::getVectorInstrCost(unsigned Opcode, Type *Val,
+                                                 unsigned Index) const {
+  assert(PrevTTI && "TTI didn't call InitializeTargetTransformInfo!");
+  return PrevTTI->getVectorInstrCost(Opcode, Val, Index);
+}
+
+unsigned TargetTransformInfo::getMemoryOpCost(unsigned Opcode, Type *Src,
+                                              unsigned Alignment,
+                                              unsigned AddressSpace) const {
+  assert(PrevTTI && "TTI didn't call InitializeTargetTransformInfo!");
+  return PrevTTI->getMemoryOpCost(Opcode, Src, Alignment, AddressSpace);
+}
+
+//===----------------------------------------------------------------------===//
+// NoTTI - The default implementation
+//===----------------------------------------------------------------------===//
+
+namespace {
+  /// NoTTI - This class implements the -no-tti pass, which knows nothing
+  /// about the target.  It reports that there are no vector registers, that
+  /// only the integer types TargetData calls native are legal, that only
+  /// register and register-plus-register addresses fold into memory
+  /// operations, and that every operation costs one unit per element, so
+  /// transformations driven by it stay conservative.  Like NoAA, it does not
+  /// chain.
+  ///
+  struct NoTTI : public ImmutablePass, public TargetTransformInfo {
+    const TargetData *TD;
+
+    static char ID; // Class identification, replacement for typeinfo
+    NoTTI() : ImmutablePass(ID), TD(0) {
+      initializeNoTTIPass(*PassRegistry::getPassRegistry());
+    }
+
+    virtual void getAnalysisUsage(AnalysisUsage &AU) const {
+    }
+
+    virtual void initializePass() {
+      // Note: NoTTI does not call InitializeTargetTransformInfo because it
+      // is the end of the chain.
+      TD = getAnalysisIfAvailable<TargetData>();
+    }
+
+    /// getElementCount - Operations on vectors are assumed to be scalarized.
+    static unsigned getElementCount(Type *Ty) {
+      if (VectorType *VTy = dyn_cast<VectorType>(Ty))
+        return VTy->getNumElements();
+      return 1;
+    }
+
+    virtual bool isTypeLegal(Type *Ty) const {
+      if (!TD || !Ty->isIntegerTy())
+        return false;
+      return TD->isLegalInteger(Ty->getPrimitiveSizeInBits());
+    }
+
+    virtual bool isLegalAddressingMode(Type *Ty, GlobalValue *BaseGV,
+                                       int64_t BaseOffset, bool HasBaseReg,
+                                       int64_t Scale) const {
+      // Allow [reg], [reg + reg] and [reg] written as 1*reg.
+      if (BaseGV || BaseOffset)
+        return false;
+      switch (Scale) {
+      case 0:
+        return HasBaseReg;
+      case 1:
+        return true;
+      default:
+        return false;
+      }
+    }
+
+    virtual unsigned getNumberOfRegisters(bool Vector) const {
+      return Vector ? 0 : 8;
+    }
+
+    virtual unsigned getRegisterBitWidth(bool Vector) const {
+      if (Vector)
+        return 0;
+      return TD ? TD->getPointerSizeInBits() : 32;
+    }
+
+    virtual PopcntSupportKind getPopcntSupport(unsigned IntTyWidthInBit) const {
+      return PSK_Software;
+    }
+
+    virtual unsigned getArithmeticInstrCost(unsigned Opcode, Type *Ty) const {
+      return getElementCount(Ty);
+    }
+
+    virtual unsigned getShuffleCost(ShuffleKind Kind, Type *Tp, int Index,
+                                    Type *SubTp) const {
+      return getElementCount(Tp);
+    }
+
+    virtual unsigned getCastInstrCost(unsigned Opcode, Type *Dst,
+                                      Type *Src) const {
+      return getElementCount(Dst);
+    }
+
+    virtual unsigned getCmpSelInstrCost(unsigned Opcode, Type *ValTy,
+                                        Type *CondTy) const {
+      return getElementCount(ValTy);
+    }
+
+    virtual unsigned getVectorInstrCost(unsigned Opcode, Type *Val,
+                                        unsigned Index) const {
+      return 1;
+    }
+
+    virtual unsigned getMemoryOpCost(unsigned Opcode, Type *Src,
+                                     unsigned Alignment,
+                                     unsigned AddressSpace) const {
+      return getElementCount(Src);
+    }
+
+    /// getAdjustedAnalysisPointer - This method is used when a pass implements
+    /// an analysis interface through multiple inheritance.  If needed, it
+    /// should override this to adjust the this pointer as needed for the
+    /// specified pass info.
+    virtual void *getAdjustedAnalysisPointer(const void *ID) {
+      if (ID == &TargetTransformInfo::ID)
+        return (TargetTransformInfo*)this;
+      return this;
+    }
+  };
+}  // End of anonymous namespace
+
+// Register this pass...
+char NoTTI::ID = 0;
+INITIALIZE_AG_PASS(NoTTI, TargetTransformInfo, "no-tti",
+                   "No target information (conservative costs)",
+                   true, true, true)
+
+ImmutablePass *llvm::createNoTargetTransformInfoPass() { return new NoTTI(); }
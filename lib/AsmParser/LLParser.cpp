@@ -952,6 +952,7 @@ bool LLParser::ParseOptionalAttrs(Attributes &Attrs, unsigned AttrKind) {
     case lltok::kw_naked:           Attrs |= Attribute::Naked; break;
     case lltok::kw_nonlazybind:     Attrs |= Attribute::NonLazyBind; break;
     case lltok::kw_address_safety:  Attrs |= Attribute::AddressSafety; break;
+    case lltok::kw_cold:            Attrs |= Attribute::Cold; break;
 
     case lltok::kw_alignstack: {
       unsigned Alignment;
@@ -1010,6 +1011,7 @@ bool LLParser::ParseOptionalAttrs(Attributes &Attrs, unsigned AttrKind) {
     case lltok::kw_nonlazybind:
     case lltok::kw_returns_twice:
     case lltok::kw_address_safety:
+    case lltok::kw_cold:
       if (AttrKind != 2)
         HaveError |= Error(AttrLoc, "invalid use of function-only attribute");
       break;
@@ -109,6 +109,7 @@ namespace lltok {
     kw_naked,
     kw_nonlazybind,
     kw_address_safety,
+    kw_cold,
 
     kw_type,
     kw_opaque,
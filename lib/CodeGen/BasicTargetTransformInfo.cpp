@@ -0,0 +1,347 @@
+//===- BasicTargetTransformInfo.cpp - Target-lowering-based cost model ----===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+//
+// This file implements a TargetTransformInfo analysis that derives costs from
+// the type and operation legalization actions a target registers with
+// TargetLowering.  It knows nothing about individual instruction latencies,
+// but it does know when a vector type is split or scalarized and when an
+// operation is expanded, which is what IR-level transformations mostly need
+// to avoid.
+//
+//===----------------------------------------------------------------------===//
+
+#define DEBUG_TYPE "basictti"
+#include "llvm/CodeGen/Passes.h"
+#include "llvm/Analysis/TargetTransformInfo.h"
+#include "llvm/DerivedTypes.h"
+#include "llvm/Instruction.h"
+#include "llvm/Pass.h"
+#include "llvm/Target/TargetLowering.h"
+#include "llvm/Target/TargetRegisterInfo.h"
+#include <utility>
+using namespace llvm;
+
+namespace {
+  class BasicTTI : public ImmutablePass, public TargetTransformInfo {
+    const TargetLowering *TLI;
+
+    /// getTypeLegalizationCost - Return the number of legal values that a
+    /// value of type Ty is legalized into, together with their type.
+    std::pair<unsigned, EVT> getTypeLegalizationCost(Type *Ty) const;
+
+    /// getScalarizationOverhead - Return the cost of inserting and/or
+    /// extracting every element of a vector of type Ty.
+    unsigned getScalarizationOverhead(Type *Ty, bool Insert,
+                                      bool Extract) const;
+
+  public:
+    static char ID; // Class identification, replacement for typeinfo
+    BasicTTI() : ImmutablePass(ID), TLI(0) {
+      llvm_unreachable("This pass cannot be directly constructed");
+    }
+
+    explicit BasicTTI(const TargetLowering *TLI)
+      : ImmutablePass(ID), TLI(TLI) {
+      initializeBasicTTIPass(*PassRegistry::getPassRegistry());
+    }
+
+    virtual void initializePass() {
+      InitializeTargetTransformInfo(this);
+    }
+
+    virtual void getAnalysisUsage(AnalysisUsage &AU) const {
+      TargetTransformInfo::getAnalysisUsage(AU);
+    }
+
+    virtual bool isTypeLegal(Type *Ty) const;
+    virtual bool isLegalAddressingMode(Type *Ty, GlobalValue *BaseGV,
+                                       int64_t BaseOffset, bool HasBaseReg,
+                                       int64_t Scale) const;
+    virtual unsigned getNumberOfRegisters(bool Vector) const;
+    virtual unsigned getRegisterBitWidth(bool Vector) const;
+    virtual PopcntSupportKind getPopcntSupport(unsigned IntTyWidthInBit) const;
+    virtual unsigned getArithmeticInstrCost(unsigned Opcode, Type *Ty) const;
+    virtual unsigned getShuffleCost(ShuffleKind Kind, Type *Tp, int Index,
+                                    Type *SubTp) const;
+    virtual unsigned getCastInstrCost(unsigned Opcode, Type *Dst,
+                                      Type *Src) const;
+    virtual unsigned getCmpSelInstrCost(unsigned Opcode, Type *ValTy,
+                                        Type *CondTy) const;
+    virtual unsigned getVectorInstrCost(unsigned Opcode, Type *Val,
+                                        unsigned Index) const;
+    virtual unsigned getMemoryOpCost(unsigned Opcode, Type *Src,
+                                     unsigned Alignment,
+                                     unsigned AddressSpace) const;
+
+    /// getAdjustedAnalysisPointer - This method is used when a pass implements
+    /// an analysis interface through multiple inheritance.  If needed, it
+    /// should override this to adjust the this pointer as needed for the
+    /// specified pass info.
+    virtual void *getAdjustedAnalysisPointer(const void *ID) {
+      if (ID == &TargetTransformInfo::ID)
+        return (TargetTransformInfo*)this;
+      return this;
+    }
+  };
+}  // End of anonymous namespace
+
+INITIALIZE_AG_PASS(BasicTTI, TargetTransformInfo, "basictti",
+                   "Target Lowering Based Cost Model", false, true, false)
+char BasicTTI::ID = 0;
+
+ImmutablePass *
+llvm::createBasicTargetTransformInfoPass(const TargetLowering *TLI) {
+  return new BasicTTI(TLI);
+}
+
+/// InstructionOpcodeToISD - Map an IR opcode to the SelectionDAG node it is
+/// lowered to, or zero if there is no single such node.
+static unsigned InstructionOpcodeToISD(unsigned Opcode) {
+  switch (Opcode) {
+  default: return 0;
+  case Instruction::Add:      return ISD::ADD;
+  case Instruction::FAdd:     return ISD::FADD;
+  case Instruction::Sub:      return ISD::SUB;
+  case Instruction::FSub:     return ISD::FSUB;
+  case Instruction::Mul:      return ISD::MUL;
+  case Instruction::FMul:     return ISD::FMUL;
+  case Instruction::UDiv:     return ISD::UDIV;
+  case Instruction::SDiv:     return ISD::SDIV;
+  case Instruction::FDiv:     return ISD::FDIV;
+  case Instruction::URem:     return ISD::UREM;
+  case Instruction::SRem:     return ISD::SREM;
+  case Instruction::FRem:     return ISD::FREM;
+  case Instruction::Shl:      return ISD::SHL;
+  case Instruction::LShr:     return ISD::SRL;
+  case Instruction::AShr:     return ISD::SRA;
+  case Instruction::And:      return ISD::AND;
+  case Instruction::Or:       return ISD::OR;
+  case Instruction::Xor:      return ISD::XOR;
+  case Instruction::Trunc:    return ISD::TRUNCATE;
+  case Instruction::ZExt:     return ISD::ZERO_EXTEND;
+  case Instruction::SExt:     return ISD::SIGN_EXTEND;
+  case Instruction::FPToUI:   return ISD::FP_TO_UINT;
+  case Instruction::FPToSI:   return ISD::FP_TO_SINT;
+  case Instruction::UIToFP:   return ISD::UINT_TO_FP;
+  case Instruction::SIToFP:   return ISD::SINT_TO_FP;
+  case Instruction::FPTrunc:  return ISD::FP_ROUND;
+  case Instruction::FPExt:    return ISD::FP_EXTEND;
+  case Instruction::BitCast:  return ISD::BITCAST;
+  case Instruction::ICmp:     return ISD::SETCC;
+  case Instruction::FCmp:     return ISD::SETCC;
+  case Instruction::Load:     return ISD::LOAD;
+  case Instruction::Store:    return ISD::STORE;
+  }
+}
+
+std::pair<unsigned, EVT>
+BasicTTI::getTypeLegalizationCost(Type *Ty) const {
+  LLVMContext &C = Ty->getContext();
+  EVT VT = TLI->getValueType(Ty, true);
+  if (VT == MVT::Other)
+    return std::make_pair(1U, VT);
+
+  // Walk the legalization steps.  Splitting or expanding a value doubles the
+  // number of values to operate on; promotion and widening are free.
+  unsigned Cost = 1;
+  while (true) {
+    switch (TLI->getTypeAction(C, VT)) {
+    case TargetLowering::TypeLegal:
+      return std::make_pair(Cost, VT);
+    case TargetLowering::TypeExpandInteger:
+    case TargetLowering::TypeExpandFloat:
+    case TargetLowering::TypeSplitVector:
+      Cost *= 2;
+      break;
+    default:
+      break;
+    }
+    EVT NextVT = TLI->getTypeToTransformTo(C, VT);
+    if (NextVT == VT)
+      return std::make_pair(Cost, VT);
+    VT = NextVT;
+  }
+}
+
+unsigned BasicTTI::getScalarizationOverhead(Type *Ty, bool Insert,
+                                            bool Extract) const {
+  VectorType *VTy = cast<VectorType>(Ty);
+  unsigned Cost = 0;
+  for (unsigned i = 0, e = VTy->getNumElements(); i != e; ++i) {
+    if (Insert)
+      Cost += getVectorInstrCost(Instruction::InsertElement, Ty, i);
+    if (Extract)
+      Cost += getVectorInstrCost(Instruction::ExtractElement, Ty, i);
+  }
+  return Cost;
+}
+
+bool BasicTTI::isTypeLegal(Type *Ty) const {
+  EVT VT = TLI->getValueType(Ty, true);
+  return VT != MVT::Other && TLI->isTypeLegal(VT);
+}
+
+bool BasicTTI::isLegalAddressingMode(Type *Ty, GlobalValue *BaseGV,
+                                     int64_t BaseOffset, bool HasBaseReg,
+                                     int64_t Scale) const {
+  TargetLowering::AddrMode AM;
+  AM.BaseGV = BaseGV;
+  AM.BaseOffs = BaseOffset;
+  AM.HasBaseReg = HasBaseReg;
+  AM.Scale = Scale;
+  return TLI->isLegalAddressingMode(AM, Ty);
+}
+
+/// getWidestLegalType - Return the widest legal vector or integer type, or
+/// MVT::Other if there is none.
+static MVT getWidestLegalType(const TargetLowering *TLI, bool Vector) {
+  unsigned First = Vector ? MVT::FIRST_VECTOR_VALUETYPE
+                          : MVT::FIRST_INTEGER_VALUETYPE;
+  unsigned Last = Vector ? MVT::LAST_VECTOR_VALUETYPE
+                         : MVT::LAST_INTEGER_VALUETYPE;
+  MVT Widest = MVT::Other;
+  unsigned Width = 0;
+  for (unsigned i = First; i <= Last; ++i) {
+    MVT VT = (MVT::SimpleValueType)i;
+    if (TLI->isTypeLegal(VT) && VT.getSizeInBits() > Width) {
+      Widest = VT;
+      Width = VT.getSizeInBits();
+    }
+  }
+  return Widest;
+}
+
+unsigned BasicTTI::getNumberOfRegisters(bool Vector) const {
+  MVT VT = getWidestLegalType(TLI, Vector);
+  if (VT == MVT::Other)
+    return 0;
+  return TLI->getRegClassFor(VT)->getNumRegs();
+}
+
+unsigned BasicTTI::getRegisterBitWidth(bool Vector) const {
+  MVT VT = getWidestLegalType(TLI, Vector);
+  return VT == MVT::Other ? 0 : VT.getSizeInBits();
+}
+
+TargetTransformInfo::PopcntSupportKind
+BasicTTI::getPopcntSupport(unsigned IntTyWidthInBit) const {
+  MVT VT = MVT::getIntegerVT(IntTyWidthInBit);
+  if (VT.SimpleTy == MVT::INVALID_SIMPLE_VALUE_TYPE || !TLI->isTypeLegal(VT))
+    return PSK_Software;
+  if (TLI->isOperationLegal(ISD::CTPOP, VT))
+    return PSK_FastHardware;
+  if (TLI->isOperationLegalOrCustom(ISD::CTPOP, VT))
+    return PSK_SlowHardware;
+  return PSK_Software;
+}
+
+unsigned BasicTTI::getArithmeticInstrCost(unsigned Opcode, Type *Ty) const {
+  unsigned ISDOpcode = InstructionOpcodeToISD(Opcode);
+  std::pair<unsigned, EVT> LT = getTypeLegalizationCost(Ty);
+
+  if (!ISDOpcode || LT.second == MVT::Other ||
+      TLI->getOperationAction(ISDOpcode, LT.second) != TargetLowering::Expand)
+    return LT.first;
+
+  // An expanded vector operation is performed one element at a time.
+  if (VectorType *VTy = dyn_cast<VectorType>(Ty))
+    return getScalarizationOverhead(Ty, true, true) +
+      VTy->getNumElements() *
+        getArithmeticInstrCost(Opcode, VTy->getElementType());
+
+  // An expanded scalar operation is usually a short sequence or a libcall.
+  return LT.first;
+}
+
+unsigned BasicTTI::getShuffleCost(ShuffleKind Kind, Type *Tp, int Index,
+                                  Type *SubTp) const {
+  // Assume one shuffle per legal register, unless the vector is legalized
+  // into scalars, in which case every element moves on its own.
+  std::pair<unsigned, EVT> LT = getTypeLegalizationCost(Tp);
+  if (LT.second == MVT::Other || LT.second.isVector())
+    return LT.first;
+  return getScalarizationOverhead(Tp, true, true);
+}
+
+unsigned BasicTTI::getCastInstrCost(unsigned Opcode, Type *Dst,
+                                    Type *Src) const {
+  std::pair<unsigned, EVT> SrcLT = getTypeLegalizationCost(Src);
+  std::pair<unsigned, EVT> DstLT = getTypeLegalizationCost(Dst);
+
+  // Casts that do not change the bits held in a register are free.
+  if ((Opcode == Instruction::BitCast || Opcode == Instruction::PtrToInt ||
+       Opcode == Instruction::IntToPtr) &&
+      SrcLT.first == DstLT.first &&
+      SrcLT.second.getSizeInBits() == DstLT.second.getSizeInBits())
+    return 0;
+  if (Opcode == Instruction::Trunc &&
+      TLI->isTruncateFree(SrcLT.second, DstLT.second))
+    return 0;
+  if (Opcode == Instruction::ZExt &&
+      TLI->isZExtFree(SrcLT.second, DstLT.second))
+    return 0;
+
+  VectorType *DstVTy = dyn_cast<VectorType>(Dst);
+  if (!DstVTy)
+    return 1;
+
+  // A vector cast between types that legalize the same way is one
+  // instruction per legal value if the target supports it.
+  unsigned ISDOpcode = InstructionOpcodeToISD(Opcode);
+  if (SrcLT.first == DstLT.first &&
+      SrcLT.second.getSizeInBits() == DstLT.second.getSizeInBits() &&
+      ISDOpcode && DstLT.second != MVT::Other &&
+      TLI->isOperationLegalOrCustom(ISDOpcode, DstLT.second))
+    return DstLT.first;
+
+  // Otherwise assume the cast is scalarized.
+  return getScalarizationOverhead(Dst, true, false) +
+    getScalarizationOverhead(Src, false, true) +
+    DstVTy->getNumElements() *
+      getCastInstrCost(Opcode, DstVTy->getElementType(),
+                       Src->getScalarType());
+}
+
+unsigned BasicTTI::getCmpSelInstrCost(unsigned Opcode, Type *ValTy,
+                                      Type *CondTy) const {
+  VectorType *VTy = dyn_cast<VectorType>(ValTy);
+  if (!VTy)
+    return 1;
+
+  unsigned ISDOpcode = Opcode == Instruction::Select ? ISD::VSELECT
+                                                     : ISD::SETCC;
+  std::pair<unsigned, EVT> LT = getTypeLegalizationCost(ValTy);
+  if (LT.second != MVT::Other &&
+      TLI->isOperationLegalOrCustom(ISDOpcode, LT.second))
+    return LT.first;
+
+  // Otherwise the comparison or select is done one element at a time.
+  return getScalarizationOverhead(ValTy, true, true) +
+    VTy->getNumElements() *
+      getCmpSelInstrCost(Opcode, VTy->getElementType(),
+                         CondTy ? CondTy->getScalarType() : 0);
+}
+
+unsigned BasicTTI::getVectorInstrCost(unsigned Opcode, Type *Val,
+                                      unsigned Index) const {
+  return 1;
+}
+
+unsigned BasicTTI::getMemoryOpCost(unsigned Opcode, Type *Src,
+                                   unsigned Alignment,
+                                   unsigned AddressSpace) const {
+  std::pair<unsigned, EVT> LT = getTypeLegalizationCost(Src);
+
+  // A vector that is legalized into scalars also has to be taken apart or
+  // put together element by element.
+  if (Src->isVectorTy() && LT.second != MVT::Other && !LT.second.isVector())
+    return LT.first + getScalarizationOverhead(Src, Opcode == Instruction::Load,
+                                               Opcode == Instruction::Store);
+  return LT.first;
+}
@@ -777,6 +777,41 @@ void LiveRange::print(raw_ostream &os) const {
   os << *this;
 }
 
+void PackedLiveSegments::init(const LiveInterval &LI,
+                              const SlotIndexes &Indexes) {
+  Bounds.clear();
+  Values.clear();
+  Bounds.reserve(2 * LI.ranges.size());
+  Values.reserve(LI.ranges.size());
+  for (LiveInterval::const_iterator I = LI.begin(), E = LI.end(); I != E; ++I) {
+    Bounds.push_back(I->start.getIndex());
+    Bounds.push_back(I->end.getIndex());
+    Values.push_back(I->valno);
+  }
+  Generation = Indexes.getGeneration();
+}
+
+unsigned PackedLiveSegments::upperBound(SlotIndex Idx) const {
+  return std::upper_bound(Bounds.begin(), Bounds.end(),
+                          unsigned(Idx.getIndex())) - Bounds.begin();
+}
+
+bool PackedLiveSegments::overlaps(const LiveInterval &LI) const {
+  SmallVectorImpl<unsigned>::const_iterator B = Bounds.begin(),
+    BE = Bounds.end();
+  for (LiveInterval::const_iterator I = LI.begin(), E = LI.end(); I != E; ++I) {
+    // Find the first boundary after the start of I.  Both are sorted, so the
+    // search can resume where the previous one ended.
+    B = std::upper_bound(B, BE, unsigned(I->start.getIndex()));
+    if (B == BE)
+      return false;
+    // I starts inside a segment, or the next segment starts before I ends.
+    if ((B - Bounds.begin()) & 1 || *B < unsigned(I->end.getIndex()))
+      return true;
+  }
+  return false;
+}
+
 unsigned ConnectedVNInfoEqClasses::Classify(const LiveInterval *LI) {
   // Create initial equivalence classes.
   EqClass.clear();
@@ -56,6 +56,7 @@ bool LiveRegMatrix::runOnMachineFunction(MachineFunction &MF) {
   if (NumRegUnits != Matrix.size())
     Queries.reset(new LiveIntervalUnion::Query[NumRegUnits]);
   Matrix.init(LIUAlloc, NumRegUnits);
+  PackedRegUnits.reset(new PackedLiveSegments[NumRegUnits]);
 
   // Make sure no stale queries get reused.
   invalidateVirtRegs();
@@ -67,6 +68,7 @@ void LiveRegMatrix::releaseMemory() {
     Matrix[i].clear();
     Queries[i].clear();
   }
+  PackedRegUnits.reset();
 }
 
 void LiveRegMatrix::assign(LiveInterval &VirtReg, unsigned PhysReg) {
@@ -118,10 +120,22 @@ bool LiveRegMatrix::checkRegUnitInterference(LiveInterval &VirtReg,
                                              unsigned PhysReg) {
   if (VirtReg.empty())
     return false;
+  const SlotIndexes &Indexes = *LIS->getSlotIndexes();
   CoalescerPair CP(VirtReg.reg, PhysReg, *TRI);
-  for (MCRegUnitIterator Units(PhysReg, TRI); Units.isValid(); ++Units)
-    if (VirtReg.overlaps(LIS->getRegUnit(*Units), CP, *LIS->getSlotIndexes()))
+  for (MCRegUnitIterator Units(PhysReg, TRI); Units.isValid(); ++Units) {
+    const LiveInterval &UnitLI = LIS->getRegUnit(*Units);
+    // Register unit intervals don't change during allocation, so the packed
+    // copy only goes stale when the indexes are renumbered.  Most candidates
+    // don't overlap at all, and the packed copy rules them out without
+    // walking the fixed interval.
+    PackedLiveSegments &Packed = PackedRegUnits[*Units];
+    if (!Packed.isCurrent(Indexes))
+      Packed.init(UnitLI, Indexes);
+    if (!Packed.overlaps(VirtReg))
+      continue;
+    if (VirtReg.overlaps(UnitLI, CP, Indexes))
       return true;
+  }
   return false;
 }
 
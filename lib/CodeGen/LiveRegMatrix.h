@@ -58,6 +58,9 @@ class LiveRegMatrix : public MachineFunctionPass {
   unsigned RegMaskVirtReg;
   BitVector RegMaskUsable;
 
+  // Packed copies of the fixed register unit intervals, made on demand.
+  OwningArrayPtr<PackedLiveSegments> PackedRegUnits;
+
   // MachineFunctionPass boilerplate.
   virtual void getAnalysisUsage(AnalysisUsage&) const;
   virtual bool runOnMachineFunction(MachineFunction&);
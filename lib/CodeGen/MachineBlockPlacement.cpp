@@ -35,6 +35,7 @@
 #include "llvm/CodeGen/MachineModuleInfo.h"
 #include "llvm/CodeGen/Passes.h"
 #include "llvm/Support/Allocator.h"
+#include "llvm/Support/CommandLine.h"
 #include "llvm/Support/Debug.h"
 #include "llvm/ADT/DenseMap.h"
 #include "llvm/ADT/SmallPtrSet.h"
@@ -51,6 +52,12 @@ STATISTIC(CondBranchTakenFreq,
           "Potential frequency of taking conditional branches");
 STATISTIC(UncondBranchTakenFreq,
           "Potential frequency of taking unconditional branches");
+STATISTIC(NumColdBlocksMoved, "Number of cold blocks moved to the end");
+
+static cl::opt<bool>
+EnableColdBlockPlacement("enable-cold-block-placement", cl::init(false),
+  cl::Hidden, cl::desc("Move landing pads and blocks that are (almost) never "
+                       "executed to the end of the function"));
 
 namespace {
 class BlockChain;
@@ -216,6 +223,7 @@ class MachineBlockPlacement : public MachineFunctionPass {
   void buildLoopChains(MachineFunction &F, MachineLoop &L);
   void rotateLoop(BlockChain &LoopChain, MachineBasicBlock *ExitingBB,
                   const BlockFilterSet &LoopBlockSet);
+  void moveColdBlocksToEnd(MachineFunction &F, BlockChain &FunctionChain);
   void buildCFGChains(MachineFunction &F);
 
 public:
@@ -869,6 +877,61 @@ void MachineBlockPlacement::buildLoopChains(MachineFunction &F,
   });
 }
 
+/// \brief Move the cold blocks of the function chain to its end.
+///
+/// Landing pads, and blocks whose frequency is a negligible fraction of the
+/// entry frequency, are moved after all the other blocks, keeping their
+/// relative order. With profile-derived branch weights, the latter are the
+/// blocks that never ran; with static heuristics, mostly the paths to
+/// unreachable code. Blocks that must keep falling through into their layout
+/// successor stay glued to it, so the terminators can be fixed up afterwards.
+void MachineBlockPlacement::moveColdBlocksToEnd(MachineFunction &F,
+                                                BlockChain &FunctionChain) {
+  const BranchProbability ColdProb(1, 1000);
+  BlockFrequency ColdFreq = MBFI->getBlockFreq(F.begin()) * ColdProb;
+
+  SmallVector<MachineBasicBlock *, 16> HotBlocks, ColdBlocks;
+  SmallVector<MachineBasicBlock *, 4> Segment;
+  SmallVector<MachineOperand, 4> Cond; // For AnalyzeBranch.
+  bool SegmentIsCold = false;
+  for (BlockChain::iterator BI = FunctionChain.begin(),
+                            BE = FunctionChain.end();
+       BI != BE; ++BI) {
+    MachineBasicBlock *BB = *BI;
+    bool Glued = false;
+    if (!Segment.empty()) {
+      // The blocks pre-merged because of an unanalyzable fallthrough are
+      // still adjacent in both the chain and the original layout.
+      MachineBasicBlock *Prev = Segment.back();
+      Cond.clear();
+      MachineBasicBlock *TBB = 0, *FBB = 0; // For AnalyzeBranch.
+      Glued = TII->AnalyzeBranch(*Prev, TBB, FBB, Cond) &&
+              Prev->isLayoutSuccessor(BB) && Prev->canFallThrough();
+    }
+    if (!Glued) {
+      SmallVectorImpl<MachineBasicBlock *> &Dest =
+        SegmentIsCold ? ColdBlocks : HotBlocks;
+      Dest.append(Segment.begin(), Segment.end());
+      Segment.clear();
+      // The entry block always stays first.
+      SegmentIsCold = BI != FunctionChain.begin();
+    }
+    Segment.push_back(BB);
+    SegmentIsCold &= BB->isLandingPad() || MBFI->getBlockFreq(BB) < ColdFreq;
+  }
+  (SegmentIsCold ? ColdBlocks : HotBlocks).append(Segment.begin(),
+                                                  Segment.end());
+  if (ColdBlocks.empty())
+    return;
+
+  DEBUG(dbgs() << "Moving " << ColdBlocks.size() << " cold blocks to the end "
+               << "of " << F.getName() << "\n");
+  NumColdBlocksMoved += ColdBlocks.size();
+  BlockChain::iterator BI = std::copy(HotBlocks.begin(), HotBlocks.end(),
+                                      FunctionChain.begin());
+  std::copy(ColdBlocks.begin(), ColdBlocks.end(), BI);
+}
+
 void MachineBlockPlacement::buildCFGChains(MachineFunction &F) {
   // Ensure that every BB in the function has an associated chain to simplify
   // the assumptions of the remaining algorithm.
@@ -961,6 +1024,9 @@ void MachineBlockPlacement::buildCFGChains(MachineFunction &F) {
     assert(!BadFunc && "Detected problems with the block placement.");
   });
 
+  if (EnableColdBlockPlacement)
+    moveColdBlocksToEnd(F, FunctionChain);
+
   // Splice the blocks into place.
   MachineFunction::iterator InsertPos = F.begin();
   for (BlockChain::iterator BI = FunctionChain.begin(),
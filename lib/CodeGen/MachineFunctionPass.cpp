@@ -13,9 +13,14 @@
 
 #include "llvm/Function.h"
 #include "llvm/Analysis/AliasAnalysis.h"
+#include "llvm/CodeGen/MachineFunction.h"
 #include "llvm/CodeGen/MachineFunctionAnalysis.h"
 #include "llvm/CodeGen/MachineFunctionPass.h"
+#include "llvm/CodeGen/MachinePassListener.h"
+#include "llvm/CodeGen/MachineRegisterInfo.h"
 #include "llvm/CodeGen/Passes.h"
+#include "llvm/Support/Timer.h"
+#include "llvm/Target/TargetMachine.h"
 using namespace llvm;
 
 Pass *MachineFunctionPass::createPrinterPass(raw_ostream &O,
@@ -30,7 +35,26 @@ bool MachineFunctionPass::runOnFunction(Function &F) {
     return false;
 
   MachineFunction &MF = getAnalysis<MachineFunctionAnalysis>().getMF();
-  return runOnMachineFunction(MF);
+  MachinePassListener *Listener = MF.getTarget().getMachinePassListener();
+  if (!Listener)
+    return runOnMachineFunction(MF);
+
+  TimeRecord Elapsed = TimeRecord::getCurrentTime(true);
+  bool Changed = runOnMachineFunction(MF);
+  Elapsed -= TimeRecord::getCurrentTime(false);
+
+  MachinePassRecord Record;
+  Record.MF = &MF;
+  Record.P = this;
+  Record.WallTime = -Elapsed.getWallTime();
+  Record.NumInstrs = 0;
+  for (MachineFunction::const_iterator I = MF.begin(), E = MF.end(); I != E;
+       ++I)
+    Record.NumInstrs += I->size();
+  Record.NumVirtRegs = MF.getRegInfo().getNumVirtRegs();
+  Record.NumBlocks = MF.size();
+  Listener->passRun(Record);
+  return Changed;
 }
 
 void MachineFunctionPass::getAnalysisUsage(AnalysisUsage &AU) const {
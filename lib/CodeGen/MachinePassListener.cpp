@@ -0,0 +1,52 @@
+//===-- MachinePassListener.cpp - Codegen pass profile --------------------===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+//
+// This file implements the CSV writer for MachinePassListener records.
+//
+//===----------------------------------------------------------------------===//
+
+#include "llvm/CodeGen/MachinePassListener.h"
+#include "llvm/Pass.h"
+#include "llvm/CodeGen/MachineFunction.h"
+#include "llvm/Support/Format.h"
+#include "llvm/Support/MutexGuard.h"
+#include "llvm/Support/raw_ostream.h"
+using namespace llvm;
+
+MachinePassListener::~MachinePassListener() {}
+
+/// printField - Print a CSV field, quoting it if it contains a separator.
+static void printField(raw_ostream &OS, StringRef Field) {
+  if (Field.find_first_of(",\"\n") == StringRef::npos) {
+    OS << Field;
+    return;
+  }
+  OS << '"';
+  for (unsigned i = 0, e = Field.size(); i != e; ++i) {
+    if (Field[i] == '"')
+      OS << '"';
+    OS << Field[i];
+  }
+  OS << '"';
+}
+
+CSVMachinePassListener::CSVMachinePassListener(raw_ostream &os) : OS(os) {
+  OS << "function,pass,seconds,instructions,vregs,blocks\n";
+}
+
+void CSVMachinePassListener::passRun(const MachinePassRecord &Record) {
+  MutexGuard Guard(Lock);
+  printField(OS, Record.MF->getName());
+  OS << ',';
+  printField(OS, Record.P->getPassName());
+  OS << ',' << format("%.6f", Record.WallTime)
+     << ',' << Record.NumInstrs
+     << ',' << Record.NumVirtRegs
+     << ',' << Record.NumBlocks << '\n';
+}
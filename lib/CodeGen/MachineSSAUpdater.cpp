@@ -187,7 +187,7 @@ unsigned MachineSSAUpdater::GetValueInMiddleOfBlock(MachineBasicBlock *BB) {
                                            Loc, VRC, MRI, TII);
 
   // Fill in all the predecessors of the PHI.
-  MachineInstrBuilder MIB(InsertedPHI);
+  MachineInstrBuilder MIB(*BB->getParent(), InsertedPHI);
   for (unsigned i = 0, e = PredValues.size(); i != e; ++i)
     MIB.addReg(PredValues[i].second).addMBB(PredValues[i].first);
 
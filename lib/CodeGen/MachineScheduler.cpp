@@ -26,11 +26,14 @@
 #include "llvm/Support/raw_ostream.h"
 #include "llvm/ADT/OwningPtr.h"
 #include "llvm/ADT/PriorityQueue.h"
+#include "llvm/ADT/Statistic.h"
 
 #include <queue>
 
 using namespace llvm;
 
+STATISTIC(NumLargeRegions, "Number of regions too large to schedule");
+
 namespace llvm {
 cl::opt<bool> ForceTopDown("misched-topdown", cl::Hidden,
                            cl::desc("Force top-down list scheduling"));
@@ -48,6 +51,10 @@ static cl::opt<unsigned> MISchedCutoff("misched-cutoff", cl::Hidden,
 static bool ViewMISchedDAGs = false;
 #endif // NDEBUG
 
+static cl::opt<unsigned> MISchedMaxRegion("misched-max-region", cl::Hidden,
+  cl::desc("Leave regions with more instructions than this unscheduled"),
+  cl::init(1000));
+
 //===----------------------------------------------------------------------===//
 // Machine Instruction Scheduling Pass and Registry
 //===----------------------------------------------------------------------===//
@@ -234,16 +241,29 @@ bool MachineScheduler::runOnMachineFunction(MachineFunction &mf) {
       // The next region starts above the previous region. Look backward in the
       // instruction stream until we find the nearest boundary.
       MachineBasicBlock::iterator I = RegionEnd;
+      unsigned NumRegionInstrs = 0;
       for(;I != MBB->begin(); --I, --RemainingCount) {
         if (TII->isSchedulingBoundary(llvm::prior(I), MBB, *MF))
           break;
+        if (!llvm::prior(I)->isDebugValue())
+          ++NumRegionInstrs;
       }
       // Notify the scheduler of the region, even if we may skip scheduling
       // it. Perhaps it still needs to be bundled.
       Scheduler->enterRegion(MBB, I, RegionEnd, RemainingCount);
 
+      // Building the DAG and tracking pressure are superlinear in the size of
+      // the region, so leave huge regions in their original order.
+      bool TooLarge = NumRegionInstrs > MISchedMaxRegion;
+      if (TooLarge) {
+        DEBUG(dbgs() << MF->getName() << ":BB#" << MBB->getNumber()
+              << " skipping region of " << NumRegionInstrs
+              << " instructions\n");
+        ++NumLargeRegions;
+      }
+
       // Skip empty scheduling regions (0 or 1 schedulable instructions).
-      if (I == RegionEnd || I == llvm::prior(RegionEnd)) {
+      if (I == RegionEnd || I == llvm::prior(RegionEnd) || TooLarge) {
         // Close the current region. Bundle the terminator if needed.
         // This invalidates 'RegionEnd' and 'I'.
         Scheduler->exitRegion();
@@ -699,6 +719,10 @@ class ConvergingScheduler : public MachineSchedStrategy {
   ScheduleDAGMI *DAG;
   const TargetRegisterInfo *TRI;
 
+  // Break ties in favor of the critical path. This is off in regions where the
+  // original order already comes close to a register pressure limit.
+  bool PreferCriticalPath;
+
   // State of the top and bottom scheduled instruction boundaries.
   SchedBoundary Top;
   SchedBoundary Bot;
@@ -712,7 +736,8 @@ public:
   };
 
   ConvergingScheduler():
-    DAG(0), TRI(0), Top(TopQID, "TopQ"), Bot(BotQID, "BotQ") {}
+    DAG(0), TRI(0), PreferCriticalPath(false), Top(TopQID, "TopQ"),
+    Bot(BotQID, "BotQ") {}
 
   virtual void initialize(ScheduleDAGMI *dag);
 
@@ -749,6 +774,19 @@ void ConvergingScheduler::initialize(ScheduleDAGMI *dag) {
   Top.HazardRec = TM.getInstrInfo()->CreateTargetMIHazardRecognizer(Itin, DAG);
   Bot.HazardRec = TM.getInstrInfo()->CreateTargetMIHazardRecognizer(Itin, DAG);
 
+  // Reordering for latency near a pressure limit costs more in copies and
+  // spills than it gains, so only do it while a quarter of each set is free.
+  PreferCriticalPath = true;
+  const std::vector<unsigned> &MaxPressure =
+    DAG->getRegPressure().MaxSetPressure;
+  for (unsigned i = 0, e = MaxPressure.size(); i < e; ++i) {
+    if (MaxPressure[i]
+        && 4 * MaxPressure[i] >= 3 * TRI->getRegPressureSetLimit(i)) {
+      PreferCriticalPath = false;
+      break;
+    }
+  }
+
   assert((!ForceTopDown || !ForceBottomUp) &&
          "-misched-topdown incompatible with -misched-bottomup");
 }
@@ -806,7 +844,10 @@ bool ConvergingScheduler::SchedBoundary::checkHazard(SUnit *SU) {
   if (HazardRec->isEnabled())
     return HazardRec->getHazardType(SU) != ScheduleHazardRecognizer::NoHazard;
 
-  if (IssueCount + DAG->getNumMicroOps(SU->getInstr()) > DAG->getIssueWidth())
+  // An instruction with more micro-ops than the issue width starts a group of
+  // its own.
+  unsigned UOps = DAG->getNumMicroOps(SU->getInstr());
+  if (IssueCount > 0 && IssueCount + UOps > DAG->getIssueWidth())
     return true;
 
   return false;
@@ -918,9 +959,11 @@ SUnit *ConvergingScheduler::SchedBoundary::pickOnlyChoice() {
   if (CheckPending)
     releasePending();
 
+  // Micro-ops left over from a long instruction delay the next group.
+  unsigned MaxStall = HazardRec->getMaxLookAhead() + MaxMinLatency
+    + IssueCount / DAG->getIssueWidth();
   for (unsigned i = 0; Available.empty(); ++i) {
-    assert(i <= (HazardRec->getMaxLookAhead() + MaxMinLatency) &&
-           "permanent hazard"); (void)i;
+    assert(i <= MaxStall && "permanent hazard"); (void)i; (void)MaxStall;
     bumpCycle();
     releasePending();
   }
@@ -965,6 +1008,12 @@ static bool compareRPDelta(const RegPressureDelta &LHS,
   return false;
 }
 
+/// Return the latency of the longest path from SU to the boundary that queue
+/// QID schedules towards, as given by the machine model.
+static unsigned getRemainingLatency(SUnit *SU, unsigned QID) {
+  return QID == ConvergingScheduler::TopQID ? SU->getHeight() : SU->getDepth();
+}
+
 /// Pick the best candidate from the top queue.
 ///
 /// TODO: getMaxPressureDelta results can be mostly cached for each SUnit during
@@ -1041,6 +1090,20 @@ pickNodeFromQueue(ReadyQueue &Q, const RegPressureTracker &RPTracker,
     if (FoundCandidate == NoCand)
       continue;
 
+    // Prefer the node with the longer latency path to the far end of the
+    // region, so that long operations issue early in an out-of-order core.
+    unsigned PathLen = getRemainingLatency(*I, Q.getID());
+    unsigned CandPathLen = getRemainingLatency(Candidate.SU, Q.getID());
+    if (PathLen != CandPathLen && PreferCriticalPath) {
+      if (PathLen > CandPathLen) {
+        DEBUG(traceCandidate("LCAND", Q, *I));
+        Candidate.SU = *I;
+        Candidate.RPDelta = RPDelta;
+        FoundCandidate = NodeOrder;
+      }
+      continue;
+    }
+
     if ((Q.getID() == TopQID && (*I)->NodeNum < Candidate.SU->NodeNum)
         || (Q.getID() == BotQID && (*I)->NodeNum > Candidate.SU->NodeNum)) {
       DEBUG(traceCandidate("NCAND", Q, *I));
@@ -1106,6 +1169,12 @@ SUnit *ConvergingScheduler::pickNodeBidrectional(bool &IsTopNode) {
     IsTopNode = true;
     return TopCand.SU;
   }
+  // A region that already exceeds a pressure limit spills less when scheduled
+  // top-down, so prefer the top candidate when the heuristics are silent.
+  if (!DAG->getRegionCriticalPSets().empty()) {
+    IsTopNode = true;
+    return TopCand.SU;
+  }
   // Otherwise prefer the bottom candidate in node order.
   IsTopNode = false;
   return BotCand.SU;
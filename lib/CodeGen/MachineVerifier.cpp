@@ -40,6 +40,7 @@
 #include "llvm/Target/TargetRegisterInfo.h"
 #include "llvm/Target/TargetInstrInfo.h"
 #include "llvm/ADT/DenseSet.h"
+#include "llvm/ADT/STLExtras.h"
 #include "llvm/ADT/SetOperations.h"
 #include "llvm/ADT/SmallVector.h"
 #include "llvm/Support/Debug.h"
@@ -228,6 +229,7 @@ namespace {
     void verifyLiveIntervalValue(const LiveInterval&, VNInfo*);
     void verifyLiveIntervalSegment(const LiveInterval&,
                                    LiveInterval::const_iterator);
+    void verifyPackedLiveSegments(const LiveInterval&);
   };
 
   struct MachineVerifierPass : public MachineFunctionPass {
@@ -670,8 +672,11 @@ MachineVerifier::visitMachineBasicBlockBefore(const MachineBasicBlock *MBB) {
   regsKilled.clear();
   regsDefined.clear();
 
-  if (Indexes)
+  if (Indexes) {
     lastIndex = Indexes->getMBBStartIdx(MBB);
+    if (Indexes->lookupMBB(lastIndex) != MBB)
+      report("Block start index maps to another block", MBB);
+  }
 }
 
 // This function gets called for all bundle headers, including normal
@@ -683,6 +688,11 @@ void MachineVerifier::visitMachineBundleBefore(const MachineInstr *MI) {
       report("Instruction index out of order", MI);
       *OS << "Last instruction was at " << lastIndex << '\n';
     }
+    if (Indexes->lookupMBB(idx) != MI->getParent()) {
+      report("Instruction index maps to another block", MI);
+      *OS << idx << " is in BB#" << Indexes->lookupMBB(idx)->getNumber()
+          << '\n';
+    }
     lastIndex = idx;
   }
 
@@ -1563,6 +1573,33 @@ MachineVerifier::verifyLiveIntervalSegment(const LiveInterval &LI,
   }
 }
 
+// Check that a packed copy of LI answers queries the same way as LI.
+void MachineVerifier::verifyPackedLiveSegments(const LiveInterval &LI) {
+  PackedLiveSegments Packed;
+  Packed.init(LI, *LiveInts->getSlotIndexes());
+  if (Packed.size() != LI.ranges.size()) {
+    report("Packed live segments have the wrong size", MF, LI);
+    return;
+  }
+  unsigned Seg = 0;
+  for (LiveInterval::const_iterator I = LI.begin(), E = LI.end(); I != E;
+       ++I, ++Seg) {
+    SlotIndex Probes[] = { I->start, I->end.getPrevSlot(), I->end };
+    for (unsigned i = 0; i != array_lengthof(Probes); ++i) {
+      SlotIndex Idx = Probes[i];
+      if (Packed.find(Idx) != unsigned(LI.find(Idx) - LI.begin()) ||
+          Packed.getVNInfoAt(Idx) != LI.getVNInfoAt(Idx)) {
+        report("Packed live segments disagree with live interval", MF, LI);
+        *OS << "Segment " << Seg << ' ' << *I << " queried at " << Idx
+            << '\n';
+        return;
+      }
+    }
+  }
+  if (!Packed.overlaps(LI) != LI.empty())
+    report("Packed live segments don't overlap their own interval", MF, LI);
+}
+
 void MachineVerifier::verifyLiveInterval(const LiveInterval &LI) {
   for (LiveInterval::const_vni_iterator I = LI.vni_begin(), E = LI.vni_end();
        I!=E; ++I)
@@ -1571,6 +1608,8 @@ void MachineVerifier::verifyLiveInterval(const LiveInterval &LI) {
   for (LiveInterval::const_iterator I = LI.begin(), E = LI.end(); I!=E; ++I)
     verifyLiveIntervalSegment(LI, I);
 
+  verifyPackedLiveSegments(LI);
+
   // Check the LI only has one connected component.
   if (TargetRegisterInfo::isVirtualRegister(LI.reg)) {
     ConnectedVNInfoEqClasses ConEQ(*LiveInts);
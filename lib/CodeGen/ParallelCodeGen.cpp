@@ -0,0 +1,152 @@
+//===-- ParallelCodeGen.cpp - Parallel code generation --------------------===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+//
+// This file implements splitCodeGen.
+//
+// An LLVMContext may only be used by one thread at a time, so the partitions
+// are written out as bitcode on the calling thread and each worker reads its
+// partition back into a context of its own.
+//
+// report_fatal_error calls exit(), which tears down global state under the
+// feet of the other workers.  While the workers run, a fatal error handler
+// records the message in the job of the failing thread and unwinds it with
+// its CrashRecoveryContext instead; splitCodeGen reports the first error once
+// every worker has finished.
+//
+//===----------------------------------------------------------------------===//
+
+#include "llvm/CodeGen/ParallelCodeGen.h"
+#include "llvm/LLVMContext.h"
+#include "llvm/Module.h"
+#include "llvm/PassManager.h"
+#include "llvm/ADT/OwningPtr.h"
+#include "llvm/ADT/Triple.h"
+#include "llvm/Bitcode/ReaderWriter.h"
+#include "llvm/Support/CrashRecoveryContext.h"
+#include "llvm/Support/ErrorHandling.h"
+#include "llvm/Support/FormattedStream.h"
+#include "llvm/Support/MemoryBuffer.h"
+#include "llvm/Support/ThreadLocal.h"
+#include "llvm/Support/Threading.h"
+#include "llvm/Support/raw_ostream.h"
+#include "llvm/Target/TargetData.h"
+#include "llvm/Target/TargetLibraryInfo.h"
+#include "llvm/Transforms/Utils/SplitModule.h"
+#include <vector>
+using namespace llvm;
+
+namespace {
+/// PartitionJob - The work and the result of one thread.
+struct PartitionJob {
+  std::string ModuleID;
+  std::string Bitcode;
+  TargetMachine *TM;
+  formatted_raw_ostream *Out;
+  TargetMachine::CodeGenFileType FileType;
+  bool DisableVerify;
+  std::string ErrMsg;
+};
+} // end anonymous namespace
+
+/// CurrentJob - The job run by the current thread, if it is a worker.
+static sys::ThreadLocal<const PartitionJob> CurrentJob;
+
+/// partitionErrorHandler - Record a fatal error of a worker in its job and
+/// abandon the job.  Returning makes report_fatal_error exit.
+static void partitionErrorHandler(void *, const std::string &Reason) {
+  PartitionJob *Job = const_cast<PartitionJob*>(CurrentJob.get());
+  CrashRecoveryContext *CRC = CrashRecoveryContext::GetCurrent();
+  if (Job && CRC) {
+    Job->ErrMsg = Reason;
+    CRC->HandleCrash();
+  }
+  errs() << "LLVM ERROR: " << Reason << "\n";
+}
+
+static void emitPartition(void *Arg) {
+  PartitionJob &Job = *static_cast<PartitionJob*>(Arg);
+  LLVMContext Context;
+  OwningPtr<MemoryBuffer> Buffer(MemoryBuffer::getMemBuffer(Job.Bitcode,
+                                                            Job.ModuleID,
+                                                            false));
+  OwningPtr<Module> M(ParseBitcodeFile(Buffer.get(), Context, &Job.ErrMsg));
+  if (!M)
+    return;
+
+  PassManager PM;
+  PM.add(new TargetLibraryInfo(Triple(M->getTargetTriple())));
+  if (const TargetData *TD = Job.TM->getTargetData())
+    PM.add(new TargetData(*TD));
+  else
+    PM.add(new TargetData(M.get()));
+
+  if (Job.TM->addPassesToEmitFile(PM, *Job.Out, Job.FileType,
+                                  Job.DisableVerify)) {
+    Job.ErrMsg = "target does not support generation of this file type";
+    return;
+  }
+  PM.run(*M);
+  Job.Out->flush();
+}
+
+static void runPartitionJob(void *Arg) {
+  PartitionJob &Job = *static_cast<PartitionJob*>(Arg);
+  CurrentJob.set(&Job);
+  // The state of an abandoned job is leaked; the caller is expected to exit
+  // after reporting the error.
+  CrashRecoveryContext CRC;
+  if (!CRC.RunSafely(emitPartition, &Job) && Job.ErrMsg.empty())
+    Job.ErrMsg = "code generation crashed";
+  CurrentJob.erase();
+}
+
+bool llvm::splitCodeGen(Module &M, ArrayRef<TargetMachine*> TMs,
+                        ArrayRef<formatted_raw_ostream*> Outs,
+                        TargetMachine::CodeGenFileType FileType,
+                        bool DisableVerify, std::string &ErrMsg) {
+  assert(!TMs.empty() && TMs.size() == Outs.size() &&
+         "Need one target machine per output");
+  ModuleSplitter Splitter(M, TMs.size());
+
+  std::vector<PartitionJob> Jobs(TMs.size());
+  std::vector<void*> Args(TMs.size());
+  for (unsigned i = 0, e = TMs.size(); i != e; ++i) {
+    OwningPtr<Module> Partition(Splitter.createPartition(i));
+    raw_string_ostream OS(Jobs[i].Bitcode);
+    WriteBitcodeToFile(Partition.get(), OS);
+    OS.flush();
+    Jobs[i].ModuleID = M.getModuleIdentifier();
+    Jobs[i].TM = TMs[i];
+    Jobs[i].Out = Outs[i];
+    Jobs[i].FileType = FileType;
+    Jobs[i].DisableVerify = DisableVerify;
+    Args[i] = &Jobs[i];
+  }
+
+  // The error handler can only be installed before going multithreaded.
+  bool CatchFatalErrors = !llvm_is_multithreaded();
+  if (CatchFatalErrors) {
+    install_fatal_error_handler(partitionErrorHandler);
+    CrashRecoveryContext::Enable();
+    llvm_start_multithreaded();
+  }
+  llvm_execute_on_threads(runPartitionJob, &Args[0], Args.size());
+  if (CatchFatalErrors) {
+    llvm_stop_multithreaded();
+    CrashRecoveryContext::Disable();
+    remove_fatal_error_handler();
+  }
+
+  for (unsigned i = 0, e = Jobs.size(); i != e; ++i)
+    if (!Jobs[i].ErrMsg.empty()) {
+      ErrMsg = Jobs[i].ErrMsg;
+      return true;
+    }
+  return false;
+}
@@ -0,0 +1,471 @@
+//===-- RegAllocLinearScan.cpp - Linear Scan Register Allocator -----------===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+//
+// This file defines the RALinearScan function pass, a register allocator that
+// sits between the fast and the greedy allocators.  It is built on the same
+// LiveIntervals and LiveRegMatrix framework as the greedy allocator, but it
+// visits the live ranges once, in order of their start points, and keeps the
+// decision procedure simple:
+//
+// 1. Assign a free register, trying the hints first.
+// 2. Evict cheaper interference from one register.  Evicted live ranges go
+//    back on the queue, but they may not evict anything themselves, so there
+//    are no eviction cascades.
+// 3. Split a global live range around the blocks that use it.  The local
+//    pieces are queued again and the remainder is spilled.
+// 4. Spill.
+//
+// There is no region splitting, and so no need for the interference cache or
+// the spill placement analysis that make up most of the greedy allocator's
+// compile time.
+//
+//===----------------------------------------------------------------------===//
+
+#define DEBUG_TYPE "regalloc"
+#include "AllocationOrder.h"
+#include "LiveDebugVariables.h"
+#include "LiveRegMatrix.h"
+#include "RegAllocBase.h"
+#include "Spiller.h"
+#include "SplitKit.h"
+#include "VirtRegMap.h"
+#include "llvm/ADT/IndexedMap.h"
+#include "llvm/ADT/Statistic.h"
+#include "llvm/Analysis/AliasAnalysis.h"
+#include "llvm/PassAnalysisSupport.h"
+#include "llvm/CodeGen/CalcSpillWeights.h"
+#include "llvm/CodeGen/LiveIntervalAnalysis.h"
+#include "llvm/CodeGen/LiveRangeEdit.h"
+#include "llvm/CodeGen/LiveStackAnalysis.h"
+#include "llvm/CodeGen/MachineDominators.h"
+#include "llvm/CodeGen/MachineFunctionPass.h"
+#include "llvm/CodeGen/MachineLoopInfo.h"
+#include "llvm/CodeGen/MachineRegisterInfo.h"
+#include "llvm/CodeGen/Passes.h"
+#include "llvm/CodeGen/RegAllocRegistry.h"
+#include "llvm/Target/TargetRegisterInfo.h"
+#include "llvm/Support/Debug.h"
+#include "llvm/Support/raw_ostream.h"
+
+#include <queue>
+
+using namespace llvm;
+
+STATISTIC(NumEvicted,    "Number of interferences evicted");
+STATISTIC(NumBlockSplit, "Number of live ranges split around blocks");
+STATISTIC(NumSpilled,    "Number of live ranges spilled");
+
+static RegisterRegAlloc linearScanRegAlloc("linearscan",
+                                           "linear scan register allocator",
+                                           createLinearScanRegisterAllocator);
+
+namespace {
+class RALinearScan : public MachineFunctionPass,
+                     public RegAllocBase,
+                     private LiveRangeEdit::Delegate {
+  // context
+  MachineFunction *MF;
+
+  // analyses
+  LiveDebugVariables *DebugVars;
+
+  // state
+  std::auto_ptr<Spiller> SpillerInstance;
+  std::auto_ptr<SplitAnalysis> SA;
+  std::auto_ptr<SplitEditor> SE;
+
+  // Live ranges are visited in order of their start points.  The queue holds
+  // (start, reg) pairs so the order is stable while the ranges are edited.
+  // Empty live ranges have an invalid start, and they are visited first.
+  typedef std::pair<SlotIndex, unsigned> QueueEntry;
+  struct StartsLater {
+    bool operator()(const QueueEntry &A, const QueueEntry &B) const {
+      if (A.first.isValid() != B.first.isValid())
+        return A.first.isValid();
+      if (A.first.isValid() && A.first != B.first)
+        return A.first > B.first;
+      return A.second > B.second;
+    }
+  };
+  std::priority_queue<QueueEntry, std::vector<QueueEntry>, StartsLater> Queue;
+
+  // Live range stages.  A live range only moves forward through the stages,
+  // which guarantees that allocation terminates.
+  enum LiveRangeStage {
+    /// Newly created live range that may evict cheaper interference.
+    LS_New,
+
+    /// Live range that was evicted.  It may not evict anything itself.
+    LS_Evicted,
+
+    /// Local live range created by splitting around blocks.  It is not split
+    /// again.
+    LS_Split,
+
+    /// Live range that will be spilled if it can't be assigned.
+    LS_Spill
+  };
+
+  IndexedMap<unsigned char, VirtReg2IndexFunctor> Stage;
+
+  LiveRangeStage getStage(const LiveInterval &VirtReg) const {
+    return LiveRangeStage(Stage[VirtReg.reg]);
+  }
+
+  void setStage(const LiveInterval &VirtReg, LiveRangeStage NewStage) {
+    Stage.grow(VirtReg.reg);
+    Stage[VirtReg.reg] = NewStage;
+  }
+
+public:
+  RALinearScan();
+
+  /// Return the pass name.
+  virtual const char* getPassName() const {
+    return "Linear Scan Register Allocator";
+  }
+
+  /// RALinearScan analysis usage.
+  virtual void getAnalysisUsage(AnalysisUsage &AU) const;
+  virtual void releaseMemory();
+  virtual Spiller &spiller() { return *SpillerInstance; }
+  virtual void enqueue(LiveInterval *LI);
+  virtual LiveInterval *dequeue();
+  virtual unsigned selectOrSplit(LiveInterval&,
+                                 SmallVectorImpl<LiveInterval*>&);
+
+  /// Perform register allocation.
+  virtual bool runOnMachineFunction(MachineFunction &mf);
+
+  static char ID;
+
+private:
+  bool LRE_CanEraseVirtReg(unsigned);
+  void LRE_WillShrinkVirtReg(unsigned);
+  void LRE_DidCloneVirtReg(unsigned, unsigned);
+
+  bool canEvictInterference(LiveInterval&, unsigned, float &MaxWeight);
+  void evictInterference(LiveInterval&, unsigned,
+                         SmallVectorImpl<LiveInterval*>&);
+  unsigned tryEvict(LiveInterval&, ArrayRef<unsigned>,
+                    SmallVectorImpl<LiveInterval*>&);
+  bool tryBlockSplit(LiveInterval&, SmallVectorImpl<LiveInterval*>&);
+};
+
+char RALinearScan::ID = 0;
+
+} // end anonymous namespace
+
+FunctionPass* llvm::createLinearScanRegisterAllocator() {
+  return new RALinearScan();
+}
+
+RALinearScan::RALinearScan(): MachineFunctionPass(ID) {
+  initializeLiveDebugVariablesPass(*PassRegistry::getPassRegistry());
+  initializeLiveIntervalsPass(*PassRegistry::getPassRegistry());
+  initializeSlotIndexesPass(*PassRegistry::getPassRegistry());
+  initializeRegisterCoalescerPass(*PassRegistry::getPassRegistry());
+  initializeMachineSchedulerPass(*PassRegistry::getPassRegistry());
+  initializeCalculateSpillWeightsPass(*PassRegistry::getPassRegistry());
+  initializeLiveStacksPass(*PassRegistry::getPassRegistry());
+  initializeMachineDominatorTreePass(*PassRegistry::getPassRegistry());
+  initializeMachineLoopInfoPass(*PassRegistry::getPassRegistry());
+  initializeVirtRegMapPass(*PassRegistry::getPassRegistry());
+  initializeLiveRegMatrixPass(*PassRegistry::getPassRegistry());
+}
+
+void RALinearScan::getAnalysisUsage(AnalysisUsage &AU) const {
+  AU.setPreservesCFG();
+  AU.addRequired<AliasAnalysis>();
+  AU.addPreserved<AliasAnalysis>();
+  AU.addRequired<LiveIntervals>();
+  AU.addPreserved<LiveIntervals>();
+  AU.addRequired<SlotIndexes>();
+  AU.addPreserved<SlotIndexes>();
+  AU.addRequired<LiveDebugVariables>();
+  AU.addPreserved<LiveDebugVariables>();
+  AU.addRequired<CalculateSpillWeights>();
+  AU.addRequired<LiveStacks>();
+  AU.addPreserved<LiveStacks>();
+  AU.addRequired<MachineDominatorTree>();
+  AU.addPreserved<MachineDominatorTree>();
+  AU.addRequired<MachineLoopInfo>();
+  AU.addPreserved<MachineLoopInfo>();
+  AU.addRequired<VirtRegMap>();
+  AU.addPreserved<VirtRegMap>();
+  AU.addRequired<LiveRegMatrix>();
+  AU.addPreserved<LiveRegMatrix>();
+  MachineFunctionPass::getAnalysisUsage(AU);
+}
+
+void RALinearScan::releaseMemory() {
+  SpillerInstance.reset(0);
+  Stage.clear();
+}
+
+
+//===----------------------------------------------------------------------===//
+//                     LiveRangeEdit delegate methods
+//===----------------------------------------------------------------------===//
+
+bool RALinearScan::LRE_CanEraseVirtReg(unsigned VirtReg) {
+  if (VRM->hasPhys(VirtReg)) {
+    Matrix->unassign(LIS->getInterval(VirtReg));
+    return true;
+  }
+  // Unassigned virtreg is probably in the priority queue.
+  // RegAllocBase will erase it after dequeueing.
+  return false;
+}
+
+void RALinearScan::LRE_WillShrinkVirtReg(unsigned VirtReg) {
+  if (!VRM->hasPhys(VirtReg))
+    return;
+
+  // Register is assigned, put it back on the queue for reassignment.
+  LiveInterval &LI = LIS->getInterval(VirtReg);
+  Matrix->unassign(LI);
+  enqueue(&LI);
+}
+
+void RALinearScan::LRE_DidCloneVirtReg(unsigned New, unsigned Old) {
+  // Cloning a register we haven't even heard about yet?  Just ignore it.
+  if (!Stage.inBounds(Old))
+    return;
+
+  // The clone is a connected component of the original live range, and it
+  // continues from the same stage.
+  Stage.grow(New);
+  Stage[New] = Stage[Old];
+}
+
+
+//===----------------------------------------------------------------------===//
+//                               Queue
+//===----------------------------------------------------------------------===//
+
+void RALinearScan::enqueue(LiveInterval *LI) {
+  assert(TargetRegisterInfo::isVirtualRegister(LI->reg) &&
+         "Can only enqueue virtual registers");
+  Stage.grow(LI->reg);
+  // Empty live ranges are dropped by RegAllocBase when they are dequeued.
+  SlotIndex Start = LI->empty() ? SlotIndex() : LI->beginIndex();
+  Queue.push(std::make_pair(Start, LI->reg));
+}
+
+LiveInterval *RALinearScan::dequeue() {
+  if (Queue.empty())
+    return 0;
+  LiveInterval *LI = &LIS->getInterval(Queue.top().second);
+  Queue.pop();
+  return LI;
+}
+
+
+//===----------------------------------------------------------------------===//
+//                              Eviction
+//===----------------------------------------------------------------------===//
+
+/// canEvictInterference - Return true if all interferences between VirtReg
+/// and PhysReg can be evicted, and set MaxWeight to the largest spill weight
+/// among them.  Only live ranges with a smaller spill weight than VirtReg can
+/// be evicted.
+bool RALinearScan::canEvictInterference(LiveInterval &VirtReg,
+                                        unsigned PhysReg, float &MaxWeight) {
+  MaxWeight = 0;
+  for (MCRegUnitIterator Units(PhysReg, TRI); Units.isValid(); ++Units) {
+    LiveIntervalUnion::Query &Q = Matrix->query(VirtReg, *Units);
+    // If there are too many interferences, eviction is not worth it.
+    if (Q.collectInterferingVRegs(10) >= 10)
+      return false;
+    if (Q.seenUnspillableVReg())
+      return false;
+    for (unsigned i = Q.interferingVRegs().size(); i; --i) {
+      LiveInterval *Intf = Q.interferingVRegs()[i - 1];
+      if (!Intf->isSpillable() || Intf->weight >= VirtReg.weight)
+        return false;
+      MaxWeight = std::max(MaxWeight, Intf->weight);
+    }
+  }
+  return true;
+}
+
+/// evictInterference - Evict all live ranges interfering with VirtReg in
+/// PhysReg, and queue them for another round.
+void RALinearScan::evictInterference(LiveInterval &VirtReg, unsigned PhysReg,
+                                     SmallVectorImpl<LiveInterval*> &NewVRegs) {
+  // Collect all interfering virtregs first.
+  SmallVector<LiveInterval*, 8> Intfs;
+  for (MCRegUnitIterator Units(PhysReg, TRI); Units.isValid(); ++Units) {
+    LiveIntervalUnion::Query &Q = Matrix->query(VirtReg, *Units);
+    assert(Q.seenAllInterferences() && "Didn't check all interfererences.");
+    ArrayRef<LiveInterval*> IVR = Q.interferingVRegs();
+    Intfs.append(IVR.begin(), IVR.end());
+  }
+
+  for (unsigned i = 0, e = Intfs.size(); i != e; ++i) {
+    LiveInterval *Intf = Intfs[i];
+    // The same VirtReg may be present in multiple RegUnits. Skip duplicates.
+    if (!VRM->hasPhys(Intf->reg))
+      continue;
+    DEBUG(dbgs() << "evicting " << PrintReg(Intf->reg) << '\n');
+    Matrix->unassign(*Intf);
+    // An evicted live range never evicts anything itself.
+    if (getStage(*Intf) == LS_New)
+      setStage(*Intf, LS_Evicted);
+    NewVRegs.push_back(Intf);
+    ++NumEvicted;
+  }
+}
+
+/// tryEvict - Pick the candidate register whose interference is cheapest to
+/// evict, and evict it.  Return the register, or 0.
+unsigned RALinearScan::tryEvict(LiveInterval &VirtReg,
+                                ArrayRef<unsigned> Candidates,
+                                SmallVectorImpl<LiveInterval*> &NewVRegs) {
+  unsigned BestPhys = 0;
+  float BestWeight = 0;
+  for (unsigned i = 0, e = Candidates.size(); i != e; ++i) {
+    float MaxWeight;
+    if (!canEvictInterference(VirtReg, Candidates[i], MaxWeight))
+      continue;
+    if (!BestPhys || MaxWeight < BestWeight) {
+      BestPhys = Candidates[i];
+      BestWeight = MaxWeight;
+    }
+  }
+  if (BestPhys)
+    evictInterference(VirtReg, BestPhys, NewVRegs);
+  return BestPhys;
+}
+
+
+//===----------------------------------------------------------------------===//
+//                            Block Splitting
+//===----------------------------------------------------------------------===//
+
+/// tryBlockSplit - Split a global live range around every block with uses.
+/// The new local live ranges are queued for assignment, and the remainder is
+/// spilled.  Return true if the live range was split.
+bool RALinearScan::tryBlockSplit(LiveInterval &VirtReg,
+                                 SmallVectorImpl<LiveInterval*> &NewVRegs) {
+  if (LIS->intervalIsInOneMBB(VirtReg))
+    return false;
+
+  SA->analyze(&VirtReg);
+  unsigned Reg = VirtReg.reg;
+  bool SingleInstrs = RegClassInfo.isProperSubClass(MRI->getRegClass(Reg));
+  LiveRangeEdit LREdit(&VirtReg, NewVRegs, *MF, *LIS, VRM, this);
+  SE->reset(LREdit, SplitEditor::SM_Size);
+  ArrayRef<SplitAnalysis::BlockInfo> UseBlocks = SA->getUseBlocks();
+  for (unsigned i = 0; i != UseBlocks.size(); ++i) {
+    const SplitAnalysis::BlockInfo &BI = UseBlocks[i];
+    if (SA->shouldSplitSingleBlock(BI, SingleInstrs))
+      SE->splitSingleBlock(BI);
+  }
+  // No blocks were split.
+  if (LREdit.empty())
+    return false;
+
+  SmallVector<unsigned, 8> IntvMap;
+  SE->finish(&IntvMap);
+  ++NumBlockSplit;
+
+  // Tell LiveDebugVariables about the new ranges.
+  DebugVars->splitRegister(Reg, LREdit.regs());
+
+  // The local ranges are not split again, and the remainder goes straight to
+  // spilling.
+  for (unsigned i = 0, e = LREdit.size(); i != e; ++i) {
+    LiveInterval &LI = *LREdit.get(i);
+    setStage(LI, IntvMap[i] == 0 ? LS_Spill : LS_Split);
+  }
+
+  if (VerifyEnabled)
+    MF->verify(this, "After splitting live range around basic blocks");
+  return true;
+}
+
+
+//===----------------------------------------------------------------------===//
+//                            Main Entry Point
+//===----------------------------------------------------------------------===//
+
+unsigned RALinearScan::selectOrSplit(LiveInterval &VirtReg,
+                                     SmallVectorImpl<LiveInterval*> &NewVRegs) {
+  // Take the first free register.  The allocation order yields the hints
+  // first.
+  SmallVector<unsigned, 8> EvictCands;
+  AllocationOrder Order(VirtReg.reg, *VRM, RegClassInfo);
+  while (unsigned PhysReg = Order.next()) {
+    switch (Matrix->checkInterference(VirtReg, PhysReg)) {
+    case LiveRegMatrix::IK_Free:
+      return PhysReg;
+    case LiveRegMatrix::IK_VirtReg:
+      // Only virtual registers in the way, we may be able to evict them.
+      EvictCands.push_back(PhysReg);
+      continue;
+    default:
+      // RegMask or RegUnit interference.
+      continue;
+    }
+  }
+
+  LiveRangeStage CurStage = getStage(VirtReg);
+
+  // Evict cheaper interference.  Unspillable live ranges are always allowed
+  // to evict, there is nothing else they can do.
+  if (CurStage == LS_New || !VirtReg.isSpillable())
+    if (unsigned PhysReg = tryEvict(VirtReg, EvictCands, NewVRegs))
+      return PhysReg;
+
+  // Split global live ranges around their uses.
+  if (CurStage < LS_Split && tryBlockSplit(VirtReg, NewVRegs))
+    return 0;
+
+  // Finally spill VirtReg itself.
+  DEBUG(dbgs() << "spilling: " << VirtReg << '\n');
+  if (!VirtReg.isSpillable())
+    return ~0u;
+  LiveRangeEdit LRE(&VirtReg, NewVRegs, *MF, *LIS, VRM, this);
+  spiller().spill(LRE);
+  ++NumSpilled;
+
+  // The live virtual register requesting allocation was spilled, so tell
+  // the caller not to allocate anything during this round.
+  return 0;
+}
+
+bool RALinearScan::runOnMachineFunction(MachineFunction &mf) {
+  DEBUG(dbgs() << "********** LINEAR SCAN REGISTER ALLOCATION **********\n"
+               << "********** Function: " << mf.getName() << '\n');
+
+  MF = &mf;
+  if (VerifyEnabled)
+    MF->verify(this, "Before linear scan register allocator");
+
+  RegAllocBase::init(getAnalysis<VirtRegMap>(),
+                     getAnalysis<LiveIntervals>(),
+                     getAnalysis<LiveRegMatrix>());
+  DebugVars = &getAnalysis<LiveDebugVariables>();
+  SpillerInstance.reset(createInlineSpiller(*this, *MF, *VRM));
+  SA.reset(new SplitAnalysis(*VRM, *LIS, getAnalysis<MachineLoopInfo>()));
+  SE.reset(new SplitEditor(*SA, *LIS, *VRM,
+                           getAnalysis<MachineDominatorTree>()));
+  Stage.clear();
+  Stage.resize(MRI->getNumVirtRegs());
+
+  allocatePhysRegs();
+
+  // Diagnostic output before rewriting
+  DEBUG(dbgs() << "Post alloc VirtRegMap:\n" << *VRM << "\n");
+
+  releaseMemory();
+  return true;
+}
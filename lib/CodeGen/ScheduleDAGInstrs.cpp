@@ -462,9 +462,9 @@ void ScheduleDAGInstrs::addVRegUseDeps(SUnit *SU, unsigned OperIdx) {
   LiveRangeQuery LRQ(LIS->getInterval(Reg), LIS->getInstructionIndex(MI));
   VNInfo *VNI = LRQ.valueIn();
 
-  // VNI will be valid because MachineOperand::readsReg() is checked by caller.
-  assert(VNI && "No value to read by operand");
-  MachineInstr *Def = LIS->getInstructionFromIndex(VNI->def);
+  // VNI may be null when the use reads an undefined value, e.g. a subregister
+  // that is only partially defined.  There is no data dependence then.
+  MachineInstr *Def = VNI ? LIS->getInstructionFromIndex(VNI->def) : 0;
   // Phis and other noninstructions (after coalescing) have a NULL Def.
   if (Def) {
     SUnit *DefSU = getSUnit(Def);
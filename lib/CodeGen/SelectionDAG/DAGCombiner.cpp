@@ -27,12 +27,17 @@
 #include "llvm/Target/TargetLowering.h"
 #include "llvm/Target/TargetMachine.h"
 #include "llvm/Target/TargetOptions.h"
+#include "llvm/ADT/DenseMap.h"
 #include "llvm/ADT/SmallPtrSet.h"
 #include "llvm/ADT/Statistic.h"
 #include "llvm/Support/CommandLine.h"
 #include "llvm/Support/Debug.h"
 #include "llvm/Support/ErrorHandling.h"
+#include "llvm/Support/Format.h"
+#include "llvm/Support/ManagedStatic.h"
 #include "llvm/Support/MathExtras.h"
+#include "llvm/Support/Mutex.h"
+#include "llvm/Support/Timer.h"
 #include "llvm/Support/raw_ostream.h"
 #include <algorithm>
 using namespace llvm;
@@ -42,6 +47,10 @@ STATISTIC(PreIndexedNodes , "Number of pre-indexed nodes created");
 STATISTIC(PostIndexedNodes, "Number of post-indexed nodes created");
 STATISTIC(OpsNarrowed     , "Number of load/op/store narrowed");
 STATISTIC(LdStFP2Int      , "Number of fp load/store pairs transformed to int");
+STATISTIC(BudgetExhausted , "Number of DAG combines stopped by the budget");
+
+// CreateInfoOutputFile - Return a file stream to print our output on.
+namespace llvm { extern raw_ostream *CreateInfoOutputFile(); }
 
 namespace {
   static cl::opt<bool>
@@ -52,6 +61,92 @@ namespace {
     CombinerGlobalAA("combiner-global-alias-analysis", cl::Hidden,
                cl::desc("Include global information in alias analysis"));
 
+  // Compile-time budget.  Blocks with many address computations can keep the
+  // combiner revisiting nodes for a long time; past the budget the remaining
+  // worklist is dropped and the DAG is left as it is.
+  static cl::opt<unsigned>
+    CombinerMaxVisits("combiner-max-visits", cl::Hidden,
+               cl::desc("Maximum number of nodes visited per DAG combine "
+                        "(0 = unlimited)"),
+               cl::init(0));
+
+  static cl::opt<bool>
+    CombinerRuleStats("combiner-rule-stats", cl::Hidden,
+               cl::desc("Print the visits, combines and time of each DAG "
+                        "combine rule at exit"));
+
+//------------------------ Combine rule statistics ---------------------------//
+
+  /// CombineRule - What -combiner-rule-stats records for each opcode.  The
+  /// rule for an opcode is its visit routine together with the target's
+  /// PerformDAGCombine hook and integer promotion.
+  struct CombineRule {
+    std::string Name;
+    unsigned Visits;
+    unsigned Hits;
+    double Time;
+
+    CombineRule() : Visits(0), Hits(0), Time(0) {}
+
+    bool operator<(const CombineRule &RHS) const {
+      if (Time != RHS.Time)
+        return Time > RHS.Time;
+      return Name < RHS.Name;
+    }
+  };
+
+  typedef DenseMap<unsigned, CombineRule> CombineRuleMap;
+
+  /// CombineRuleInfo - The rules of all DAG combines so far.  This is used in
+  /// a ManagedStatic and printed from its destructor, like -stats.
+  class CombineRuleInfo {
+    sys::SmartMutex<true> Lock;
+    CombineRuleMap Rules;
+  public:
+    ~CombineRuleInfo();
+    void merge(const CombineRuleMap &Run);
+  };
+}
+
+static ManagedStatic<CombineRuleInfo> CombineRules;
+
+void CombineRuleInfo::merge(const CombineRuleMap &Run) {
+  sys::SmartScopedLock<true> Guard(Lock);
+  for (CombineRuleMap::const_iterator I = Run.begin(), E = Run.end();
+       I != E; ++I) {
+    CombineRule &R = Rules[I->first];
+    R.Name = I->second.Name;
+    R.Visits += I->second.Visits;
+    R.Hits += I->second.Hits;
+    R.Time += I->second.Time;
+  }
+}
+
+CombineRuleInfo::~CombineRuleInfo() {
+  if (Rules.empty())
+    return;
+
+  std::vector<CombineRule> Sorted;
+  for (CombineRuleMap::const_iterator I = Rules.begin(), E = Rules.end();
+       I != E; ++I)
+    Sorted.push_back(I->second);
+  std::sort(Sorted.begin(), Sorted.end());
+
+  raw_ostream &OS = *CreateInfoOutputFile();
+  OS << "===" << std::string(73, '-') << "===\n"
+     << "                      ... DAG Combine Rule Statistics ...\n"
+     << "===" << std::string(73, '-') << "===\n\n"
+     << "    Time (s)     Visits       Hits  Rule\n";
+  for (unsigned i = 0, e = Sorted.size(); i != e; ++i)
+    OS << format("  %10.6f %10u %10u  ", Sorted[i].Time, Sorted[i].Visits,
+                 Sorted[i].Hits)
+       << Sorted[i].Name << '\n';
+  OS << '\n';
+  delete &OS;
+}
+
+namespace {
+
 //------------------------------ DAGCombiner ---------------------------------//
 
   class DAGCombiner {
@@ -69,17 +164,12 @@ namespace {
     // also only appear once. The naive approach to this takes
     // linear time.
     //
-    // To reduce the insert/remove time to logarithmic, we use
-    // a set and a vector to maintain our worklist.
-    //
-    // The set contains the items on the worklist, but does not
-    // maintain the order they should be visited.
-    //
-    // The vector maintains the order nodes should be visited, but may
-    // contain duplicate or removed nodes. When choosing a node to
-    // visit, we pop off the order stack until we find an item that is
-    // also in the contents set. All operations are O(log N).
-    SmallPtrSet<SDNode*, 64> WorkListContents;
+    // The vector maintains the order nodes should be visited, and the
+    // map holds the index of each node on the worklist in the vector.
+    // Adding a node that is already on the worklist or removing one
+    // clears its old slot, and empty slots are skipped when choosing
+    // the next node to visit.  All operations are O(1).
+    DenseMap<SDNode*, unsigned> WorkListMap;
     SmallVector<SDNode*, 64> WorkListOrder;
 
     // AA - Used for DAG load/store alias analysis.
@@ -103,14 +193,25 @@ namespace {
     /// AddToWorkList - Add to the work list making sure its instance is at the
     /// back (next to be processed.)
     void AddToWorkList(SDNode *N) {
-      WorkListContents.insert(N);
+      std::pair<DenseMap<SDNode*, unsigned>::iterator, bool> Ins =
+        WorkListMap.insert(std::make_pair(N, WorkListOrder.size()));
+      if (!Ins.second) {
+        if (Ins.first->second + 1 == WorkListOrder.size())
+          return;
+        WorkListOrder[Ins.first->second] = 0;
+        Ins.first->second = WorkListOrder.size();
+      }
       WorkListOrder.push_back(N);
     }
 
-    /// removeFromWorkList - remove all instances of N from the worklist.
+    /// removeFromWorkList - remove N from the worklist.
     ///
     void removeFromWorkList(SDNode *N) {
-      WorkListContents.erase(N);
+      DenseMap<SDNode*, unsigned>::iterator I = WorkListMap.find(N);
+      if (I == WorkListMap.end())
+        return;
+      WorkListOrder[I->second] = 0;
+      WorkListMap.erase(I);
     }
 
     SDValue CombineTo(SDNode *N, const SDValue *To, unsigned NumTo,
@@ -1001,17 +1102,18 @@ void DAGCombiner::Run(CombineLevel AtLevel) {
   // done.  Set it to null to avoid confusion.
   DAG.setRoot(SDValue());
 
+  unsigned NumVisits = 0;
+  CombineRuleMap Rules;
+
   // while the worklist isn't empty, find a node and
   // try and combine it.
-  while (!WorkListContents.empty()) {
+  while (!WorkListMap.empty()) {
+    // Slots of nodes that were removed or re-added are cleared; skip them.
     SDNode *N;
-    // The WorkListOrder holds the SDNodes in order, but it may contain duplicates.
-    // In order to avoid a linear scan, we use a set (O(log N)) to hold what the
-    // worklist *should* contain, and check the node we want to visit is should
-    // actually be visited.
     do {
       N = WorkListOrder.pop_back_val();
-    } while (!WorkListContents.erase(N));
+    } while (!N);
+    WorkListMap.erase(N);
 
     // If N has no uses, it is dead.  Make sure to revisit all N's operands once
     // N is deleted from the DAG, since they too may now be dead or may have a
@@ -1024,7 +1126,30 @@ void DAGCombiner::Run(CombineLevel AtLevel) {
       continue;
     }
 
-    SDValue RV = combine(N);
+    if (CombinerMaxVisits && ++NumVisits > CombinerMaxVisits) {
+      ++BudgetExhausted;
+      DEBUG(dbgs() << "\nCombine budget exhausted, " << WorkListMap.size()
+                   << " nodes left on the worklist\n");
+      WorkListMap.clear();
+      WorkListOrder.clear();
+      break;
+    }
+
+    SDValue RV;
+    if (CombinerRuleStats) {
+      // N may be deleted by the combine, so look its rule up first.
+      CombineRule &R = Rules[N->getOpcode()];
+      if (R.Name.empty())
+        R.Name = N->getOperationName(&DAG);
+      double Start = TimeRecord::getCurrentTime(true).getWallTime();
+      RV = combine(N);
+      R.Time += TimeRecord::getCurrentTime(false).getWallTime() - Start;
+      ++R.Visits;
+      if (RV.getNode())
+        ++R.Hits;
+    } else {
+      RV = combine(N);
+    }
 
     if (RV.getNode() == 0)
       continue;
@@ -1083,6 +1208,9 @@ void DAGCombiner::Run(CombineLevel AtLevel) {
     }
   }
 
+  if (!Rules.empty())
+    CombineRules->merge(Rules);
+
   // If the root changed (e.g. it was a dead load, update the root).
   DAG.setRoot(Dummy.getValue());
   DAG.RemoveDeadNodes();
@@ -53,6 +53,7 @@
 #include "llvm/CodeGen/MachineModuleInfo.h"
 #include "llvm/CodeGen/MachineRegisterInfo.h"
 #include "llvm/Analysis/Loads.h"
+#include "llvm/MC/MCContext.h"
 #include "llvm/Target/TargetData.h"
 #include "llvm/Target/TargetInstrInfo.h"
 #include "llvm/Target/TargetLibraryInfo.h"
@@ -241,6 +242,34 @@ unsigned FastISel::lookUpRegForValue(const Value *V) {
   return LocalValueMap[V];
 }
 
+bool FastISel::canFoldAcrossBlocks(const Instruction *I) const {
+  if (!SelectingFunction)
+    return false;
+  for (User::const_op_iterator OI = I->op_begin(), OE = I->op_end();
+       OI != OE; ++OI) {
+    const Value *Op = *OI;
+    if (isa<Constant>(Op))
+      continue;
+    if (const AllocaInst *AI = dyn_cast<AllocaInst>(Op))
+      if (FuncInfo.StaticAllocaMap.count(AI))
+        continue;
+    // A value with a register in ValueMap is live across blocks, and
+    // whichever selector handles its block defines the register.
+    if (!FuncInfo.ValueMap.count(Op))
+      return false;
+    // Values only used in their own block may be killed there.
+    if (const Instruction *OpI = dyn_cast<Instruction>(Op)) {
+      bool LiveOut = false;
+      for (Value::const_use_iterator UI = OpI->use_begin(),
+           UE = OpI->use_end(); UI != UE && !LiveOut; ++UI)
+        LiveOut = cast<Instruction>(*UI)->getParent() != OpI->getParent();
+      if (!LiveOut)
+        return false;
+    }
+  }
+  return true;
+}
+
 /// UpdateValueMap - Update the value map to include the new mapping for this
 /// instruction, or insert an extra copy to get the result in a previous
 /// determined register.
@@ -782,6 +811,7 @@ bool
 FastISel::SelectInstruction(const Instruction *I) {
   // Just before the terminator instruction, insert instructions to
   // feed PHI nodes in successor blocks.
+  unsigned OrigNumPHINodesToUpdate = FuncInfo.PHINodesToUpdate.size();
   if (isa<TerminatorInst>(I))
     if (!HandlePHINodesInSuccessorBlocks(I->getParent()))
       return false;
@@ -827,6 +857,9 @@ FastISel::SelectInstruction(const Instruction *I) {
   if (SavedInsertPt != FuncInfo.InsertPt)
     removeDeadCode(FuncInfo.InsertPt, SavedInsertPt);
 
+  // SelectionDAG adds its own PHI operands for the terminator.
+  FuncInfo.PHINodesToUpdate.resize(OrigNumPHINodesToUpdate);
+
   DL = DebugLoc();
   return false;
 }
@@ -849,6 +882,28 @@ FastISel::FastEmitBranch(MachineBasicBlock *MSucc, DebugLoc DL) {
   FuncInfo.MBB->addSuccessor(MSucc);
 }
 
+/// FastEmitTryRange - Bracket the instructions emitted after Prev with EH
+/// labels and record the range with MachineModuleInfo, as
+/// SelectionDAGBuilder's EmitTryRangeStart and EmitTryRangeEnd do.  The
+/// begin label is placed once the call has been emitted, so that nothing is
+/// left behind if the target fails to select it.
+void
+FastISel::FastEmitTryRange(MachineInstr *Prev, MachineBasicBlock *LandingPad) {
+  MachineModuleInfo &MMI = FuncInfo.MF->getMMI();
+  const MCInstrDesc &II = TII.get(TargetOpcode::EH_LABEL);
+
+  MachineBasicBlock::iterator Begin = FuncInfo.MBB->begin();
+  if (Prev)
+    Begin = llvm::next(MachineBasicBlock::iterator(Prev));
+  MCSymbol *BeginLabel = MMI.getContext().CreateTempSymbol();
+  BuildMI(*FuncInfo.MBB, Begin, DL, II).addSym(BeginLabel);
+
+  MCSymbol *EndLabel = MMI.getContext().CreateTempSymbol();
+  BuildMI(*FuncInfo.MBB, FuncInfo.InsertPt, DL, II).addSym(EndLabel);
+
+  MMI.addInvoke(LandingPad, BeginLabel, EndLabel);
+}
+
 /// SelectFNeg - Emit an FNeg operation.
 ///
 bool
@@ -936,6 +991,59 @@ FastISel::SelectExtractValue(const User *U) {
   return true;
 }
 
+/// SelectLandingPad - Record the landing pad with MachineModuleInfo and copy
+/// the exception pointer and selector out of their physical registers.  The
+/// EH_LABEL and live-ins of the block are set up by PrepareEHLandingPad.
+bool
+FastISel::SelectLandingPad(const User *U) {
+  const LandingPadInst *LP = cast<LandingPadInst>(U);
+  MachineBasicBlock *MBB = FuncInfo.MBB;
+  if (!MBB->isLandingPad())
+    return false;
+
+  unsigned PtrReg = TLI.getExceptionPointerRegister();
+  unsigned SelReg = TLI.getExceptionSelectorRegister();
+  if (PtrReg == 0 && SelReg == 0) {
+    // SjLj exceptions don't pass anything in registers.
+    AddLandingPadInfo(*LP, FuncInfo.MF->getMMI(), MBB);
+    return true;
+  }
+  if (PtrReg == 0 || SelReg == 0)
+    return false;
+
+  // Only the usual { i8*, i32 } result is handled.
+  SmallVector<EVT, 2> ValueVTs;
+  ComputeValueVTs(TLI, LP->getType(), ValueVTs);
+  if (ValueVTs.size() != 2 || ValueVTs[0] != TLI.getPointerTy() ||
+      ValueVTs[1] != MVT::i32)
+    return false;
+
+  // The selector arrives in a pointer-sized register; read its 32-bit
+  // subregister.
+  const TargetRegisterClass *SelRC = TLI.getRegClassFor(MVT::i32);
+  unsigned SelReg32 = 0;
+  if (SelRC->contains(SelReg))
+    SelReg32 = SelReg;
+  else
+    for (MCSubRegIterator SR(SelReg, &TRI); SR.isValid(); ++SR)
+      if (SelRC->contains(*SR)) {
+        SelReg32 = *SR;
+        break;
+      }
+  if (SelReg32 == 0)
+    return false;
+
+  AddLandingPadInfo(*LP, FuncInfo.MF->getMMI(), MBB);
+
+  unsigned ResultReg = FuncInfo.CreateRegs(LP->getType());
+  BuildMI(*MBB, FuncInfo.InsertPt, DL, TII.get(TargetOpcode::COPY), ResultReg)
+    .addReg(PtrReg);
+  BuildMI(*MBB, FuncInfo.InsertPt, DL, TII.get(TargetOpcode::COPY),
+          ResultReg + 1).addReg(SelReg32);
+  UpdateValueMap(LP, ResultReg, 2);
+  return true;
+}
+
 bool
 FastISel::SelectOperator(const User *I, unsigned Opcode) {
   switch (Opcode) {
@@ -1043,6 +1151,9 @@ FastISel::SelectOperator(const User *I, unsigned Opcode) {
   case Instruction::ExtractValue:
     return SelectExtractValue(I);
 
+  case Instruction::LandingPad:
+    return SelectLandingPad(I);
+
   case Instruction::PHI:
     llvm_unreachable("FastISel shouldn't visit PHI nodes!");
 
@@ -1063,7 +1174,8 @@ FastISel::FastISel(FunctionLoweringInfo &funcInfo,
     TII(*TM.getInstrInfo()),
     TLI(*TM.getTargetLowering()),
     TRI(*TM.getRegisterInfo()),
-    LibInfo(libInfo) {
+    LibInfo(libInfo),
+    SelectingFunction(false) {
 }
 
 FastISel::~FastISel() {}
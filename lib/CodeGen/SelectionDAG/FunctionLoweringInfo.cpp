@@ -57,7 +57,7 @@ static bool isUsedOutsideOfDefiningBlock(const Instruction *I) {
 }
 
 FunctionLoweringInfo::FunctionLoweringInfo(const TargetLowering &tli)
-  : TLI(tli) {
+  : TLI(tli), UsesFastISel(false) {
 }
 
 void FunctionLoweringInfo::set(const Function &fn, MachineFunction &mf) {
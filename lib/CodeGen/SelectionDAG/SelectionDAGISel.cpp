@@ -54,6 +54,7 @@
 #include "llvm/ADT/PostOrderIterator.h"
 #include "llvm/ADT/Statistic.h"
 #include <algorithm>
+#include <map>
 using namespace llvm;
 
 STATISTIC(NumFastIselFailures, "Number of instructions fast isel failed on");
@@ -61,6 +62,10 @@ STATISTIC(NumFastIselSuccess, "Number of instructions fast isel selected");
 STATISTIC(NumFastIselBlocks, "Number of blocks selected entirely by fast isel");
 STATISTIC(NumDAGBlocks, "Number of blocks selected using DAG");
 STATISTIC(NumDAGIselRetries,"Number of times dag isel has to try another path");
+STATISTIC(NumGlobalISelFunctions,
+          "Number of functions selected whole by fast isel");
+STATISTIC(NumGlobalISelRejected,
+          "Number of functions global isel left to the DAG");
 
 #ifndef NDEBUG
 static cl::opt<bool>
@@ -143,6 +148,15 @@ EnableFastISelVerbose("fast-isel-verbose", cl::Hidden,
 static cl::opt<bool>
 EnableFastISelAbort("fast-isel-abort", cl::Hidden,
           cl::desc("Enable abort calls when \"fast\" instruction fails"));
+static cl::opt<bool>
+EnableGlobalISel("global-isel", cl::Hidden,
+          cl::desc("Select whole functions with the \"fast\" instruction "
+                   "selector at every optimization level when the target "
+                   "supports all of their instructions (experimental)"));
+static cl::opt<bool>
+ReportFastISelFallbacks("fast-isel-report-fallbacks", cl::Hidden,
+          cl::desc("Report, per function and opcode, the instructions the "
+                   "\"fast\" instruction selector left to SelectionDAG"));
 
 static cl::opt<bool>
 UseMBPI("use-mbpi",
@@ -980,6 +994,25 @@ void SelectionDAGISel::SelectAllBasicBlocks(const Function &Fn) {
   FastISel *FastIS = 0;
   if (TM.Options.EnableFastISel)
     FastIS = TLI.createFastISel(*FuncInfo, LibInfo);
+  else if (EnableGlobalISel) {
+    // Select the function as a whole if the target expects to handle all of
+    // it.  Otherwise the whole function is left to SelectionDAG.
+    FastIS = TLI.createFastISel(*FuncInfo, LibInfo);
+    if (FastIS && FastIS->canSelectFunction(Fn)) {
+      FastIS->setSelectingFunction(true);
+      ++NumGlobalISelFunctions;
+    } else {
+      delete FastIS;
+      FastIS = 0;
+      ++NumGlobalISelRejected;
+    }
+  }
+  FuncInfo->UsesFastISel = FastIS != 0;
+
+  // For -fast-isel-report-fallbacks: the opcode of each instruction FastISel
+  // missed, with the number of misses and of instructions they sent to
+  // SelectionDAG.
+  std::map<unsigned, std::pair<unsigned, unsigned> > Fallbacks;
 
   // Iterate over all basic blocks in the function.
   ReversePostOrderTraversal<const Function*> RPOT(&Fn);
@@ -1112,6 +1145,11 @@ void SelectionDAGISel::SelectAllBasicBlocks(const Function &Fn) {
           // selection may have handled the call, input args, etc.
           unsigned RemainingNow = std::distance(Begin, BI);
           NumFastIselFailures += NumFastIselRemaining - RemainingNow;
+          if (ReportFastISelFallbacks) {
+            std::pair<unsigned, unsigned> &F = Fallbacks[Inst->getOpcode()];
+            ++F.first;
+            F.second += NumFastIselRemaining - RemainingNow;
+          }
 
           // If the call was emitted as a tail call, we're done with the block.
           if (HadTailCall) {
@@ -1123,6 +1161,12 @@ void SelectionDAGISel::SelectAllBasicBlocks(const Function &Fn) {
           continue;
         }
 
+        if (ReportFastISelFallbacks) {
+          std::pair<unsigned, unsigned> &F = Fallbacks[Inst->getOpcode()];
+          ++F.first;
+          F.second += NumFastIselRemaining;
+        }
+
         if (isa<TerminatorInst>(Inst) && !isa<BranchInst>(Inst)) {
           // Don't abort, and use a different message for terminator misses.
           NumFastIselFailures += NumFastIselRemaining;
@@ -1164,6 +1208,15 @@ void SelectionDAGISel::SelectAllBasicBlocks(const Function &Fn) {
     FuncInfo->PHINodesToUpdate.clear();
   }
 
+  if (!Fallbacks.empty()) {
+    dbgs() << "FastISel fallbacks in '" << Fn.getName() << "':\n";
+    for (std::map<unsigned, std::pair<unsigned, unsigned> >::iterator
+         I = Fallbacks.begin(), E = Fallbacks.end(); I != E; ++I)
+      dbgs() << "  " << Instruction::getOpcodeName(I->first) << ": "
+             << I->second.first << " missed, " << I->second.second
+             << " instructions\n";
+  }
+
   delete FastIS;
   SDB->clearDanglingDebugInfo();
 }
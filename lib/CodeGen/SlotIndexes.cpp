@@ -34,6 +34,7 @@ void SlotIndexes::releaseMemory() {
   mi2iMap.clear();
   MBBRanges.clear();
   idx2MBBMap.clear();
+  MBBStarts.clear();
   indexList.clear();
   ileAllocator.Reset();
 }
@@ -101,6 +102,7 @@ bool SlotIndexes::runOnMachineFunction(MachineFunction &fn) {
 
   // Sort the Idx2MBBMap
   std::sort(idx2MBBMap.begin(), idx2MBBMap.end(), Idx2MBBCompare());
+  ++Generation;
 
   DEBUG(mf->print(dbgs(), this));
 
@@ -112,6 +114,7 @@ void SlotIndexes::renumberIndexes() {
   // Renumber updates the index of every element of the index list.
   DEBUG(dbgs() << "\n*** Renumbering SlotIndexes ***\n");
   ++NumGlobalRenum;
+  ++Generation;
 
   unsigned index = 0;
 
@@ -131,6 +134,7 @@ void SlotIndexes::renumberIndexes(IndexList::iterator curItr) {
 
   IndexList::iterator startItr = prior(curItr);
   unsigned index = startItr->getIndex();
+  ++Generation;
   do {
     curItr->setIndex(index += Space);
     ++curItr;
@@ -142,6 +146,12 @@ void SlotIndexes::renumberIndexes(IndexList::iterator curItr) {
   ++NumLocalRenum;
 }
 
+void SlotIndexes::computeMBBStarts() const {
+  MBBStarts.resize(idx2MBBMap.size());
+  for (unsigned i = 0, e = idx2MBBMap.size(); i != e; ++i)
+    MBBStarts[i] = idx2MBBMap[i].first.getIndex();
+  MBBStartsGeneration = Generation;
+}
 
 #if !defined(NDEBUG) || defined(LLVM_ENABLE_DUMP)
 void SlotIndexes::dump() const {
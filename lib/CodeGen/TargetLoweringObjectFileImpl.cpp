@@ -204,6 +204,13 @@ static const char *getSectionPrefixForGlobal(SectionKind Kind) {
 }
 
 
+/// isColdFunction - Return true if GV is a function marked cold, which goes
+/// to .text.unlikely rather than .text.
+static bool isColdFunction(const GlobalValue *GV) {
+  const Function *F = dyn_cast<Function>(GV);
+  return F && F->getFnAttributes().hasColdAttr();
+}
+
 const MCSection *TargetLoweringObjectFileELF::
 SelectSectionForGlobal(const GlobalValue *GV, SectionKind Kind,
                        Mangler *Mang, const TargetMachine &TM) const {
@@ -220,7 +227,10 @@ SelectSectionForGlobal(const GlobalValue *GV, SectionKind Kind,
   if ((GV->isWeakForLinker() || EmitUniquedSection) &&
       !Kind.isCommon()) {
     const char *Prefix;
-    Prefix = getSectionPrefixForGlobal(Kind);
+    if (Kind.isText() && isColdFunction(GV))
+      Prefix = ".text.unlikely.";
+    else
+      Prefix = getSectionPrefixForGlobal(Kind);
 
     SmallString<128> Name(Prefix, Prefix+strlen(Prefix));
     MCSymbol *Sym = Mang->getSymbol(GV);
@@ -237,7 +247,13 @@ SelectSectionForGlobal(const GlobalValue *GV, SectionKind Kind,
                                       Flags, Kind, 0, Group);
   }
 
-  if (Kind.isText()) return TextSection;
+  if (Kind.isText()) {
+    if (isColdFunction(GV))
+      return getContext().getELFSection(".text.unlikely", ELF::SHT_PROGBITS,
+                                        ELF::SHF_EXECINSTR | ELF::SHF_ALLOC,
+                                        SectionKind::getText());
+    return TextSection;
+  }
 
   if (Kind.isMergeable1ByteCString() ||
       Kind.isMergeable2ByteCString() ||
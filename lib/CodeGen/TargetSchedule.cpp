@@ -82,6 +82,36 @@ resolveSchedClass(const MachineInstr *MI) const {
   return SCDesc;
 }
 
+/// Return true if the machine model describes the instructions of this class.
+/// A model that only covers some of the instruction classes leaves the others
+/// without any writes.
+static bool isDescribed(const MCSchedClassDesc *SCDesc) {
+  return SCDesc->isValid() && SCDesc->NumWriteLatencyEntries != 0;
+}
+
+TargetSchedModel::ProcResIter
+TargetSchedModel::getWriteProcResBegin(const MCSchedClassDesc *SC) const {
+  return STI->getWriteProcResBegin(SC);
+}
+
+TargetSchedModel::ProcResIter
+TargetSchedModel::getWriteProcResEnd(const MCSchedClassDesc *SC) const {
+  return STI->getWriteProcResEnd(SC);
+}
+
+unsigned TargetSchedModel::getNumMicroOps(const MachineInstr *MI) const {
+  if (EnableSchedItins && hasInstrItineraries()) {
+    int UOps = InstrItins.getNumMicroOps(MI->getDesc().getSchedClass());
+    return (UOps >= 0) ? UOps : TII->getNumMicroOps(&InstrItins, MI);
+  }
+  if (EnableSchedModel && hasInstrSchedModel()) {
+    const MCSchedClassDesc *SCDesc = resolveSchedClass(MI);
+    if (isDescribed(SCDesc))
+      return SCDesc->NumMicroOps;
+  }
+  return 1;
+}
+
 /// Find the def index of this operand. This index maps to the machine model and
 /// is independent of use operands. Def operands may be reordered with uses or
 /// merged with uses without affecting the def index (e.g. before/after
@@ -163,12 +193,19 @@ unsigned TargetSchedModel::computeOperandLatency(
     if (UseDesc->NumReadAdvanceEntries == 0)
       return Latency;
     unsigned UseIdx = findUseIdx(UseMI, UseOperIdx);
-    return Latency - STI->getReadAdvanceCycles(UseDesc, UseIdx, WriteID);
+    int Advance = STI->getReadAdvanceCycles(UseDesc, UseIdx, WriteID);
+    if (Advance > 0 && (unsigned)Advance > Latency)
+      return 0;
+    return Latency - Advance;
   }
+  // The model may leave some instruction classes out entirely.
+  if (!isDescribed(SCDesc))
+    return TII->defaultDefLatency(&SchedModel, DefMI);
+
   // If DefIdx does not exist in the model (e.g. implicit defs), then return
   // unit latency (defaultDefLatency may be too conservative).
 #ifndef NDEBUG
-  if (SCDesc->isValid() && !DefMI->getOperand(DefOperIdx).isImplicit()
+  if (!DefMI->getOperand(DefOperIdx).isImplicit()
       && !DefMI->getDesc().OpInfo[DefOperIdx].isOptionalDef()) {
     std::string Err;
     raw_string_ostream ss(Err);
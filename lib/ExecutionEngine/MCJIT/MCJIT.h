@@ -73,6 +73,10 @@ public:
     Dyld.mapSectionAddress(LocalAddress, TargetAddress);
   }
 
+  virtual void setMachinePassListener(MachinePassListener *L) {
+    TM->setMachinePassListener(L);
+  }
+
   /// @}
   /// @name (Private) Registration Interfaces
   /// @{
@@ -220,13 +220,15 @@ void RuntimeDyldMachO::processRelocationRef(const ObjRelocationInfo &Rel,
     const SymbolRef &Symbol = Rel.Symbol;
     Symbol.getName(TargetName);
     // First search for the symbol in the local symbol table
-    SymbolTableMap::const_iterator lsi = Symbols.find(TargetName.data());
+    unsigned TargetHash = StringMapImpl::hash(TargetName);
+    SymbolTableMap::const_iterator lsi = Symbols.find(TargetName, TargetHash);
     if (lsi != Symbols.end()) {
       Value.SectionID = lsi->second.first;
       Value.Addend = lsi->second.second;
     } else {
       // Search for the symbol in the global symbol table
-      SymbolTableMap::const_iterator gsi = GlobalSymbolTable.find(TargetName.data());
+      SymbolTableMap::const_iterator gsi =
+          GlobalSymbolTable.find(TargetName, TargetHash);
       if (gsi != GlobalSymbolTable.end()) {
         Value.SectionID = gsi->second.first;
         Value.Addend = gsi->second.second;
@@ -71,25 +71,33 @@ MCSymbol *MCContext::GetOrCreateSymbol(StringRef Name) {
   assert(!Name.empty() && "Normal symbols cannot be unnamed!");
 
   // Do the lookup and get the entire StringMapEntry.  We want access to the
-  // key if we are creating the entry.
-  StringMapEntry<MCSymbol*> &Entry = Symbols.GetOrCreateValue(Name);
+  // key if we are creating the entry.  The hash is shared with the UsedNames
+  // lookup in CreateSymbol.
+  unsigned FullHashValue = StringMapImpl::hash(Name);
+  StringMapEntry<MCSymbol*> &Entry =
+    Symbols.GetOrCreateValueWithHash(Name, FullHashValue);
   MCSymbol *Sym = Entry.getValue();
 
   if (Sym)
     return Sym;
 
-  Sym = CreateSymbol(Name);
+  Sym = CreateSymbol(Name, FullHashValue);
   Entry.setValue(Sym);
   return Sym;
 }
 
 MCSymbol *MCContext::CreateSymbol(StringRef Name) {
+  return CreateSymbol(Name, StringMapImpl::hash(Name));
+}
+
+MCSymbol *MCContext::CreateSymbol(StringRef Name, unsigned FullHashValue) {
   // Determine whether this is an assembler temporary or normal label, if used.
   bool isTemporary = false;
   if (AllowTemporaryLabels)
     isTemporary = Name.startswith(MAI.getPrivateGlobalPrefix());
 
-  StringMapEntry<bool> *NameEntry = &UsedNames.GetOrCreateValue(Name);
+  StringMapEntry<bool> *NameEntry =
+    &UsedNames.GetOrCreateValueWithHash(Name, FullHashValue);
   if (NameEntry->getValue()) {
     assert(isTemporary && "Cannot rename non temporary symbols");
     SmallString<128> NewName = Name;
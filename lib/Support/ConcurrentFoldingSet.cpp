@@ -0,0 +1,303 @@
+//===-- Support/ConcurrentFoldingSet.cpp - Thread-safe uniquing set -------===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+//
+// This file implements the thread-safe variant of FoldingSet.
+//
+//===----------------------------------------------------------------------===//
+
+#include "llvm/ADT/ConcurrentFoldingSet.h"
+#include "llvm/Support/Atomic.h"
+#include "llvm/Support/Mutex.h"
+#include <cassert>
+#include <cstdlib>
+#include <vector>
+using namespace llvm;
+
+typedef ConcurrentFoldingSetImpl::Node Node;
+
+namespace {
+/// BucketTable - A bucket array together with its size, so that lock-free
+/// readers always see a consistent pair with a single pointer load.
+struct BucketTable {
+  unsigned NumBuckets;
+  Node *volatile Buckets[1];
+};
+}
+
+/// AllocateTable - Allocate an empty table with NumBuckets buckets.
+static BucketTable *AllocateTable(unsigned NumBuckets) {
+  BucketTable *T = static_cast<BucketTable*>(
+    calloc(1, sizeof(BucketTable) + (NumBuckets - 1) * sizeof(Node*)));
+  T->NumBuckets = NumBuckets;
+  return T;
+}
+
+/// getChainEnd - The value of the next pointer of the last node in a chain.
+/// It is distinct from null, which marks a node that is not in the set.
+static Node *getChainEnd() {
+  return reinterpret_cast<Node*>(static_cast<intptr_t>(1));
+}
+
+static bool isChainEnd(Node *N) {
+  return N == 0 || N == getChainEnd();
+}
+
+struct ConcurrentFoldingSetImpl::Shard {
+  /// Lock - Held while the shard is modified.
+  sys::SmartMutex<true> Lock;
+
+  /// Table - The current bucket table.
+  BucketTable *volatile Table;
+
+  /// NumNodes - Number of nodes in the shard. Growth occurs when NumNodes is
+  /// greater than twice the number of buckets.
+  unsigned NumNodes;
+
+  /// RetiredTables - Tables replaced by GrowShard.  Lock-free lookups may
+  /// still be walking them, so they are only freed along with the set.
+  std::vector<BucketTable*> RetiredTables;
+
+  Shard() : Lock(false), Table(0), NumNodes(0) {}
+
+  void freeTables() {
+    for (unsigned i = 0, e = RetiredTables.size(); i != e; ++i)
+      free(RetiredTables[i]);
+    RetiredTables.clear();
+    free(Table);
+    Table = 0;
+  }
+};
+
+ConcurrentFoldingSetImpl::ConcurrentFoldingSetImpl(unsigned Log2InitSize,
+                                                   unsigned Log2NumShards)
+  : Log2NumShards(Log2NumShards) {
+  assert(5 < Log2InitSize && Log2InitSize < 32 &&
+         "Initial hash table size out of range");
+  assert(Log2NumShards < 16 && "Too many shards");
+  unsigned Log2ShardSize =
+    Log2InitSize > Log2NumShards ? Log2InitSize - Log2NumShards : 1;
+  Shards = new Shard[1 << Log2NumShards];
+  for (unsigned i = 0, e = 1 << Log2NumShards; i != e; ++i)
+    Shards[i].Table = AllocateTable(1 << Log2ShardSize);
+}
+
+ConcurrentFoldingSetImpl::~ConcurrentFoldingSetImpl() {
+  for (unsigned i = 0, e = 1 << Log2NumShards; i != e; ++i)
+    Shards[i].freeTables();
+  delete [] Shards;
+}
+
+/// getShardIndex - The shard is selected by the high bits of the hash, and
+/// the bucket within the shard by the low bits.
+static unsigned getShardIndex(unsigned Hash, unsigned Log2NumShards) {
+  return Log2NumShards ? Hash >> (32 - Log2NumShards) : 0;
+}
+
+ConcurrentFoldingSetImpl::Shard &
+ConcurrentFoldingSetImpl::getShardFor(unsigned Hash) const {
+  return Shards[getShardIndex(Hash, Log2NumShards)];
+}
+
+void ConcurrentFoldingSetImpl::clear() {
+  for (unsigned i = 0, e = 1 << Log2NumShards; i != e; ++i) {
+    Shard &S = Shards[i];
+    sys::SmartScopedLock<true> Guard(S.Lock);
+    unsigned NumBuckets = S.Table->NumBuckets;
+    S.freeTables();
+    S.Table = AllocateTable(NumBuckets);
+    S.NumNodes = 0;
+  }
+}
+
+unsigned ConcurrentFoldingSetImpl::size() const {
+  unsigned Size = 0;
+  for (unsigned i = 0, e = 1 << Log2NumShards; i != e; ++i)
+    Size += Shards[i].NumNodes;
+  return Size;
+}
+
+bool ConcurrentFoldingSetImpl::NodeEquals(Node *N, const FoldingSetNodeID &ID,
+                                          unsigned IDHash,
+                                          FoldingSetNodeID &TempID) const {
+  // Most nodes in a chain have a different hash; only profile the rest.
+  if (N->HashValue != IDHash)
+    return false;
+  GetNodeProfile(N, TempID);
+  bool Equal = TempID == ID;
+  TempID.clear();
+  return Equal;
+}
+
+Node *ConcurrentFoldingSetImpl::FindNodeLocked(const Shard &S,
+                                               const FoldingSetNodeID &ID,
+                                               unsigned IDHash,
+                                               FoldingSetNodeID &TempID) const {
+  BucketTable *T = S.Table;
+  Node *N = T->Buckets[IDHash & (T->NumBuckets-1)];
+  for (; !isChainEnd(N); N = N->NextInFoldingSetBucket)
+    if (NodeEquals(N, ID, IDHash, TempID))
+      return N;
+  return 0;
+}
+
+Node *ConcurrentFoldingSetImpl::FindNode(const Shard &S,
+                                         const FoldingSetNodeID &ID,
+                                         unsigned IDHash,
+                                         FoldingSetNodeID &TempID) const {
+  // Chains are always acyclic and terminated, even while a rehash is moving
+  // nodes between them, so this walk finishes.  It may miss a node that is
+  // moved or inserted behind its back; callers recheck under the lock before
+  // acting on a miss.
+  sys::MemoryFence();
+  return FindNodeLocked(S, ID, IDHash, TempID);
+}
+
+Node *ConcurrentFoldingSetImpl::FindNodeOrInsertPos(const FoldingSetNodeID &ID,
+                                                    void *&InsertPos) {
+  unsigned IDHash = ID.ComputeHash();
+  Shard &S = getShardFor(IDHash);
+  InsertPos = 0;
+
+  FoldingSetNodeID TempID;
+  if (Node *N = FindNode(S, ID, IDHash, TempID))
+    return N;
+
+  // The lock-free lookup missed, either because the node is not there or
+  // because the shard changed underneath it.  Check again under the lock.
+  sys::SmartScopedLock<true> Guard(S.Lock);
+  if (Node *N = FindNodeLocked(S, ID, IDHash, TempID))
+    return N;
+
+  // Didn't find the node, return null with the shard as the InsertPos.
+  InsertPos = &S;
+  return 0;
+}
+
+void ConcurrentFoldingSetImpl::InsertNodeLocked(Shard &S, Node *N) {
+  // Do we need to grow the hashtable?
+  if (S.NumNodes+1 > S.Table->NumBuckets*2)
+    GrowShard(S);
+
+  ++S.NumNodes;
+  BucketTable *T = S.Table;
+  Node *volatile &Bucket = T->Buckets[N->HashValue & (T->NumBuckets-1)];
+  Node *Next = Bucket;
+  N->NextInFoldingSetBucket = Next ? Next : getChainEnd();
+
+  // Publish the node only once its next pointer is visible.
+  sys::MemoryFence();
+  Bucket = N;
+}
+
+void ConcurrentFoldingSetImpl::InsertNode(Node *N, void *InsertPos) {
+  assert(N->getNextInBucket() == 0 && "Node already in a folding set!");
+  FoldingSetNodeID ID;
+  GetNodeProfile(N, ID);
+  N->HashValue = ID.ComputeHash();
+
+  Shard &S = getShardFor(N->HashValue);
+  (void)InsertPos;
+  assert(InsertPos == &S && "InsertPos is not from FindNodeOrInsertPos!");
+  sys::SmartScopedLock<true> Guard(S.Lock);
+  InsertNodeLocked(S, N);
+}
+
+Node *ConcurrentFoldingSetImpl::GetOrInsertNode(Node *N) {
+  assert(N->getNextInBucket() == 0 && "Node already in a folding set!");
+  FoldingSetNodeID ID;
+  GetNodeProfile(N, ID);
+  unsigned IDHash = ID.ComputeHash();
+  Shard &S = getShardFor(IDHash);
+
+  FoldingSetNodeID TempID;
+  if (Node *E = FindNode(S, ID, IDHash, TempID))
+    return E;
+
+  sys::SmartScopedLock<true> Guard(S.Lock);
+  if (Node *E = FindNodeLocked(S, ID, IDHash, TempID))
+    return E;
+  N->HashValue = IDHash;
+  InsertNodeLocked(S, N);
+  return N;
+}
+
+bool ConcurrentFoldingSetImpl::RemoveNode(Node *N) {
+  if (N->getNextInBucket() == 0) return false;  // Not in folding set.
+
+  Shard &S = getShardFor(N->HashValue);
+  sys::SmartScopedLock<true> Guard(S.Lock);
+  BucketTable *T = S.Table;
+  Node *volatile *Link = &T->Buckets[N->HashValue & (T->NumBuckets-1)];
+  while (*Link != N) {
+    assert(!isChainEnd(*Link) && "Node not in its bucket chain!");
+    Link = &(*Link)->NextInFoldingSetBucket;
+  }
+
+  // A reader standing on N sees a null next pointer and stops, then retries
+  // under the lock.
+  Node *Next = N->NextInFoldingSetBucket;
+  *Link = Link == &T->Buckets[N->HashValue & (T->NumBuckets-1)] &&
+          Next == getChainEnd() ? 0 : Next;
+  N->NextInFoldingSetBucket = 0;
+  --S.NumNodes;
+  return true;
+}
+
+void ConcurrentFoldingSetImpl::GrowShard(Shard &S) {
+  BucketTable *OldTable = S.Table;
+  unsigned NewNumBuckets = OldTable->NumBuckets * 2;
+  BucketTable *NewTable = AllocateTable(NewNumBuckets);
+
+  // Move every node to its new chain, using the cached hashes.  Each node is
+  // pushed onto a new chain only after it has been unlinked from the old one,
+  // so concurrent readers never see a cycle.
+  for (unsigned i = 0, e = OldTable->NumBuckets; i != e; ++i) {
+    Node *N = OldTable->Buckets[i];
+    while (!isChainEnd(N)) {
+      Node *Next = N->NextInFoldingSetBucket;
+      OldTable->Buckets[i] = isChainEnd(Next) ? 0 : Next;
+      Node *volatile &Bucket =
+        NewTable->Buckets[N->HashValue & (NewNumBuckets-1)];
+      N->NextInFoldingSetBucket = Bucket ? Bucket : getChainEnd();
+      Bucket = N;
+      N = Next;
+    }
+  }
+
+  sys::MemoryFence();
+  S.Table = NewTable;
+  S.RetiredTables.push_back(OldTable);
+}
+
+Node *ConcurrentFoldingSetImpl::getFirstNode() const {
+  for (unsigned i = 0, e = 1 << Log2NumShards; i != e; ++i) {
+    BucketTable *T = Shards[i].Table;
+    for (unsigned b = 0, be = T->NumBuckets; b != be; ++b)
+      if (Node *N = T->Buckets[b])
+        return N;
+  }
+  return 0;
+}
+
+Node *ConcurrentFoldingSetImpl::getNextNode(const Node *N) const {
+  if (!isChainEnd(N->NextInFoldingSetBucket))
+    return N->NextInFoldingSetBucket;
+
+  // Use the cached hash to find where N lives and scan from the next bucket.
+  unsigned ShardNo = getShardIndex(N->HashValue, Log2NumShards);
+  unsigned BucketNo =
+    (N->HashValue & (Shards[ShardNo].Table->NumBuckets-1)) + 1;
+  for (unsigned e = 1 << Log2NumShards; ShardNo != e; ++ShardNo, BucketNo = 0) {
+    BucketTable *T = Shards[ShardNo].Table;
+    for (unsigned be = T->NumBuckets; BucketNo != be; ++BucketNo)
+      if (Node *Next = T->Buckets[BucketNo])
+        return Next;
+  }
+  return 0;
+}
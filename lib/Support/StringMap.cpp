@@ -49,19 +49,56 @@ void StringMapImpl::init(unsigned InitSize) {
   TheTable[NumBuckets] = (StringMapEntryBase*)2;
 }
 
+#if LLVM_STRINGMAP_FAST_HASH
+/// load64 - Read up to eight bytes starting at P as a native-endian integer,
+/// zero-filling the high bytes.
+static inline uint64_t load64(const char *P, size_t Len) {
+  uint64_t V = 0;
+  memcpy(&V, P, Len < 8 ? Len : 8);
+  return V;
+}
+
+/// mix64 - Fold a 64-bit word into the running hash with a wide multiply.
+static inline uint64_t mix64(uint64_t H, uint64_t V) {
+  H ^= V * 0x9E3779B97F4A7C15ULL;
+  H = (H << 27) | (H >> 37);
+  return H * 0xC2B2AE3D27D4EB4FULL + 0x165667B19E3779F9ULL;
+}
+#endif
+
+/// hash - Return the hash value StringMap uses for Key.
+unsigned StringMapImpl::hash(StringRef Key) {
+#if LLVM_STRINGMAP_FAST_HASH
+  const char *P = Key.data();
+  size_t Len = Key.size();
+  uint64_t H = Len * 0x87C37B91114253D5ULL;
+  for (; Len > 8; P += 8, Len -= 8)
+    H = mix64(H, load64(P, 8));
+  H = mix64(H, load64(P, Len));
+
+  // Fold the high bits down; StringMap indexes with the low bits.
+  H ^= H >> 29;
+  H *= 0xBF58476D1CE4E5B9ULL;
+  H ^= H >> 32;
+  return static_cast<unsigned>(H);
+#else
+  return HashString(Key);
+#endif
+}
+
 
 /// LookupBucketFor - Look up the bucket that the specified string should end
 /// up in.  If it already exists as a key in the map, the Item pointer for the
 /// specified bucket will be non-null.  Otherwise, it will be null.  In either
 /// case, the FullHashValue field of the bucket will be set to the hash value
 /// of the string.
-unsigned StringMapImpl::LookupBucketFor(StringRef Name) {
+unsigned StringMapImpl::LookupBucketFor(StringRef Name,
+                                        unsigned FullHashValue) {
   unsigned HTSize = NumBuckets;
   if (HTSize == 0) {  // Hash table unallocated so far?
     init(16);
     HTSize = NumBuckets;
   }
-  unsigned FullHashValue = HashString(Name);
   unsigned BucketNo = FullHashValue & (HTSize-1);
   unsigned *HashTable = (unsigned *)(TheTable + NumBuckets + 1);
 
@@ -113,10 +150,9 @@ unsigned StringMapImpl::LookupBucketFor(StringRef Name) {
 /// FindKey - Look up the bucket that contains the specified key. If it exists
 /// in the map, return the bucket number of the key.  Otherwise return -1.
 /// This does not modify the map.
-int StringMapImpl::FindKey(StringRef Key) const {
+int StringMapImpl::FindKey(StringRef Key, unsigned FullHashValue) const {
   unsigned HTSize = NumBuckets;
   if (HTSize == 0) return -1;  // Really empty table?
-  unsigned FullHashValue = HashString(Key);
   unsigned BucketNo = FullHashValue & (HTSize-1);
   unsigned *HashTable = (unsigned *)(TheTable + NumBuckets + 1);
 
@@ -182,19 +218,37 @@ StringMapEntryBase *StringMapImpl::RemoveKey(StringRef Key) {
 /// RehashTable - Grow the table, redistributing values into the buckets with
 /// the appropriate mod-of-hashtable-size.
 void StringMapImpl::RehashTable() {
-  unsigned NewSize;
-  unsigned *HashTable = (unsigned *)(TheTable + NumBuckets + 1);
-
   // If the hash table is now more than 3/4 full, or if fewer than 1/8 of
   // the buckets are empty (meaning that many are filled with tombstones),
   // grow/rehash the table.
   if (NumItems*4 > NumBuckets*3) {
-    NewSize = NumBuckets*2;
+    ResizeTable(NumBuckets*2);
   } else if (NumBuckets-(NumItems+NumTombstones) <= NumBuckets/8) {
-    NewSize = NumBuckets;
-  } else {
+    ResizeTable(NumBuckets);
+  }
+}
+
+/// ReserveTable - Grow the table so that it can hold NumEntries items without
+/// being rehashed.
+void StringMapImpl::ReserveTable(unsigned NumEntries) {
+  // RehashTable grows the table once it is more than 3/4 full.
+  unsigned NewSize = 16;
+  while (NumEntries*4 > NewSize*3)
+    NewSize *= 2;
+  if (NewSize <= NumBuckets)
+    return;
+
+  if (NumBuckets == 0) {
+    init(NewSize);
     return;
   }
+  ResizeTable(NewSize);
+}
+
+/// ResizeTable - Redistribute the values into a table with NewSize buckets,
+/// dropping all tombstones.
+void StringMapImpl::ResizeTable(unsigned NewSize) {
+  unsigned *HashTable = (unsigned *)(TheTable + NumBuckets + 1);
 
   // Allocate one extra bucket which will always be non-empty.  This allows the
   // iterators to stop at end.
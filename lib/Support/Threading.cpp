@@ -16,6 +16,7 @@
 #include "llvm/Support/Mutex.h"
 #include "llvm/Config/config.h"
 #include <cassert>
+#include <vector>
 
 using namespace llvm;
 
@@ -102,6 +103,39 @@ void llvm::llvm_execute_on_thread(void (*Fn)(void*), void *UserData,
  error:
   ::pthread_attr_destroy(&Attr);
 }
+
+void llvm::llvm_execute_on_threads(void (*Fn)(void*), void *const *UserData,
+                                   unsigned NumThreads,
+                                   unsigned RequestedStackSize) {
+  std::vector<ThreadInfo> Info(NumThreads);
+  std::vector<pthread_t> Threads(NumThreads);
+  std::vector<bool> Started(NumThreads, false);
+  pthread_attr_t Attr;
+  bool HaveAttr = ::pthread_attr_init(&Attr) == 0;
+  if (HaveAttr && RequestedStackSize != 0 &&
+      ::pthread_attr_setstacksize(&Attr, RequestedStackSize) != 0) {
+    ::pthread_attr_destroy(&Attr);
+    HaveAttr = false;
+  }
+
+  // Start all the threads, then run whatever could not be started here.
+  for (unsigned i = 0; i != NumThreads; ++i) {
+    Info[i].UserFn = Fn;
+    Info[i].UserData = UserData[i];
+    if (HaveAttr)
+      Started[i] = ::pthread_create(&Threads[i], &Attr,
+                                    ExecuteOnThread_Dispatch, &Info[i]) == 0;
+  }
+  for (unsigned i = 0; i != NumThreads; ++i)
+    if (!Started[i])
+      Fn(UserData[i]);
+
+  for (unsigned i = 0; i != NumThreads; ++i)
+    if (Started[i])
+      ::pthread_join(Threads[i], 0);
+  if (HaveAttr)
+    ::pthread_attr_destroy(&Attr);
+}
 #elif LLVM_ENABLE_THREADS!=0 && defined(LLVM_ON_WIN32)
 #include "Windows/Windows.h"
 #include <process.h>
@@ -136,6 +170,28 @@ void llvm::llvm_execute_on_thread(void (*Fn)(void*), void *UserData,
     ::CloseHandle(hThread);
   }
 }
+
+void llvm::llvm_execute_on_threads(void (*Fn)(void*), void *const *UserData,
+                                   unsigned NumThreads,
+                                   unsigned RequestedStackSize) {
+  std::vector<ThreadInfo> Info(NumThreads);
+  std::vector<HANDLE> Threads(NumThreads);
+  for (unsigned i = 0; i != NumThreads; ++i) {
+    Info[i].func = Fn;
+    Info[i].param = UserData[i];
+    Threads[i] = (HANDLE)::_beginthreadex(NULL, RequestedStackSize,
+                                          ThreadCallback, &Info[i], 0, NULL);
+  }
+  for (unsigned i = 0; i != NumThreads; ++i)
+    if (!Threads[i])
+      Fn(UserData[i]);
+
+  for (unsigned i = 0; i != NumThreads; ++i)
+    if (Threads[i]) {
+      (void)::WaitForSingleObject(Threads[i], INFINITE);
+      ::CloseHandle(Threads[i]);
+    }
+}
 #else
 // Support for non-Win32, non-pthread implementation.
 void llvm::llvm_execute_on_thread(void (*Fn)(void*), void *UserData,
@@ -144,4 +200,12 @@ void llvm::llvm_execute_on_thread(void (*Fn)(void*), void *UserData,
   Fn(UserData);
 }
 
+void llvm::llvm_execute_on_threads(void (*Fn)(void*), void *const *UserData,
+                                   unsigned NumThreads,
+                                   unsigned RequestedStackSize) {
+  (void) RequestedStackSize;
+  for (unsigned i = 0; i != NumThreads; ++i)
+    Fn(UserData[i]);
+}
+
 #endif
@@ -199,6 +199,13 @@ bool ARMPassConfig::addPreEmitPass() {
   return true;
 }
 
+void ARMBaseTargetMachine::addAnalysisPasses(PassManagerBase &PM) {
+  // Add the target-independent cost model first so that the ARM one can
+  // forward the queries it does not refine.
+  LLVMTargetMachine::addAnalysisPasses(PM);
+  PM.add(createARMTargetTransformInfoPass(this));
+}
+
 bool ARMBaseTargetMachine::addCodeEmitter(PassManagerBase &PM,
                                           JITCodeEmitter &JCE) {
   // Machine code emitter pass for ARM.
@@ -51,6 +51,9 @@ public:
     return &InstrItins;
   }
 
+  /// addAnalysisPasses - Register the ARM cost model with a pass manager.
+  virtual void addAnalysisPasses(PassManagerBase &PM);
+
   // Pass Pipeline Configuration
   virtual TargetPassConfig *createPassConfig(PassManagerBase &PM);
 
@@ -0,0 +1,177 @@
+//===-- ARMTargetTransformInfo.cpp - ARM specific TTI pass ----------------===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+//
+// This file implements a TargetTransformInfo analysis pass specific to the
+// ARM target machine.  It refines the TargetLowering based cost model
+// (-basictti) with what NEON does not show in its legalization actions:
+// lengthening and narrowing conversions are single instructions, while
+// moving an integer between a NEON lane and a core register is slow.
+// Everything else is forwarded down the chain.
+//
+//===----------------------------------------------------------------------===//
+
+#define DEBUG_TYPE "armtti"
+#include "ARM.h"
+#include "ARMTargetMachine.h"
+#include "llvm/DerivedTypes.h"
+#include "llvm/Instruction.h"
+#include "llvm/Pass.h"
+#include "llvm/Analysis/TargetTransformInfo.h"
+#include "llvm/Target/TargetLowering.h"
+using namespace llvm;
+
+// Declare the pass initialization routine locally as target-specific passes
+// don't have a target-wide initialization entry point, and so we rely on the
+// pass constructor initialization.
+namespace llvm {
+void initializeARMTTIPass(PassRegistry &);
+}
+
+namespace {
+
+/// ARMCastCostTblEntry - The cost of an IR cast between two legal ARM types.
+struct ARMCastCostTblEntry {
+  unsigned Opcode;
+  MVT::SimpleValueType Dst;
+  MVT::SimpleValueType Src;
+  unsigned Cost;
+};
+
+} // end anonymous namespace
+
+// NEON conversions that are a single instruction: vcvt, vmovl and vmovn.
+static const ARMCastCostTblEntry NEONCastCostTable[] = {
+  { Instruction::SIToFP, MVT::v4f32, MVT::v4i32, 1 },
+  { Instruction::UIToFP, MVT::v4f32, MVT::v4i32, 1 },
+  { Instruction::FPToSI, MVT::v4i32, MVT::v4f32, 1 },
+  { Instruction::FPToUI, MVT::v4i32, MVT::v4f32, 1 },
+  { Instruction::SIToFP, MVT::v2f32, MVT::v2i32, 1 },
+  { Instruction::UIToFP, MVT::v2f32, MVT::v2i32, 1 },
+  { Instruction::FPToSI, MVT::v2i32, MVT::v2f32, 1 },
+  { Instruction::FPToUI, MVT::v2i32, MVT::v2f32, 1 },
+  { Instruction::SExt,   MVT::v4i32, MVT::v4i16, 1 },
+  { Instruction::ZExt,   MVT::v4i32, MVT::v4i16, 1 },
+  { Instruction::SExt,   MVT::v8i16, MVT::v8i8,  1 },
+  { Instruction::ZExt,   MVT::v8i16, MVT::v8i8,  1 },
+  { Instruction::SExt,   MVT::v2i64, MVT::v2i32, 1 },
+  { Instruction::ZExt,   MVT::v2i64, MVT::v2i32, 1 },
+  { Instruction::Trunc,  MVT::v4i16, MVT::v4i32, 1 },
+  { Instruction::Trunc,  MVT::v8i8,  MVT::v8i16, 1 },
+  { Instruction::Trunc,  MVT::v2i32, MVT::v2i64, 1 },
+};
+
+/// lookupCastCost - Return the entry for Opcode, Dst and Src in Tbl, or null.
+template<unsigned N>
+static const ARMCastCostTblEntry *
+lookupCastCost(const ARMCastCostTblEntry (&Tbl)[N], unsigned Opcode, MVT Dst,
+               MVT Src) {
+  for (unsigned i = 0; i != N; ++i)
+    if (Tbl[i].Opcode == Opcode && Tbl[i].Dst == Dst.SimpleTy &&
+        Tbl[i].Src == Src.SimpleTy)
+      return &Tbl[i];
+  return 0;
+}
+
+namespace {
+
+class ARMTTI : public ImmutablePass, public TargetTransformInfo {
+  const ARMSubtarget *ST;
+  const TargetLowering *TLI;
+
+  /// getSimpleLegalType - Return the type that Ty lives in if it is legal
+  /// and simple, or MVT::Other otherwise.
+  MVT getSimpleLegalType(Type *Ty) const {
+    EVT VT = TLI->getValueType(Ty, true);
+    if (VT == MVT::Other || !VT.isSimple() || !TLI->isTypeLegal(VT))
+      return MVT::Other;
+    return VT.getSimpleVT();
+  }
+
+public:
+  static char ID; // Class identification, replacement for typeinfo
+  ARMTTI() : ImmutablePass(ID), ST(0), TLI(0) {
+    llvm_unreachable("This pass cannot be directly constructed");
+  }
+
+  explicit ARMTTI(const ARMBaseTargetMachine *TM)
+    : ImmutablePass(ID), ST(TM->getSubtargetImpl()),
+      TLI(TM->getTargetLowering()) {
+    initializeARMTTIPass(*PassRegistry::getPassRegistry());
+  }
+
+  virtual void initializePass() {
+    InitializeTargetTransformInfo(this);
+  }
+
+  virtual void getAnalysisUsage(AnalysisUsage &AU) const {
+    TargetTransformInfo::getAnalysisUsage(AU);
+  }
+
+  virtual unsigned getNumberOfRegisters(bool Vector) const;
+  virtual unsigned getRegisterBitWidth(bool Vector) const;
+  virtual unsigned getCastInstrCost(unsigned Opcode, Type *Dst,
+                                    Type *Src) const;
+  virtual unsigned getVectorInstrCost(unsigned Opcode, Type *Val,
+                                      unsigned Index) const;
+
+  /// getAdjustedAnalysisPointer - This method is used when a pass implements
+  /// an analysis interface through multiple inheritance.  If needed, it
+  /// should override this to adjust the this pointer as needed for the
+  /// specified pass info.
+  virtual void *getAdjustedAnalysisPointer(const void *ID) {
+    if (ID == &TargetTransformInfo::ID)
+      return (TargetTransformInfo*)this;
+    return this;
+  }
+};
+
+} // end anonymous namespace
+
+INITIALIZE_AG_PASS(ARMTTI, TargetTransformInfo, "armtti",
+                   "ARM Target Transform Info", true, true, false)
+char ARMTTI::ID = 0;
+
+ImmutablePass *
+llvm::createARMTargetTransformInfoPass(const ARMBaseTargetMachine *TM) {
+  return new ARMTTI(TM);
+}
+
+unsigned ARMTTI::getNumberOfRegisters(bool Vector) const {
+  if (Vector)
+    return ST->hasNEON() ? 16 : 0;
+  // r0-r7 in Thumb1; everything but sp, lr and pc otherwise.
+  return ST->isThumb1Only() ? 8 : 13;
+}
+
+unsigned ARMTTI::getRegisterBitWidth(bool Vector) const {
+  if (Vector)
+    return ST->hasNEON() ? 128 : 0;
+  return 32;
+}
+
+unsigned ARMTTI::getCastInstrCost(unsigned Opcode, Type *Dst,
+                                  Type *Src) const {
+  MVT DstVT = getSimpleLegalType(Dst), SrcVT = getSimpleLegalType(Src);
+  if (ST->hasNEON() && DstVT != MVT::Other && SrcVT != MVT::Other)
+    if (const ARMCastCostTblEntry *E =
+          lookupCastCost(NEONCastCostTable, Opcode, DstVT, SrcVT))
+      return E->Cost;
+  return TargetTransformInfo::getCastInstrCost(Opcode, Dst, Src);
+}
+
+unsigned ARMTTI::getVectorInstrCost(unsigned Opcode, Type *Val,
+                                    unsigned Index) const {
+  // Moving an integer between a NEON lane and a core register stalls the
+  // pipeline on most cores.
+  if (ST->hasNEON() && Val->getScalarType()->isIntegerTy() &&
+      (Opcode == Instruction::InsertElement ||
+       Opcode == Instruction::ExtractElement))
+    return 3;
+  return TargetTransformInfo::getVectorInstrCost(Opcode, Val, Index);
+}
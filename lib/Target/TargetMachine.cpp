@@ -53,6 +53,7 @@ TargetMachine::TargetMachine(const Target &T,
     MCUseLoc(true),
     MCUseCFI(true),
     MCUseDwarfDirectory(false),
+    PassListener(0),
     Options(Options) {
 }
 
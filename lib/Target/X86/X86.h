@@ -23,6 +23,7 @@
 namespace llvm {
 
 class FunctionPass;
+class ImmutablePass;
 class JITCodeEmitter;
 class X86TargetMachine;
 
@@ -69,6 +70,11 @@ FunctionPass *createEmitX86CodeToMemory();
 ///
 FunctionPass *createX86MaxStackAlignmentHeuristicPass();
 
+/// createX86TargetTransformInfoPass - This function returns a pass that
+/// answers TargetTransformInfo queries with X86 specific costs.
+///
+ImmutablePass *createX86TargetTransformInfoPass(const X86TargetMachine *TM);
+
 } // End llvm namespace
 
 #endif
@@ -31,6 +31,7 @@
 #include "llvm/CodeGen/FunctionLoweringInfo.h"
 #include "llvm/CodeGen/MachineConstantPool.h"
 #include "llvm/CodeGen/MachineFrameInfo.h"
+#include "llvm/CodeGen/MachineModuleInfo.h"
 #include "llvm/CodeGen/MachineRegisterInfo.h"
 #include "llvm/Support/CallSite.h"
 #include "llvm/Support/ErrorHandling.h"
@@ -38,6 +39,10 @@
 #include "llvm/Target/TargetOptions.h"
 using namespace llvm;
 
+/// MaxFastSwitchCases - Switches with more cases than this are left to
+/// SelectionDAG, which can build jump tables and balanced trees.
+static const unsigned MaxFastSwitchCases = 4;
+
 namespace {
 
 class X86FastISel : public FastISel {
@@ -68,6 +73,10 @@ public:
 
   virtual bool TargetSelectInstruction(const Instruction *I);
 
+  /// canSelectFunction - Whole functions are selected on x86-64 when they
+  /// only compute with scalar integers, pointers and SSE floating point.
+  virtual bool canSelectFunction(const Function &F);
+
   /// TryToFoldLoad - The specified machine instr operand is a vreg, and that
   /// vreg is being provided by the specified load instruction.  If possible,
   /// try to fold the load as an operand to the instruction, returning true if
@@ -112,8 +121,12 @@ private:
   bool X86SelectFPExt(const Instruction *I);
   bool X86SelectFPTrunc(const Instruction *I);
 
+  bool X86SelectSwitch(const Instruction *I);
+
   bool X86VisitIntrinsicCall(const IntrinsicInst &I);
+  bool X86SelectMonoIntrinsic(const Instruction *I, unsigned IID);
   bool X86SelectCall(const Instruction *I);
+  bool X86SelectInvoke(const Instruction *I);
 
   bool DoSelectCall(const Instruction *I, const char *MemIntName);
 
@@ -139,6 +152,8 @@ private:
 
   bool isTypeLegal(Type *Ty, MVT &VT, bool AllowI1 = false);
 
+  bool isScalarType(Type *Ty);
+
   bool IsMemcpySmall(uint64_t Len);
 
   bool TryEmitSmallMemcpy(X86AddressMode DestAM,
@@ -342,9 +357,11 @@ bool X86FastISel::X86SelectAddress(const Value *V, X86AddressMode &AM) {
   if (const Instruction *I = dyn_cast<Instruction>(V)) {
     // Don't walk into other basic blocks; it's possible we haven't
     // visited them yet, so the instructions may not yet be assigned
-    // virtual registers.
+    // virtual registers.  When selecting the whole function, instructions
+    // whose operands are all live across blocks can be folded.
     if (FuncInfo.StaticAllocaMap.count(static_cast<const AllocaInst *>(V)) ||
-        FuncInfo.MBBMap[I->getParent()] == FuncInfo.MBB) {
+        FuncInfo.MBBMap[I->getParent()] == FuncInfo.MBB ||
+        canFoldAcrossBlocks(I)) {
       Opcode = I->getOpcode();
       U = I;
     }
@@ -434,7 +451,8 @@ bool X86FastISel::X86SelectAddress(const Value *V, X86AddressMode &AM) {
         if (isa<AddOperator>(Op) &&
             (!isa<Instruction>(Op) ||
              FuncInfo.MBBMap[cast<Instruction>(Op)->getParent()]
-               == FuncInfo.MBB) &&
+               == FuncInfo.MBB ||
+             canFoldAcrossBlocks(cast<Instruction>(Op))) &&
             isa<ConstantInt>(cast<AddOperator>(Op)->getOperand(1))) {
           // An add (in the same block) with a constant operand. Fold the
           // constant.
@@ -453,6 +471,10 @@ bool X86FastISel::X86SelectAddress(const Value *V, X86AddressMode &AM) {
           IndexReg = getRegForGEPIndex(Op).first;
           if (IndexReg == 0)
             return false;
+          // The stack pointer can't be used as an index.
+          MRI.constrainRegClass(IndexReg, Subtarget->is64Bit() ?
+            (const TargetRegisterClass*)&X86::GR64_NOSPRegClass :
+            (const TargetRegisterClass*)&X86::GR32_NOSPRegClass);
           break;
         }
         // Unsupported.
@@ -1158,6 +1180,82 @@ bool X86FastISel::X86SelectBranch(const Instruction *I) {
   return true;
 }
 
+/// X86SelectSwitch - Lower a small switch to a chain of compares and
+/// branches.  Each compare after the first gets a block of its own right
+/// after the switch block.  SelectionDAGISel only adds PHI operands for
+/// FuncInfo.MBB, so the operands for the new blocks are added here.
+bool X86FastISel::X86SelectSwitch(const Instruction *I) {
+  const SwitchInst *SI = cast<SwitchInst>(I);
+  MachineBasicBlock *DefaultMBB = FuncInfo.MBBMap[SI->getDefaultDest()];
+
+  if (SI->getNumCases() == 0) {
+    FastEmitBranch(DefaultMBB, DL);
+    return true;
+  }
+  if (SI->getNumCases() > MaxFastSwitchCases)
+    return false;
+
+  MVT VT;
+  if (!isTypeLegal(SI->getCondition()->getType(), VT))
+    return false;
+  for (SwitchInst::ConstCaseIt i = SI->case_begin(), e = SI->case_end();
+       i != e; ++i)
+    if (!X86ChooseCmpImmediateOpcode(VT, i.getCaseValue()))
+      return false;
+
+  unsigned CondReg = getRegForValue(SI->getCondition());
+  if (CondReg == 0)
+    return false;
+
+  MachineFunction *MF = FuncInfo.MF;
+  MachineBasicBlock *SwitchMBB = FuncInfo.MBB;
+  MachineFunction::iterator InsertPos = SwitchMBB;
+  ++InsertPos;
+
+  SmallVector<MachineBasicBlock*, 4> NewMBBs;
+  MachineBasicBlock *CurMBB = SwitchMBB;
+  MachineBasicBlock::iterator CurPt = FuncInfo.InsertPt;
+  for (SwitchInst::ConstCaseIt i = SI->case_begin(), e = SI->case_end();
+       i != e; ++i) {
+    const ConstantInt *CaseVal = i.getCaseValue();
+    MachineBasicBlock *CaseMBB = FuncInfo.MBBMap[i.getCaseSuccessor()];
+
+    // Each compare after the first starts a new block, reached by falling
+    // through from the previous one.
+    if (i != SI->case_begin()) {
+      MachineBasicBlock *NextMBB =
+        MF->CreateMachineBasicBlock(SwitchMBB->getBasicBlock());
+      MF->insert(InsertPos, NextMBB);
+      CurMBB->addSuccessor(NextMBB);
+      NewMBBs.push_back(NextMBB);
+      CurMBB = NextMBB;
+      CurPt = NextMBB->end();
+    }
+
+    BuildMI(*CurMBB, CurPt, DL,
+            TII.get(X86ChooseCmpImmediateOpcode(VT, CaseVal)))
+      .addReg(CondReg).addImm(CaseVal->getSExtValue());
+    BuildMI(*CurMBB, CurPt, DL, TII.get(X86::JE_4)).addMBB(CaseMBB);
+    if (!CurMBB->isSuccessor(CaseMBB))
+      CurMBB->addSuccessor(CaseMBB);
+  }
+  BuildMI(*CurMBB, CurPt, DL, TII.get(X86::JMP_4)).addMBB(DefaultMBB);
+  if (!CurMBB->isSuccessor(DefaultMBB))
+    CurMBB->addSuccessor(DefaultMBB);
+
+  for (unsigned i = 0, e = FuncInfo.PHINodesToUpdate.size(); i != e; ++i) {
+    MachineInstr *PHI = FuncInfo.PHINodesToUpdate[i].first;
+    for (unsigned j = 0, je = NewMBBs.size(); j != je; ++j) {
+      if (!NewMBBs[j]->isSuccessor(PHI->getParent()))
+        continue;
+      PHI->addOperand(
+        MachineOperand::CreateReg(FuncInfo.PHINodesToUpdate[i].second, false));
+      PHI->addOperand(MachineOperand::CreateMBB(NewMBBs[j]));
+    }
+  }
+  return true;
+}
+
 bool X86FastISel::X86SelectShift(const Instruction *I) {
   unsigned CReg = 0, OpReg = 0;
   const TargetRegisterClass *RC = NULL;
@@ -1469,6 +1567,9 @@ bool X86FastISel::X86VisitIntrinsicCall(const IntrinsicInst &I) {
     BuildMI(*FuncInfo.MBB, FuncInfo.InsertPt, DL, TII.get(X86::TRAP));
     return true;
   }
+  case Intrinsic::mono_load:
+  case Intrinsic::mono_store:
+    return X86SelectMonoIntrinsic(&I, I.getIntrinsicID());
   case Intrinsic::sadd_with_overflow:
   case Intrinsic::uadd_with_overflow: {
     // FIXME: Should fold immediates.
@@ -1517,6 +1618,34 @@ bool X86FastISel::X86VisitIntrinsicCall(const IntrinsicInst &I) {
   }
 }
 
+/// X86SelectMonoIntrinsic - Emit llvm.mono.load and llvm.mono.store, which
+/// are plain loads and stores that may be invoked.
+bool X86FastISel::X86SelectMonoIntrinsic(const Instruction *I, unsigned IID) {
+  ImmutableCallSite CS(I);
+  MVT VT;
+  X86AddressMode AM;
+
+  if (IID == Intrinsic::mono_load) {
+    if (!isTypeLegal(I->getType(), VT, /*AllowI1=*/true))
+      return false;
+    if (!X86SelectAddress(CS.getArgument(0), AM))
+      return false;
+    unsigned ResultReg = 0;
+    if (!X86FastEmitLoad(VT, AM, ResultReg))
+      return false;
+    UpdateValueMap(I, ResultReg);
+    return true;
+  }
+
+  assert(IID == Intrinsic::mono_store && "Unexpected Mono intrinsic!");
+  const Value *Val = CS.getArgument(0);
+  if (!isTypeLegal(Val->getType(), VT, /*AllowI1=*/true))
+    return false;
+  if (!X86SelectAddress(CS.getArgument(1), AM))
+    return false;
+  return X86FastEmitStore(VT, Val, AM);
+}
+
 bool X86FastISel::X86SelectCall(const Instruction *I) {
   const CallInst *CI = cast<CallInst>(I);
   const Value *Callee = CI->getCalledValue();
@@ -1548,13 +1677,50 @@ static unsigned computeBytesPoppedByCallee(const X86Subtarget &Subtarget,
   return 4;
 }
 
+/// X86SelectInvoke - Emit the call of an invoke between EH labels, then
+/// branch to the normal destination.
+bool X86FastISel::X86SelectInvoke(const Instruction *I) {
+  const InvokeInst *II = cast<InvokeInst>(I);
+
+  // SelectionDAGBuilder keeps the landing pad to call site map that SjLj
+  // exception handling needs.
+  if (FuncInfo.MF->getMMI().getCurrentCallSite())
+    return false;
+
+  const Value *Callee = II->getCalledValue();
+  if (isa<InlineAsm>(Callee))
+    return false;
+
+  MachineBasicBlock *InvokeMBB = FuncInfo.MBB;
+  MachineBasicBlock *Return = FuncInfo.MBBMap[II->getNormalDest()];
+  MachineBasicBlock *LandingPad = FuncInfo.MBBMap[II->getUnwindDest()];
+
+  const Function *Fn = dyn_cast<Function>(Callee);
+  unsigned IID = Fn ? Fn->getIntrinsicID() : 0;
+  if (IID != Intrinsic::donothing) {
+    MachineInstr *Prev = 0;
+    if (FuncInfo.InsertPt != InvokeMBB->begin())
+      Prev = llvm::prior(FuncInfo.InsertPt);
+
+    if (IID == Intrinsic::mono_load || IID == Intrinsic::mono_store) {
+      if (!X86SelectMonoIntrinsic(I, IID))
+        return false;
+    } else if (IID != 0 || !DoSelectCall(I, 0))
+      return false;
+
+    FastEmitTryRange(Prev, LandingPad);
+  }
+
+  FastEmitBranch(Return, DL);
+  InvokeMBB->addSuccessor(LandingPad);
+  return true;
+}
+
 // Select either a call, or an llvm.memcpy/memmove/memset intrinsic
 bool X86FastISel::DoSelectCall(const Instruction *I, const char *MemIntName) {
-  const CallInst *CI = cast<CallInst>(I);
-  const Value *Callee = CI->getCalledValue();
-
   // Handle only C and fastcc calling conventions for now.
-  ImmutableCallSite CS(CI);
+  ImmutableCallSite CS(I);
+  const Value *Callee = CS.getCalledValue();
   CallingConv::ID CC = CS.getCallingConv();
   if (CC != CallingConv::C && CC != CallingConv::Fast &&
       CC != CallingConv::X86_FastCall)
@@ -1976,6 +2142,87 @@ bool X86FastISel::DoSelectCall(const Instruction *I, const char *MemIntName) {
 }
 
 
+/// isScalarType - Return true if Ty is a type whole-function selection
+/// handles: a legal scalar integer, a pointer or an SSE float, or one of the
+/// types without a value.
+bool X86FastISel::isScalarType(Type *Ty) {
+  if (Ty->isVoidTy() || Ty->isLabelTy() || Ty->isMetadataTy())
+    return true;
+  if (PointerType *PTy = dyn_cast<PointerType>(Ty))
+    return PTy->getAddressSpace() == 0;
+  MVT VT;
+  return isTypeLegal(Ty, VT, /*AllowI1=*/true) && !VT.isVector();
+}
+
+bool X86FastISel::canSelectFunction(const Function &F) {
+  if (!Subtarget->is64Bit())
+    return false;
+  for (Function::const_iterator BB = F.begin(), BE = F.end(); BB != BE; ++BB)
+    for (BasicBlock::const_iterator I = BB->begin(), IE = BB->end(); I != IE;
+         ++I) {
+      switch (I->getOpcode()) {
+      default:
+        return false;
+      case Instruction::Alloca:
+        if (!cast<AllocaInst>(I)->isStaticAlloca())
+          return false;
+        break;
+      case Instruction::Load:
+        if (cast<LoadInst>(I)->isAtomic())
+          return false;
+        break;
+      case Instruction::Store:
+        if (cast<StoreInst>(I)->isAtomic())
+          return false;
+        break;
+      case Instruction::Call:
+        if (cast<CallInst>(I)->isInlineAsm())
+          return false;
+        break;
+      case Instruction::Ret:
+      case Instruction::Br:
+      case Instruction::Switch:
+      case Instruction::Unreachable:
+      case Instruction::Add:
+      case Instruction::Sub:
+      case Instruction::Mul:
+      case Instruction::And:
+      case Instruction::Or:
+      case Instruction::Xor:
+      case Instruction::Shl:
+      case Instruction::LShr:
+      case Instruction::AShr:
+      case Instruction::FAdd:
+      case Instruction::FSub:
+      case Instruction::FMul:
+      case Instruction::FDiv:
+      case Instruction::ICmp:
+      case Instruction::FCmp:
+      case Instruction::Select:
+      case Instruction::ZExt:
+      case Instruction::SExt:
+      case Instruction::Trunc:
+      case Instruction::FPExt:
+      case Instruction::FPTrunc:
+      case Instruction::SIToFP:
+      case Instruction::FPToSI:
+      case Instruction::BitCast:
+      case Instruction::IntToPtr:
+      case Instruction::PtrToInt:
+      case Instruction::GetElementPtr:
+      case Instruction::PHI:
+        break;
+      }
+      if (!isScalarType(I->getType()))
+        return false;
+      for (User::const_op_iterator OI = I->op_begin(), OE = I->op_end();
+           OI != OE; ++OI)
+        if (!isScalarType((*OI)->getType()))
+          return false;
+    }
+  return true;
+}
+
 bool
 X86FastISel::TargetSelectInstruction(const Instruction *I)  {
   switch (I->getOpcode()) {
@@ -1993,8 +2240,12 @@ X86FastISel::TargetSelectInstruction(const Instruction *I)  {
     return X86SelectZExt(I);
   case Instruction::Br:
     return X86SelectBranch(I);
+  case Instruction::Switch:
+    return X86SelectSwitch(I);
   case Instruction::Call:
     return X86SelectCall(I);
+  case Instruction::Invoke:
+    return X86SelectInvoke(I);
   case Instruction::LShr:
   case Instruction::AShr:
   case Instruction::Shl:
@@ -119,6 +119,12 @@ static cl::opt<bool>
 X86EarlyIfConv("x86-early-ifcvt",
 	       cl::desc("Enable early if-conversion on X86"));
 
+// The pre-RA machine scheduler is only enabled by default on x86-64 CPUs with
+// a per-instruction machine model. -enable-misched overrides this.
+static cl::opt<bool>
+X86MISched("x86-misched", cl::Hidden, cl::init(true),
+           cl::desc("Enable the machine scheduler on modeled x86-64 CPUs"));
+
 //===----------------------------------------------------------------------===//
 // Pass Pipeline Configuration
 //===----------------------------------------------------------------------===//
@@ -151,6 +157,10 @@ TargetPassConfig *X86TargetMachine::createPassConfig(PassManagerBase &PM) {
   if (X86EarlyIfConv && Subtarget.hasCMov())
     PC->enablePass(&EarlyIfConverterID);
 
+  if (X86MISched && Subtarget.is64Bit() &&
+      Subtarget.getSchedModel()->hasInstrSchedModel())
+    PC->enablePass(&MachineSchedulerID);
+
   return PC;
 }
 
@@ -194,6 +204,13 @@ bool X86PassConfig::addPreEmitPass() {
   return ShouldPrint;
 }
 
+void X86TargetMachine::addAnalysisPasses(PassManagerBase &PM) {
+  // Add the target-independent cost model first so that the X86 one can
+  // forward the queries it does not refine.
+  LLVMTargetMachine::addAnalysisPasses(PM);
+  PM.add(createX86TargetTransformInfoPass(this));
+}
+
 bool X86TargetMachine::addCodeEmitter(PassManagerBase &PM,
                                       JITCodeEmitter &JCE) {
   PM.add(createX86JITCodeEmitterPass(*this, JCE));
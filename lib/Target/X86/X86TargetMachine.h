@@ -69,6 +69,9 @@ public:
     return &InstrItins;
   }
 
+  /// addAnalysisPasses - Register the X86 cost model with a pass manager.
+  virtual void addAnalysisPasses(PassManagerBase &PM);
+
   // Set up the pass pipeline.
   virtual TargetPassConfig *createPassConfig(PassManagerBase &PM);
 
@@ -0,0 +1,323 @@
+//===-- X86TargetTransformInfo.cpp - X86 specific TTI pass ----------------===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+//
+// This file implements a TargetTransformInfo analysis pass specific to the
+// X86 target machine.  It refines the target-independent, TargetLowering
+// based cost model (-basictti) where X86 lowers an operation in a way that
+// its legalization actions do not show, such as 256-bit integer operations
+// that AVX splits into two halves, and answers the register file questions
+// from the subtarget.  Everything else is forwarded down the chain.
+//
+//===----------------------------------------------------------------------===//
+
+#define DEBUG_TYPE "x86tti"
+#include "X86.h"
+#include "X86TargetMachine.h"
+#include "llvm/DerivedTypes.h"
+#include "llvm/Instruction.h"
+#include "llvm/Pass.h"
+#include "llvm/Analysis/TargetTransformInfo.h"
+#include "llvm/Target/TargetLowering.h"
+using namespace llvm;
+
+// Declare the pass initialization routine locally as target-specific passes
+// don't have a target-wide initialization entry point, and so we rely on the
+// pass constructor initialization.
+namespace llvm {
+void initializeX86TTIPass(PassRegistry &);
+}
+
+namespace {
+
+/// X86CostTblEntry - The cost of an IR operation on a legal X86 type.
+struct X86CostTblEntry {
+  unsigned Opcode;
+  MVT::SimpleValueType Type;
+  unsigned Cost;
+};
+
+/// X86CastCostTblEntry - The cost of an IR cast between two legal X86 types.
+struct X86CastCostTblEntry {
+  unsigned Opcode;
+  MVT::SimpleValueType Dst;
+  MVT::SimpleValueType Src;
+  unsigned Cost;
+};
+
+} // end anonymous namespace
+
+/// lookupCost - Return the entry for Opcode and Ty in Tbl, or null.
+template<unsigned N>
+static const X86CostTblEntry *lookupCost(const X86CostTblEntry (&Tbl)[N],
+                                         unsigned Opcode, MVT Ty) {
+  for (unsigned i = 0; i != N; ++i)
+    if (Tbl[i].Opcode == Opcode && Tbl[i].Type == Ty.SimpleTy)
+      return &Tbl[i];
+  return 0;
+}
+
+/// lookupCastCost - Return the entry for Opcode, Dst and Src in Tbl, or null.
+template<unsigned N>
+static const X86CastCostTblEntry *
+lookupCastCost(const X86CastCostTblEntry (&Tbl)[N], unsigned Opcode, MVT Dst,
+               MVT Src) {
+  for (unsigned i = 0; i != N; ++i)
+    if (Tbl[i].Opcode == Opcode && Tbl[i].Dst == Dst.SimpleTy &&
+        Tbl[i].Src == Src.SimpleTy)
+      return &Tbl[i];
+  return 0;
+}
+
+// AVX1 has 256-bit registers but no 256-bit integer instructions; integer
+// operations are split into two 128-bit halves and reassembled.
+static const X86CostTblEntry AVX1CostTable[] = {
+  { Instruction::Add, MVT::v8i32,  4 },
+  { Instruction::Sub, MVT::v8i32,  4 },
+  { Instruction::Mul, MVT::v8i32,  4 },
+  { Instruction::Add, MVT::v4i64,  4 },
+  { Instruction::Sub, MVT::v4i64,  4 },
+  { Instruction::Mul, MVT::v4i64, 12 },
+  { Instruction::Add, MVT::v16i16, 4 },
+  { Instruction::Sub, MVT::v16i16, 4 },
+  { Instruction::Mul, MVT::v16i16, 4 },
+  { Instruction::Add, MVT::v32i8,  4 },
+  { Instruction::Sub, MVT::v32i8,  4 },
+  { Instruction::And, MVT::v8i32,  1 },
+  { Instruction::Or,  MVT::v8i32,  1 },
+  { Instruction::Xor, MVT::v8i32,  1 },
+};
+
+// SSE2 lacks a 32-bit and a 64-bit element multiply; both are built from
+// pmuludq and shuffles.
+static const X86CostTblEntry SSE2CostTable[] = {
+  { Instruction::Mul, MVT::v2i64, 9 },
+  { Instruction::Mul, MVT::v4i32, 6 },
+};
+
+// SSE4.1 adds pmulld.
+static const X86CostTblEntry SSE41CostTable[] = {
+  { Instruction::Mul, MVT::v2i64, 9 },
+  { Instruction::Mul, MVT::v4i32, 1 },
+};
+
+// Compares and selects.  AVX1 splits 256-bit integer compares, and before
+// SSE4.2 a 64-bit element compare is a sequence of 32-bit compares.
+static const X86CostTblEntry AVX1CmpSelCostTable[] = {
+  { Instruction::ICmp,   MVT::v8i32,  4 },
+  { Instruction::ICmp,   MVT::v4i64,  4 },
+  { Instruction::ICmp,   MVT::v16i16, 4 },
+  { Instruction::ICmp,   MVT::v32i8,  4 },
+  { Instruction::FCmp,   MVT::v8f32,  1 },
+  { Instruction::FCmp,   MVT::v4f64,  1 },
+  { Instruction::Select, MVT::v8f32,  1 },
+  { Instruction::Select, MVT::v4f64,  1 },
+  { Instruction::Select, MVT::v8i32,  1 },
+  { Instruction::Select, MVT::v4i64,  1 },
+};
+
+static const X86CostTblEntry SSE42CmpSelCostTable[] = {
+  { Instruction::ICmp, MVT::v2i64, 1 },
+};
+
+static const X86CostTblEntry SSE2CmpSelCostTable[] = {
+  { Instruction::ICmp,   MVT::v2i64, 6 },
+  { Instruction::ICmp,   MVT::v4i32, 1 },
+  { Instruction::ICmp,   MVT::v8i16, 1 },
+  { Instruction::ICmp,   MVT::v16i8, 1 },
+  { Instruction::FCmp,   MVT::v4f32, 1 },
+  { Instruction::FCmp,   MVT::v2f64, 1 },
+  // Without blendv, a select is an and, an andn and an or.
+  { Instruction::Select, MVT::v4f32, 3 },
+  { Instruction::Select, MVT::v2f64, 3 },
+  { Instruction::Select, MVT::v4i32, 3 },
+  { Instruction::Select, MVT::v2i64, 3 },
+};
+
+static const X86CostTblEntry SSE41CmpSelCostTable[] = {
+  { Instruction::Select, MVT::v4f32, 1 },
+  { Instruction::Select, MVT::v2f64, 1 },
+  { Instruction::Select, MVT::v4i32, 1 },
+  { Instruction::Select, MVT::v2i64, 1 },
+};
+
+// Conversions that have a single instruction.
+static const X86CastCostTblEntry AVX1CastCostTable[] = {
+  { Instruction::SIToFP,  MVT::v8f32, MVT::v8i32, 1 },
+  { Instruction::FPToSI,  MVT::v8i32, MVT::v8f32, 1 },
+  { Instruction::SIToFP,  MVT::v4f64, MVT::v4i32, 1 },
+  { Instruction::FPToSI,  MVT::v4i32, MVT::v4f64, 1 },
+  { Instruction::FPExt,   MVT::v4f64, MVT::v4f32, 1 },
+  { Instruction::FPTrunc, MVT::v4f32, MVT::v4f64, 1 },
+  // Extending into a 256-bit integer vector is done in two halves.
+  { Instruction::SExt,    MVT::v8i32, MVT::v8i16, 3 },
+  { Instruction::ZExt,    MVT::v8i32, MVT::v8i16, 3 },
+};
+
+static const X86CastCostTblEntry SSE2CastCostTable[] = {
+  { Instruction::SIToFP,  MVT::v4f32, MVT::v4i32, 1 },
+  { Instruction::FPToSI,  MVT::v4i32, MVT::v4f32, 1 },
+};
+
+namespace {
+
+class X86TTI : public ImmutablePass, public TargetTransformInfo {
+  const X86Subtarget *ST;
+  const X86TargetLowering *TLI;
+
+  /// getSimpleLegalType - Return the type that Ty lives in if it is legal
+  /// and simple, or MVT::Other otherwise.
+  MVT getSimpleLegalType(Type *Ty) const {
+    EVT VT = TLI->getValueType(Ty, true);
+    if (VT == MVT::Other || !VT.isSimple() || !TLI->isTypeLegal(VT))
+      return MVT::Other;
+    return VT.getSimpleVT();
+  }
+
+public:
+  static char ID; // Class identification, replacement for typeinfo
+  X86TTI() : ImmutablePass(ID), ST(0), TLI(0) {
+    llvm_unreachable("This pass cannot be directly constructed");
+  }
+
+  explicit X86TTI(const X86TargetMachine *TM)
+    : ImmutablePass(ID), ST(TM->getSubtargetImpl()),
+      TLI(TM->getTargetLowering()) {
+    initializeX86TTIPass(*PassRegistry::getPassRegistry());
+  }
+
+  virtual void initializePass() {
+    InitializeTargetTransformInfo(this);
+  }
+
+  virtual void getAnalysisUsage(AnalysisUsage &AU) const {
+    TargetTransformInfo::getAnalysisUsage(AU);
+  }
+
+  virtual unsigned getNumberOfRegisters(bool Vector) const;
+  virtual unsigned getRegisterBitWidth(bool Vector) const;
+  virtual unsigned getArithmeticInstrCost(unsigned Opcode, Type *Ty) const;
+  virtual unsigned getCastInstrCost(unsigned Opcode, Type *Dst,
+                                    Type *Src) const;
+  virtual unsigned getCmpSelInstrCost(unsigned Opcode, Type *ValTy,
+                                      Type *CondTy) const;
+  virtual unsigned getVectorInstrCost(unsigned Opcode, Type *Val,
+                                      unsigned Index) const;
+  virtual unsigned getMemoryOpCost(unsigned Opcode, Type *Src,
+                                   unsigned Alignment,
+                                   unsigned AddressSpace) const;
+
+  /// getAdjustedAnalysisPointer - This method is used when a pass implements
+  /// an analysis interface through multiple inheritance.  If needed, it
+  /// should override this to adjust the this pointer as needed for the
+  /// specified pass info.
+  virtual void *getAdjustedAnalysisPointer(const void *ID) {
+    if (ID == &TargetTransformInfo::ID)
+      return (TargetTransformInfo*)this;
+    return this;
+  }
+};
+
+} // end anonymous namespace
+
+INITIALIZE_AG_PASS(X86TTI, TargetTransformInfo, "x86tti",
+                   "X86 Target Transform Info", true, true, false)
+char X86TTI::ID = 0;
+
+ImmutablePass *
+llvm::createX86TargetTransformInfoPass(const X86TargetMachine *TM) {
+  return new X86TTI(TM);
+}
+
+unsigned X86TTI::getNumberOfRegisters(bool Vector) const {
+  if (Vector && !ST->hasSSE1())
+    return 0;
+  return ST->is64Bit() ? 16 : 8;
+}
+
+unsigned X86TTI::getRegisterBitWidth(bool Vector) const {
+  if (Vector) {
+    if (ST->hasAVX())
+      return 256;
+    return ST->hasSSE1() ? 128 : 0;
+  }
+  return ST->is64Bit() ? 64 : 32;
+}
+
+unsigned X86TTI::getArithmeticInstrCost(unsigned Opcode, Type *Ty) const {
+  MVT VT = getSimpleLegalType(Ty);
+  if (VT != MVT::Other) {
+    const X86CostTblEntry *E = 0;
+    if (ST->hasAVX() && !ST->hasAVX2())
+      E = lookupCost(AVX1CostTable, Opcode, VT);
+    if (!E && ST->hasSSE41())
+      E = lookupCost(SSE41CostTable, Opcode, VT);
+    if (!E && ST->hasSSE2())
+      E = lookupCost(SSE2CostTable, Opcode, VT);
+    if (E)
+      return E->Cost;
+  }
+  return TargetTransformInfo::getArithmeticInstrCost(Opcode, Ty);
+}
+
+unsigned X86TTI::getCastInstrCost(unsigned Opcode, Type *Dst,
+                                  Type *Src) const {
+  MVT DstVT = getSimpleLegalType(Dst), SrcVT = getSimpleLegalType(Src);
+  if (DstVT != MVT::Other && SrcVT != MVT::Other) {
+    const X86CastCostTblEntry *E = 0;
+    if (ST->hasAVX())
+      E = lookupCastCost(AVX1CastCostTable, Opcode, DstVT, SrcVT);
+    if (!E && ST->hasSSE2())
+      E = lookupCastCost(SSE2CastCostTable, Opcode, DstVT, SrcVT);
+    if (E)
+      return E->Cost;
+  }
+  return TargetTransformInfo::getCastInstrCost(Opcode, Dst, Src);
+}
+
+unsigned X86TTI::getCmpSelInstrCost(unsigned Opcode, Type *ValTy,
+                                    Type *CondTy) const {
+  MVT VT = getSimpleLegalType(ValTy);
+  if (VT != MVT::Other && VT.isVector()) {
+    const X86CostTblEntry *E = 0;
+    if (ST->hasAVX() && !ST->hasAVX2())
+      E = lookupCost(AVX1CmpSelCostTable, Opcode, VT);
+    if (!E && ST->hasSSE42())
+      E = lookupCost(SSE42CmpSelCostTable, Opcode, VT);
+    if (!E && ST->hasSSE41())
+      E = lookupCost(SSE41CmpSelCostTable, Opcode, VT);
+    if (!E && ST->hasSSE2())
+      E = lookupCost(SSE2CmpSelCostTable, Opcode, VT);
+    if (E)
+      return E->Cost;
+  }
+  return TargetTransformInfo::getCmpSelInstrCost(Opcode, ValTy, CondTy);
+}
+
+unsigned X86TTI::getVectorInstrCost(unsigned Opcode, Type *Val,
+                                    unsigned Index) const {
+  // Lane zero of a floating-point vector is the scalar register itself.
+  if (Index == 0 && Val->getScalarType()->isFloatingPointTy() &&
+      getSimpleLegalType(Val) != MVT::Other)
+    return 0;
+  return TargetTransformInfo::getVectorInstrCost(Opcode, Val, Index);
+}
+
+unsigned X86TTI::getMemoryOpCost(unsigned Opcode, Type *Src,
+                                 unsigned Alignment,
+                                 unsigned AddressSpace) const {
+  unsigned Cost = TargetTransformInfo::getMemoryOpCost(Opcode, Src, Alignment,
+                                                       AddressSpace);
+  // Sandy Bridge and Ivy Bridge split 256-bit accesses that are not known to
+  // be 32-byte aligned into two 128-bit halves.
+  MVT VT = getSimpleLegalType(Src);
+  if (ST->hasAVX() && !ST->hasAVX2() && VT != MVT::Other &&
+      VT.getSizeInBits() == 256 && Alignment && Alignment < 32)
+    return Cost * 2;
+  return Cost;
+}
@@ -0,0 +1,299 @@
+//===- FunctionOrdering.cpp - Order functions for code locality -----------===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+//
+// This pass reorders the functions of a module so that functions which call
+// each other often are emitted next to each other, reducing instruction cache
+// and TLB misses.  It implements the function ordering of Pettis and Hansen,
+// "Profile Guided Code Positioning" (PLDI 1990):
+//
+//   - The call graph is turned into an undirected graph whose edge weights are
+//     the number of calls between two functions.
+//   - The heaviest edge is repeatedly collapsed, merging the chains of
+//     functions at its ends.  The chains are concatenated in the orientation
+//     that puts the two most strongly connected end functions next to each
+//     other, and the edges to the rest of the graph are merged.
+//   - The chains are emitted hottest first, followed by the functions that
+//     are not called from other functions of the module, in their original
+//     order.
+//
+// Call counts come from the ProfileInfo analysis when a profile is loaded
+// (e.g. with -profile-loader), and are estimated from the static block
+// frequencies of the call sites otherwise.
+//
+//===----------------------------------------------------------------------===//
+
+#define DEBUG_TYPE "order-functions"
+#include "llvm/Transforms/IPO.h"
+#include "llvm/Instructions.h"
+#include "llvm/Module.h"
+#include "llvm/Pass.h"
+#include "llvm/Analysis/BlockFrequencyInfo.h"
+#include "llvm/Analysis/ProfileInfo.h"
+#include "llvm/Support/CallSite.h"
+#include "llvm/Support/Debug.h"
+#include "llvm/Support/raw_ostream.h"
+#include "llvm/ADT/DenseMap.h"
+#include "llvm/ADT/SmallVector.h"
+#include "llvm/ADT/Statistic.h"
+#include <algorithm>
+#include <queue>
+using namespace llvm;
+
+STATISTIC(NumChains, "Number of function chains formed");
+STATISTIC(NumMoved, "Number of functions that changed position");
+
+namespace {
+  /// FunctionChain - A sequence of functions to be emitted contiguously.
+  struct FunctionChain {
+    SmallVector<Function*, 4> Functions;
+    /// Weight - The total weight of the edges collapsed into this chain.
+    uint64_t Weight;
+    /// Index - The position of the first function in the original order,
+    /// used to keep the sort stable.
+    unsigned Index;
+    /// Edges - The weights of the edges to other live chains.
+    DenseMap<unsigned, uint64_t> Edges;
+    bool Dead;
+
+    FunctionChain(Function *F, unsigned Index)
+      : Functions(1, F), Weight(0), Index(Index), Dead(false) {}
+  };
+
+  /// ChainEdge - A candidate edge for collapsing.  Entries whose weight no
+  /// longer matches the current edge weight are stale and skipped.
+  struct ChainEdge {
+    uint64_t Weight;
+    unsigned From, To;
+    ChainEdge(uint64_t Weight, unsigned From, unsigned To)
+      : Weight(Weight), From(From), To(To) {}
+    bool operator<(const ChainEdge &RHS) const {
+      if (Weight != RHS.Weight)
+        return Weight < RHS.Weight;
+      // Prefer the edges between functions that come first in the module.
+      if (From != RHS.From)
+        return From > RHS.From;
+      return To > RHS.To;
+    }
+  };
+
+  class FunctionOrdering : public ModulePass {
+    typedef std::pair<Function*, Function*> FunctionPair;
+
+    /// CallWeights - The number of calls between each pair of functions, in
+    /// both directions, keyed with the lower address first.
+    DenseMap<FunctionPair, uint64_t> CallWeights;
+
+    std::vector<FunctionChain> Chains;
+    std::priority_queue<ChainEdge> Worklist;
+
+    uint64_t getCallWeight(Function *A, Function *B) const {
+      if (B < A)
+        std::swap(A, B);
+      DenseMap<FunctionPair, uint64_t>::const_iterator I =
+        CallWeights.find(std::make_pair(A, B));
+      return I == CallWeights.end() ? 0 : I->second;
+    }
+
+    void collectCallWeights(Module &M);
+    void mergeChains(unsigned Into, unsigned From);
+
+  public:
+    static char ID; // Pass identification, replacement for typeid
+    FunctionOrdering() : ModulePass(ID) {
+      initializeFunctionOrderingPass(*PassRegistry::getPassRegistry());
+    }
+
+    virtual bool runOnModule(Module &M);
+
+    virtual void getAnalysisUsage(AnalysisUsage &AU) const {
+      AU.addRequired<ProfileInfo>();
+      AU.addRequired<BlockFrequencyInfo>();
+      AU.setPreservesAll();
+    }
+  };
+}
+
+char FunctionOrdering::ID = 0;
+INITIALIZE_PASS_BEGIN(FunctionOrdering, "order-functions",
+                      "Order functions for code locality", false, false)
+INITIALIZE_AG_DEPENDENCY(ProfileInfo)
+INITIALIZE_PASS_DEPENDENCY(BlockFrequencyInfo)
+INITIALIZE_PASS_END(FunctionOrdering, "order-functions",
+                    "Order functions for code locality", false, false)
+
+ModulePass *llvm::createFunctionOrderingPass() {
+  return new FunctionOrdering();
+}
+
+/// collectCallWeights - Sum the weights of the direct calls between the
+/// functions defined in M.  With a profile, the weight of a call site is the
+/// number of times its block ran; without one, it is the static frequency of
+/// its block relative to the function entry (in units of 1/1024 calls).
+void FunctionOrdering::collectCallWeights(Module &M) {
+  ProfileInfo &PI = getAnalysis<ProfileInfo>();
+  bool HasProfile = false;
+  for (Module::iterator F = M.begin(), E = M.end(); F != E; ++F)
+    if (!F->isDeclaration() &&
+        PI.getExecutionCount(F) != ProfileInfo::MissingValue) {
+      HasProfile = true;
+      break;
+    }
+
+  for (Module::iterator F = M.begin(), E = M.end(); F != E; ++F) {
+    if (F->isDeclaration())
+      continue;
+    BlockFrequencyInfo *BFI = 0;
+    if (!HasProfile)
+      BFI = &getAnalysis<BlockFrequencyInfo>(*F);
+
+    for (Function::iterator BB = F->begin(), BE = F->end(); BB != BE; ++BB) {
+      uint64_t BlockWeight = 0;
+      bool Computed = false;
+      for (BasicBlock::iterator I = BB->begin(), IE = BB->end(); I != IE; ++I) {
+        CallSite CS(cast<Value>(I));
+        if (!CS)
+          continue;
+        Function *Callee = CS.getCalledFunction();
+        if (!Callee || Callee->isDeclaration() || Callee == F)
+          continue;
+
+        if (!Computed) {
+          Computed = true;
+          if (HasProfile) {
+            double Count = PI.getExecutionCount(BB);
+            BlockWeight = Count > 0 ? (uint64_t)Count : 0;
+          } else {
+            BlockWeight = BFI->getBlockFreq(BB).getFrequency();
+          }
+        }
+        if (!BlockWeight)
+          break;
+
+        Function *A = F, *B = Callee;
+        if (B < A)
+          std::swap(A, B);
+        CallWeights[std::make_pair(A, B)] += BlockWeight;
+      }
+    }
+  }
+}
+
+/// mergeChains - Append the chain From to the chain Into, in the orientation
+/// that puts the most strongly connected pair of end functions next to each
+/// other, and redirect the edges of From to Into.
+void FunctionOrdering::mergeChains(unsigned Into, unsigned From) {
+  FunctionChain &A = Chains[Into], &B = Chains[From];
+  uint64_t AB = getCallWeight(A.Functions.back(), B.Functions.front());
+  uint64_t ARevB = getCallWeight(A.Functions.back(), B.Functions.back());
+  uint64_t RevAB = getCallWeight(A.Functions.front(), B.Functions.front());
+  uint64_t BA = getCallWeight(A.Functions.front(), B.Functions.back());
+  uint64_t Best = std::max(std::max(AB, ARevB), std::max(RevAB, BA));
+
+  if (AB == Best) {
+    // A followed by B.
+  } else if (ARevB == Best) {
+    std::reverse(B.Functions.begin(), B.Functions.end());
+  } else if (RevAB == Best) {
+    std::reverse(A.Functions.begin(), A.Functions.end());
+  } else {
+    std::swap(A.Functions, B.Functions);
+  }
+  A.Functions.append(B.Functions.begin(), B.Functions.end());
+  A.Weight += B.Weight + A.Edges[From];
+  A.Index = std::min(A.Index, B.Index);
+  A.Edges.erase(From);
+
+  for (DenseMap<unsigned, uint64_t>::iterator I = B.Edges.begin(),
+       E = B.Edges.end(); I != E; ++I) {
+    if (I->first == Into)
+      continue;
+    FunctionChain &C = Chains[I->first];
+    uint64_t W = A.Edges[I->first] += I->second;
+    C.Edges.erase(From);
+    C.Edges[Into] = W;
+    Worklist.push(ChainEdge(W, std::min(Into, I->first),
+                            std::max(Into, I->first)));
+  }
+  B.Functions.clear();
+  B.Edges.clear();
+  B.Dead = true;
+}
+
+/// ChainOrder - Hottest chains first, then the original order.
+static bool ChainOrder(const FunctionChain *L, const FunctionChain *R) {
+  if (L->Weight != R->Weight)
+    return L->Weight > R->Weight;
+  return L->Index < R->Index;
+}
+
+bool FunctionOrdering::runOnModule(Module &M) {
+  collectCallWeights(M);
+  if (CallWeights.empty())
+    return false;
+
+  DenseMap<Function*, unsigned> ChainFor;
+  for (Module::iterator F = M.begin(), E = M.end(); F != E; ++F)
+    if (!F->isDeclaration()) {
+      ChainFor[F] = Chains.size();
+      Chains.push_back(FunctionChain(F, Chains.size()));
+    }
+
+  for (DenseMap<FunctionPair, uint64_t>::iterator I = CallWeights.begin(),
+       E = CallWeights.end(); I != E; ++I) {
+    unsigned A = ChainFor[I->first.first], B = ChainFor[I->first.second];
+    if (A > B)
+      std::swap(A, B);
+    Chains[A].Edges[B] = I->second;
+    Chains[B].Edges[A] = I->second;
+    Worklist.push(ChainEdge(I->second, A, B));
+  }
+
+  while (!Worklist.empty()) {
+    ChainEdge Edge = Worklist.top();
+    Worklist.pop();
+    FunctionChain &From = Chains[Edge.From];
+    if (From.Dead || Chains[Edge.To].Dead)
+      continue;
+    DenseMap<unsigned, uint64_t>::iterator I = From.Edges.find(Edge.To);
+    if (I == From.Edges.end() || I->second != Edge.Weight)
+      continue;
+    DEBUG(dbgs() << "Merging chains of " << From.Functions.front()->getName()
+                 << " and " << Chains[Edge.To].Functions.front()->getName()
+                 << " (weight " << Edge.Weight << ")\n");
+    mergeChains(Edge.From, Edge.To);
+  }
+
+  SmallVector<FunctionChain*, 16> Order;
+  for (unsigned i = 0, e = Chains.size(); i != e; ++i)
+    if (!Chains[i].Dead) {
+      Order.push_back(&Chains[i]);
+      if (Chains[i].Functions.size() > 1)
+        ++NumChains;
+    }
+  std::stable_sort(Order.begin(), Order.end(), ChainOrder);
+
+  // Move the defined functions to the end of the function list in their new
+  // order; declarations stay where they are.
+  Module::FunctionListType &FL = M.getFunctionList();
+  unsigned Position = 0;
+  bool Changed = false;
+  for (unsigned i = 0, e = Order.size(); i != e; ++i)
+    for (unsigned j = 0, je = Order[i]->Functions.size(); j != je; ++j) {
+      Function *F = Order[i]->Functions[j];
+      if (ChainFor[F] != Position++) {
+        ++NumMoved;
+        Changed = true;
+      }
+      FL.splice(FL.end(), FL, F);
+    }
+
+  CallWeights.clear();
+  Chains.clear();
+  return Changed;
+}
@@ -19,6 +19,7 @@
 #include "llvm/IntrinsicInst.h"
 #include "llvm/Analysis/CallGraph.h"
 #include "llvm/Analysis/InlineCost.h"
+#include "llvm/Analysis/ProfileInfo.h"
 #include "llvm/Target/TargetData.h"
 #include "llvm/Target/TargetLibraryInfo.h"
 #include "llvm/Transforms/IPO/InlinerPass.h"
@@ -27,6 +28,7 @@
 #include "llvm/Support/CallSite.h"
 #include "llvm/Support/CommandLine.h"
 #include "llvm/Support/Debug.h"
+#include "llvm/Support/Format.h"
 #include "llvm/Support/raw_ostream.h"
 #include "llvm/ADT/SmallPtrSet.h"
 #include "llvm/ADT/Statistic.h"
@@ -36,6 +38,8 @@ STATISTIC(NumInlined, "Number of functions inlined");
 STATISTIC(NumCallsDeleted, "Number of call sites deleted, not inlined");
 STATISTIC(NumDeleted, "Number of functions deleted because all callers found");
 STATISTIC(NumMergedAllocas, "Number of allocas merged together");
+STATISTIC(NumHotInlined, "Number of profile-hot call sites inlined");
+STATISTIC(NumColdNotInlined, "Number of profile-cold call sites not inlined");
 
 // This weirdly named statistic tracks the number of times that, when attempting
 // to inline a function A into B, we analyze the callers of B in order to see
@@ -50,21 +54,40 @@ static cl::opt<int>
 HintThreshold("inlinehint-threshold", cl::Hidden, cl::init(325),
               cl::desc("Threshold for inlining functions with inline hint"));
 
+static cl::opt<int>
+HotCallSiteThreshold("inlinehot-threshold", cl::Hidden, cl::init(750),
+  cl::desc("Threshold for inlining call sites that are hot in the loaded "
+           "profile"));
+
+static cl::opt<int>
+ColdCallSiteThreshold("inlinecold-threshold", cl::Hidden, cl::init(45),
+  cl::desc("Threshold for inlining call sites that are cold in the loaded "
+           "profile"));
+
+static cl::opt<bool>
+PrintInlineDecisions("print-inline-decisions", cl::Hidden,
+  cl::desc("Print the cost, threshold and profile count behind each "
+           "inlining decision"));
+
 // Threshold to use when optsize is specified (and there is no -inline-limit).
 const int OptSizeThreshold = 75;
 
 Inliner::Inliner(char &ID) 
-  : CallGraphSCCPass(ID), InlineThreshold(InlineLimit), InsertLifetime(true) {}
+  : CallGraphSCCPass(ID), InlineThreshold(InlineLimit), InsertLifetime(true),
+    PI(0), MaxBlockCount(-1) {}
 
 Inliner::Inliner(char &ID, int Threshold, bool InsertLifetime)
   : CallGraphSCCPass(ID), InlineThreshold(InlineLimit.getNumOccurrences() > 0 ?
                                           InlineLimit : Threshold),
-    InsertLifetime(InsertLifetime) {}
+    InsertLifetime(InsertLifetime), PI(0), MaxBlockCount(-1) {}
 
 /// getAnalysisUsage - For this class, we declare that we require and preserve
-/// the call graph.  If the derived class implements this method, it should
-/// always explicitly call the implementation here.
+/// the call graph, and that we read the profile information.  Without a
+/// profile loaded this is the no-op default implementation.  If the derived
+/// class implements this method, it should always explicitly call the
+/// implementation here.
 void Inliner::getAnalysisUsage(AnalysisUsage &Info) const {
+  Info.addRequired<ProfileInfo>();
   CallGraphSCCPass::getAnalysisUsage(Info);
 }
 
@@ -221,14 +244,87 @@ unsigned Inliner::getInlineThreshold(CallSite CS) const {
   if (InlineHint && HintThreshold > thres)
     thres = HintThreshold;
 
+  // Listen to the profile: grow hot call sites more eagerly, and do not grow
+  // code for cold ones even if the callee asks to be inlined.
+  switch (getCallSiteHotness(CS)) {
+  case HotCallSite:
+    if (HotCallSiteThreshold > thres)
+      thres = HotCallSiteThreshold;
+    break;
+  case ColdCallSite:
+    if (ColdCallSiteThreshold < thres)
+      thres = ColdCallSiteThreshold;
+    break;
+  case NormalCallSite:
+    break;
+  }
+
   return thres;
 }
 
+double Inliner::getCallSiteCount(CallSite CS) const {
+  Instruction *Call = CS.getInstruction();
+  DenseMap<const Instruction*, double>::const_iterator I =
+    CallSiteCounts.find(Call);
+  if (I != CallSiteCounts.end())
+    return I->second;
+  // Call sites outside the current SCC have not been touched by this pass, so
+  // their blocks still carry their counts.
+  if (PI)
+    return PI->getExecutionCount(Call->getParent());
+  return ProfileInfo::MissingValue;
+}
+
+Inliner::CallSiteHotness Inliner::getCallSiteHotness(CallSite CS) const {
+  if (MaxBlockCount <= 0)
+    return NormalCallSite;
+
+  double Count = getCallSiteCount(CS);
+  if (Count == ProfileInfo::MissingValue)
+    return NormalCallSite;
+
+  if (Count * InlineConstants::HotCallSiteRatio >= MaxBlockCount)
+    return HotCallSite;
+  if (Count * InlineConstants::ColdCallSiteRatio < MaxBlockCount)
+    return ColdCallSite;
+  return NormalCallSite;
+}
+
 /// shouldInline - Return true if the inliner should attempt to inline
 /// at the given CallSite.
 bool Inliner::shouldInline(CallSite CS) {
   InlineCost IC = getInlineCost(CS);
-  
+  bool Inline = isInlineProfitable(CS, IC);
+
+  CallSiteHotness Hotness = getCallSiteHotness(CS);
+  if (Inline && Hotness == HotCallSite)
+    ++NumHotInlined;
+  else if (!Inline && Hotness == ColdCallSite)
+    ++NumColdNotInlined;
+
+  if (PrintInlineDecisions) {
+    errs() << (Inline ? "inline: " : "no inline: ")
+           << CS.getCaller()->getName() << " -> "
+           << CS.getCalledFunction()->getName() << ", count=";
+    double Count = getCallSiteCount(CS);
+    if (Count != ProfileInfo::MissingValue)
+      errs() << format("%.0f", Count);
+    else
+      errs() << "?";
+    errs() << (Hotness == HotCallSite ? " (hot)" :
+               Hotness == ColdCallSite ? " (cold)" : "");
+    if (IC.isAlways())
+      errs() << ", cost=always\n";
+    else if (IC.isNever())
+      errs() << ", cost=never\n";
+    else
+      errs() << ", cost=" << IC.getCost()
+             << ", thres=" << (IC.getCostDelta() + IC.getCost()) << "\n";
+  }
+  return Inline;
+}
+
+bool Inliner::isInlineProfitable(CallSite CS, InlineCost IC) {
   if (IC.isAlways()) {
     DEBUG(dbgs() << "    Inlining: cost=always"
           << ", Call: " << *CS.getInstruction() << "\n");
@@ -342,6 +438,17 @@ bool Inliner::runOnSCC(CallGraphSCC &SCC) {
   CallGraph &CG = getAnalysis<CallGraph>();
   const TargetData *TD = getAnalysisIfAvailable<TargetData>();
   const TargetLibraryInfo *TLI = getAnalysisIfAvailable<TargetLibraryInfo>();
+  PI = &getAnalysis<ProfileInfo>();
+
+  // The first time through, find the hottest block of the module; call sites
+  // are hot or cold relative to it.
+  if (MaxBlockCount < 0) {
+    MaxBlockCount = 0;
+    Module &M = CG.getModule();
+    for (Module::iterator F = M.begin(), FE = M.end(); F != FE; ++F)
+      for (Function::iterator BB = F->begin(), BE = F->end(); BB != BE; ++BB)
+        MaxBlockCount = std::max(MaxBlockCount, PI->getExecutionCount(BB));
+  }
 
   SmallPtrSet<Function*, 8> SCCFunctions;
   DEBUG(dbgs() << "Inliner visiting SCC:");
@@ -389,6 +496,14 @@ bool Inliner::runOnSCC(CallGraphSCC &SCC) {
   // If there are no calls in this function, exit early.
   if (CallSites.empty())
     return false;
+
+  // Record the profile counts of the call sites before inlining splits their
+  // blocks.
+  CallSiteCounts.clear();
+  for (unsigned i = 0, e = CallSites.size(); i != e; ++i) {
+    Instruction *Call = CallSites[i].first.getInstruction();
+    CallSiteCounts[Call] = PI->getExecutionCount(Call->getParent());
+  }
   
   // Now that we have all of the call sites, move the ones to functions in the
   // current SCC to the end of the list.
@@ -465,6 +580,8 @@ bool Inliner::runOnSCC(CallGraphSCC &SCC) {
                i != e; ++i) {
             Value *Ptr = InlineInfo.InlinedCalls[i];
             CallSites.push_back(std::make_pair(CallSite(Ptr), NewHistoryID));
+            // The profile has no counts for the blocks cloned from Callee.
+            CallSiteCounts[cast<Instruction>(Ptr)] = ProfileInfo::MissingValue;
           }
         }
       }
@@ -494,7 +611,9 @@ bool Inliner::runOnSCC(CallGraphSCC &SCC) {
       // Remove this call site from the list.  If possible, use 
       // swap/pop_back for efficiency, but do not use it if doing so would
       // move a call site to a function in this SCC before the
-      // 'FirstCallInSCC' barrier.
+      // 'FirstCallInSCC' barrier.  The call has been deleted, so forget its
+      // count before another instruction can take its address.
+      CallSiteCounts.erase(CS.getInstruction());
       if (SCC.isSingular()) {
         CallSites[CSi] = CallSites.back();
         CallSites.pop_back();
@@ -508,6 +627,7 @@ bool Inliner::runOnSCC(CallGraphSCC &SCC) {
     }
   } while (LocalChange);
 
+  CallSiteCounts.clear();
   return Changed;
 }
 
@@ -35,6 +35,14 @@ using namespace llvm;
 static cl::opt<bool>
 RunVectorization("vectorize", cl::desc("Run vectorization passes"));
 
+static cl::opt<bool>
+RunLoopVectorization("vectorize-loops",
+                     cl::desc("Run the Loop vectorization passes"));
+
+static cl::opt<bool>
+RunSLPVectorization("vectorize-slp",
+                    cl::desc("Run the SLP vectorization passes"));
+
 static cl::opt<bool>
 UseGVNAfterVectorization("use-gvn-after-vectorization",
   cl::init(false), cl::Hidden,
@@ -53,6 +61,8 @@ PassManagerBuilder::PassManagerBuilder() {
     DisableUnitAtATime = false;
     DisableUnrollLoops = false;
     Vectorize = RunVectorization;
+    LoopVectorize = RunLoopVectorization;
+    SLPVectorize = RunSLPVectorization;
 }
 
 PassManagerBuilder::~PassManagerBuilder() {
@@ -176,6 +186,10 @@ void PassManagerBuilder::populateModulePassManager(PassManagerBase &MPM) {
   MPM.add(createIndVarSimplifyPass());        // Canonicalize indvars
   MPM.add(createLoopIdiomPass());             // Recognize idioms like memset.
   MPM.add(createLoopDeletionPass());          // Delete dead loops
+  if (LoopVectorize && OptLevel > 1) {
+    MPM.add(createLoopVectorizePass());       // Vectorize innermost loops
+    MPM.add(createLICMPass());                // Hoist the runtime checks
+  }
   if (!DisableUnrollLoops)
     MPM.add(createLoopUnrollPass());          // Unroll small loops
   addExtensionsToPM(EP_LoopOptimizerEnd, MPM);
@@ -194,6 +208,11 @@ void PassManagerBuilder::populateModulePassManager(PassManagerBase &MPM) {
 
   addExtensionsToPM(EP_ScalarOptimizerLate, MPM);
 
+  if (SLPVectorize && OptLevel > 1) {
+    MPM.add(createSLPVectorizerPass());       // Vectorize parallel scalar chains
+    MPM.add(createInstructionCombiningPass());
+  }
+
   if (Vectorize) {
     MPM.add(createBBVectorizePass());
     MPM.add(createInstructionCombiningPass());
@@ -74,6 +74,9 @@ class LLVM_LIBRARY_VISIBILITY InstCombiner
   TargetData *TD;
   TargetLibraryInfo *TLI;
   bool MadeIRChange;
+  /// NumVisits - The instructions visited in this function so far, checked
+  /// against the -instcombine-max-visits budget.
+  unsigned NumVisits;
 public:
   /// Worklist - All of the instructions that need to be simplified.
   InstCombineWorklist Worklist;
@@ -84,7 +87,7 @@ public:
   BuilderTy *Builder;
       
   static char ID; // Pass identification, replacement for typeid
-  InstCombiner() : FunctionPass(ID), TD(0), Builder(0) {
+  InstCombiner() : FunctionPass(ID), TD(0), NumVisits(0), Builder(0) {
     initializeInstCombinerPass(*PassRegistry::getPassRegistry());
   }
 
@@ -91,6 +91,12 @@ public:
   }
   
   
+  /// Clear - Drop the pending instructions without visiting them.
+  void Clear() {
+    Worklist.clear();
+    WorklistMap.clear();
+  }
+
   /// Zap - check that the worklist is empty and nuke the backing store for
   /// the map if it is large.
   void Zap() {
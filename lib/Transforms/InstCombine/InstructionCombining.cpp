@@ -44,6 +44,7 @@
 #include "llvm/Target/TargetLibraryInfo.h"
 #include "llvm/Transforms/Utils/Local.h"
 #include "llvm/Support/CFG.h"
+#include "llvm/Support/CommandLine.h"
 #include "llvm/Support/Debug.h"
 #include "llvm/Support/GetElementPtrTypeIterator.h"
 #include "llvm/Support/PatternMatch.h"
@@ -64,6 +65,25 @@ STATISTIC(NumSunkInst , "Number of instructions sunk");
 STATISTIC(NumExpand,    "Number of expansions");
 STATISTIC(NumFactor   , "Number of factorizations");
 STATISTIC(NumReassoc  , "Number of reassociations");
+STATISTIC(NumIterationLimitHits,
+          "Number of functions that hit the iteration limit");
+STATISTIC(NumVisitLimitHits,
+          "Number of functions that hit the visit budget");
+
+// Compile-time budgets.  Each iteration revisits every instruction of the
+// function, so on huge generated functions the fixpoint can take a very long
+// time to reach; past these limits the function is left partially combined.
+static cl::opt<unsigned>
+MaxIterations("instcombine-max-iterations", cl::Hidden,
+              cl::desc("Maximum number of instcombine iterations per "
+                       "function"),
+              cl::init(1000));
+
+static cl::opt<unsigned>
+MaxVisits("instcombine-max-visits", cl::Hidden,
+          cl::desc("Maximum number of instructions instcombine visits per "
+                   "function (0 = unlimited)"),
+          cl::init(0));
 
 // Initialization Routines
 void llvm::initializeInstCombine(PassRegistry &Registry) {
@@ -2002,6 +2022,14 @@ bool InstCombiner::DoOneIteration(Function &F, unsigned Iteration) {
     Instruction *I = Worklist.RemoveOne();
     if (I == 0) continue;  // skip null values.
 
+    if (MaxVisits && NumVisits >= MaxVisits) {
+      DEBUG(errs() << "IC: Visit budget exhausted in " << F.getName() << '\n');
+      ++NumVisitLimitHits;
+      Worklist.Clear();
+      break;
+    }
+    ++NumVisits;
+
     // Check to see if we can DCE the instruction.
     if (isInstructionTriviallyDead(I, TLI)) {
       DEBUG(errs() << "IC: DCE: " << *I << '\n');
@@ -2136,10 +2164,20 @@ bool InstCombiner::runOnFunction(Function &F) {
   // by instcombiner.
   EverMadeChange = LowerDbgDeclare(F);
 
-  // Iterate while there is work to do.
+  // Iterate while there is work to do, within the compile-time budgets.
+  NumVisits = 0;
   unsigned Iteration = 0;
-  while (DoOneIteration(F, Iteration++))
+  while (DoOneIteration(F, Iteration++)) {
     EverMadeChange = true;
+    if (MaxVisits && NumVisits >= MaxVisits)
+      break;
+    if (Iteration >= MaxIterations) {
+      DEBUG(errs() << "IC: Iteration limit reached in " << F.getName()
+                   << '\n');
+      ++NumIterationLimitHits;
+      break;
+    }
+  }
 
   Builder = 0;
   return EverMadeChange;
@@ -30,6 +30,7 @@
 #include "llvm/Analysis/Dominators.h"
 #include "llvm/Analysis/InstructionSimplify.h"
 #include "llvm/Analysis/ProfileInfo.h"
+#include "llvm/Analysis/TargetTransformInfo.h"
 #include "llvm/Assembly/Writer.h"
 #include "llvm/Support/CallSite.h"
 #include "llvm/Support/CommandLine.h"
@@ -75,8 +76,11 @@ static cl::opt<bool> DisableSelectToBranch(
 namespace {
   class CodeGenPrepare : public FunctionPass {
     /// TLI - Keep a pointer of a TargetLowering to consult for determining
-    /// transformation profitability.
+    /// what the target can lower.
     const TargetLowering *TLI;
+    /// TTI - The target's cost model, if one is available, to consult for
+    /// determining transformation profitability.
+    const TargetTransformInfo *TTI;
     const TargetLibraryInfo *TLInfo;
     DominatorTree *DT;
     ProfileInfo *PFI;
@@ -113,6 +117,22 @@ namespace {
     }
 
   private:
+    /// isTruncateFree - Return true if truncating a value of type Src to Dst
+    /// costs nothing on the target.  Requires TLI.
+    bool isTruncateFree(Type *Src, Type *Dst) const {
+      if (TTI)
+        return TTI->getCastInstrCost(Instruction::Trunc, Dst, Src) == 0;
+      return TLI->isTruncateFree(Src, Dst);
+    }
+
+    /// isTypeLegal - Return true if values of type Ty live in a register of
+    /// the target.  Requires TLI.
+    bool isTypeLegal(Type *Ty) const {
+      if (TTI)
+        return TTI->isTypeLegal(Ty);
+      return TLI->isTypeLegal(TLI->getValueType(Ty));
+    }
+
     bool EliminateFallThrough(Function &F);
     bool EliminateMostlyEmptyBlocks(Function &F);
     bool CanMergeBlocks(const BasicBlock *BB, const BasicBlock *DestBB) const;
@@ -147,6 +167,7 @@ bool CodeGenPrepare::runOnFunction(Function &F) {
 
   ModifiedDT = false;
   TLInfo = &getAnalysis<TargetLibraryInfo>();
+  TTI = getAnalysisIfAvailable<TargetTransformInfo>();
   DT = getAnalysisIfAvailable<DominatorTree>();
   PFI = getAnalysisIfAvailable<ProfileInfo>();
   OptSize = F.getFnAttributes().hasOptimizeForSizeAttr();
@@ -1062,9 +1083,8 @@ bool CodeGenPrepare::MoveExtToFormExtLoad(Instruction *I) {
   // If the load has other users and the truncate is not free, this probably
   // isn't worthwhile.
   if (!LI->hasOneUse() &&
-      TLI && (TLI->isTypeLegal(TLI->getValueType(LI->getType())) ||
-              !TLI->isTypeLegal(TLI->getValueType(I->getType()))) &&
-      !TLI->isTruncateFree(I->getType(), LI->getType()))
+      TLI && (isTypeLegal(LI->getType()) || !isTypeLegal(I->getType())) &&
+      !isTruncateFree(I->getType(), LI->getType()))
     return false;
 
   // Check whether the target supports casts folded into loads.
@@ -1096,7 +1116,7 @@ bool CodeGenPrepare::OptimizeExtUses(Instruction *I) {
     return false;
 
   // Only do this xform if truncating is free.
-  if (TLI && !TLI->isTruncateFree(I->getType(), Src->getType()))
+  if (TLI && !isTruncateFree(I->getType(), Src->getType()))
     return false;
 
   // Only safe to perform the optimization if the source is also defined in
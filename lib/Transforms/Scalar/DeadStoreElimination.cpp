@@ -28,10 +28,12 @@
 #include "llvm/Analysis/Dominators.h"
 #include "llvm/Analysis/MemoryBuiltins.h"
 #include "llvm/Analysis/MemoryDependenceAnalysis.h"
+#include "llvm/Analysis/MemorySSA.h"
 #include "llvm/Analysis/ValueTracking.h"
 #include "llvm/Target/TargetData.h"
 #include "llvm/Target/TargetLibraryInfo.h"
 #include "llvm/Transforms/Utils/Local.h"
+#include "llvm/Support/CommandLine.h"
 #include "llvm/Support/Debug.h"
 #include "llvm/ADT/SetVector.h"
 #include "llvm/ADT/Statistic.h"
@@ -41,21 +43,30 @@ using namespace llvm;
 STATISTIC(NumFastStores, "Number of stores deleted");
 STATISTIC(NumFastOther , "Number of other instrs removed");
 
+// Find the earlier writes to a stored location by walking the MemorySSA def
+// chain, which only visits the writes of the block and the reads hanging off
+// them, instead of scanning every instruction with memory dependence queries.
+static cl::opt<bool>
+EnableDSEMemorySSA("enable-dse-memoryssa", cl::init(false), cl::Hidden,
+                   cl::desc("Use MemorySSA to find overwritten stores in DSE"));
+
 namespace {
   struct DSE : public FunctionPass {
     AliasAnalysis *AA;
     MemoryDependenceAnalysis *MD;
+    MemorySSA *MSSA;
     DominatorTree *DT;
     const TargetLibraryInfo *TLI;
 
     static char ID; // Pass identification, replacement for typeid
-    DSE() : FunctionPass(ID), AA(0), MD(0), DT(0) {
+    DSE() : FunctionPass(ID), AA(0), MD(0), MSSA(0), DT(0) {
       initializeDSEPass(*PassRegistry::getPassRegistry());
     }
 
     virtual bool runOnFunction(Function &F) {
       AA = &getAnalysis<AliasAnalysis>();
       MD = &getAnalysis<MemoryDependenceAnalysis>();
+      MSSA = EnableDSEMemorySSA ? &getAnalysis<MemorySSA>() : 0;
       DT = &getAnalysis<DominatorTree>();
       TLI = AA->getTargetLibraryInfo();
 
@@ -66,11 +77,13 @@ namespace {
         if (DT->isReachableFromEntry(I))
           Changed |= runOnBasicBlock(*I);
 
-      AA = 0; MD = 0; DT = 0;
+      AA = 0; MD = 0; MSSA = 0; DT = 0;
       return Changed;
     }
 
     bool runOnBasicBlock(BasicBlock &BB);
+    MemDepResult getMemorySSADependency(Instruction *Inst,
+                                        const AliasAnalysis::Location &Loc);
     bool HandleFree(CallInst *F);
     bool handleEndBlock(BasicBlock &BB);
     void RemoveAccessedObjects(const AliasAnalysis::Location &LoadedLoc,
@@ -84,6 +97,10 @@ namespace {
       AU.addPreserved<AliasAnalysis>();
       AU.addPreserved<DominatorTree>();
       AU.addPreserved<MemoryDependenceAnalysis>();
+      if (EnableDSEMemorySSA) {
+        AU.addRequired<MemorySSA>();
+        AU.addPreserved<MemorySSA>();
+      }
     }
   };
 }
@@ -92,6 +109,7 @@ char DSE::ID = 0;
 INITIALIZE_PASS_BEGIN(DSE, "dse", "Dead Store Elimination", false, false)
 INITIALIZE_PASS_DEPENDENCY(DominatorTree)
 INITIALIZE_PASS_DEPENDENCY(MemoryDependenceAnalysis)
+INITIALIZE_PASS_DEPENDENCY(MemorySSA)
 INITIALIZE_AG_DEPENDENCY(AliasAnalysis)
 INITIALIZE_PASS_END(DSE, "dse", "Dead Store Elimination", false, false)
 
@@ -109,6 +127,7 @@ FunctionPass *llvm::createDeadStoreEliminationPass() { return new DSE(); }
 ///
 static void DeleteDeadInstruction(Instruction *I,
                                   MemoryDependenceAnalysis &MD,
+                                  MemorySSA *MSSA,
                                   const TargetLibraryInfo *TLI,
                                   SmallSetVector<Value*, 16> *ValueSet = 0) {
   SmallVector<Instruction*, 32> NowDeadInsts;
@@ -125,6 +144,8 @@ static void DeleteDeadInstruction(Instruction *I,
     // MemDep, which needs to know the operands and needs it to be in the
     // function.
     MD.removeInstruction(DeadInst);
+    if (MSSA)
+      MSSA->removeInstruction(DeadInst);
 
     for (unsigned op = 0, e = DeadInst->getNumOperands(); op != e; ++op) {
       Value *Op = DeadInst->getOperand(op);
@@ -505,7 +526,15 @@ bool DSE::runOnBasicBlock(BasicBlock &BB) {
     if (!hasMemoryWrite(Inst, TLI))
       continue;
 
-    MemDepResult InstDep = MD->getDependency(Inst);
+    // Figure out what location is being stored to.
+    AliasAnalysis::Location Loc = getLocForWrite(Inst, *AA);
+
+    // If we didn't get a useful location, fail.
+    if (Loc.Ptr == 0)
+      continue;
+
+    MemDepResult InstDep = MSSA ? getMemorySSADependency(Inst, Loc)
+                                : MD->getDependency(Inst);
 
     // Ignore any store where we can't find a local dependence.
     // FIXME: cross-block DSE would be fun. :)
@@ -525,7 +554,7 @@ bool DSE::runOnBasicBlock(BasicBlock &BB) {
           // in case we need it.
           WeakVH NextInst(BBI);
 
-          DeleteDeadInstruction(SI, *MD, TLI);
+          DeleteDeadInstruction(SI, *MD, MSSA, TLI);
 
           if (NextInst == 0)  // Next instruction deleted.
             BBI = BB.begin();
@@ -538,13 +567,6 @@ bool DSE::runOnBasicBlock(BasicBlock &BB) {
       }
     }
 
-    // Figure out what location is being stored to.
-    AliasAnalysis::Location Loc = getLocForWrite(Inst, *AA);
-
-    // If we didn't get a useful location, fail.
-    if (Loc.Ptr == 0)
-      continue;
-
     while (InstDep.isDef() || InstDep.isClobber()) {
       // Get the memory clobbered by the instruction we depend on.  MemDep will
       // skip any instructions that 'Loc' clearly doesn't interact with.  If we
@@ -572,7 +594,7 @@ bool DSE::runOnBasicBlock(BasicBlock &BB) {
                 << *DepWrite << "\n  KILLER: " << *Inst << '\n');
 
           // Delete the store and now-dead instructions that feed it.
-          DeleteDeadInstruction(DepWrite, *MD, TLI);
+          DeleteDeadInstruction(DepWrite, *MD, MSSA, TLI);
           ++NumFastStores;
           MadeChange = true;
 
@@ -624,7 +646,8 @@ bool DSE::runOnBasicBlock(BasicBlock &BB) {
       if (AA->getModRefInfo(DepWrite, Loc) & AliasAnalysis::Ref)
         break;
 
-      InstDep = MD->getPointerDependencyFrom(Loc, false, DepWrite, &BB);
+      InstDep = MSSA ? getMemorySSADependency(DepWrite, Loc)
+                     : MD->getPointerDependencyFrom(Loc, false, DepWrite, &BB);
     }
   }
 
@@ -636,6 +659,72 @@ bool DSE::runOnBasicBlock(BasicBlock &BB) {
   return MadeChange;
 }
 
+/// isOrderedMemoryOp - Return true if I orders the memory accesses around it
+/// against other threads, whatever locations they access.
+static bool isOrderedMemoryOp(Instruction *I) {
+  if (LoadInst *LI = dyn_cast<LoadInst>(I))
+    return !LI->isUnordered();
+  if (StoreInst *SI = dyn_cast<StoreInst>(I))
+    return !SI->isUnordered();
+  return isa<FenceInst>(I);
+}
+
+/// getMemorySSADependency - Return the nearest instruction above Inst in its
+/// block that reads or writes Loc, as MD->getPointerDependencyFrom would.
+/// Only the writes on the def chain of Inst are visited, together with the
+/// reads of the memory version each of them starts from.  A read of Loc that
+/// is the value stored by Inst is preferred, so that storing a loaded value
+/// back is recognized.
+MemDepResult DSE::getMemorySSADependency(Instruction *Inst,
+                                         const AliasAnalysis::Location &Loc) {
+  BasicBlock *BB = Inst->getParent();
+  StoreInst *SI = dyn_cast<StoreInst>(Inst);
+  MemoryAccess *MA = MSSA->getMemoryAccess(Inst)->getDefiningAccess();
+  while (true) {
+    // The reads of MA in this block lie between MA and the current write.
+    Instruction *Reader = 0;
+    for (MemoryAccess::user_iterator UI = MA->user_begin(),
+         UE = MA->user_end(); UI != UE; ++UI) {
+      MemoryUse *Use = dyn_cast<MemoryUse>(*UI);
+      if (!Use || Use->getBlock() != BB)
+        continue;
+      Instruction *I = Use->getMemoryInst();
+      if (isOrderedMemoryOp(I))
+        return MemDepResult::getClobber(I);
+      if (!(AA->getModRefInfo(I, Loc) & AliasAnalysis::Ref))
+        continue;
+      if (!Reader || (SI && I == SI->getValueOperand()))
+        Reader = I;
+    }
+    if (Reader) {
+      LoadInst *LI = dyn_cast<LoadInst>(Reader);
+      if (LI && AA->alias(AA->getLocation(LI), Loc) == AliasAnalysis::MustAlias)
+        return MemDepResult::getDef(LI);
+      return MemDepResult::getClobber(Reader);
+    }
+
+    MemoryDef *Def = dyn_cast<MemoryDef>(MA);
+    if (!Def || MSSA->isLiveOnEntryDef(Def) || Def->getBlock() != BB)
+      return MemDepResult::getNonLocal();
+
+    // Like MemoryDependenceAnalysis, stop at atomics stronger than unordered
+    // and at fences even if they access other locations.
+    Instruction *DefInst = Def->getMemoryInst();
+    if (isOrderedMemoryOp(DefInst))
+      return MemDepResult::getClobber(DefInst);
+    if (StoreInst *DepSI = dyn_cast<StoreInst>(DefInst)) {
+      AliasAnalysis::AliasResult R = AA->alias(AA->getLocation(DepSI), Loc);
+      if (R == AliasAnalysis::MustAlias)
+        return MemDepResult::getDef(DepSI);
+      if (R != AliasAnalysis::NoAlias)
+        return MemDepResult::getClobber(DepSI);
+    } else if (AA->getModRefInfo(DefInst, Loc) != AliasAnalysis::NoModRef) {
+      return MemDepResult::getClobber(DefInst);
+    }
+    MA = Def->getDefiningAccess();
+  }
+}
+
 /// Find all blocks that will unconditionally lead to the block BB and append
 /// them to F.
 static void FindUnconditionalPreds(SmallVectorImpl<BasicBlock *> &Blocks,
@@ -682,7 +771,7 @@ bool DSE::HandleFree(CallInst *F) {
       Instruction *Next = llvm::next(BasicBlock::iterator(Dependency));
 
       // DCE instructions only used to calculate that store
-      DeleteDeadInstruction(Dependency, *MD, TLI);
+      DeleteDeadInstruction(Dependency, *MD, MSSA, TLI);
       ++NumFastStores;
       MadeChange = true;
 
@@ -766,7 +855,7 @@ bool DSE::handleEndBlock(BasicBlock &BB) {
               dbgs() << '\n');
 
         // DCE instructions only used to calculate that store.
-        DeleteDeadInstruction(Dead, *MD, TLI, &DeadStackObjects);
+        DeleteDeadInstruction(Dead, *MD, MSSA, TLI, &DeadStackObjects);
         ++NumFastStores;
         MadeChange = true;
         continue;
@@ -776,7 +865,7 @@ bool DSE::handleEndBlock(BasicBlock &BB) {
     // Remove any dead non-memory-mutating instructions.
     if (isInstructionTriviallyDead(BBI, TLI)) {
       Instruction *Inst = BBI++;
-      DeleteDeadInstruction(Inst, *MD, TLI, &DeadStackObjects);
+      DeleteDeadInstruction(Inst, *MD, MSSA, TLI, &DeadStackObjects);
       ++NumFastOther;
       MadeChange = true;
       continue;
@@ -34,6 +34,7 @@
 #include "llvm/Analysis/Loads.h"
 #include "llvm/Analysis/MemoryBuiltins.h"
 #include "llvm/Analysis/MemoryDependenceAnalysis.h"
+#include "llvm/Analysis/MemorySSA.h"
 #include "llvm/Analysis/PHITransAddr.h"
 #include "llvm/Analysis/ValueTracking.h"
 #include "llvm/Assembly/Writer.h"
@@ -60,6 +61,15 @@ static cl::opt<bool> EnablePRE("enable-pre",
                                cl::init(true), cl::Hidden);
 static cl::opt<bool> EnableLoadPRE("enable-load-pre", cl::init(true));
 
+// Number loads and read-only calls by their clobbering MemorySSA access
+// instead of querying memory dependence analysis.  Loads are then only
+// eliminated when an equivalent value is available in a dominating block;
+// load PRE and the non-local load analysis are not done.
+static cl::opt<bool>
+EnableGVNMemorySSA("enable-gvn-memoryssa", cl::init(false), cl::Hidden,
+                   cl::desc("Use MemorySSA instead of memory dependence "
+                            "analysis in GVN"));
+
 // Maximum allowed recursion depth.
 static cl::opt<uint32_t>
 MaxRecurseDepth("max-recurse-depth", cl::Hidden, cl::init(1000), cl::ZeroOrMore,
@@ -104,18 +114,20 @@ namespace {
     DenseMap<Expression, uint32_t> expressionNumbering;
     AliasAnalysis *AA;
     MemoryDependenceAnalysis *MD;
+    MemorySSA *MSSA;
     DominatorTree *DT;
 
     uint32_t nextValueNumber;
 
     Expression create_expression(Instruction* I);
+    Expression create_load_expression(LoadInst *LI);
     Expression create_cmp_expression(unsigned Opcode,
                                      CmpInst::Predicate Predicate,
                                      Value *LHS, Value *RHS);
     Expression create_extractvalue_expression(ExtractValueInst* EI);
     uint32_t lookup_or_add_call(CallInst* C);
   public:
-    ValueTable() : nextValueNumber(1) { }
+    ValueTable() : MD(0), MSSA(0), nextValueNumber(1) { }
     uint32_t lookup_or_add(Value *V);
     uint32_t lookup(Value *V) const;
     uint32_t lookup_or_add_cmp(unsigned Opcode, CmpInst::Predicate Pred,
@@ -126,6 +138,7 @@ namespace {
     void setAliasAnalysis(AliasAnalysis* A) { AA = A; }
     AliasAnalysis *getAliasAnalysis() const { return AA; }
     void setMemDep(MemoryDependenceAnalysis* M) { MD = M; }
+    void setMemorySSA(MemorySSA *M) { MSSA = M; }
     void setDomTree(DominatorTree* D) { DT = D; }
     uint32_t getNextUnusedValueNumber() { return nextValueNumber; }
     void verifyRemoved(const Value *) const;
@@ -210,6 +223,17 @@ Expression ValueTable::create_cmp_expression(unsigned Opcode,
   return e;
 }
 
+/// create_load_expression - Loads of the same pointer that see the same
+/// clobbering memory access load the same value.
+Expression ValueTable::create_load_expression(LoadInst *LI) {
+  Expression e;
+  e.type = LI->getType();
+  e.opcode = LI->getOpcode();
+  e.varargs.push_back(lookup_or_add(LI->getPointerOperand()));
+  e.varargs.push_back(MSSA->getClobberingMemoryAccess(LI)->getID());
+  return e;
+}
+
 Expression ValueTable::create_extractvalue_expression(ExtractValueInst *EI) {
   assert(EI != 0 && "Not an ExtractValueInst?");
   Expression e;
@@ -280,6 +304,19 @@ uint32_t ValueTable::lookup_or_add_call(CallInst *C) {
     return e;
   } else if (AA->onlyReadsMemory(C)) {
     Expression exp = create_expression(C);
+    if (MSSA) {
+      // Calls that read the same memory version compute the same value.
+      MemoryAccess *Clobber = MSSA->getClobberingMemoryAccess(C);
+      if (!Clobber) {
+        valueNumbering[C] = nextValueNumber;
+        return nextValueNumber++;
+      }
+      exp.varargs.push_back(Clobber->getID());
+      uint32_t &e = expressionNumbering[exp];
+      if (!e) e = nextValueNumber++;
+      valueNumbering[C] = e;
+      return e;
+    }
     uint32_t &e = expressionNumbering[exp];
     if (!e) {
       e = nextValueNumber++;
@@ -440,6 +477,13 @@ uint32_t ValueTable::lookup_or_add(Value *V) {
     case Instruction::ExtractValue:
       exp = create_extractvalue_expression(cast<ExtractValueInst>(I));
       break;
+    case Instruction::Load:
+      if (MSSA && cast<LoadInst>(I)->isSimple()) {
+        exp = create_load_expression(cast<LoadInst>(I));
+        break;
+      }
+      valueNumbering[V] = nextValueNumber;
+      return nextValueNumber++;
     default:
       valueNumbering[V] = nextValueNumber;
       return nextValueNumber++;
@@ -502,6 +546,7 @@ namespace {
   class GVN : public FunctionPass {
     bool NoLoads;
     MemoryDependenceAnalysis *MD;
+    MemorySSA *MSSA;
     DominatorTree *DT;
     const TargetData *TD;
     const TargetLibraryInfo *TLI;
@@ -522,7 +567,7 @@ namespace {
   public:
     static char ID; // Pass identification, replacement for typeid
     explicit GVN(bool noloads = false)
-        : FunctionPass(ID), NoLoads(noloads), MD(0) {
+        : FunctionPass(ID), NoLoads(noloads), MD(0), MSSA(0) {
       initializeGVNPass(*PassRegistry::getPassRegistry());
     }
 
@@ -590,8 +635,12 @@ namespace {
     virtual void getAnalysisUsage(AnalysisUsage &AU) const {
       AU.addRequired<DominatorTree>();
       AU.addRequired<TargetLibraryInfo>();
-      if (!NoLoads)
-        AU.addRequired<MemoryDependenceAnalysis>();
+      if (!NoLoads) {
+        if (EnableGVNMemorySSA)
+          AU.addRequired<MemorySSA>();
+        else
+          AU.addRequired<MemoryDependenceAnalysis>();
+      }
       AU.addRequired<AliasAnalysis>();
 
       AU.addPreserved<DominatorTree>();
@@ -602,6 +651,7 @@ namespace {
     // Helper fuctions
     // FIXME: eliminate or document these better
     bool processLoad(LoadInst *L);
+    MemDepResult getMemorySSADependency(LoadInst *L);
     bool processInstruction(Instruction *I);
     bool processNonLocalLoad(LoadInst *L);
     bool processBlock(BasicBlock *BB);
@@ -627,6 +677,7 @@ FunctionPass *llvm::createGVNPass(bool NoLoads) {
 
 INITIALIZE_PASS_BEGIN(GVN, "gvn", "Global Value Numbering", false, false)
 INITIALIZE_PASS_DEPENDENCY(MemoryDependenceAnalysis)
+INITIALIZE_PASS_DEPENDENCY(MemorySSA)
 INITIALIZE_PASS_DEPENDENCY(DominatorTree)
 INITIALIZE_PASS_DEPENDENCY(TargetLibraryInfo)
 INITIALIZE_AG_DEPENDENCY(AliasAnalysis)
@@ -1787,7 +1838,7 @@ static void patchAndReplaceAllUsesWith(Value *Repl, Instruction *I) {
 /// processLoad - Attempt to eliminate a load, first by eliminating it
 /// locally, and then attempting non-local elimination if that fails.
 bool GVN::processLoad(LoadInst *L) {
-  if (!MD)
+  if (!MD && !MSSA)
     return false;
 
   if (!L->isSimple())
@@ -1798,8 +1849,19 @@ bool GVN::processLoad(LoadInst *L) {
     return true;
   }
 
+  // With memory SSA, a load that reads the same memory version as an earlier
+  // load of the same pointer has the same value number.
+  if (MSSA) {
+    if (Value *Leader = findLeader(L->getParent(), VN.lookup_or_add(L))) {
+      patchAndReplaceAllUsesWith(Leader, L);
+      markInstructionForDeletion(L);
+      ++NumGVNLoad;
+      return true;
+    }
+  }
+
   // ... to a pointer that has been loaded from before...
-  MemDepResult Dep = MD->getDependency(L);
+  MemDepResult Dep = MSSA ? getMemorySSADependency(L) : MD->getDependency(L);
 
   // If we have a clobber and target data is around, see if this is a clobber
   // that we can fix up through code synthesis.
@@ -1857,7 +1919,7 @@ bool GVN::processLoad(LoadInst *L) {
 
       // Replace the load!
       L->replaceAllUsesWith(AvailVal);
-      if (AvailVal->getType()->isPointerTy())
+      if (MD && AvailVal->getType()->isPointerTy())
         MD->invalidateCachedPointerInfo(AvailVal);
       markInstructionForDeletion(L);
       ++NumGVNLoad;
@@ -1877,9 +1939,10 @@ bool GVN::processLoad(LoadInst *L) {
     return false;
   }
 
-  // If it is defined in another block, try harder.
+  // If it is defined in another block, try harder.  Memory SSA has already
+  // looked at the other blocks.
   if (Dep.isNonLocal())
-    return processNonLocalLoad(L);
+    return MSSA ? false : processNonLocalLoad(L);
 
   if (!Dep.isDef()) {
     DEBUG(
@@ -1914,7 +1977,7 @@ bool GVN::processLoad(LoadInst *L) {
 
     // Remove it!
     L->replaceAllUsesWith(StoredVal);
-    if (StoredVal->getType()->isPointerTy())
+    if (MD && StoredVal->getType()->isPointerTy())
       MD->invalidateCachedPointerInfo(StoredVal);
     markInstructionForDeletion(L);
     ++NumGVNLoad;
@@ -1943,7 +2006,7 @@ bool GVN::processLoad(LoadInst *L) {
 
     // Remove it!
     patchAndReplaceAllUsesWith(AvailableVal, L);
-    if (DepLI->getType()->isPointerTy())
+    if (MD && DepLI->getType()->isPointerTy())
       MD->invalidateCachedPointerInfo(DepLI);
     markInstructionForDeletion(L);
     ++NumGVNLoad;
@@ -1974,6 +2037,42 @@ bool GVN::processLoad(LoadInst *L) {
   return false;
 }
 
+/// getMemorySSADependency - Describe the clobbering access of L the way a
+/// local memory dependence query would, so that processLoad can handle both.
+/// Loads do not define memory versions, so earlier loads are never returned;
+/// those are found by value numbering instead.
+MemDepResult GVN::getMemorySSADependency(LoadInst *L) {
+  MemoryAccess *Clobber = MSSA->getClobberingMemoryAccess(L);
+  Value *Object = GetUnderlyingObject(L->getPointerOperand(), TD);
+
+  // Nothing writes the memory before L: a load from a local allocation is
+  // undefined.
+  if (MSSA->isLiveOnEntryDef(Clobber)) {
+    if (AllocaInst *AI = dyn_cast<AllocaInst>(Object))
+      return MemDepResult::getDef(AI);
+    return MemDepResult::getNonLocal();
+  }
+
+  MemoryDef *Def = dyn_cast<MemoryDef>(Clobber);
+  if (!Def)
+    return MemDepResult::getNonLocal();
+
+  Instruction *DefInst = Def->getMemoryInst();
+  AliasAnalysis *AA = VN.getAliasAnalysis();
+  if (StoreInst *SI = dyn_cast<StoreInst>(DefInst)) {
+    if (AA->alias(AA->getLocation(SI), AA->getLocation(L)) ==
+        AliasAnalysis::MustAlias)
+      return MemDepResult::getDef(SI);
+  } else if (IntrinsicInst *II = dyn_cast<IntrinsicInst>(DefInst)) {
+    if (II->getIntrinsicID() == Intrinsic::lifetime_start &&
+        AA->isMustAlias(II->getArgOperand(1), L->getPointerOperand()))
+      return MemDepResult::getDef(II);
+  } else if (DefInst == Object && isMallocLikeFn(DefInst, TLI)) {
+    return MemDepResult::getDef(DefInst);
+  }
+  return MemDepResult::getClobber(DefInst);
+}
+
 // findLeader - In order to find a leader for a given value number at a
 // specific basic block, we first obtain the list of all Values for that number,
 // and then scan the list to find one whose block dominates the block in
@@ -2292,13 +2391,18 @@ bool GVN::processInstruction(Instruction *I) {
 
 /// runOnFunction - This is the main transformation entry point for a function.
 bool GVN::runOnFunction(Function& F) {
-  if (!NoLoads)
-    MD = &getAnalysis<MemoryDependenceAnalysis>();
+  if (!NoLoads) {
+    if (EnableGVNMemorySSA)
+      MSSA = &getAnalysis<MemorySSA>();
+    else
+      MD = &getAnalysis<MemoryDependenceAnalysis>();
+  }
   DT = &getAnalysis<DominatorTree>();
   TD = getAnalysisIfAvailable<TargetData>();
   TLI = &getAnalysis<TargetLibraryInfo>();
   VN.setAliasAnalysis(&getAnalysis<AliasAnalysis>());
   VN.setMemDep(MD);
+  VN.setMemorySSA(MSSA);
   VN.setDomTree(DT);
 
   bool Changed = false;
@@ -2315,6 +2419,10 @@ bool GVN::runOnFunction(Function& F) {
     Changed |= removedBlock;
   }
 
+  // The accesses of the merged blocks moved; rebuild the memory SSA form.
+  if (MSSA && Changed)
+    MSSA->reset();
+
   unsigned Iteration = 0;
   while (ShouldContinue) {
     DEBUG(dbgs() << "GVN iteration: " << Iteration << "\n");
@@ -2370,6 +2478,7 @@ bool GVN::processBlock(BasicBlock *BB) {
          E = InstrsToErase.end(); I != E; ++I) {
       DEBUG(dbgs() << "GVN removed: " << **I << '\n');
       if (MD) MD->removeInstruction(*I);
+      if (MSSA) MSSA->removeInstruction(*I);
       (*I)->eraseFromParent();
       DEBUG(verifyRemoved(*I));
     }
@@ -42,6 +42,7 @@
 #include "llvm/Analysis/ConstantFolding.h"
 #include "llvm/Analysis/LoopInfo.h"
 #include "llvm/Analysis/LoopPass.h"
+#include "llvm/Analysis/MemorySSA.h"
 #include "llvm/Analysis/Dominators.h"
 #include "llvm/Analysis/ValueTracking.h"
 #include "llvm/Transforms/Utils/Local.h"
@@ -66,6 +67,11 @@ static cl::opt<bool>
 DisablePromotion("disable-licm-promotion", cl::Hidden,
                  cl::desc("Disable memory promotion in LICM pass"));
 
+static cl::opt<bool>
+EnableLICMMemorySSA("enable-licm-memoryssa", cl::Hidden,
+                    cl::desc("Use MemorySSA to find loop invariant loads in "
+                             "LICM"));
+
 namespace {
   struct LICM : public LoopPass {
     static char ID; // Pass identification, replacement for typeid
@@ -88,6 +94,10 @@ namespace {
       AU.addPreserved("scalar-evolution");
       AU.addPreservedID(LoopSimplifyID);
       AU.addRequired<TargetLibraryInfo>();
+      if (EnableLICMMemorySSA) {
+        AU.addRequired<MemorySSA>();
+        AU.addPreserved<MemorySSA>();
+      }
     }
 
     bool doFinalization() {
@@ -99,6 +109,7 @@ namespace {
     AliasAnalysis *AA;       // Current AliasAnalysis information
     LoopInfo      *LI;       // Current LoopInfo
     DominatorTree *DT;       // Dominator Tree for the current Loop.
+    MemorySSA *MSSA;         // Memory SSA form, if enabled and still valid.
 
     TargetData *TD;          // TargetData for constant folding.
     TargetLibraryInfo *TLI;  // TargetLibraryInfo for constant folding.
@@ -190,6 +201,7 @@ INITIALIZE_PASS_DEPENDENCY(DominatorTree)
 INITIALIZE_PASS_DEPENDENCY(LoopInfo)
 INITIALIZE_PASS_DEPENDENCY(LoopSimplify)
 INITIALIZE_PASS_DEPENDENCY(TargetLibraryInfo)
+INITIALIZE_PASS_DEPENDENCY(MemorySSA)
 INITIALIZE_AG_DEPENDENCY(AliasAnalysis)
 INITIALIZE_PASS_END(LICM, "licm", "Loop Invariant Code Motion", false, false)
 
@@ -210,6 +222,11 @@ bool LICM::runOnLoop(Loop *L, LPPassManager &LPM) {
   TD = getAnalysisIfAvailable<TargetData>();
   TLI = &getAnalysis<TargetLibraryInfo>();
 
+  // The other passes of the loop pass manager do not preserve memory SSA, so
+  // it is only available until one of them has changed the function; the
+  // alias sets are used from then on.
+  MSSA = EnableLICMMemorySSA ? getAnalysisIfAvailable<MemorySSA>() : 0;
+
   CurAST = new AliasSetTracker(*AA);
   // Collect Alias info from subloops.
   for (Loop::iterator LoopItr = L->begin(), LoopItrE = L->end();
@@ -323,6 +340,7 @@ void LICM::SinkRegion(DomTreeNode *N) {
       DEBUG(dbgs() << "LICM deleting dead inst: " << I << '\n');
       ++II;
       CurAST->deleteValue(&I);
+      if (MSSA) MSSA->removeInstruction(&I);
       I.eraseFromParent();
       Changed = true;
       continue;
@@ -365,6 +383,7 @@ void LICM::HoistRegion(DomTreeNode *N) {
         DEBUG(dbgs() << "LICM folding inst: " << I << "  --> " << *C << '\n');
         CurAST->copyValue(&I, C);
         CurAST->deleteValue(&I);
+        if (MSSA) MSSA->removeInstruction(&I);
         I.replaceAllUsesWith(C);
         I.eraseFromParent();
         continue;
@@ -407,6 +426,14 @@ bool LICM::canSinkOrHoistInst(Instruction &I) {
     if (I.getMetadata("mono.noalias"))
       return true;
 
+    // With memory SSA, the load is invariant if nothing in the loop may write
+    // the memory it reads.
+    if (MSSA) {
+      MemoryAccess *Clobber = MSSA->getClobberingMemoryAccess(LI);
+      return MSSA->isLiveOnEntryDef(Clobber) ||
+             !CurLoop->contains(Clobber->getBlock());
+    }
+
     // Don't hoist loads which have may-aliased stores in loop.
     uint64_t Size = 0;
     if (LI->getType()->isSized())
@@ -492,6 +519,12 @@ void LICM::sink(Instruction &I) {
   ++NumSunk;
   Changed = true;
 
+  // Only read-only instructions are sunk; their memory accesses are created
+  // again at the new positions.
+  bool HasMemoryAccess = MSSA && MSSA->getMemoryAccess(&I);
+  if (HasMemoryAccess)
+    MSSA->removeInstruction(&I);
+
   // The case where there is only a single exit node of this loop is common
   // enough that we handle it as a special (more efficient) case.  It is more
   // efficient to handle because there are no PHI nodes that need to be placed.
@@ -509,6 +542,8 @@ void LICM::sink(Instruction &I) {
       // Move the instruction to the start of the exit block, after any PHI
       // nodes in it.
       I.moveBefore(ExitBlocks[0]->getFirstInsertionPt());
+      if (HasMemoryAccess)
+        MSSA->createMemoryUse(&I);
 
       // This instruction is no longer in the AST for the current loop, because
       // we just sunk it out of the loop.  If we just sunk it into an outer
@@ -566,6 +601,8 @@ void LICM::sink(Instruction &I) {
         New->setName(I.getName()+".le");
       ExitBlock->getInstList().insert(InsertPt, New);
     }
+    if (HasMemoryAccess)
+      MSSA->createMemoryUse(New);
 
     // Now that we have inserted the instruction, inform SSAUpdater.
     if (!I.use_empty())
@@ -607,7 +644,12 @@ void LICM::hoist(Instruction &I) {
         << I << "\n");
 
   // Move the new node to the Preheader, before its terminator.
+  bool HasMemoryAccess = MSSA && MSSA->getMemoryAccess(&I);
+  if (HasMemoryAccess)
+    MSSA->removeInstruction(&I);
   I.moveBefore(Preheader->getTerminator());
+  if (HasMemoryAccess)
+    MSSA->createMemoryUse(&I);
 
   if (isa<LoadInst>(I)) ++NumMovedLoads;
   else if (isa<CallInst>(I)) ++NumMovedCalls;
@@ -827,6 +869,11 @@ void LICM::PromoteAliasSet(AliasSet &AS,
   Changed = true;
   ++NumPromoted;
 
+  // Promotion moves stores out of the loop; rather than patching the memory
+  // SSA form, have it rebuilt when it is next needed.
+  if (MSSA)
+    MSSA->reset();
+
   // Grab a debug location for the inserted loads/stores; given that the
   // inserted loads/stores have little relation to the original loads/stores,
   // this code just arbitrarily picks a location from one, since any debug
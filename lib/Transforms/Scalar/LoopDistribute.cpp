@@ -0,0 +1,414 @@
+//===- LoopDistribute.cpp - Distribute loops for vectorization ------------===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+//
+// This pass splits an innermost loop into a sequence of loops over the same
+// iteration space, separating the statements the loop vectorizer can handle
+// from the ones it cannot, such as a recurrence through memory:
+//
+//   for (i = 0; i < n; ++i) {          for (i = 0; i < n; ++i)
+//     A[i + 1] = A[i] * k;      =>       A[i + 1] = A[i] * k;
+//     C[i] = B[i] + D[i];              for (i = 0; i < n; ++i)
+//   }                                    C[i] = B[i] + D[i];
+//
+// Each store of the loop seeds a partition with the instructions computing
+// its operands.  Instructions needed by several partitions are recomputed in
+// each of their loops, and the loop control is copied into every loop.  A
+// partition is vectorizable if it only accesses memory consecutively or
+// through an invariant address, carries no value from one iteration to the
+// next, and has no dependence carried by the loop.  Adjacent partitions of the
+// same kind are merged, and the loop is distributed if both kinds remain.
+//
+// Distributing runs all iterations of a partition before those of the next
+// one, so it is legal if no dependence found by LoopDependenceAnalysis goes
+// from a later partition to an earlier one.
+//
+// Only loops with a single block are distributed, as those are the only ones
+// the loop vectorizer handles.
+//
+//===----------------------------------------------------------------------===//
+
+#define DEBUG_TYPE "loop-distribute"
+#include "llvm/Transforms/Scalar.h"
+#include "llvm/Function.h"
+#include "llvm/Instructions.h"
+#include "llvm/Analysis/Dominators.h"
+#include "llvm/Analysis/LoopDependenceAnalysis.h"
+#include "llvm/Analysis/LoopInfo.h"
+#include "llvm/Analysis/LoopPass.h"
+#include "llvm/Analysis/ScalarEvolution.h"
+#include "llvm/Analysis/ScalarEvolutionExpressions.h"
+#include "llvm/Target/TargetData.h"
+#include "llvm/Transforms/Utils/Cloning.h"
+#include "llvm/Transforms/Utils/ValueMapper.h"
+#include "llvm/Support/Debug.h"
+#include "llvm/Support/raw_ostream.h"
+#include "llvm/ADT/DenseMap.h"
+#include "llvm/ADT/SmallPtrSet.h"
+#include "llvm/ADT/SmallVector.h"
+#include "llvm/ADT/Statistic.h"
+using namespace llvm;
+
+STATISTIC(NumDistributed, "Number of loops distributed");
+STATISTIC(NumLoopsCreated, "Number of loops created by distribution");
+
+namespace {
+  /// Partition - The instructions executed by one of the distributed loops,
+  /// besides the loop control.
+  struct Partition {
+    SmallPtrSet<Instruction*, 16> Insts;
+    /// MemInsts - The loads and stores of the partition, in program order.
+    SmallVector<Instruction*, 8> MemInsts;
+    bool Vectorizable;
+
+    Partition() : Vectorizable(false) {}
+  };
+
+  class LoopDistribute : public LoopPass {
+    Loop *TheLoop;
+    ScalarEvolution *SE;
+    LoopDependenceAnalysis *LDA;
+    TargetData *TD;
+
+    /// Control - The instructions computing the exit condition of the loop,
+    /// which are copied into every distributed loop.
+    SmallPtrSet<Instruction*, 8> Control;
+
+    /// Order - The position of each instruction in the loop body.
+    DenseMap<Instruction*, unsigned> Order;
+
+    void collectSlice(Instruction *Root, SmallPtrSet<Instruction*, 16> &Slice,
+                      bool IsControl);
+    void finalizePartition(Partition &P);
+    bool isConsecutivePtr(Value *Ptr) const;
+    bool isVectorizable(const Partition &P);
+    bool isLegal(ArrayRef<Partition> Partitions);
+    void distribute(ArrayRef<Partition> Partitions, LPPassManager &LPM);
+
+  public:
+    static char ID; // Pass ID, replacement for typeid
+    LoopDistribute() : LoopPass(ID) {
+      initializeLoopDistributePass(*PassRegistry::getPassRegistry());
+    }
+
+    virtual bool runOnLoop(Loop *L, LPPassManager &LPM);
+
+    virtual void getAnalysisUsage(AnalysisUsage &AU) const {
+      AU.addRequiredID(LoopSimplifyID);
+      AU.addPreservedID(LoopSimplifyID);
+      AU.addRequiredID(LCSSAID);
+      AU.addPreservedID(LCSSAID);
+      AU.addRequired<DominatorTree>();
+      AU.addPreserved<DominatorTree>();
+      AU.addRequired<LoopInfo>();
+      AU.addPreserved<LoopInfo>();
+      AU.addRequired<ScalarEvolution>();
+      AU.addPreserved<ScalarEvolution>();
+      AU.addRequired<LoopDependenceAnalysis>();
+    }
+  };
+}
+
+char LoopDistribute::ID = 0;
+INITIALIZE_PASS_BEGIN(LoopDistribute, "loop-distribute",
+                      "Distribute loops for vectorization", false, false)
+INITIALIZE_PASS_DEPENDENCY(DominatorTree)
+INITIALIZE_PASS_DEPENDENCY(LoopInfo)
+INITIALIZE_PASS_DEPENDENCY(LoopSimplify)
+INITIALIZE_PASS_DEPENDENCY(LCSSA)
+INITIALIZE_PASS_DEPENDENCY(ScalarEvolution)
+INITIALIZE_PASS_DEPENDENCY(LoopDependenceAnalysis)
+INITIALIZE_PASS_END(LoopDistribute, "loop-distribute",
+                    "Distribute loops for vectorization", false, false)
+
+Pass *llvm::createLoopDistributePass() { return new LoopDistribute(); }
+
+static Value *getPointerOperand(Instruction *I) {
+  if (LoadInst *LI = dyn_cast<LoadInst>(I))
+    return LI->getPointerOperand();
+  return cast<StoreInst>(I)->getPointerOperand();
+}
+
+/// collectSlice - Add Root and the instructions of the loop it depends on to
+/// Slice, stopping at the loop control unless IsControl is set.
+void LoopDistribute::collectSlice(Instruction *Root,
+                                  SmallPtrSet<Instruction*, 16> &Slice,
+                                  bool IsControl) {
+  SmallVector<Instruction*, 16> Worklist;
+  Worklist.push_back(Root);
+  while (!Worklist.empty()) {
+    Instruction *I = Worklist.pop_back_val();
+    if (!Slice.insert(I))
+      continue;
+    for (User::op_iterator OI = I->op_begin(), OE = I->op_end(); OI != OE;
+         ++OI) {
+      Instruction *Op = dyn_cast<Instruction>(*OI);
+      if (Op && TheLoop->contains(Op) && (IsControl || !Control.count(Op)))
+        Worklist.push_back(Op);
+    }
+  }
+}
+
+/// finalizePartition - Collect the memory accesses of P in program order.
+void LoopDistribute::finalizePartition(Partition &P) {
+  BasicBlock *BB = TheLoop->getHeader();
+  P.MemInsts.clear();
+  for (BasicBlock::iterator I = BB->begin(), E = BB->end(); I != E; ++I)
+    if (P.Insts.count(I) && (isa<LoadInst>(I) || isa<StoreInst>(I)))
+      P.MemInsts.push_back(I);
+}
+
+/// isConsecutivePtr - Return true if Ptr advances by the size of the value
+/// it points to on each iteration.
+bool LoopDistribute::isConsecutivePtr(Value *Ptr) const {
+  const SCEVAddRecExpr *AR = dyn_cast<SCEVAddRecExpr>(SE->getSCEV(Ptr));
+  if (!AR || AR->getLoop() != TheLoop || !AR->isAffine())
+    return false;
+  const SCEVConstant *Step =
+    dyn_cast<SCEVConstant>(AR->getStepRecurrence(*SE));
+  if (!Step)
+    return false;
+  Type *EltTy = cast<PointerType>(Ptr->getType())->getElementType();
+  return Step->getValue()->getValue() == TD->getTypeAllocSize(EltTy) &&
+         TD->getTypeAllocSize(EltTy) == TD->getTypeStoreSize(EltTy);
+}
+
+/// isVectorizable - Return true if the loop vectorizer could handle a loop
+/// executing the instructions of P.
+bool LoopDistribute::isVectorizable(const Partition &P) {
+  for (SmallPtrSet<Instruction*, 16>::const_iterator I = P.Insts.begin(),
+       E = P.Insts.end(); I != E; ++I)
+    if (isa<PHINode>(*I))
+      return false;
+
+  for (unsigned i = 0, e = P.MemInsts.size(); i != e; ++i) {
+    Instruction *A = P.MemInsts[i];
+    Value *Ptr = getPointerOperand(A);
+    if (!isConsecutivePtr(Ptr) &&
+        (isa<StoreInst>(A) || !SE->isLoopInvariant(SE->getSCEV(Ptr), TheLoop)))
+      return false;
+
+    // Accesses to the same location must happen in the same iteration.
+    for (unsigned j = i; j != e; ++j) {
+      Instruction *B = P.MemInsts[j];
+      if (!LDA->isDependencePair(A, B) || !LDA->depends(A, B))
+        continue;
+      SmallVector<std::pair<const Loop*, int64_t>, 4> Distances;
+      if (!LDA->getDistances(A, B, Distances))
+        return false;
+      bool Carried = true;
+      for (unsigned k = 0, ke = Distances.size(); k != ke; ++k)
+        if (Distances[k].first == TheLoop)
+          Carried = Distances[k].second != 0;
+      if (Carried)
+        return false;
+    }
+  }
+  return true;
+}
+
+/// isLegal - Return true if no dependence goes from a partition to an
+/// earlier one: running all the iterations of the earlier partition first
+/// would reverse it.
+bool LoopDistribute::isLegal(ArrayRef<Partition> Partitions) {
+  for (unsigned p = 0, pe = Partitions.size(); p != pe; ++p)
+    for (unsigned q = p + 1; q != pe; ++q)
+      for (unsigned i = 0, ie = Partitions[p].MemInsts.size(); i != ie; ++i)
+        for (unsigned j = 0, je = Partitions[q].MemInsts.size(); j != je;
+             ++j) {
+          Instruction *A = Partitions[p].MemInsts[i];
+          Instruction *B = Partitions[q].MemInsts[j];
+          if (!LDA->isDependencePair(A, B) || !LDA->depends(A, B))
+            continue;
+
+          // B accesses the location A accessed Distance iterations later.
+          SmallVector<std::pair<const Loop*, int64_t>, 4> Distances;
+          bool Known = LDA->getDistances(A, B, Distances);
+          int64_t Distance = 0;
+          bool HasDistance = false;
+          for (unsigned k = 0, ke = Distances.size(); k != ke; ++k)
+            if (Distances[k].first == TheLoop) {
+              Distance = Distances[k].second;
+              HasDistance = true;
+            }
+          if (!Known || !HasDistance || Distance < 0 ||
+              (Distance == 0 && Order[B] < Order[A])) {
+            DEBUG(dbgs() << "LoopDistribute: dependence from " << *B
+                         << " to " << *A << " prevents distribution\n");
+            return false;
+          }
+        }
+  return true;
+}
+
+/// distribute - Replace the loop with one loop per partition, in order.
+/// Every loop but the last one is a copy of the original loop, which is
+/// kept for the last partition.
+void LoopDistribute::distribute(ArrayRef<Partition> Partitions,
+                                LPPassManager &LPM) {
+  BasicBlock *Header = TheLoop->getHeader();
+  BasicBlock *Preheader = TheLoop->getLoopPreheader();
+  BasicBlock *Exit = TheLoop->getExitBlock();
+  Function *F = Header->getParent();
+  Loop *ParentLoop = TheLoop->getParentLoop();
+  DominatorTree *DT = &getAnalysis<DominatorTree>();
+  LoopInfo *LI = &getAnalysis<LoopInfo>();
+  SE->forgetLoop(TheLoop);
+
+  SmallVector<Instruction*, 32> Dead;
+  BasicBlock *Pred = Preheader;
+  for (unsigned p = 0, pe = Partitions.size() - 1; p != pe; ++p) {
+    ValueToValueMapTy VMap;
+    BasicBlock *NewHeader = CloneBasicBlock(Header, VMap, ".ldist", F);
+    NewHeader->moveBefore(Header);
+    VMap[Header] = NewHeader;
+    for (BasicBlock::iterator I = NewHeader->begin(), E = NewHeader->end();
+         I != E; ++I)
+      RemapInstruction(I, VMap,
+                       RF_NoModuleLevelChanges | RF_IgnoreMissingEntries);
+
+    // Chain the copy between the previous loop and a new preheader of the
+    // next one.
+    BasicBlock *NewExit = BasicBlock::Create(Header->getContext(),
+                                             Header->getName() + ".ldist.ph",
+                                             F, Header);
+    BranchInst::Create(Header, NewExit);
+    NewHeader->getTerminator()->replaceUsesOfWith(Exit, NewExit);
+    Pred->getTerminator()->replaceUsesOfWith(Header, NewHeader);
+    for (BasicBlock::iterator I = NewHeader->begin();
+         PHINode *PN = dyn_cast<PHINode>(I); ++I)
+      PN->setIncomingBlock(PN->getBasicBlockIndex(Preheader), Pred);
+
+    // Keep the instructions of this partition only.
+    for (BasicBlock::iterator I = Header->begin(), E = Header->end();
+         I != E; ++I)
+      if (!Control.count(I) && !Partitions[p].Insts.count(I))
+        Dead.push_back(cast<Instruction>(VMap[I]));
+
+    DT->addNewBlock(NewHeader, Pred);
+    DT->addNewBlock(NewExit, NewHeader);
+    Loop *NewLoop = new Loop();
+    LPM.insertLoop(NewLoop, ParentLoop);
+    NewLoop->addBasicBlockToLoop(NewHeader, LI->getBase());
+    if (ParentLoop)
+      ParentLoop->addBasicBlockToLoop(NewExit, LI->getBase());
+    Pred = NewExit;
+    ++NumLoopsCreated;
+  }
+
+  // The original loop runs the last partition.
+  for (BasicBlock::iterator I = Header->begin();
+       PHINode *PN = dyn_cast<PHINode>(I); ++I)
+    PN->setIncomingBlock(PN->getBasicBlockIndex(Preheader), Pred);
+  for (BasicBlock::iterator I = Header->begin(), E = Header->end(); I != E;
+       ++I)
+    if (!Control.count(I) && !Partitions.back().Insts.count(I))
+      Dead.push_back(I);
+  DT->changeImmediateDominator(Header, Pred);
+
+  for (unsigned i = 0, e = Dead.size(); i != e; ++i)
+    Dead[i]->dropAllReferences();
+  for (unsigned i = 0, e = Dead.size(); i != e; ++i) {
+    Dead[i]->replaceAllUsesWith(UndefValue::get(Dead[i]->getType()));
+    Dead[i]->eraseFromParent();
+  }
+}
+
+bool LoopDistribute::runOnLoop(Loop *L, LPPassManager &LPM) {
+  TheLoop = L;
+  if (!L->empty() || L->getNumBlocks() != 1)
+    return false;
+  BasicBlock *BB = L->getHeader();
+  if (!L->getLoopPreheader() || !L->getExitBlock())
+    return false;
+  BranchInst *Br = dyn_cast<BranchInst>(BB->getTerminator());
+  if (!Br || !Br->isConditional())
+    return false;
+
+  TD = getAnalysisIfAvailable<TargetData>();
+  if (!TD)
+    return false;
+  SE = &getAnalysis<ScalarEvolution>();
+  LDA = &getAnalysis<LoopDependenceAnalysis>();
+
+  // The loop control is copied into every loop, so it must not access
+  // memory.
+  Control.clear();
+  Order.clear();
+  SmallPtrSet<Instruction*, 16> ControlSlice;
+  collectSlice(Br, ControlSlice, true);
+  for (SmallPtrSet<Instruction*, 16>::iterator I = ControlSlice.begin(),
+       E = ControlSlice.end(); I != E; ++I) {
+    if ((*I)->mayReadFromMemory())
+      return false;
+    Control.insert(*I);
+  }
+
+  // Seed a partition with each store.  Only the loop control may be used
+  // outside of the loop, as the other instructions do not remain in it.
+  SmallVector<Partition, 8> Partitions;
+  unsigned Pos = 0;
+  for (BasicBlock::iterator I = BB->begin(), E = BB->end(); I != E; ++I) {
+    Order[I] = Pos++;
+    if (LoadInst *LI = dyn_cast<LoadInst>(I)) {
+      if (!LI->isSimple())
+        return false;
+    } else if (StoreInst *SI = dyn_cast<StoreInst>(I)) {
+      if (!SI->isSimple())
+        return false;
+      Partitions.push_back(Partition());
+      collectSlice(SI, Partitions.back().Insts, false);
+      finalizePartition(Partitions.back());
+    } else if (I->mayReadFromMemory() || I->mayHaveSideEffects()) {
+      return false;
+    }
+
+    if (Control.count(I))
+      continue;
+    for (Value::use_iterator UI = I->use_begin(), UE = I->use_end();
+         UI != UE; ++UI)
+      if (!L->contains(cast<Instruction>(*UI)))
+        return false;
+  }
+  if (Partitions.size() < 2)
+    return false;
+
+  // Merge adjacent partitions of the same kind, as long as merging keeps a
+  // vectorizable partition vectorizable.
+  SmallVector<Partition, 8> Merged;
+  for (unsigned i = 0, e = Partitions.size(); i != e; ++i) {
+    Partition &P = Partitions[i];
+    P.Vectorizable = isVectorizable(P);
+    if (!Merged.empty() && Merged.back().Vectorizable == P.Vectorizable) {
+      Partition Candidate = Merged.back();
+      for (SmallPtrSet<Instruction*, 16>::iterator I = P.Insts.begin(),
+           E = P.Insts.end(); I != E; ++I)
+        Candidate.Insts.insert(*I);
+      finalizePartition(Candidate);
+      if (!P.Vectorizable || isVectorizable(Candidate)) {
+        Merged.back() = Candidate;
+        continue;
+      }
+    }
+    Merged.push_back(P);
+  }
+
+  bool HasVectorizable = false;
+  for (unsigned i = 0, e = Merged.size(); i != e; ++i)
+    HasVectorizable |= Merged[i].Vectorizable;
+  DEBUG(dbgs() << "LoopDistribute: loop at " << BB->getName() << " has "
+               << Merged.size() << " partitions\n");
+  if (Merged.size() < 2 || !HasVectorizable || !isLegal(Merged))
+    return false;
+
+  DEBUG(dbgs() << "LoopDistribute: distributing loop at " << BB->getName()
+               << "\n");
+  distribute(Merged, LPM);
+  ++NumDistributed;
+  return true;
+}
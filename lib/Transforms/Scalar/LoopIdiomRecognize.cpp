@@ -11,25 +11,28 @@
 // non-loop form.  In cases that this kicks in, it can be a significant
 // performance win.
 //
+// Counted loops whose stores (or groups of adjacent stores) fill or copy
+// consecutive memory become memset, memset_pattern16 or memcpy calls.  Loops
+// whose trip count is not computable are matched against a few more idioms:
+// bit counting loops become ctpop, ctlz or cttz, string scanning loops become
+// strlen and array comparison loops become memcmp.  These leave the original
+// loop behind with a computable trip count and no live-out values, for loop
+// deletion to remove.
+//
 //===----------------------------------------------------------------------===//
 //
 // TODO List:
 //
 // Future loop memory idioms to recognize:
-//   memcmp, memmove, strlen, etc.
+//   memmove, memchr, etc.
 // Future floating point idioms to recognize in -ffast-math mode:
 //   fpowi
-// Future integer operation idioms to recognize:
-//   ctpop, ctlz, cttz
 //
 // Beware that isel's default lowering for ctpop is highly inefficient for
-// i64 and larger types when i64 is legal and the value has few bits set.  It
-// would be good to enhance isel to emit a loop for ctpop in this case.
-//
-// We should enhance the memset/memcpy recognition to handle multiple stores in
-// the loop.  This would handle things like:
-//   void foo(_Complex float *P)
-//     for (i) { __real__(*P) = 0;  __imag__(*P) = 0; }
+// i64 and larger types when i64 is legal and the value has few bits set.
+// This is why popcount loops are only rewritten when the target has a fast
+// population count instruction.  It would be good to enhance isel to emit a
+// loop for ctpop in this case.
 //
 // We should enhance this to handle negative strides through memory.
 // Alternatively (and perhaps better) we could rely on an earlier pass to force
@@ -49,18 +52,28 @@
 #include "llvm/ADT/Statistic.h"
 #include "llvm/Analysis/AliasAnalysis.h"
 #include "llvm/Analysis/LoopPass.h"
+#include "llvm/Analysis/MemoryBuiltins.h"
 #include "llvm/Analysis/ScalarEvolutionExpander.h"
 #include "llvm/Analysis/ScalarEvolutionExpressions.h"
+#include "llvm/Analysis/TargetTransformInfo.h"
 #include "llvm/Analysis/ValueTracking.h"
 #include "llvm/Support/Debug.h"
+#include "llvm/Support/PatternMatch.h"
 #include "llvm/Support/raw_ostream.h"
 #include "llvm/Target/TargetData.h"
 #include "llvm/Target/TargetLibraryInfo.h"
+#include "llvm/Transforms/Utils/BuildLibCalls.h"
 #include "llvm/Transforms/Utils/Local.h"
+#include <algorithm>
 using namespace llvm;
+using namespace llvm::PatternMatch;
 
 STATISTIC(NumMemSet, "Number of memset's formed from loop stores");
 STATISTIC(NumMemCpy, "Number of memcpy's formed from loop load+stores");
+STATISTIC(NumStoreGroups, "Number of memset/memcpy's formed from store groups");
+STATISTIC(NumBitCount, "Number of ctpop/ctlz/cttz's formed from loops");
+STATISTIC(NumStrLen, "Number of strlen's formed from loop loads");
+STATISTIC(NumMemCmp, "Number of memcmp's formed from loop compares");
 
 namespace {
   class LoopIdiomRecognize : public LoopPass {
@@ -69,6 +82,7 @@ namespace {
     DominatorTree *DT;
     ScalarEvolution *SE;
     TargetLibraryInfo *TLI;
+    const TargetTransformInfo *TTI;
   public:
     static char ID;
     explicit LoopIdiomRecognize() : LoopPass(ID) {
@@ -80,18 +94,28 @@ namespace {
                         SmallVectorImpl<BasicBlock*> &ExitBlocks);
 
     bool processLoopStore(StoreInst *SI, const SCEV *BECount);
+    bool processLoopStoreGroup(StoreInst *SI, const SCEVAddRecExpr *StoreEv,
+                               const SCEV *BECount);
     bool processLoopMemSet(MemSetInst *MSI, const SCEV *BECount);
 
     bool processLoopStridedStore(Value *DestPtr, unsigned StoreSize,
                                  unsigned StoreAlignment,
-                                 Value *SplatValue, Instruction *TheStore,
+                                 Value *SplatValue,
+                                 ArrayRef<Instruction*> TheStores,
                                  const SCEVAddRecExpr *Ev,
                                  const SCEV *BECount);
-    bool processLoopStoreOfLoopLoad(StoreInst *SI, unsigned StoreSize,
+    bool processLoopStoreOfLoopLoad(ArrayRef<StoreInst*> Stores,
+                                    unsigned StoreSize,
                                     const SCEVAddRecExpr *StoreEv,
                                     const SCEVAddRecExpr *LoadEv,
                                     const SCEV *BECount);
 
+    bool runOnNoncountableLoop();
+    bool recognizeBitCount();
+    bool recognizeStrLen();
+    bool recognizeMemCmp();
+    void rewriteLoopExitCount(ICmpInst *ExitCond, Value *TripCount);
+
     /// This transformation requires natural loop information & requires that
     /// loop preheaders be inserted into the CFG.
     ///
@@ -109,6 +133,7 @@ namespace {
       AU.addPreserved<DominatorTree>();
       AU.addRequired<DominatorTree>();
       AU.addRequired<TargetLibraryInfo>();
+      AU.addRequired<TargetTransformInfo>();
     }
   };
 }
@@ -123,6 +148,7 @@ INITIALIZE_PASS_DEPENDENCY(LCSSA)
 INITIALIZE_PASS_DEPENDENCY(ScalarEvolution)
 INITIALIZE_PASS_DEPENDENCY(TargetLibraryInfo)
 INITIALIZE_AG_DEPENDENCY(AliasAnalysis)
+INITIALIZE_AG_DEPENDENCY(TargetTransformInfo)
 INITIALIZE_PASS_END(LoopIdiomRecognize, "loop-idiom", "Recognize loop idioms",
                     false, false)
 
@@ -182,13 +208,23 @@ bool LoopIdiomRecognize::runOnLoop(Loop *L, LPPassManager &LPM) {
 
   // Disable loop idiom recognition if the function's name is a common idiom.
   StringRef Name = L->getHeader()->getParent()->getName();
-  if (Name == "memset" || Name == "memcpy")
+  if (Name == "memset" || Name == "memcpy" || Name == "memcmp" ||
+      Name == "strlen")
     return false;
 
-  // The trip count of the loop must be analyzable.
+  // We require target data for now.
+  TD = getAnalysisIfAvailable<TargetData>();
+  if (TD == 0) return false;
+
   SE = &getAnalysis<ScalarEvolution>();
+  DT = &getAnalysis<DominatorTree>();
+  TLI = &getAnalysis<TargetLibraryInfo>();
+  TTI = &getAnalysis<TargetTransformInfo>();
+
+  // If the trip count of the loop is not analyzable, it may still be one of
+  // the idioms that compute it.
   if (!SE->hasLoopInvariantBackedgeTakenCount(L))
-    return false;
+    return runOnNoncountableLoop();
   const SCEV *BECount = SE->getBackedgeTakenCount(L);
   if (isa<SCEVCouldNotCompute>(BECount)) return false;
 
@@ -198,13 +234,7 @@ bool LoopIdiomRecognize::runOnLoop(Loop *L, LPPassManager &LPM) {
     if (BECst->getValue()->getValue() == 0)
       return false;
 
-  // We require target data for now.
-  TD = getAnalysisIfAvailable<TargetData>();
-  if (TD == 0) return false;
-
-  DT = &getAnalysis<DominatorTree>();
   LoopInfo &LI = getAnalysis<LoopInfo>();
-  TLI = &getAnalysis<TargetLibraryInfo>();
 
   SmallVector<BasicBlock*, 8> ExitBlocks;
   CurLoop->getUniqueExitBlocks(ExitBlocks);
@@ -298,6 +328,12 @@ bool LoopIdiomRecognize::processLoopStore(StoreInst *SI, const SCEV *BECount) {
   const SCEVConstant *Stride = dyn_cast<SCEVConstant>(StoreEv->getOperand(1));
 
   if (Stride == 0 || StoreSize != Stride->getValue()->getValue()) {
+    // If the store writes only part of each stride, it may be the first of a
+    // group of stores that together write all of it.
+    if (Stride && Stride->getValue()->getValue().ugt(StoreSize) &&
+        Stride->getValue()->getValue().getActiveBits() <= 32)
+      return processLoopStoreGroup(SI, StoreEv, BECount);
+
     // TODO: Could also handle negative stride here someday, that will require
     // the validity check in mayLoopAccessLocation to be updated though.
     // Enable this to print exact negative strides.
@@ -330,6 +366,105 @@ bool LoopIdiomRecognize::processLoopStore(StoreInst *SI, const SCEV *BECount) {
   return false;
 }
 
+/// processLoopStoreGroup - SI is a strided store that writes only the start of
+/// each stride.  See if the other stores in its block with the same stride
+/// write the rest of it, like
+///   for (i) { P[i].re = 0; P[i].im = 0; }
+/// and if so turn the whole group into a single memset or memcpy.
+bool LoopIdiomRecognize::
+processLoopStoreGroup(StoreInst *SI, const SCEVAddRecExpr *StoreEv,
+                      const SCEV *BECount) {
+  const SCEV *StrideS = StoreEv->getOperand(1);
+  unsigned Stride =
+    (unsigned)cast<SCEVConstant>(StrideS)->getValue()->getZExtValue();
+
+  // Collect the stores with the same stride at a constant offset from SI.
+  typedef std::pair<int64_t, StoreInst*> OffsetStore;
+  SmallVector<OffsetStore, 8> Group;
+  BasicBlock *BB = SI->getParent();
+  for (BasicBlock::iterator I = BB->begin(), E = BB->end(); I != E; ++I) {
+    StoreInst *Other = dyn_cast<StoreInst>(I);
+    if (Other == 0 || !Other->isSimple())
+      continue;
+    const SCEVAddRecExpr *Ev =
+      dyn_cast<SCEVAddRecExpr>(SE->getSCEV(Other->getPointerOperand()));
+    if (Ev == 0 || Ev->getLoop() != CurLoop || !Ev->isAffine() ||
+        Ev->getOperand(1) != StrideS)
+      continue;
+    const SCEVConstant *Offset =
+      dyn_cast<SCEVConstant>(SE->getMinusSCEV(Ev->getStart(),
+                                              StoreEv->getStart()));
+    if (Offset == 0)
+      continue;
+    // Let the lowest store of the group handle it.
+    if (Offset->getValue()->isNegative())
+      return false;
+    Group.push_back(std::make_pair(Offset->getValue()->getSExtValue(), Other));
+  }
+
+  // The stores must write every byte of the stride exactly once.
+  std::sort(Group.begin(), Group.end());
+  if (Group.size() < 2)
+    return false;
+  uint64_t End = 0;
+  for (unsigned i = 0, e = Group.size(); i != e; ++i) {
+    uint64_t SizeInBits =
+      TD->getTypeSizeInBits(Group[i].second->getValueOperand()->getType());
+    if ((SizeInBits & 7) || Group[i].first != (int64_t)End)
+      return false;
+    End += SizeInBits >> 3;
+  }
+  if (End != Stride)
+    return false;
+
+  // If every store writes the same byte-wise value, form a memset.
+  Value *SplatValue = isBytewiseValue(SI->getValueOperand());
+  for (unsigned i = 1, e = Group.size(); SplatValue && i != e; ++i)
+    if (isBytewiseValue(Group[i].second->getValueOperand()) != SplatValue)
+      SplatValue = 0;
+  if (SplatValue && TLI->has(LibFunc::memset) &&
+      CurLoop->isLoopInvariant(SplatValue)) {
+    SmallVector<Instruction*, 8> Stores;
+    for (unsigned i = 0, e = Group.size(); i != e; ++i)
+      Stores.push_back(Group[i].second);
+    if (!processLoopStridedStore(SI->getPointerOperand(), Stride,
+                                 SI->getAlignment(), SplatValue, Stores,
+                                 StoreEv, BECount))
+      return false;
+    ++NumStoreGroups;
+    return true;
+  }
+
+  // If every store writes a value loaded at the same offset from the start of
+  // a same-strided source, form a memcpy.
+  SmallVector<StoreInst*, 8> Stores;
+  const SCEVAddRecExpr *LoadEv = 0;
+  for (unsigned i = 0, e = Group.size(); i != e; ++i) {
+    LoadInst *LI = dyn_cast<LoadInst>(Group[i].second->getValueOperand());
+    if (LI == 0 || !LI->isSimple())
+      return false;
+    const SCEVAddRecExpr *Ev =
+      dyn_cast<SCEVAddRecExpr>(SE->getSCEV(LI->getPointerOperand()));
+    if (Ev == 0 || Ev->getLoop() != CurLoop || !Ev->isAffine() ||
+        Ev->getOperand(1) != StrideS)
+      return false;
+    if (i == 0) {
+      LoadEv = Ev;
+    } else {
+      const SCEVConstant *Offset =
+        dyn_cast<SCEVConstant>(SE->getMinusSCEV(Ev->getStart(),
+                                                LoadEv->getStart()));
+      if (Offset == 0 || Offset->getValue()->getSExtValue() != Group[i].first)
+        return false;
+    }
+    Stores.push_back(Group[i].second);
+  }
+  if (!processLoopStoreOfLoopLoad(Stores, Stride, StoreEv, LoadEv, BECount))
+    return false;
+  ++NumStoreGroups;
+  return true;
+}
+
 /// processLoopMemSet - See if this memset can be promoted to a large memset.
 bool LoopIdiomRecognize::
 processLoopMemSet(MemSetInst *MSI, const SCEV *BECount) {
@@ -375,7 +510,7 @@ processLoopMemSet(MemSetInst *MSI, const SCEV *BECount) {
 static bool mayLoopAccessLocation(Value *Ptr,AliasAnalysis::ModRefResult Access,
                                   Loop *L, const SCEV *BECount,
                                   unsigned StoreSize, AliasAnalysis &AA,
-                                  Instruction *IgnoredStore) {
+                                  SmallPtrSet<Instruction*, 8> &IgnoredStores) {
   // Get the location that may be stored across the loop.  Since the access is
   // strided positively through memory, we say that the modified location starts
   // at the pointer and has infinite size.
@@ -395,7 +530,7 @@ static bool mayLoopAccessLocation(Value *Ptr,AliasAnalysis::ModRefResult Access,
   for (Loop::block_iterator BI = L->block_begin(), E = L->block_end(); BI != E;
        ++BI)
     for (BasicBlock::iterator I = (*BI)->begin(), E = (*BI)->end(); I != E; ++I)
-      if (&*I != IgnoredStore &&
+      if (!IgnoredStores.count(I) &&
           (AA.getModRefInfo(I, StoreLoc) & Access))
         return true;
 
@@ -446,8 +581,8 @@ static Constant *getMemSetPatternValue(Value *V, const TargetData &TD) {
 bool LoopIdiomRecognize::
 processLoopStridedStore(Value *DestPtr, unsigned StoreSize,
                         unsigned StoreAlignment, Value *StoredVal,
-                        Instruction *TheStore, const SCEVAddRecExpr *Ev,
-                        const SCEV *BECount) {
+                        ArrayRef<Instruction*> TheStores,
+                        const SCEVAddRecExpr *Ev, const SCEV *BECount) {
 
   // If the stored value is a byte-wise value (like i32 -1), then it may be
   // turned into a memset of i8 -1, assuming that all the consecutive bytes
@@ -492,9 +627,10 @@ processLoopStridedStore(Value *DestPtr, unsigned StoreSize,
                            Preheader->getTerminator());
 
 
+  SmallPtrSet<Instruction*, 8> Ignored(TheStores.begin(), TheStores.end());
   if (mayLoopAccessLocation(BasePtr, AliasAnalysis::ModRef,
                             CurLoop, BECount,
-                            StoreSize, getAnalysis<AliasAnalysis>(), TheStore)){
+                            StoreSize, getAnalysis<AliasAnalysis>(), Ignored)){
     Expander.clear();
     // If we generated new code for the base pointer, clean up.
     deleteIfDeadInstruction(BasePtr, *SE, TLI);
@@ -521,7 +657,7 @@ processLoopStridedStore(Value *DestPtr, unsigned StoreSize,
   if (SplatValue)
     NewCall = Builder.CreateMemSet(BasePtr, SplatValue,NumBytes,StoreAlignment);
   else {
-    Module *M = TheStore->getParent()->getParent()->getParent();
+    Module *M = TheStores[0]->getParent()->getParent()->getParent();
     Value *MSP = M->getOrInsertFunction("memset_pattern16",
                                         Builder.getVoidTy(),
                                         Builder.getInt8PtrTy(),
@@ -540,20 +676,24 @@ processLoopStridedStore(Value *DestPtr, unsigned StoreSize,
   }
 
   DEBUG(dbgs() << "  Formed memset: " << *NewCall << "\n"
-               << "    from store to: " << *Ev << " at: " << *TheStore << "\n");
-  NewCall->setDebugLoc(TheStore->getDebugLoc());
-
-  // Okay, the memset has been formed.  Zap the original store and anything that
-  // feeds into it.
-  deleteDeadInstruction(TheStore, *SE, TLI);
+               << "    from store to: " << *Ev << " at: " << *TheStores[0]
+               << "\n");
+  NewCall->setDebugLoc(TheStores[0]->getDebugLoc());
+
+  // Okay, the memset has been formed.  Zap the original stores and anything
+  // that feeds into them.
+  for (unsigned i = 0, e = TheStores.size(); i != e; ++i)
+    deleteDeadInstruction(TheStores[i], *SE, TLI);
   ++NumMemSet;
   return true;
 }
 
 /// processLoopStoreOfLoopLoad - We see a strided store whose value is a
-/// same-strided load.
+/// same-strided load, or a group of such stores that together write StoreSize
+/// consecutive bytes per iteration, the first of which is at the start of
+/// StoreEv and stores a value loaded from the start of LoadEv.
 bool LoopIdiomRecognize::
-processLoopStoreOfLoopLoad(StoreInst *SI, unsigned StoreSize,
+processLoopStoreOfLoopLoad(ArrayRef<StoreInst*> Stores, unsigned StoreSize,
                            const SCEVAddRecExpr *StoreEv,
                            const SCEVAddRecExpr *LoadEv,
                            const SCEV *BECount) {
@@ -561,7 +701,9 @@ processLoopStoreOfLoopLoad(StoreInst *SI, unsigned StoreSize,
   if (!TLI->has(LibFunc::memcpy))
     return false;
 
+  StoreInst *SI = Stores[0];
   LoadInst *LI = cast<LoadInst>(SI->getValueOperand());
+  SmallPtrSet<Instruction*, 8> Ignored(Stores.begin(), Stores.end());
 
   // The trip count of the loop and the base pointer of the addrec SCEV is
   // guaranteed to be loop invariant, which means that it should dominate the
@@ -583,7 +725,7 @@ processLoopStoreOfLoopLoad(StoreInst *SI, unsigned StoreSize,
 
   if (mayLoopAccessLocation(StoreBasePtr, AliasAnalysis::ModRef,
                             CurLoop, BECount, StoreSize,
-                            getAnalysis<AliasAnalysis>(), SI)) {
+                            getAnalysis<AliasAnalysis>(), Ignored)) {
     Expander.clear();
     // If we generated new code for the base pointer, clean up.
     deleteIfDeadInstruction(StoreBasePtr, *SE, TLI);
@@ -598,7 +740,7 @@ processLoopStoreOfLoopLoad(StoreInst *SI, unsigned StoreSize,
                            Preheader->getTerminator());
 
   if (mayLoopAccessLocation(LoadBasePtr, AliasAnalysis::Mod, CurLoop, BECount,
-                            StoreSize, getAnalysis<AliasAnalysis>(), SI)) {
+                            StoreSize, getAnalysis<AliasAnalysis>(), Ignored)) {
     Expander.clear();
     // If we generated new code for the base pointer, clean up.
     deleteIfDeadInstruction(LoadBasePtr, *SE, TLI);
@@ -633,9 +775,425 @@ processLoopStoreOfLoopLoad(StoreInst *SI, unsigned StoreSize,
                << "    from store ptr=" << *StoreEv << " at: " << *SI << "\n");
 
 
-  // Okay, the memset has been formed.  Zap the original store and anything that
-  // feeds into it.
-  deleteDeadInstruction(SI, *SE, TLI);
+  // Okay, the memcpy has been formed.  Zap the original stores and anything
+  // that feeds into them.
+  for (unsigned i = 0, e = Stores.size(); i != e; ++i)
+    deleteDeadInstruction(Stores[i], *SE, TLI);
   ++NumMemCpy;
   return true;
 }
+
+/// runOnNoncountableLoop - Process a loop whose trip count is not computable,
+/// which may be an idiom that computes it.
+bool LoopIdiomRecognize::runOnNoncountableLoop() {
+  DEBUG(dbgs() << "loop-idiom Scanning non-countable loop: F["
+               << CurLoop->getHeader()->getParent()->getName()
+               << "] Loop %" << CurLoop->getHeader()->getName() << "\n");
+
+  return recognizeBitCount() || recognizeStrLen() || recognizeMemCmp();
+}
+
+/// getZeroExitTest - If the single block loop L exits when a value becomes
+/// zero, return the compare of that value against zero.
+static ICmpInst *getZeroExitTest(Loop *L) {
+  if (L->getNumBlocks() != 1 || L->getExitBlock() == 0)
+    return 0;
+  BranchInst *Br = dyn_cast<BranchInst>(L->getHeader()->getTerminator());
+  if (Br == 0 || !Br->isConditional())
+    return 0;
+  ICmpInst *Cmp = dyn_cast<ICmpInst>(Br->getCondition());
+  if (Cmp == 0 || !Cmp->isEquality() || !Cmp->hasOneUse() ||
+      !match(Cmp->getOperand(1), m_Zero()))
+    return 0;
+  unsigned ZeroSucc = Cmp->getPredicate() == ICmpInst::ICMP_EQ ? 0 : 1;
+  if (L->contains(Br->getSuccessor(ZeroSucc)))
+    return 0;
+  return Cmp;
+}
+
+/// isNonZeroOnEntry - Return true if V is known to be nonzero whenever the
+/// loop with the specified preheader is entered.
+static bool isNonZeroOnEntry(Value *V, BasicBlock *Preheader,
+                             const TargetData *TD) {
+  if (isKnownNonZero(V, TD))
+    return true;
+
+  // Look for the guard that skips the loop for zero.
+  BasicBlock *Pred = Preheader->getSinglePredecessor();
+  if (Pred == 0)
+    return false;
+  BranchInst *Br = dyn_cast<BranchInst>(Pred->getTerminator());
+  if (Br == 0 || !Br->isConditional())
+    return false;
+  ICmpInst *Cmp = dyn_cast<ICmpInst>(Br->getCondition());
+  if (Cmp == 0 || !Cmp->isEquality() || Cmp->getOperand(0) != V ||
+      !match(Cmp->getOperand(1), m_Zero()))
+    return false;
+  unsigned NonZeroSucc = Cmp->getPredicate() == ICmpInst::ICMP_EQ ? 1 : 0;
+  return Br->getSuccessor(NonZeroSucc) == Preheader &&
+         Br->getSuccessor(1 - NonZeroSucc) != Preheader;
+}
+
+/// rewriteLoopExitCount - The single block loop exits through ExitCond, a
+/// compare against zero, after exactly TripCount iterations.  Make the trip
+/// count visible by counting it down to zero instead.
+void LoopIdiomRecognize::rewriteLoopExitCount(ICmpInst *ExitCond,
+                                              Value *TripCount) {
+  BasicBlock *Header = CurLoop->getHeader();
+  Type *Ty = TripCount->getType();
+  PHINode *Phi = PHINode::Create(Ty, 2, "tcphi", Header->begin());
+  IRBuilder<> Builder(ExitCond);
+  Value *Dec = Builder.CreateAdd(Phi, Constant::getAllOnesValue(Ty), "tcdec");
+  Phi->addIncoming(TripCount, CurLoop->getLoopPreheader());
+  Phi->addIncoming(Dec, Header);
+
+  Value *NewCond = Builder.CreateICmp(ExitCond->getPredicate(), Dec,
+                                      Constant::getNullValue(Ty));
+  NewCond->takeName(ExitCond);
+  ExitCond->replaceAllUsesWith(NewCond);
+  deleteDeadInstruction(ExitCond, *SE, TLI);
+  SE->forgetLoop(CurLoop);
+}
+
+/// recognizeBitCount - Recognize a loop that counts the bits of a value that
+/// is nonzero on entry:
+///   do { x &= x - 1; ++n; } while (x);    // n += ctpop(x)
+///   do { x >>= 1; ++n; } while (x);       // n += BitWidth - ctlz(x)
+///   do { x <<= 1; ++n; } while (x);       // n += BitWidth - cttz(x)
+/// The loop may only update x and counters that step by one.
+bool LoopIdiomRecognize::recognizeBitCount() {
+  ICmpInst *ExitCond = getZeroExitTest(CurLoop);
+  if (ExitCond == 0)
+    return false;
+  BasicBlock *Header = CurLoop->getHeader();
+  BasicBlock *Preheader = CurLoop->getLoopPreheader();
+
+  // Match the update of x.
+  Instruction *Next = dyn_cast<Instruction>(ExitCond->getOperand(0));
+  if (Next == 0 || Next->getParent() != Header)
+    return false;
+  Value *X = 0;
+  Instruction *Dec = 0;
+  Intrinsic::ID IID;
+  if (Next->getOpcode() == Instruction::And) {
+    IID = Intrinsic::ctpop;
+    for (unsigned i = 0; i != 2 && X == 0; ++i) {
+      Value *Op = Next->getOperand(i), *Other = Next->getOperand(1 - i);
+      if (match(Op, m_Add(m_Specific(Other), m_AllOnes())) ||
+          match(Op, m_Sub(m_Specific(Other), m_One()))) {
+        X = Other;
+        Dec = cast<Instruction>(Op);
+      }
+    }
+  } else if (match(Next, m_LShr(m_Value(X), m_One()))) {
+    IID = Intrinsic::ctlz;
+  } else if (match(Next, m_Shl(m_Value(X), m_One()))) {
+    IID = Intrinsic::cttz;
+  } else {
+    return false;
+  }
+  PHINode *Phi = dyn_cast_or_null<PHINode>(X);
+  if (Phi == 0 || Phi->getParent() != Header ||
+      Phi->getIncomingValueForBlock(Header) != Next)
+    return false;
+  Value *Init = Phi->getIncomingValueForBlock(Preheader);
+  if (!isNonZeroOnEntry(Init, Preheader, TD))
+    return false;
+
+  // The other phis must be counters that step by one, and the loop must not
+  // do anything else.
+  SmallVector<PHINode*, 4> Counters;
+  for (BasicBlock::iterator I = Header->begin(); isa<PHINode>(I); ++I) {
+    PHINode *P = cast<PHINode>(I);
+    if (P == Phi)
+      continue;
+    Value *Inc = P->getIncomingValueForBlock(Header);
+    if (!P->getType()->isIntegerTy() ||
+        !match(Inc, m_Add(m_Specific(P), m_One())) ||
+        cast<Instruction>(Inc)->getParent() != Header)
+      return false;
+    Counters.push_back(P);
+  }
+  if (Counters.empty() ||
+      Header->size() != 2 * Counters.size() + (Dec ? 5 : 4))
+    return false;
+
+  // Every live-out value must be a counter, or x after the last iteration,
+  // which is zero.
+  BasicBlock *Exit = CurLoop->getExitBlock();
+  for (BasicBlock::iterator I = Exit->begin(); isa<PHINode>(I); ++I) {
+    Value *V = cast<PHINode>(I)->getIncomingValueForBlock(Header);
+    if (V == Phi || V == Dec)
+      return false;
+  }
+
+  Type *Ty = Init->getType();
+  unsigned BitWidth = Ty->getPrimitiveSizeInBits();
+  if (IID == Intrinsic::ctpop &&
+      TTI->getPopcntSupport(BitWidth) != TargetTransformInfo::PSK_FastHardware)
+    return false;
+
+  // Compute the trip count in the preheader.
+  Module *M = Header->getParent()->getParent();
+  IRBuilder<> Builder(Preheader->getTerminator());
+  Value *Fn = Intrinsic::getDeclaration(M, IID, Ty);
+  Value *TripCount;
+  if (IID == Intrinsic::ctpop) {
+    TripCount = Builder.CreateCall(Fn, Init, "popcnt");
+  } else {
+    // x is nonzero, so the result for zero does not matter.
+    Value *Zeros = Builder.CreateCall2(Fn, Init, Builder.getTrue(),
+                                       IID == Intrinsic::ctlz ? "ctlz" : "cttz");
+    TripCount = Builder.CreateSub(ConstantInt::get(Ty, BitWidth), Zeros,
+                                  "bits");
+  }
+  DEBUG(dbgs() << "  Formed bit count: " << *TripCount << "\n"
+               << "    from loop: " << *Header);
+
+  // Replace the live-out values with their final values.
+  for (BasicBlock::iterator I = Exit->begin(); isa<PHINode>(I); ++I) {
+    PHINode *PN = cast<PHINode>(I);
+    unsigned Idx = PN->getBasicBlockIndex(Header);
+    Value *V = PN->getIncomingValue(Idx);
+    if (V == Next) {
+      PN->setIncomingValue(Idx, Constant::getNullValue(Ty));
+      continue;
+    }
+    for (unsigned i = 0, e = Counters.size(); i != e; ++i) {
+      PHINode *P = Counters[i];
+      Value *Inc = P->getIncomingValueForBlock(Header);
+      if (V != P && V != Inc)
+        continue;
+      Value *Count =
+        Builder.CreateZExtOrTrunc(TripCount, cast<IntegerType>(P->getType()));
+      if (V == P)
+        Count = Builder.CreateSub(Count, ConstantInt::get(P->getType(), 1));
+      PN->setIncomingValue(Idx, Builder.CreateAdd(
+                                  P->getIncomingValueForBlock(Preheader), Count,
+                                  V->getName() + ".final"));
+    }
+  }
+
+  rewriteLoopExitCount(ExitCond, TripCount);
+  ++NumBitCount;
+  return true;
+}
+
+/// recognizeStrLen - Recognize a loop that scans a string for its terminator,
+/// like
+///   for (p = s; *p; ++p) ;
+/// It runs strlen(s) + 1 times, so the values of its induction variables after
+/// the loop are computed from a strlen call in the preheader.
+bool LoopIdiomRecognize::recognizeStrLen() {
+  if (!TLI->has(LibFunc::strlen))
+    return false;
+  ICmpInst *ExitCond = getZeroExitTest(CurLoop);
+  if (ExitCond == 0)
+    return false;
+  BasicBlock *Header = CurLoop->getHeader();
+  BasicBlock *Preheader = CurLoop->getLoopPreheader();
+
+  LoadInst *Load = dyn_cast<LoadInst>(ExitCond->getOperand(0));
+  if (Load == 0 || !Load->isSimple() || !Load->getType()->isIntegerTy(8) ||
+      Load->getParent() != Header)
+    return false;
+  const SCEVAddRecExpr *Ev =
+    dyn_cast<SCEVAddRecExpr>(SE->getSCEV(Load->getPointerOperand()));
+  if (Ev == 0 || Ev->getLoop() != CurLoop || !Ev->isAffine() ||
+      !Ev->getStepRecurrence(*SE)->isOne())
+    return false;
+
+  for (BasicBlock::iterator I = Header->begin(), E = Header->end(); I != E; ++I)
+    if (I->mayHaveSideEffects())
+      return false;
+
+  // Every live-out value must be loop invariant or an induction variable.
+  BasicBlock *Exit = CurLoop->getExitBlock();
+  SmallVector<std::pair<PHINode*, const SCEVAddRecExpr*>, 4> LiveOuts;
+  for (BasicBlock::iterator I = Exit->begin(); isa<PHINode>(I); ++I) {
+    PHINode *PN = cast<PHINode>(I);
+    Value *V = PN->getIncomingValueForBlock(Header);
+    if (CurLoop->isLoopInvariant(V))
+      continue;
+    if (!SE->isSCEVable(V->getType()))
+      return false;
+    const SCEVAddRecExpr *AR = dyn_cast<SCEVAddRecExpr>(SE->getSCEV(V));
+    if (AR == 0 || AR->getLoop() != CurLoop || !AR->isAffine())
+      return false;
+    LiveOuts.push_back(std::make_pair(PN, AR));
+  }
+
+  // The loop exits in the iteration that loads the terminator.
+  IRBuilder<> Builder(Preheader->getTerminator());
+  SCEVExpander Expander(*SE, "loop-idiom");
+  Value *Base =
+    Expander.expandCodeFor(Ev->getStart(),
+                           Builder.getInt8PtrTy(Load->getPointerAddressSpace()),
+                           Preheader->getTerminator());
+  Value *StrLen = EmitStrLen(Base, Builder, TD, TLI);
+  const SCEV *LastIteration = SE->getSCEV(StrLen);
+  DEBUG(dbgs() << "  Formed strlen: " << *StrLen << "\n"
+               << "    from load ptr=" << *Ev << " at: " << *Load << "\n");
+
+  for (unsigned i = 0, e = LiveOuts.size(); i != e; ++i) {
+    PHINode *PN = LiveOuts[i].first;
+    const SCEVAddRecExpr *AR = LiveOuts[i].second;
+    const SCEV *Step = AR->getStepRecurrence(*SE);
+    const SCEV *It = SE->getTruncateOrZeroExtend(LastIteration,
+                                                 Step->getType());
+    const SCEV *Final = SE->getAddExpr(AR->getStart(),
+                                       SE->getMulExpr(It, Step));
+    PN->setIncomingValue(PN->getBasicBlockIndex(Header),
+                         Expander.expandCodeFor(Final, PN->getType(),
+                                                Preheader->getTerminator()));
+  }
+
+  Value *TripCount =
+    Builder.CreateNUWAdd(StrLen, ConstantInt::get(StrLen->getType(), 1));
+  rewriteLoopExitCount(ExitCond, TripCount);
+  ++NumStrLen;
+  return true;
+}
+
+/// isDereferenceableFor - Return true if the NumBytes bytes starting at the
+/// address Start are known to lie within a single object.
+static bool isDereferenceableFor(const SCEV *Start, uint64_t NumBytes,
+                                 ScalarEvolution *SE, const TargetData *TD,
+                                 const TargetLibraryInfo *TLI) {
+  const SCEVUnknown *Base = dyn_cast<SCEVUnknown>(SE->getPointerBase(Start));
+  if (Base == 0)
+    return false;
+  const SCEVConstant *Offset =
+    dyn_cast<SCEVConstant>(SE->getMinusSCEV(Start, Base));
+  if (Offset == 0 || Offset->getValue()->isNegative())
+    return false;
+  uint64_t ObjSize;
+  if (!getObjectSize(Base->getValue(), ObjSize, TD, TLI))
+    return false;
+  uint64_t Off = Offset->getValue()->getZExtValue();
+  return Off <= ObjSize && NumBytes <= ObjSize - Off;
+}
+
+/// recognizeMemCmp - Recognize a loop that compares two arrays for equality,
+/// like
+///   for (i = 0; i != n; ++i)
+///     if (a[i] != b[i])
+///       break;
+/// where both exits reach the same block, which only selects between loop
+/// invariant values depending on the exit taken.  The selection is made on the
+/// result of memcmp(a, b, n * sizeof(*a)) in the preheader instead, and the
+/// mismatch exit is removed from the loop.
+///
+/// Unlike the loop, memcmp may read both arrays past the first mismatch, so
+/// the trip count must be a constant and both arrays must be objects known to
+/// be large enough for the full length of the loop.
+bool LoopIdiomRecognize::recognizeMemCmp() {
+  if (!TLI->has(LibFunc::memcmp) || CurLoop->getNumBlocks() != 2)
+    return false;
+  BasicBlock *Header = CurLoop->getHeader();
+  BasicBlock *Latch = CurLoop->getLoopLatch();
+  BasicBlock *Preheader = CurLoop->getLoopPreheader();
+  BasicBlock *Exit = CurLoop->getUniqueExitBlock();
+  if (Latch == 0 || Latch == Header || Exit == 0 ||
+      !CurLoop->isLoopExiting(Latch))
+    return false;
+
+  // The header compares the elements and leaves the loop on a mismatch.
+  BranchInst *Br = dyn_cast<BranchInst>(Header->getTerminator());
+  if (Br == 0 || !Br->isConditional())
+    return false;
+  ICmpInst *Cmp = dyn_cast<ICmpInst>(Br->getCondition());
+  if (Cmp == 0 || !Cmp->isEquality() || !Cmp->hasOneUse())
+    return false;
+  unsigned MismatchSucc = Cmp->getPredicate() == ICmpInst::ICMP_NE ? 0 : 1;
+  if (Br->getSuccessor(MismatchSucc) != Exit ||
+      Br->getSuccessor(1 - MismatchSucc) != Latch)
+    return false;
+  LoadInst *LA = dyn_cast<LoadInst>(Cmp->getOperand(0));
+  LoadInst *LB = dyn_cast<LoadInst>(Cmp->getOperand(1));
+  if (LA == 0 || LB == 0 || !LA->isSimple() || !LB->isSimple() ||
+      !LA->getType()->isIntegerTy())
+    return false;
+
+  // Equal elements must be equal bytes, and the elements must be adjacent.
+  Type *EltTy = LA->getType();
+  uint64_t EltSize = TD->getTypeStoreSize(EltTy);
+  if (TD->getTypeSizeInBits(EltTy) != EltSize * 8)
+    return false;
+  const SCEVAddRecExpr *EvA =
+    dyn_cast<SCEVAddRecExpr>(SE->getSCEV(LA->getPointerOperand()));
+  const SCEVAddRecExpr *EvB =
+    dyn_cast<SCEVAddRecExpr>(SE->getSCEV(LB->getPointerOperand()));
+  if (EvA == 0 || EvB == 0 || EvA->getLoop() != CurLoop ||
+      EvB->getLoop() != CurLoop || !EvA->isAffine() || !EvB->isAffine())
+    return false;
+  const SCEVConstant *StepA = dyn_cast<SCEVConstant>(EvA->getOperand(1));
+  if (StepA == 0 || StepA->getValue()->getValue() != EltSize ||
+      EvB->getOperand(1) != StepA)
+    return false;
+
+  // The latch exit must be taken after a constant number of iterations, and
+  // memcmp must be able to read that many elements of both arrays.
+  const SCEVConstant *ExitCount =
+    dyn_cast<SCEVConstant>(SE->getExitCount(CurLoop, Latch));
+  if (ExitCount == 0 || ExitCount->getValue()->getValue().getActiveBits() > 32)
+    return false;
+  uint64_t NumBytes = (ExitCount->getValue()->getZExtValue() + 1) * EltSize;
+  if (!isDereferenceableFor(EvA->getStart(), NumBytes, SE, TD, TLI) ||
+      !isDereferenceableFor(EvB->getStart(), NumBytes, SE, TD, TLI))
+    return false;
+
+  for (Loop::block_iterator BI = CurLoop->block_begin(),
+       BE = CurLoop->block_end(); BI != BE; ++BI)
+    for (BasicBlock::iterator I = (*BI)->begin(), E = (*BI)->end(); I != E; ++I)
+      if (I->mayHaveSideEffects())
+        return false;
+
+  // The live-out values must only depend on the exit taken.
+  for (BasicBlock::iterator I = Exit->begin(); isa<PHINode>(I); ++I) {
+    PHINode *PN = cast<PHINode>(I);
+    if (!CurLoop->isLoopInvariant(PN->getIncomingValueForBlock(Header)) ||
+        !CurLoop->isLoopInvariant(PN->getIncomingValueForBlock(Latch)))
+      return false;
+  }
+
+  // Compare the arrays in the preheader.
+  IRBuilder<> Builder(Preheader->getTerminator());
+  SCEVExpander Expander(*SE, "loop-idiom");
+  Type *IntPtr = TD->getIntPtrType(Header->getContext());
+  Value *PtrA =
+    Expander.expandCodeFor(EvA->getStart(),
+                           Builder.getInt8PtrTy(LA->getPointerAddressSpace()),
+                           Preheader->getTerminator());
+  Value *PtrB =
+    Expander.expandCodeFor(EvB->getStart(),
+                           Builder.getInt8PtrTy(LB->getPointerAddressSpace()),
+                           Preheader->getTerminator());
+  Value *Res = EmitMemCmp(PtrA, PtrB, ConstantInt::get(IntPtr, NumBytes),
+                          Builder, TD, TLI);
+  Value *Equal = Builder.CreateICmpEQ(Res, Constant::getNullValue(Res->getType()),
+                                      "memcmp.eq");
+  DEBUG(dbgs() << "  Formed memcmp: " << *Res << "\n"
+               << "    from load ptrs=" << *EvA << " and " << *EvB
+               << " at: " << *Cmp << "\n");
+
+  for (BasicBlock::iterator I = Exit->begin(); isa<PHINode>(I); ++I) {
+    PHINode *PN = cast<PHINode>(I);
+    Value *Mismatch = PN->getIncomingValueForBlock(Header);
+    Value *Done = PN->getIncomingValueForBlock(Latch);
+    if (Mismatch != Done)
+      PN->setIncomingValue(PN->getBasicBlockIndex(Latch),
+                           Builder.CreateSelect(Equal, Done, Mismatch));
+  }
+
+  // Remove the mismatch exit.  The exit block is now only reached from the
+  // latch.
+  Exit->removePredecessor(Header);
+  BranchInst::Create(Latch, Br);
+  Br->eraseFromParent();
+  deleteDeadInstruction(Cmp, *SE, TLI);
+  DT->changeImmediateDominator(Exit, Latch);
+  SE->forgetLoop(CurLoop);
+  ++NumMemCmp;
+  return true;
+}
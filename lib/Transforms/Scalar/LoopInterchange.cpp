@@ -0,0 +1,434 @@
+//===- LoopInterchange.cpp - Interchange loops for cache locality ---------===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+//
+// This pass interchanges the two loops of a perfect loop nest when this makes
+// the memory accesses of the inner loop walk memory with a smaller stride,
+// e.g. when a row-major array is traversed column by column.
+//
+// The nest must be in the rotated form produced by -loop-rotate: the outer
+// header only computes values from the outer induction variable before
+// entering the inner loop, and the inner loop exits to the outer latch, which
+// only steps the outer induction variable.  Both loops must be counted by an
+// integer induction variable with a constant step, compared with a bound that
+// is invariant in the nest, so that the iteration space is a rectangle and
+// the interchange only changes the order in which it is walked.  The two
+// induction variables are then swapped in place, without changing the CFG.
+//
+// The interchange is legal if LoopDependenceAnalysis shows that no dependence
+// has distances of opposite signs in the two loops.  It is profitable if the
+// accesses of the new inner loop touch fewer cache lines per iteration,
+// counting each access as its stride clamped to the size of a cache line.
+//
+//===----------------------------------------------------------------------===//
+
+#define DEBUG_TYPE "loop-interchange"
+#include "llvm/Transforms/Scalar.h"
+#include "llvm/Instructions.h"
+#include "llvm/LLVMContext.h"
+#include "llvm/Analysis/Dominators.h"
+#include "llvm/Analysis/LoopDependenceAnalysis.h"
+#include "llvm/Analysis/LoopInfo.h"
+#include "llvm/Analysis/LoopPass.h"
+#include "llvm/Analysis/ScalarEvolution.h"
+#include "llvm/Analysis/ScalarEvolutionExpressions.h"
+#include "llvm/Analysis/ValueTracking.h"
+#include "llvm/Support/CommandLine.h"
+#include "llvm/Support/Debug.h"
+#include "llvm/Support/raw_ostream.h"
+#include "llvm/ADT/SmallVector.h"
+#include "llvm/ADT/Statistic.h"
+#include <algorithm>
+using namespace llvm;
+
+STATISTIC(NumInterchanged, "Number of loop nests interchanged");
+
+static cl::opt<unsigned>
+CacheLineSize("loop-interchange-cache-line-size", cl::init(64), cl::Hidden,
+              cl::desc("The cache line size assumed by the loop interchange "
+                       "cost model, in bytes"));
+
+namespace {
+  /// InductionInfo - The induction variable counting one loop of the nest.
+  /// Phi starts at its StartIdx operand and is stepped by Next, whose
+  /// StepIdx operand is a constant, and the loop exits on the value of Cmp,
+  /// which compares Phi or Next with a bound invariant in the nest.
+  struct InductionInfo {
+    PHINode *Phi;
+    BinaryOperator *Next;
+    ICmpInst *Cmp;
+    BranchInst *Br;
+    unsigned StartIdx;
+    unsigned StepIdx;
+
+    InductionInfo()
+      : Phi(0), Next(0), Cmp(0), Br(0), StartIdx(0), StepIdx(0) {}
+  };
+
+  class LoopInterchange : public LoopPass {
+    ScalarEvolution *SE;
+    LoopDependenceAnalysis *LDA;
+
+    bool analyzeInduction(Loop *L, Loop *Nest, InductionInfo &IV);
+    bool isLegal(Loop *Outer, Loop *Inner, ArrayRef<Instruction*> MemInsts);
+    unsigned getCost(const Loop *L, ArrayRef<Instruction*> MemInsts);
+    void interchange(Loop *Outer, Loop *Inner, InductionInfo &OuterIV,
+                     InductionInfo &InnerIV);
+
+  public:
+    static char ID; // Pass ID, replacement for typeid
+    LoopInterchange() : LoopPass(ID) {
+      initializeLoopInterchangePass(*PassRegistry::getPassRegistry());
+    }
+
+    virtual bool runOnLoop(Loop *L, LPPassManager &LPM);
+
+    virtual void getAnalysisUsage(AnalysisUsage &AU) const {
+      AU.addRequiredID(LoopSimplifyID);
+      AU.addPreservedID(LoopSimplifyID);
+      AU.addRequiredID(LCSSAID);
+      AU.addPreservedID(LCSSAID);
+      AU.addRequired<LoopInfo>();
+      AU.addPreserved<LoopInfo>();
+      AU.addRequired<ScalarEvolution>();
+      AU.addPreserved<ScalarEvolution>();
+      AU.addRequired<LoopDependenceAnalysis>();
+      AU.addPreserved<DominatorTree>();
+    }
+  };
+}
+
+char LoopInterchange::ID = 0;
+INITIALIZE_PASS_BEGIN(LoopInterchange, "loop-interchange",
+                      "Interchange loops for cache locality", false, false)
+INITIALIZE_PASS_DEPENDENCY(LoopInfo)
+INITIALIZE_PASS_DEPENDENCY(LoopSimplify)
+INITIALIZE_PASS_DEPENDENCY(LCSSA)
+INITIALIZE_PASS_DEPENDENCY(ScalarEvolution)
+INITIALIZE_PASS_DEPENDENCY(LoopDependenceAnalysis)
+INITIALIZE_PASS_END(LoopInterchange, "loop-interchange",
+                    "Interchange loops for cache locality", false, false)
+
+Pass *llvm::createLoopInterchangePass() { return new LoopInterchange(); }
+
+static Value *getPointerOperand(Instruction *I) {
+  if (LoadInst *LI = dyn_cast<LoadInst>(I))
+    return LI->getPointerOperand();
+  return cast<StoreInst>(I)->getPointerOperand();
+}
+
+/// analyzeInduction - Find the induction variable counting L, whose start
+/// and bound must be invariant in the loop nest Nest.
+bool LoopInterchange::analyzeInduction(Loop *L, Loop *Nest,
+                                       InductionInfo &IV) {
+  BasicBlock *Header = L->getHeader(), *Latch = L->getLoopLatch();
+  if (!Latch || L->getExitingBlock() != Latch)
+    return false;
+  IV.Br = dyn_cast<BranchInst>(Latch->getTerminator());
+  if (!IV.Br || !IV.Br->isConditional())
+    return false;
+
+  // The induction variable must be the only PHI of the header, so that no
+  // value is carried from one iteration of the loop to the next.
+  IV.Phi = dyn_cast<PHINode>(Header->begin());
+  if (!IV.Phi || !IV.Phi->getType()->isIntegerTy() ||
+      isa<PHINode>(IV.Phi->getNextNode()) ||
+      IV.Phi->getNumIncomingValues() != 2)
+    return false;
+  unsigned LatchIdx = IV.Phi->getIncomingBlock(0) == Latch ? 0 : 1;
+  IV.StartIdx = 1 - LatchIdx;
+  if (!Nest->isLoopInvariant(IV.Phi->getIncomingValue(IV.StartIdx)))
+    return false;
+
+  IV.Next = dyn_cast<BinaryOperator>(IV.Phi->getIncomingValue(LatchIdx));
+  if (!IV.Next || IV.Next->getOpcode() != Instruction::Add)
+    return false;
+  if (IV.Next->getOperand(0) == IV.Phi &&
+      isa<ConstantInt>(IV.Next->getOperand(1)))
+    IV.StepIdx = 1;
+  else if (IV.Next->getOperand(1) == IV.Phi &&
+           isa<ConstantInt>(IV.Next->getOperand(0)))
+    IV.StepIdx = 0;
+  else
+    return false;
+
+  IV.Cmp = dyn_cast<ICmpInst>(IV.Br->getCondition());
+  if (!IV.Cmp || !IV.Cmp->hasOneUse())
+    return false;
+  Value *Bound;
+  if (IV.Cmp->getOperand(0) == IV.Phi || IV.Cmp->getOperand(0) == IV.Next)
+    Bound = IV.Cmp->getOperand(1);
+  else if (IV.Cmp->getOperand(1) == IV.Phi ||
+           IV.Cmp->getOperand(1) == IV.Next)
+    Bound = IV.Cmp->getOperand(0);
+  else
+    return false;
+  if (!Nest->isLoopInvariant(Bound))
+    return false;
+
+  // The stepped value must only feed the PHI and the exit test.
+  for (Value::use_iterator UI = IV.Next->use_begin(), UE = IV.Next->use_end();
+       UI != UE; ++UI)
+    if (*UI != IV.Phi && *UI != IV.Cmp)
+      return false;
+  return true;
+}
+
+/// isLegal - Return true if no dependence between the memory accesses of
+/// the nest would be reversed by walking the iteration space in the other
+/// order, which is the case for the dependences whose distances in the two
+/// loops have opposite signs.
+bool LoopInterchange::isLegal(Loop *Outer, Loop *Inner,
+                              ArrayRef<Instruction*> MemInsts) {
+  for (unsigned i = 0, e = MemInsts.size(); i != e; ++i)
+    for (unsigned j = i; j != e; ++j) {
+      Instruction *A = MemInsts[i], *B = MemInsts[j];
+      if (!LDA->isDependencePair(A, B) || !LDA->depends(A, B))
+        continue;
+
+      SmallVector<std::pair<const Loop*, int64_t>, 4> Distances;
+      if (!LDA->getDistances(A, B, Distances)) {
+        DEBUG(dbgs() << "LoopInterchange: unknown dependence between " << *A
+                     << " and " << *B << "\n");
+        return false;
+      }
+      bool HasOuter = false, HasInner = false;
+      int64_t OuterDist = 0, InnerDist = 0;
+      for (unsigned k = 0, ke = Distances.size(); k != ke; ++k)
+        if (Distances[k].first == Outer) {
+          HasOuter = true;
+          OuterDist = Distances[k].second;
+        } else if (Distances[k].first == Inner) {
+          HasInner = true;
+          InnerDist = Distances[k].second;
+        }
+
+      // A loop without a distance may conflict at any distance, so the other
+      // loop must not carry the dependence.
+      bool Reversed;
+      if (!HasOuter && !HasInner)
+        Reversed = true;
+      else if (!HasOuter || !HasInner)
+        Reversed = (HasOuter ? OuterDist : InnerDist) != 0;
+      else
+        Reversed = (OuterDist < 0 && InnerDist > 0) ||
+                   (OuterDist > 0 && InnerDist < 0);
+      if (Reversed) {
+        DEBUG(dbgs() << "LoopInterchange: dependence between " << *A
+                     << " and " << *B << " prevents interchange\n");
+        return false;
+      }
+    }
+  return true;
+}
+
+/// getCost - Estimate the number of bytes of cache lines that MemInsts
+/// touch on each iteration if L is the innermost loop: the stride of each
+/// access in L, up to the size of a cache line.
+unsigned LoopInterchange::getCost(const Loop *L,
+                                  ArrayRef<Instruction*> MemInsts) {
+  unsigned Cost = 0;
+  for (unsigned i = 0, e = MemInsts.size(); i != e; ++i) {
+    // The recurrences of the outer loops are nested in the starts of the
+    // recurrences of the inner loops.
+    const SCEV *S = SE->getSCEV(getPointerOperand(MemInsts[i]));
+    const SCEVAddRecExpr *AR = dyn_cast<SCEVAddRecExpr>(S);
+    while (AR && AR->getLoop() != L) {
+      S = AR->getStart();
+      AR = dyn_cast<SCEVAddRecExpr>(S);
+    }
+
+    if (!AR) {
+      if (!SE->isLoopInvariant(S, L))
+        Cost += CacheLineSize;
+      continue;
+    }
+    const SCEVConstant *Step =
+      AR->isAffine() ? dyn_cast<SCEVConstant>(AR->getStepRecurrence(*SE)) : 0;
+    if (!Step || Step->getValue()->getValue().getMinSignedBits() > 32) {
+      Cost += CacheLineSize;
+      continue;
+    }
+    uint64_t Stride = Step->getValue()->getValue().abs().getZExtValue();
+    Cost += std::min(Stride, (uint64_t)CacheLineSize);
+  }
+  return Cost;
+}
+
+/// setExitTest - Make the loop counted by To exit under the condition Cmp
+/// tested for the induction variable From, which exited its loop when Cmp
+/// was ExitOnTrue.
+static void setExitTest(InductionInfo &To, const Loop *ToLoop, ICmpInst *Cmp,
+                        const InductionInfo &From, bool ExitOnTrue) {
+  bool ToExitsOnTrue = !ToLoop->contains(To.Br->getSuccessor(0));
+  ICmpInst *NewCmp = cast<ICmpInst>(Cmp->clone());
+  NewCmp->replaceUsesOfWith(From.Phi, To.Phi);
+  NewCmp->replaceUsesOfWith(From.Next, To.Next);
+  NewCmp->insertBefore(To.Br);
+  NewCmp->takeName(To.Cmp);
+  To.Br->setCondition(NewCmp);
+  if (ToExitsOnTrue != ExitOnTrue)
+    To.Br->swapSuccessors();
+}
+
+/// interchange - Swap the induction variables of the outer and inner loops,
+/// so that each loop walks the range of the other one.
+void LoopInterchange::interchange(Loop *Outer, Loop *Inner,
+                                  InductionInfo &OuterIV,
+                                  InductionInfo &InnerIV) {
+  SE->forgetLoop(Outer);
+
+  // Sink the computations of the outer header into the inner loop, which
+  // now walks the range of the outer induction variable.
+  BasicBlock *OuterHeader = Outer->getHeader();
+  Instruction *InsertPt = Inner->getHeader()->getFirstNonPHI();
+  for (BasicBlock::iterator I = OuterHeader->getFirstNonPHI(),
+       E = OuterHeader->getTerminator(); I != E; ) {
+    Instruction *Inst = I++;
+    Inst->moveBefore(InsertPt);
+  }
+
+  // Swap the uses of the two induction variables in the loop body.
+  SmallVector<Use*, 16> OuterUses, InnerUses;
+  for (Value::use_iterator UI = OuterIV.Phi->use_begin(),
+       UE = OuterIV.Phi->use_end(); UI != UE; ++UI)
+    if (*UI != OuterIV.Next && *UI != OuterIV.Cmp)
+      OuterUses.push_back(&UI.getUse());
+  for (Value::use_iterator UI = InnerIV.Phi->use_begin(),
+       UE = InnerIV.Phi->use_end(); UI != UE; ++UI)
+    if (*UI != InnerIV.Next && *UI != InnerIV.Cmp)
+      InnerUses.push_back(&UI.getUse());
+  for (unsigned i = 0, e = OuterUses.size(); i != e; ++i)
+    OuterUses[i]->set(InnerIV.Phi);
+  for (unsigned i = 0, e = InnerUses.size(); i != e; ++i)
+    InnerUses[i]->set(OuterIV.Phi);
+
+  // Swap the starts, steps and exit tests of the induction variables.
+  Value *OuterStart = OuterIV.Phi->getIncomingValue(OuterIV.StartIdx);
+  OuterIV.Phi->setIncomingValue(OuterIV.StartIdx,
+                         InnerIV.Phi->getIncomingValue(InnerIV.StartIdx));
+  InnerIV.Phi->setIncomingValue(InnerIV.StartIdx, OuterStart);
+
+  Value *OuterStep = OuterIV.Next->getOperand(OuterIV.StepIdx);
+  bool OuterNSW = OuterIV.Next->hasNoSignedWrap();
+  bool OuterNUW = OuterIV.Next->hasNoUnsignedWrap();
+  OuterIV.Next->setOperand(OuterIV.StepIdx,
+                           InnerIV.Next->getOperand(InnerIV.StepIdx));
+  OuterIV.Next->setHasNoSignedWrap(InnerIV.Next->hasNoSignedWrap());
+  OuterIV.Next->setHasNoUnsignedWrap(InnerIV.Next->hasNoUnsignedWrap());
+  InnerIV.Next->setOperand(InnerIV.StepIdx, OuterStep);
+  InnerIV.Next->setHasNoSignedWrap(OuterNSW);
+  InnerIV.Next->setHasNoUnsignedWrap(OuterNUW);
+
+  bool OuterExitsOnTrue = !Outer->contains(OuterIV.Br->getSuccessor(0));
+  bool InnerExitsOnTrue = !Inner->contains(InnerIV.Br->getSuccessor(0));
+  MDNode *OuterProf = OuterIV.Br->getMetadata(LLVMContext::MD_prof);
+  MDNode *InnerProf = InnerIV.Br->getMetadata(LLVMContext::MD_prof);
+  ICmpInst *OuterCmp = OuterIV.Cmp, *InnerCmp = InnerIV.Cmp;
+  setExitTest(OuterIV, Outer, InnerCmp, InnerIV, InnerExitsOnTrue);
+  setExitTest(InnerIV, Inner, OuterCmp, OuterIV, OuterExitsOnTrue);
+  OuterIV.Br->setMetadata(LLVMContext::MD_prof, InnerProf);
+  InnerIV.Br->setMetadata(LLVMContext::MD_prof, OuterProf);
+  OuterCmp->eraseFromParent();
+  InnerCmp->eraseFromParent();
+}
+
+bool LoopInterchange::runOnLoop(Loop *L, LPPassManager &LPM) {
+  // Only consider the outer loop of a nest of two loops.
+  if (L->getSubLoops().size() != 1)
+    return false;
+  Loop *Inner = L->getSubLoops()[0];
+  if (!Inner->empty())
+    return false;
+
+  SE = &getAnalysis<ScalarEvolution>();
+  LDA = &getAnalysis<LoopDependenceAnalysis>();
+
+  // The nest must be perfect: the outer header enters the inner loop, which
+  // exits to the outer latch.
+  BasicBlock *OuterHeader = L->getHeader();
+  BasicBlock *OuterLatch = L->getLoopLatch();
+  if (!L->getLoopPreheader() || !OuterLatch ||
+      Inner->getLoopPreheader() != OuterHeader ||
+      Inner->getExitBlock() != OuterLatch ||
+      OuterLatch->getSinglePredecessor() != Inner->getLoopLatch() ||
+      L->getNumBlocks() != Inner->getNumBlocks() + 2)
+    return false;
+
+  InductionInfo OuterIV, InnerIV;
+  if (!analyzeInduction(L, L, OuterIV) ||
+      !analyzeInduction(Inner, L, InnerIV) ||
+      OuterIV.Phi->getType() != InnerIV.Phi->getType())
+    return false;
+
+  // The outer latch must only step the outer induction variable, and the
+  // outer header only compute values that can be sunk into the inner loop.
+  if (OuterLatch->size() != 3 || OuterIV.Next->getParent() != OuterLatch ||
+      OuterIV.Cmp->getParent() != OuterLatch)
+    return false;
+  for (BasicBlock::iterator I = OuterHeader->getFirstNonPHI(),
+       E = OuterHeader->getTerminator(); I != E; ++I) {
+    if (I->mayReadFromMemory() || !isSafeToSpeculativelyExecute(I))
+      return false;
+    for (Value::use_iterator UI = I->use_begin(), UE = I->use_end();
+         UI != UE; ++UI)
+      if (!L->contains(cast<Instruction>(*UI)))
+        return false;
+  }
+  for (Value::use_iterator UI = OuterIV.Phi->use_begin(),
+       UE = OuterIV.Phi->use_end(); UI != UE; ++UI)
+    if (!L->contains(cast<Instruction>(*UI)))
+      return false;
+  for (Value::use_iterator UI = InnerIV.Phi->use_begin(),
+       UE = InnerIV.Phi->use_end(); UI != UE; ++UI)
+    if (!L->contains(cast<Instruction>(*UI)))
+      return false;
+
+  // Collect the memory accesses of the inner loop, which must all be simple
+  // loads and stores, and check that its values do not escape.
+  SmallVector<Instruction*, 16> MemInsts;
+  for (Loop::block_iterator BI = Inner->block_begin(),
+       BE = Inner->block_end(); BI != BE; ++BI)
+    for (BasicBlock::iterator I = (*BI)->begin(), E = (*BI)->end();
+         I != E; ++I) {
+      if (LoadInst *LI = dyn_cast<LoadInst>(I)) {
+        if (!LI->isSimple())
+          return false;
+        MemInsts.push_back(LI);
+      } else if (StoreInst *SI = dyn_cast<StoreInst>(I)) {
+        if (!SI->isSimple())
+          return false;
+        MemInsts.push_back(SI);
+      } else if (I->mayReadFromMemory() || I->mayHaveSideEffects()) {
+        return false;
+      }
+      for (Value::use_iterator UI = I->use_begin(), UE = I->use_end();
+           UI != UE; ++UI)
+        if (!Inner->contains(cast<Instruction>(*UI)))
+          return false;
+    }
+  if (MemInsts.empty())
+    return false;
+
+  unsigned InnerCost = getCost(Inner, MemInsts);
+  unsigned OuterCost = getCost(L, MemInsts);
+  DEBUG(dbgs() << "LoopInterchange: nest at " << OuterHeader->getName()
+               << " costs " << InnerCost << ", interchanged " << OuterCost
+               << "\n");
+  if (OuterCost >= InnerCost)
+    return false;
+
+  if (!isLegal(L, Inner, MemInsts))
+    return false;
+
+  DEBUG(dbgs() << "LoopInterchange: interchanging nest at "
+               << OuterHeader->getName() << "\n");
+  interchange(L, Inner, OuterIV, InnerIV);
+  ++NumInterchanged;
+  return true;
+}
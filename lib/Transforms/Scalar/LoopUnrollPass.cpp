@@ -18,6 +18,7 @@
 #include "llvm/Analysis/LoopPass.h"
 #include "llvm/Analysis/CodeMetrics.h"
 #include "llvm/Analysis/ScalarEvolution.h"
+#include "llvm/Analysis/TargetTransformInfo.h"
 #include "llvm/Support/CommandLine.h"
 #include "llvm/Support/Debug.h"
 #include "llvm/Support/raw_ostream.h"
@@ -111,13 +112,16 @@ Pass *llvm::createLoopUnrollPass(int Threshold, int Count, int AllowPartial) {
   return new LoopUnroll(Threshold, Count, AllowPartial);
 }
 
-/// ApproximateLoopSize - Approximate the size of the loop.
+/// ApproximateLoopSize - Approximate the size of the loop.  If the target's
+/// cost model is available, address computations and casts that it folds
+/// away do not count.
 static unsigned ApproximateLoopSize(const Loop *L, unsigned &NumCalls,
-                                    const TargetData *TD) {
+                                    const TargetData *TD,
+                                    const TargetTransformInfo *TTI) {
   CodeMetrics Metrics;
   for (Loop::block_iterator I = L->block_begin(), E = L->block_end();
        I != E; ++I)
-    Metrics.analyzeBasicBlock(*I, TD);
+    Metrics.analyzeBasicBlock(*I, TD, TTI);
   NumCalls = Metrics.NumInlineCandidates;
 
   unsigned LoopSize = Metrics.NumInsts;
@@ -179,8 +183,10 @@ bool LoopUnroll::runOnLoop(Loop *L, LPPassManager &LPM) {
   // Enforce the threshold.
   if (Threshold != NoThreshold) {
     const TargetData *TD = getAnalysisIfAvailable<TargetData>();
+    const TargetTransformInfo *TTI =
+      getAnalysisIfAvailable<TargetTransformInfo>();
     unsigned NumInlineCandidates;
-    unsigned LoopSize = ApproximateLoopSize(L, NumInlineCandidates, TD);
+    unsigned LoopSize = ApproximateLoopSize(L, NumInlineCandidates, TD, TTI);
     DEBUG(dbgs() << "  Loop Size = " << LoopSize << "\n");
     if (NumInlineCandidates != 0) {
       DEBUG(dbgs() << "  Not unrolling loop with inlinable calls.\n");
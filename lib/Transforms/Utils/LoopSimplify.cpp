@@ -49,6 +49,7 @@
 #include "llvm/Analysis/Dominators.h"
 #include "llvm/Analysis/InstructionSimplify.h"
 #include "llvm/Analysis/LoopPass.h"
+#include "llvm/Analysis/MemorySSA.h"
 #include "llvm/Analysis/ScalarEvolution.h"
 #include "llvm/Transforms/Utils/BasicBlockUtils.h"
 #include "llvm/Transforms/Utils/Local.h"
@@ -89,6 +90,7 @@ namespace {
 
       AU.addPreserved<AliasAnalysis>();
       AU.addPreserved<ScalarEvolution>();
+      AU.addPreserved<MemorySSA>();  // Rebuilt lazily after changes.
       AU.addPreservedID(BreakCriticalEdgesID);  // No critical edges added.
     }
 
@@ -133,6 +135,11 @@ bool LoopSimplify::runOnLoop(Loop *l, LPPassManager &LPM) {
 
   Changed |= ProcessLoop(L, LPM);
 
+  // The new blocks and edges change where memory versions merge.
+  if (Changed)
+    if (MemorySSA *MSSA = getAnalysisIfAvailable<MemorySSA>())
+      MSSA->reset();
+
   return Changed;
 }
 
@@ -0,0 +1,434 @@
+//===-- SplitModule.cpp - Split a module into partitions ------------------===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+//
+// This file implements the ModuleSplitter class.
+//
+// Symbols that must be defined in the same partition are joined into groups
+// with IntEqClasses, numbering the symbols in module order.  The groups are
+// then handed out largest first to the partition with the fewest instructions
+// so far.  Local symbols are not joined with their users: after
+// internalization nearly every symbol is local, and the whole call graph would
+// end up in one group.  Instead, a local symbol that ends up in a different
+// partition than one of its users is promoted to a hidden external symbol.
+// Everything is ordered by position in the module, never by address, so the
+// result is deterministic.
+//
+//===----------------------------------------------------------------------===//
+
+#include "llvm/Transforms/Utils/SplitModule.h"
+#include "llvm/Constants.h"
+#include "llvm/DerivedTypes.h"
+#include "llvm/Module.h"
+#include "llvm/ADT/IntEqClasses.h"
+#include "llvm/ADT/SmallPtrSet.h"
+#include "llvm/Transforms/Utils/Cloning.h"
+#include <algorithm>
+using namespace llvm;
+
+namespace {
+/// References - The symbols that a definition refers to.
+struct References {
+  /// Symbols - The global values referred to, in order of first reference.
+  SmallVector<const GlobalValue*, 8> Symbols;
+
+  /// Pinned - Functions referred to by a blockaddress.  They must be defined
+  /// together with the reference whatever their linkage.
+  SmallVector<const GlobalValue*, 2> Pinned;
+
+  SmallPtrSet<const Constant*, 32> Visited;
+
+  void clear() {
+    Symbols.clear();
+    Pinned.clear();
+    Visited.clear();
+  }
+
+  void addConstant(const Constant *C);
+  void addFunction(const Function *F);
+};
+
+/// OrderByWeight - Order groups by decreasing weight, then by the position of
+/// their first symbol.
+struct OrderByWeight {
+  const SmallVectorImpl<uint64_t> &Weight;
+  OrderByWeight(const SmallVectorImpl<uint64_t> &W) : Weight(W) {}
+  bool operator()(unsigned A, unsigned B) const {
+    if (Weight[A] != Weight[B])
+      return Weight[A] > Weight[B];
+    return A < B;
+  }
+};
+} // end anonymous namespace
+
+void References::addConstant(const Constant *C) {
+  if (!Visited.insert(C))
+    return;
+  if (const BlockAddress *BA = dyn_cast<BlockAddress>(C)) {
+    Pinned.push_back(BA->getFunction());
+    return;
+  }
+  if (const GlobalValue *GV = dyn_cast<GlobalValue>(C)) {
+    Symbols.push_back(GV);
+    return;
+  }
+  for (User::const_op_iterator I = C->op_begin(), E = C->op_end(); I != E; ++I)
+    addConstant(cast<Constant>(*I));
+}
+
+void References::addFunction(const Function *F) {
+  for (Function::const_iterator BB = F->begin(), BE = F->end(); BB != BE; ++BB)
+    for (BasicBlock::const_iterator I = BB->begin(), E = BB->end(); I != E;
+         ++I)
+      for (User::const_op_iterator OI = I->op_begin(), OE = I->op_end();
+           OI != OE; ++OI)
+        if (const Constant *C = dyn_cast<Constant>(*OI))
+          addConstant(C);
+}
+
+/// getElements - Return the elements of an appending array, or null if the
+/// initializer is not a ConstantArray.
+static const ConstantArray *getElements(const GlobalVariable *GV) {
+  return dyn_cast<ConstantArray>(GV->getInitializer());
+}
+
+/// isAppendingArray - Return true if GV is one of the special arrays such as
+/// llvm.global_ctors that code generation merges with the same array in other
+/// objects.  Other appending arrays are emitted as ordinary external symbols,
+/// so they must be defined whole by a single partition.
+static bool isAppendingArray(const GlobalValue *GV) {
+  return GV->hasAppendingLinkage() && !GV->isDeclaration() &&
+         GV->getName().startswith("llvm.");
+}
+
+/// isDefinedWithUsers - Return true if GV must be defined in the same
+/// partition as its users.  That is the case for aliases of declarations,
+/// which the assembler resolves to the aliasee without emitting a symbol of
+/// their own, so they cannot be referred to from another object.
+static bool isDefinedWithUsers(const GlobalValue *GV) {
+  if (const GlobalAlias *GA = dyn_cast<GlobalAlias>(GV)) {
+    const GlobalValue *Aliasee = GA->resolveAliasedGlobal(false);
+    return !Aliasee || Aliasee->isDeclaration();
+  }
+  return false;
+}
+
+/// isCopyable - Return true if GV is a local constant whose address is not
+/// significant and that refers to no other symbol, such as a string literal.
+/// Every partition that uses it gets a copy of its own.
+static bool isCopyable(const GlobalValue *GV) {
+  const GlobalVariable *Var = dyn_cast<GlobalVariable>(GV);
+  return Var && Var->hasLocalLinkage() && Var->isConstant() &&
+         Var->hasUnnamedAddr() && !Var->isDeclaration() &&
+         Var->getInitializer()->getRelocationInfo() ==
+           Constant::NoRelocation;
+}
+
+/// addReferences - Add the symbols that the definition GV refers to to Refs.
+static void addReferences(References &Refs, const GlobalValue *GV) {
+  if (const Function *F = dyn_cast<Function>(GV))
+    Refs.addFunction(F);
+  else if (const GlobalVariable *Var = dyn_cast<GlobalVariable>(GV))
+    Refs.addConstant(Var->getInitializer());
+  else
+    Refs.addConstant(cast<GlobalAlias>(GV)->getAliasee());
+}
+
+ModuleSplitter::ModuleSplitter(Module &m, unsigned N)
+  : M(m), NumPartitions(N) {
+  assert(N && "Need at least one partition");
+
+  // Number the symbols in module order.  An unnamed definition is given a
+  // name so that the partitions that declare it refer to the same symbol.
+  SmallVector<GlobalValue*, 64> Symbols;
+  for (Module::iterator I = M.begin(), E = M.end(); I != E; ++I)
+    Symbols.push_back(I);
+  for (Module::global_iterator I = M.global_begin(), E = M.global_end();
+       I != E; ++I)
+    Symbols.push_back(I);
+  for (Module::alias_iterator I = M.alias_begin(), E = M.alias_end();
+       I != E; ++I)
+    Symbols.push_back(I);
+
+  DenseMap<const GlobalValue*, unsigned> Number;
+  for (unsigned i = 0, e = Symbols.size(); i != e; ++i) {
+    GlobalValue *GV = Symbols[i];
+    Number[GV] = i;
+    if (!GV->hasName() && !GV->hasLocalLinkage() && !GV->isDeclaration())
+      GV->setName("__llvm_split_unnamed");
+  }
+
+  // Join every definition with the symbols it refers to that cannot be
+  // referred to from another partition.  An alias joins everything in its
+  // aliasee.
+  IntEqClasses Groups(Symbols.size());
+  References Refs;
+  for (unsigned i = 0, e = Symbols.size(); i != e; ++i) {
+    GlobalValue *GV = Symbols[i];
+    if (GV->isDeclaration() || isAppendingArray(GV))
+      continue;
+    Refs.clear();
+    addReferences(Refs, GV);
+    bool JoinAll = isa<GlobalAlias>(GV);
+    for (unsigned j = 0, je = Refs.Symbols.size(); j != je; ++j)
+      if (JoinAll || isDefinedWithUsers(Refs.Symbols[j]))
+        Groups.join(i, Number[Refs.Symbols[j]]);
+    for (unsigned j = 0, je = Refs.Pinned.size(); j != je; ++j)
+      Groups.join(i, Number[Refs.Pinned[j]]);
+  }
+
+  // Each element of an appending array is anchored to the first definition it
+  // refers to, and the local symbols and the symbols that must be defined with
+  // their users are joined to the anchor.
+  SmallVector<std::pair<const GlobalVariable*, SmallVector<int, 4> >, 4>
+    Anchors;
+  for (Module::global_iterator I = M.global_begin(), E = M.global_end();
+       I != E; ++I) {
+    if (!isAppendingArray(I))
+      continue;
+    Anchors.push_back(std::make_pair(I, SmallVector<int, 4>()));
+    const ConstantArray *CA = getElements(I);
+    if (!CA)
+      continue;
+    for (unsigned i = 0, e = CA->getNumOperands(); i != e; ++i) {
+      Refs.clear();
+      Refs.addConstant(CA->getOperand(i));
+      int Anchor = -1;
+      for (unsigned j = 0, je = Refs.Pinned.size(); j != je && Anchor < 0; ++j)
+        Anchor = Number[Refs.Pinned[j]];
+      for (unsigned j = 0, je = Refs.Symbols.size(); j != je && Anchor < 0;
+           ++j)
+        if (!Refs.Symbols[j]->isDeclaration() &&
+            !isAppendingArray(Refs.Symbols[j]))
+          Anchor = Number[Refs.Symbols[j]];
+      Anchors.back().second.push_back(Anchor);
+      if (Anchor < 0)
+        continue;
+      for (unsigned j = 0, je = Refs.Symbols.size(); j != je; ++j)
+        if (Refs.Symbols[j]->hasLocalLinkage() ||
+            isDefinedWithUsers(Refs.Symbols[j]))
+          Groups.join(Anchor, Number[Refs.Symbols[j]]);
+      for (unsigned j = 0, je = Refs.Pinned.size(); j != je; ++j)
+        Groups.join(Anchor, Number[Refs.Pinned[j]]);
+    }
+  }
+  Groups.compress();
+
+  // Weigh the groups by instruction count.  Each variable counts as one.
+  SmallVector<uint64_t, 64> Weight(Groups.getNumClasses(), 0);
+  SmallVector<bool, 64> HasDefinition(Groups.getNumClasses(), false);
+  for (unsigned i = 0, e = Symbols.size(); i != e; ++i) {
+    GlobalValue *GV = Symbols[i];
+    if (GV->isDeclaration() || isAppendingArray(GV))
+      continue;
+    HasDefinition[Groups[i]] = true;
+    if (Function *F = dyn_cast<Function>(GV)) {
+      for (Function::iterator BB = F->begin(), BE = F->end(); BB != BE; ++BB)
+        Weight[Groups[i]] += BB->size();
+    } else if (isa<GlobalVariable>(GV))
+      ++Weight[Groups[i]];
+  }
+
+  SmallVector<unsigned, 64> Order;
+  for (unsigned i = 0, e = Groups.getNumClasses(); i != e; ++i)
+    if (HasDefinition[i])
+      Order.push_back(i);
+  std::sort(Order.begin(), Order.end(), OrderByWeight(Weight));
+
+  // Give each group to the least loaded partition.
+  SmallVector<unsigned, 64> GroupPartition(Groups.getNumClasses(), 0);
+  SmallVector<uint64_t, 8> Load(NumPartitions, 0);
+  for (unsigned i = 0, e = Order.size(); i != e; ++i) {
+    unsigned Best = 0;
+    for (unsigned p = 1; p != NumPartitions; ++p)
+      if (Load[p] < Load[Best])
+        Best = p;
+    GroupPartition[Order[i]] = Best;
+    Load[Best] += Weight[Order[i]];
+  }
+
+  for (unsigned i = 0, e = Symbols.size(); i != e; ++i)
+    if (!Symbols[i]->isDeclaration() && !isAppendingArray(Symbols[i]))
+      Partition[Symbols[i]] = GroupPartition[Groups[i]];
+
+  // Promote the local symbols that are used by another partition.  They get a
+  // name of their own so that they cannot clash with symbols of other objects.
+  SmallVector<bool, 64> Promote(Symbols.size(), false);
+  for (unsigned i = 0, e = Symbols.size(); i != e; ++i) {
+    GlobalValue *GV = Symbols[i];
+    if (GV->isDeclaration() || isAppendingArray(GV))
+      continue;
+    Refs.clear();
+    addReferences(Refs, GV);
+    for (unsigned j = 0, je = Refs.Symbols.size(); j != je; ++j) {
+      const GlobalValue *Ref = Refs.Symbols[j];
+      if (Ref->hasLocalLinkage() && !isCopyable(Ref) &&
+          Partition[Ref] != Partition[GV])
+        Promote[Number[Ref]] = true;
+    }
+  }
+  for (unsigned i = 0, e = Symbols.size(); i != e; ++i) {
+    if (!Promote[i])
+      continue;
+    GlobalValue *GV = Symbols[i];
+    if (GV->hasName())
+      GV->setName(GV->getName() + ".llvm.split");
+    else
+      GV->setName("__llvm_split_unnamed");
+    GV->setLinkage(GlobalValue::ExternalLinkage);
+    GV->setVisibility(GlobalValue::HiddenVisibility);
+  }
+
+  // Elements without an anchor go to partition 0.
+  for (unsigned i = 0, e = Anchors.size(); i != e; ++i) {
+    SmallVector<unsigned, 4> &Elts = ElementPartition[Anchors[i].first];
+    for (unsigned j = 0, je = Anchors[i].second.size(); j != je; ++j) {
+      int Anchor = Anchors[i].second[j];
+      Elts.push_back(Anchor < 0 ? 0 : GroupPartition[Groups[Anchor]]);
+    }
+  }
+}
+
+unsigned ModuleSplitter::getPartition(const GlobalValue *GV) const {
+  DenseMap<const GlobalValue*, unsigned>::const_iterator I = Partition.find(GV);
+  assert(I != Partition.end() && "Not a definition in the module");
+  return I->second;
+}
+
+/// createDeclaration - Return a new external declaration in M of the symbol
+/// that GA aliases, taking the name and visibility of GA.
+static GlobalValue *createDeclaration(Module &M, GlobalAlias *GA) {
+  PointerType *PTy = cast<PointerType>(GA->getType());
+  GlobalValue *Decl;
+  if (FunctionType *FTy = dyn_cast<FunctionType>(PTy->getElementType()))
+    Decl = Function::Create(FTy, GlobalValue::ExternalLinkage, "", &M);
+  else {
+    GlobalVariable::ThreadLocalMode TLM = GlobalVariable::NotThreadLocal;
+    if (const GlobalVariable *Aliasee =
+          dyn_cast_or_null<GlobalVariable>(GA->getAliasedGlobal()))
+      TLM = Aliasee->getThreadLocalMode();
+    Decl = new GlobalVariable(M, PTy->getElementType(), false,
+                              GlobalValue::ExternalLinkage, 0, "", 0, TLM,
+                              PTy->getAddressSpace());
+  }
+  Decl->takeName(GA);
+  Decl->setVisibility(GA->getVisibility());
+  return Decl;
+}
+
+Module *ModuleSplitter::createPartition(unsigned I) const {
+  assert(I < NumPartitions && "Partition out of range");
+  ValueToValueMapTy VMap;
+  Module *New = CloneModule(&M, VMap);
+  if (I != 0)
+    New->setModuleInlineAsm("");
+
+  // Turn the definitions of other partitions into declarations.  Their local
+  // symbols are only referred to by other partitions, so they are removed
+  // once nothing refers to them any more.  The other declarations and the
+  // copyable constants are removed if this partition does not use them.
+  SmallVector<GlobalValue*, 16> DeadLocals;
+  SmallVector<GlobalValue*, 16> MaybeUnused;
+  for (Module::const_iterator F = M.begin(), E = M.end(); F != E; ++F) {
+    if (F->isDeclaration() || getPartition(F) == I)
+      continue;
+    Function *NF = cast<Function>(VMap[F]);
+    NF->deleteBody();
+    if (F->hasLocalLinkage())
+      DeadLocals.push_back(NF);
+    else
+      MaybeUnused.push_back(NF);
+  }
+  for (Module::const_global_iterator GV = M.global_begin(),
+       E = M.global_end(); GV != E; ++GV) {
+    if (GV->isDeclaration() || isAppendingArray(GV))
+      continue;
+    GlobalVariable *NGV = cast<GlobalVariable>(VMap[GV]);
+    if (isCopyable(GV)) {
+      MaybeUnused.push_back(NGV);
+      continue;
+    }
+    if (getPartition(GV) == I)
+      continue;
+    NGV->setInitializer(0);
+    NGV->setLinkage(GlobalValue::ExternalLinkage);
+    if (GV->hasLocalLinkage())
+      DeadLocals.push_back(NGV);
+    else
+      MaybeUnused.push_back(NGV);
+  }
+  for (Module::const_alias_iterator GA = M.alias_begin(), E = M.alias_end();
+       GA != E; ++GA) {
+    if (getPartition(GA) == I)
+      continue;
+    GlobalAlias *NGA = cast<GlobalAlias>(VMap[GA]);
+    GlobalValue *Decl = createDeclaration(*New, NGA);
+    NGA->replaceAllUsesWith(ConstantExpr::getBitCast(Decl, NGA->getType()));
+    NGA->eraseFromParent();
+    if (GA->hasLocalLinkage())
+      DeadLocals.push_back(Decl);
+    else
+      MaybeUnused.push_back(Decl);
+  }
+
+  // Keep the elements of the appending arrays that belong to this partition.
+  for (Module::const_global_iterator GV = M.global_begin(),
+       E = M.global_end(); GV != E; ++GV) {
+    if (!isAppendingArray(GV))
+      continue;
+    GlobalVariable *NGV = cast<GlobalVariable>(VMap[GV]);
+    const SmallVectorImpl<unsigned> &Elts =
+      ElementPartition.find(GV)->second;
+    const ConstantArray *CA = getElements(NGV);
+    SmallVector<Constant*, 8> Kept;
+    if (!CA) {
+      if (I == 0)
+        continue;
+    } else {
+      for (unsigned i = 0, e = Elts.size(); i != e; ++i)
+        if (Elts[i] == I)
+          Kept.push_back(CA->getOperand(i));
+      if (Kept.size() == Elts.size())
+        continue;
+    }
+
+    GlobalVariable *Replacement = 0;
+    if (!Kept.empty()) {
+      ArrayType *ATy = ArrayType::get(CA->getType()->getElementType(),
+                                      Kept.size());
+      Replacement = new GlobalVariable(*New, ATy, NGV->isConstant(),
+                                       NGV->getLinkage(),
+                                       ConstantArray::get(ATy, Kept), "",
+                                       NGV, NGV->getThreadLocalMode(),
+                                       NGV->getType()->getAddressSpace());
+      Replacement->copyAttributesFrom(NGV);
+      Replacement->takeName(NGV);
+    }
+    if (!NGV->use_empty()) {
+      assert(Replacement && "Appending array used but emptied");
+      NGV->replaceAllUsesWith(ConstantExpr::getBitCast(Replacement,
+                                                       NGV->getType()));
+    }
+    NGV->eraseFromParent();
+  }
+
+  for (unsigned i = 0, e = MaybeUnused.size(); i != e; ++i) {
+    GlobalValue *GV = MaybeUnused[i];
+    GV->removeDeadConstantUsers();
+    if (GV->use_empty())
+      GV->eraseFromParent();
+  }
+
+  for (unsigned i = 0, e = DeadLocals.size(); i != e; ++i) {
+    GlobalValue *GV = DeadLocals[i];
+    GV->removeDeadConstantUsers();
+    assert(GV->use_empty() && "Local symbol used by another partition");
+    GV->eraseFromParent();
+  }
+  return New;
+}
@@ -36,6 +36,7 @@
 #include "llvm/Analysis/AliasSetTracker.h"
 #include "llvm/Analysis/ScalarEvolution.h"
 #include "llvm/Analysis/ScalarEvolutionExpressions.h"
+#include "llvm/Analysis/TargetTransformInfo.h"
 #include "llvm/Analysis/ValueTracking.h"
 #include "llvm/Support/CommandLine.h"
 #include "llvm/Support/Debug.h"
@@ -64,6 +65,10 @@ static cl::opt<unsigned>
 VectorBits("bb-vectorize-vector-bits", cl::init(128), cl::Hidden,
   cl::desc("The size of the native vector registers"));
 
+static cl::opt<bool>
+IgnoreTargetInfo("bb-vectorize-ignore-target-info", cl::init(false),
+  cl::Hidden, cl::desc("Ignore target information"));
+
 static cl::opt<unsigned>
 MaxIter("bb-vectorize-max-iter", cl::init(0), cl::Hidden,
   cl::desc("The maximum number of pairing iterations"));
@@ -179,6 +184,8 @@ namespace {
       AA = &P->getAnalysis<AliasAnalysis>();
       SE = &P->getAnalysis<ScalarEvolution>();
       TD = P->getAnalysisIfAvailable<TargetData>();
+      TTI = IgnoreTargetInfo ? 0 :
+        P->getAnalysisIfAvailable<TargetTransformInfo>();
     }
 
     typedef std::pair<Value *, Value *> ValuePair;
@@ -193,6 +200,7 @@ namespace {
     AliasAnalysis *AA;
     ScalarEvolution *SE;
     TargetData *TD;
+    TargetTransformInfo *TTI;
 
     // FIXME: const correct?
 
@@ -365,6 +373,8 @@ namespace {
       AA = &getAnalysis<AliasAnalysis>();
       SE = &getAnalysis<ScalarEvolution>();
       TD = getAnalysisIfAvailable<TargetData>();
+      TTI = IgnoreTargetInfo ? 0 :
+        getAnalysisIfAvailable<TargetTransformInfo>();
 
       return vectorizeBB(BB);
     }
@@ -417,6 +427,43 @@ namespace {
         T2 = T1;
     }
 
+    // Returns the type whose cost the target's cost model should be asked
+    // about: the operand type for comparisons, whose result is just i1, and
+    // the type that getInstructionTypes returns first otherwise.
+    static inline Type *getCostType(Instruction *I, Type *T1) {
+      if (isa<CmpInst>(I))
+        return I->getOperand(0)->getType();
+      return T1;
+    }
+
+    // Returns the cost, according to the target, of the operation performed
+    // by I when applied to values of type T1 (converted from T2 for casts).
+    // The cost of a vectorized pair is obtained by passing the vector types.
+    unsigned getInstrCost(Instruction *I, Type *T1, Type *T2) {
+      unsigned Opcode = I->getOpcode();
+      switch (Opcode) {
+      default: break;
+      case Instruction::Load:
+        return TTI->getMemoryOpCost(Opcode, T1,
+                                    cast<LoadInst>(I)->getAlignment(),
+                                    cast<LoadInst>(I)->getPointerAddressSpace());
+      case Instruction::Store:
+        return TTI->getMemoryOpCost(Opcode, T1,
+                                    cast<StoreInst>(I)->getAlignment(),
+                                    cast<StoreInst>(I)->getPointerAddressSpace());
+      case Instruction::ICmp:
+      case Instruction::FCmp:
+      case Instruction::Select:
+        return TTI->getCmpSelInstrCost(Opcode, T1);
+      }
+
+      if (I->isBinaryOp())
+        return TTI->getArithmeticInstrCost(Opcode, T1);
+      if (I->isCast())
+        return TTI->getCastInstrCost(Opcode, T1, T2);
+      return 1;
+    }
+
     // Returns the weight associated with the provided value. A chain of
     // candidate pairs has a length given by the sum of the weights of its
     // members (one weight per pair; the weight of each member of the pair
@@ -722,6 +769,23 @@ namespace {
     if (MaxTypeBits > Config.VectorBits)
       return false;
 
+    // If the target's cost model is available, do not form pairs whose vector
+    // operation costs more than the two scalar operations it replaces, for
+    // example because the vector type is split or the operation scalarized.
+    if (TTI) {
+      Type *ICT = getCostType(I, IT1), *JCT = getCostType(J, JT1);
+      unsigned ICost = getInstrCost(I, ICT, IT2);
+      unsigned JCost = getInstrCost(J, JCT, JT2);
+      unsigned VCost = getInstrCost(I, getVecTypeForPair(ICT, JCT),
+                                    getVecTypeForPair(IT2, JT2));
+      if (VCost > ICost + JCost) {
+        DEBUG(if (DebugCandidateSelection) dbgs() << "BBV: vector cost "
+              << VCost << " exceeds scalar cost " << ICost + JCost
+              << " for " << *I << " <-> " << *J << "\n");
+        return false;
+      }
+    }
+
     // FIXME: handle addsub-type operations!
 
     if (IsSimpleLoadStore) {
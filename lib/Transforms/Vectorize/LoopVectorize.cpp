@@ -0,0 +1,1303 @@
+//===- LoopVectorize.cpp - A Loop Vectorizer ------------------------------===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+//
+// This file implements a vectorizer for innermost counted loops.  It combines
+// VF consecutive iterations of the loop into one iteration that operates on
+// vectors of VF elements, so that the induction variable advances by VF
+// instead of by one.  The vector width is chosen by a cost model that asks
+// the target, through TargetTransformInfo, what each widened instruction
+// costs.
+//
+// The transformed code looks like this:
+//
+//   preheader:   compute the trip count and check, at runtime, that the
+//                vector loop runs at least once and that the arrays it
+//                reads and writes do not overlap; if not, go to scalar.ph
+//   vector.ph:   broadcast loop-invariant values
+//   vector.body: the widened loop, running (TripCount / VF) * VF iterations
+//   middle.block: reduce vector accumulators to scalars; if no iterations
+//                are left, leave the loop
+//   scalar.ph:   resume the inductions and reductions where the vector
+//                loop stopped, and run the original loop for the rest
+//
+// The pass has three parts: LoopVectorizationLegality checks that the loop
+// can be vectorized and collects its inductions, reductions and memory
+// accesses; LoopVectorizationCostModel picks the vectorization factor; and
+// InnerLoopVectorizer builds the vector loop.
+//
+//===----------------------------------------------------------------------===//
+
+#define LV_NAME "loop-vectorize"
+#define DEBUG_TYPE LV_NAME
+#include "llvm/Constants.h"
+#include "llvm/DerivedTypes.h"
+#include "llvm/Function.h"
+#include "llvm/Instructions.h"
+#include "llvm/IRBuilder.h"
+#include "llvm/LLVMContext.h"
+#include "llvm/Operator.h"
+#include "llvm/Pass.h"
+#include "llvm/ADT/DenseMap.h"
+#include "llvm/ADT/SmallPtrSet.h"
+#include "llvm/ADT/SmallVector.h"
+#include "llvm/ADT/Statistic.h"
+#include "llvm/Analysis/AliasAnalysis.h"
+#include "llvm/Analysis/Dominators.h"
+#include "llvm/Analysis/LoopInfo.h"
+#include "llvm/Analysis/LoopPass.h"
+#include "llvm/Analysis/ScalarEvolution.h"
+#include "llvm/Analysis/ScalarEvolutionExpander.h"
+#include "llvm/Analysis/ScalarEvolutionExpressions.h"
+#include "llvm/Analysis/TargetTransformInfo.h"
+#include "llvm/Analysis/ValueTracking.h"
+#include "llvm/Support/CommandLine.h"
+#include "llvm/Support/Debug.h"
+#include "llvm/Support/MathExtras.h"
+#include "llvm/Support/raw_ostream.h"
+#include "llvm/Target/TargetData.h"
+#include "llvm/Transforms/Scalar.h"
+#include "llvm/Transforms/Vectorize.h"
+using namespace llvm;
+
+static cl::opt<unsigned>
+VectorizationFactor("force-vector-width", cl::init(0), cl::Hidden,
+  cl::desc("Set the vectorization factor, which must be a power of two. "
+           "Zero lets the cost model decide"));
+
+static cl::opt<unsigned>
+MaxRuntimeChecks("vectorize-max-runtime-checks", cl::init(8), cl::Hidden,
+  cl::desc("The maximum number of pointer pairs that may be checked for "
+           "overlap at runtime"));
+
+/// TinyTripCountThreshold - Loops with a known trip count below this are not
+/// worth the setup of the vector loop and its epilogue.
+static const unsigned TinyTripCountThreshold = 16;
+
+STATISTIC(LoopsAnalyzed, "Number of innermost loops analyzed");
+STATISTIC(LoopsVectorized, "Number of loops vectorized");
+STATISTIC(LoopsWithRuntimeChecks,
+          "Number of vectorized loops that check for aliasing at runtime");
+
+namespace {
+
+//===----------------------------------------------------------------------===//
+/// LoopVectorizationLegality - Checks whether a loop can be vectorized and
+/// records what the cost model and the vectorizer need to know about it.
+///
+/// Only single-block innermost loops with a computable trip count are
+/// handled.  The header PHIs must be integer inductions that step by one or
+/// integer reductions, and all memory accesses must be simple loads and
+/// stores whose addresses are either consecutive or loop invariant.
+class LoopVectorizationLegality {
+public:
+  LoopVectorizationLegality(Loop *L, ScalarEvolution *SE, TargetData *TD)
+    : TheLoop(L), SE(SE), TD(TD), BackedgeTakenCount(0), WidestType(0) {}
+
+  /// ReductionKind - The operation that combines the partial results of a
+  /// reduction variable.
+  enum ReductionKind {
+    NoReduction,
+    IntegerAdd,
+    IntegerMult,
+    IntegerOr,
+    IntegerAnd,
+    IntegerXor
+  };
+
+  /// ReductionDescriptor - A reduction variable: its value on entry to the
+  /// loop, the instruction whose value leaves the loop, and the operation
+  /// that combines partial results.
+  struct ReductionDescriptor {
+    ReductionDescriptor() : StartValue(0), LoopExitInstr(0),
+                            Kind(NoReduction) {}
+    ReductionDescriptor(Value *Start, Instruction *Exit, ReductionKind K)
+      : StartValue(Start), LoopExitInstr(Exit), Kind(K) {}
+
+    Value *StartValue;
+    Instruction *LoopExitInstr;
+    ReductionKind Kind;
+  };
+
+  /// PointerRange - The first and last addresses that a load or store
+  /// accesses over all iterations of the loop.
+  struct PointerRange {
+    PointerRange(Value *Ptr, const SCEV *Start, const SCEV *Last,
+                 bool IsWrite, bool IsConsecutive)
+      : Ptr(Ptr), Start(Start), Last(Last), IsWrite(IsWrite),
+        IsConsecutive(IsConsecutive) {}
+
+    Value *Ptr;
+    const SCEV *Start;
+    const SCEV *Last;
+    bool IsWrite;
+    bool IsConsecutive;
+  };
+
+  /// ReductionList - Maps reduction PHIs to their descriptors.
+  typedef DenseMap<PHINode*, ReductionDescriptor> ReductionList;
+
+  /// InductionList - Maps induction PHIs to their start values.
+  typedef DenseMap<PHINode*, Value*> InductionList;
+
+  /// canVectorize - Return true if the loop can be vectorized.
+  bool canVectorize();
+
+  const ReductionList &getReductionVars() const { return Reductions; }
+  const InductionList &getInductionVars() const { return Inductions; }
+
+  /// getPointerRanges - Return the ranges of all memory accesses that need
+  /// to be checked for overlap.
+  const SmallVectorImpl<PointerRange> &getPointerRanges() const {
+    return Ranges;
+  }
+
+  /// getRuntimeChecks - Return the pairs of indices into the pointer ranges
+  /// that must be checked for overlap before entering the vector loop.
+  const SmallVectorImpl<std::pair<unsigned, unsigned> > &
+  getRuntimeChecks() const {
+    return Checks;
+  }
+
+  /// getBackedgeTakenCount - Return the number of times the loop branches
+  /// back to its header.
+  const SCEV *getBackedgeTakenCount() const { return BackedgeTakenCount; }
+
+  /// getWidestType - Return the size in bits of the widest scalar type that
+  /// is widened into a vector.
+  unsigned getWidestType() const { return WidestType; }
+
+  /// isConsecutivePtr - Return true if Ptr advances by the size of the value
+  /// it points to on each iteration.
+  bool isConsecutivePtr(Value *Ptr) const;
+
+  /// isUniformPtr - Return true if Ptr is the same on every iteration.
+  bool isUniformPtr(Value *Ptr) const {
+    return SE->isLoopInvariant(SE->getSCEV(Ptr), TheLoop);
+  }
+
+  /// isSkipped - Return true if I only computes addresses or the exit
+  /// condition.  Such instructions are not widened; the vectorizer computes
+  /// addresses and the loop control itself.
+  bool isSkipped(Instruction *I) const { return Skipped.count(I); }
+
+private:
+  /// canVectorizeInstrs - Check the instructions of the loop body and
+  /// classify the header PHIs.
+  bool canVectorizeInstrs(BasicBlock *BB);
+
+  /// canVectorizeMemory - Check the addresses of all loads and stores and
+  /// decide which of them need to be checked for overlap at runtime.
+  bool canVectorizeMemory(BasicBlock *BB);
+
+  /// isInductionVariable - Return true if Phi is an integer induction that
+  /// steps by one.
+  bool isInductionVariable(PHINode *Phi);
+
+  /// addReductionVar - If Phi is a reduction variable, record it and return
+  /// true.
+  bool addReductionVar(PHINode *Phi);
+
+  /// collectSkippedInstructions - Find the instructions that only feed
+  /// addresses, the exit condition or the induction updates.
+  void collectSkippedInstructions(BasicBlock *BB);
+
+  Loop *TheLoop;
+  ScalarEvolution *SE;
+  TargetData *TD;
+
+  const SCEV *BackedgeTakenCount;
+  ReductionList Reductions;
+  InductionList Inductions;
+  SmallPtrSet<Instruction*, 16> Skipped;
+  SmallVector<PointerRange, 8> Ranges;
+  SmallVector<std::pair<unsigned, unsigned>, 8> Checks;
+  unsigned WidestType;
+};
+
+//===----------------------------------------------------------------------===//
+/// LoopVectorizationCostModel - Estimates the cost of the loop body at each
+/// vectorization factor and picks the cheapest per scalar iteration.
+class LoopVectorizationCostModel {
+public:
+  LoopVectorizationCostModel(Loop *L, ScalarEvolution *SE,
+                             LoopVectorizationLegality *Legal,
+                             const TargetTransformInfo *TTI)
+    : TheLoop(L), SE(SE), Legal(Legal), TTI(TTI) {}
+
+  /// selectVectorizationFactor - Return the most profitable vectorization
+  /// factor, which is one if vectorization does not pay off.
+  unsigned selectVectorizationFactor();
+
+private:
+  /// expectedCost - Return the cost of one iteration of the loop body when
+  /// vectorized by VF.
+  unsigned expectedCost(unsigned VF);
+
+  /// getInstructionCost - Return the cost of I when widened to VF lanes.
+  unsigned getInstructionCost(Instruction *I, unsigned VF);
+
+  /// ToVectorTy - Return a vector of VF elements of type Scalar, or Scalar
+  /// itself if VF is one.
+  static Type *ToVectorTy(Type *Scalar, unsigned VF) {
+    if (VF == 1)
+      return Scalar;
+    return VectorType::get(Scalar, VF);
+  }
+
+  Loop *TheLoop;
+  ScalarEvolution *SE;
+  LoopVectorizationLegality *Legal;
+  const TargetTransformInfo *TTI;
+};
+
+//===----------------------------------------------------------------------===//
+/// InnerLoopVectorizer - Builds the vector loop, the runtime checks and the
+/// scalar epilogue for a loop that LoopVectorizationLegality accepted.
+class InnerLoopVectorizer {
+public:
+  InnerLoopVectorizer(Loop *OrigLoop, ScalarEvolution *SE, LoopInfo *LI,
+                      DominatorTree *DT, LPPassManager *LPM, unsigned VF)
+    : OrigLoop(OrigLoop), SE(SE), LI(LI), DT(DT), LPM(LPM), VF(VF),
+      Builder(OrigLoop->getHeader()->getContext()), Exp(*SE, "vector"),
+      Induction(0), TripCount(0), VectorCount(0), BypassBlock(0),
+      VectorPH(0), VectorBody(0), MiddleBlock(0), ScalarPH(0), ExitBlock(0),
+      BodyInsertPt(0) {}
+
+  /// vectorize - Vectorize the loop.
+  void vectorize(LoopVectorizationLegality *Legal) {
+    createEmptyLoop(Legal);
+    vectorizeLoop(Legal);
+    updateAnalysis();
+  }
+
+private:
+  /// createEmptyLoop - Create the blocks around the vector loop, the vector
+  /// induction variable, the runtime checks and the resume values of the
+  /// scalar loop.
+  void createEmptyLoop(LoopVectorizationLegality *Legal);
+
+  /// addRuntimeCheck - Emit code before Loc that computes whether any of
+  /// the accesses that Legal asked to check overlap.  Returns null if no
+  /// checks are needed.
+  Value *addRuntimeCheck(LoopVectorizationLegality *Legal, Instruction *Loc);
+
+  /// vectorizeLoop - Widen the instructions of the loop body into the
+  /// vector loop and reduce the reduction variables after it.
+  void vectorizeLoop(LoopVectorizationLegality *Legal);
+
+  /// widenInstruction - Emit the vector version of I.
+  void widenInstruction(Instruction *I, LoopVectorizationLegality *Legal);
+
+  /// updateAnalysis - Tell the dominator tree, LoopInfo and ScalarEvolution
+  /// about the new blocks.
+  void updateAnalysis();
+
+  /// getVectorValue - Return the vector version of V, which is either a
+  /// widened instruction, an induction vector or a broadcast invariant.
+  Value *getVectorValue(Value *V, LoopVectorizationLegality *Legal);
+
+  /// getBroadcastInstrs - Emit code at the builder's insertion point that
+  /// splats V into all lanes of a vector.
+  Value *getBroadcastInstrs(IRBuilder<> &B, Value *V);
+
+  /// getConsecutivePointer - Return a pointer to the vector of VF elements
+  /// that Ptr addresses in the current vector iteration.
+  Value *getConsecutivePointer(Value *Ptr);
+
+  /// expandInPreheader - Emit code for S before the bypass branch.
+  Value *expandInPreheader(const SCEV *S, Type *Ty) {
+    return Exp.expandCodeFor(S, Ty, BypassBlock->getTerminator());
+  }
+
+  Loop *OrigLoop;
+  ScalarEvolution *SE;
+  LoopInfo *LI;
+  DominatorTree *DT;
+  LPPassManager *LPM;
+  unsigned VF;
+
+  IRBuilder<> Builder;
+  SCEVExpander Exp;
+
+  /// Induction - The vector loop's counter, counting from zero by VF.
+  PHINode *Induction;
+  /// TripCount - The number of iterations of the original loop.
+  Value *TripCount;
+  /// VectorCount - The number of those iterations that the vector loop
+  /// runs: TripCount rounded down to a multiple of VF.
+  Value *VectorCount;
+
+  BasicBlock *BypassBlock;
+  BasicBlock *VectorPH;
+  BasicBlock *VectorBody;
+  BasicBlock *MiddleBlock;
+  BasicBlock *ScalarPH;
+  BasicBlock *ExitBlock;
+
+  /// BodyInsertPt - Widened instructions are inserted before this, the
+  /// increment of the vector induction variable.
+  Instruction *BodyInsertPt;
+
+  /// WidenMap - Maps scalar values to their vector versions.
+  DenseMap<Value*, Value*> WidenMap;
+  /// ReducedValues - Maps reduction exit instructions to the scalar value
+  /// the vector loop computed for them.
+  DenseMap<Value*, Value*> ReducedValues;
+};
+
+} // end anonymous namespace
+
+//===----------------------------------------------------------------------===//
+// LoopVectorizationLegality
+//===----------------------------------------------------------------------===//
+
+bool LoopVectorizationLegality::canVectorize() {
+  if (!TheLoop->empty() || TheLoop->getNumBlocks() != 1) {
+    DEBUG(dbgs() << "LV: Not a single-block innermost loop.\n");
+    return false;
+  }
+
+  BasicBlock *BB = TheLoop->getHeader();
+  if (!TheLoop->getLoopPreheader() || !TheLoop->getExitBlock() ||
+      TheLoop->getExitingBlock() != BB) {
+    DEBUG(dbgs() << "LV: Loop is not in simplified form.\n");
+    return false;
+  }
+
+  BranchInst *Br = dyn_cast<BranchInst>(BB->getTerminator());
+  if (!Br || !Br->isConditional()) {
+    DEBUG(dbgs() << "LV: Unsupported loop terminator.\n");
+    return false;
+  }
+
+  BackedgeTakenCount = SE->getBackedgeTakenCount(TheLoop);
+  if (isa<SCEVCouldNotCompute>(BackedgeTakenCount) ||
+      !BackedgeTakenCount->getType()->isIntegerTy()) {
+    DEBUG(dbgs() << "LV: Unknown trip count.\n");
+    return false;
+  }
+
+  if (!canVectorizeInstrs(BB))
+    return false;
+
+  collectSkippedInstructions(BB);
+
+  // Everything that is not skipped is widened, so its result and operand
+  // types must be valid vector element types.  Addresses are handled
+  // separately.
+  for (BasicBlock::iterator it = BB->begin(), e = BB->end(); it != e; ++it) {
+    Instruction *I = it;
+    if (isa<PHINode>(I) || isa<TerminatorInst>(I) || Skipped.count(I))
+      continue;
+
+    // Address computations are only supported when they feed loads and
+    // stores.  A GEP whose result is used as data would have to be widened.
+    if (isa<GetElementPtrInst>(I)) {
+      DEBUG(dbgs() << "LV: Found a GEP used as data: " << *I << "\n");
+      return false;
+    }
+
+    Value *PtrOp = 0;
+    if (LoadInst *LI = dyn_cast<LoadInst>(I))
+      PtrOp = LI->getPointerOperand();
+    else if (StoreInst *SI = dyn_cast<StoreInst>(I))
+      PtrOp = SI->getPointerOperand();
+
+    Type *Ty = isa<StoreInst>(I) ? I->getOperand(0)->getType() : I->getType();
+    if (!VectorType::isValidElementType(Ty)) {
+      DEBUG(dbgs() << "LV: Found an unwidenable value: " << *I << "\n");
+      return false;
+    }
+    for (unsigned i = 0, e = I->getNumOperands(); i != e; ++i)
+      if (I->getOperand(i) != PtrOp &&
+          !VectorType::isValidElementType(I->getOperand(i)->getType())) {
+        DEBUG(dbgs() << "LV: Found an unwidenable operand: " << *I << "\n");
+        return false;
+      }
+
+    if (!Ty->isIntegerTy(1))
+      WidestType = std::max(WidestType, Ty->getPrimitiveSizeInBits());
+  }
+
+  // Values computed in the loop may only leave it through the reductions.
+  BasicBlock *Exit = TheLoop->getExitBlock();
+  for (BasicBlock::iterator it = Exit->begin(); isa<PHINode>(it); ++it) {
+    PHINode *Phi = cast<PHINode>(it);
+    Instruction *V = dyn_cast<Instruction>(Phi->getIncomingValueForBlock(BB));
+    if (!V || !TheLoop->contains(V))
+      continue;
+    bool IsReductionExit = false;
+    for (ReductionList::iterator RI = Reductions.begin(), RE = Reductions.end();
+         RI != RE; ++RI)
+      if (RI->second.LoopExitInstr == V)
+        IsReductionExit = true;
+    if (!IsReductionExit) {
+      DEBUG(dbgs() << "LV: Found a value used outside the loop: " << *V
+                   << "\n");
+      return false;
+    }
+  }
+
+  return canVectorizeMemory(BB);
+}
+
+bool LoopVectorizationLegality::canVectorizeInstrs(BasicBlock *BB) {
+  BasicBlock *PreHeader = TheLoop->getLoopPreheader();
+
+  for (BasicBlock::iterator it = BB->begin(), e = BB->end(); it != e; ++it) {
+    Instruction *I = it;
+
+    if (PHINode *Phi = dyn_cast<PHINode>(I)) {
+      if (!Phi->getType()->isIntegerTy()) {
+        DEBUG(dbgs() << "LV: Found a non-integer PHI: " << *Phi << "\n");
+        return false;
+      }
+      if (isInductionVariable(Phi)) {
+        Inductions[Phi] = Phi->getIncomingValueForBlock(PreHeader);
+        continue;
+      }
+      if (addReductionVar(Phi))
+        continue;
+      DEBUG(dbgs() << "LV: Found an unidentified PHI: " << *Phi << "\n");
+      return false;
+    }
+
+    switch (I->getOpcode()) {
+    case Instruction::Br:
+    case Instruction::GetElementPtr:
+    case Instruction::ICmp:
+    case Instruction::FCmp:
+    case Instruction::Select:
+      break;
+    case Instruction::Load:
+      if (!cast<LoadInst>(I)->isSimple()) {
+        DEBUG(dbgs() << "LV: Found a non-simple load.\n");
+        return false;
+      }
+      break;
+    case Instruction::Store:
+      if (!cast<StoreInst>(I)->isSimple()) {
+        DEBUG(dbgs() << "LV: Found a non-simple store.\n");
+        return false;
+      }
+      break;
+    default:
+      if (I->isBinaryOp() || I->isCast())
+        break;
+      DEBUG(dbgs() << "LV: Found an unsupported instruction: " << *I << "\n");
+      return false;
+    }
+  }
+
+  if (Inductions.empty()) {
+    DEBUG(dbgs() << "LV: Did not find an induction variable.\n");
+    return false;
+  }
+  return true;
+}
+
+bool LoopVectorizationLegality::isInductionVariable(PHINode *Phi) {
+  const SCEVAddRecExpr *AR = dyn_cast<SCEVAddRecExpr>(SE->getSCEV(Phi));
+  if (!AR || AR->getLoop() != TheLoop || !AR->isAffine())
+    return false;
+  const SCEVConstant *Step =
+    dyn_cast<SCEVConstant>(AR->getStepRecurrence(*SE));
+  return Step && Step->getValue()->isOne();
+}
+
+/// getReductionKind - Return the kind of reduction that I performs on the
+/// running value Chain, or NoReduction.
+static LoopVectorizationLegality::ReductionKind
+getReductionKind(Instruction *I, Value *Chain) {
+  switch (I->getOpcode()) {
+  case Instruction::Add: return LoopVectorizationLegality::IntegerAdd;
+  case Instruction::Mul: return LoopVectorizationLegality::IntegerMult;
+  case Instruction::Or:  return LoopVectorizationLegality::IntegerOr;
+  case Instruction::And: return LoopVectorizationLegality::IntegerAnd;
+  case Instruction::Xor: return LoopVectorizationLegality::IntegerXor;
+  case Instruction::Sub:
+    // Subtracting from the running value accumulates a negated sum.
+    if (I->getOperand(0) == Chain)
+      return LoopVectorizationLegality::IntegerAdd;
+    return LoopVectorizationLegality::NoReduction;
+  default:
+    return LoopVectorizationLegality::NoReduction;
+  }
+}
+
+bool LoopVectorizationLegality::addReductionVar(PHINode *Phi) {
+  if (Phi->getNumIncomingValues() != 2)
+    return false;
+
+  Value *Start = Phi->getIncomingValueForBlock(TheLoop->getLoopPreheader());
+  Instruction *Exit =
+    dyn_cast<Instruction>(Phi->getIncomingValueForBlock(TheLoop->getLoopLatch()));
+  if (!Exit || Exit == Phi || !TheLoop->contains(Exit))
+    return false;
+
+  // Walk the chain of operations from the PHI to the value it is updated
+  // with.  Each link must have a single user, which is the next link and an
+  // operation of the same kind, so that the partial results of the lanes
+  // can be combined at the end.
+  ReductionKind Kind = NoReduction;
+  Instruction *Cur = Phi;
+  while (Cur != Exit) {
+    Instruction *Next = 0;
+    for (Value::use_iterator UI = Cur->use_begin(), E = Cur->use_end();
+         UI != E; ++UI) {
+      Instruction *U = cast<Instruction>(*UI);
+      if (Next || !TheLoop->contains(U))
+        return false;
+      Next = U;
+    }
+    if (!Next)
+      return false;
+
+    ReductionKind K = getReductionKind(Next, Cur);
+    if (K == NoReduction || (Kind != NoReduction && K != Kind))
+      return false;
+    Kind = K;
+    Cur = Next;
+  }
+
+  // The final value may only be used by the PHI and outside of the loop.
+  for (Value::use_iterator UI = Exit->use_begin(), E = Exit->use_end();
+       UI != E; ++UI) {
+    Instruction *U = cast<Instruction>(*UI);
+    if (U != Phi && TheLoop->contains(U))
+      return false;
+  }
+
+  Reductions[Phi] = ReductionDescriptor(Start, Exit, Kind);
+  return true;
+}
+
+void LoopVectorizationLegality::collectSkippedInstructions(BasicBlock *BB) {
+  // An instruction is skipped if all of its users are skipped, the loop
+  // branch, induction PHIs, or loads and stores that use it as an address.
+  // The increment of an induction is used by the PHI above it, so iterate
+  // until nothing changes.
+  bool Changed = true;
+  while (Changed) {
+    Changed = false;
+    for (BasicBlock::iterator it = BB->end(), b = BB->begin(); it != b; ) {
+      Instruction *I = --it;
+      if (Skipped.count(I) || isa<TerminatorInst>(I) || isa<StoreInst>(I))
+        continue;
+      if (PHINode *Phi = dyn_cast<PHINode>(I))
+        if (!Inductions.count(Phi))
+          continue;
+
+      bool AllUsersSkipped = true;
+      for (Value::use_iterator UI = I->use_begin(), E = I->use_end();
+           UI != E && AllUsersSkipped; ++UI) {
+        Instruction *U = cast<Instruction>(*UI);
+        if (!TheLoop->contains(U))
+          AllUsersSkipped = false;
+        else if (Skipped.count(U) || isa<TerminatorInst>(U))
+          continue;
+        else if (PHINode *P = dyn_cast<PHINode>(U))
+          AllUsersSkipped = Inductions.count(P);
+        else if (LoadInst *LI = dyn_cast<LoadInst>(U))
+          AllUsersSkipped = LI->getPointerOperand() == I;
+        else if (StoreInst *SI = dyn_cast<StoreInst>(U))
+          AllUsersSkipped = SI->getPointerOperand() == I &&
+                            SI->getValueOperand() != I;
+        else
+          AllUsersSkipped = false;
+      }
+
+      if (AllUsersSkipped) {
+        Skipped.insert(I);
+        Changed = true;
+      }
+    }
+  }
+}
+
+bool LoopVectorizationLegality::isConsecutivePtr(Value *Ptr) const {
+  const SCEVAddRecExpr *AR = dyn_cast<SCEVAddRecExpr>(SE->getSCEV(Ptr));
+  if (!AR || AR->getLoop() != TheLoop || !AR->isAffine())
+    return false;
+  const SCEVConstant *Step =
+    dyn_cast<SCEVConstant>(AR->getStepRecurrence(*SE));
+  if (!Step)
+    return false;
+  Type *EltTy = cast<PointerType>(Ptr->getType())->getElementType();
+  return Step->getValue()->getValue() == TD->getTypeAllocSize(EltTy) &&
+         TD->getTypeAllocSize(EltTy) == TD->getTypeStoreSize(EltTy);
+}
+
+bool LoopVectorizationLegality::canVectorizeMemory(BasicBlock *BB) {
+  bool HasStores = false;
+  for (BasicBlock::iterator it = BB->begin(), e = BB->end(); it != e; ++it) {
+    Instruction *I = it;
+    if (Skipped.count(I))
+      continue;
+
+    Value *Ptr;
+    bool IsWrite = isa<StoreInst>(I);
+    if (LoadInst *LI = dyn_cast<LoadInst>(I))
+      Ptr = LI->getPointerOperand();
+    else if (StoreInst *SI = dyn_cast<StoreInst>(I))
+      Ptr = SI->getPointerOperand();
+    else
+      continue;
+
+    if (isConsecutivePtr(Ptr)) {
+      const SCEVAddRecExpr *AR = cast<SCEVAddRecExpr>(SE->getSCEV(Ptr));
+      Ranges.push_back(PointerRange(Ptr, AR->getStart(),
+                                    AR->evaluateAtIteration(BackedgeTakenCount,
+                                                            *SE),
+                                    IsWrite, true));
+    } else if (!IsWrite && isUniformPtr(Ptr)) {
+      const SCEV *S = SE->getSCEV(Ptr);
+      Ranges.push_back(PointerRange(Ptr, S, S, false, false));
+    } else {
+      DEBUG(dbgs() << "LV: Found a non-consecutive access: " << *I << "\n");
+      return false;
+    }
+    HasStores |= IsWrite;
+  }
+
+  if (!HasStores)
+    return true;
+
+  for (unsigned i = 0, e = Ranges.size(); i != e; ++i)
+    for (unsigned j = i + 1; j != e; ++j) {
+      const PointerRange &A = Ranges[i], &B = Ranges[j];
+      if (!A.IsWrite && !B.IsWrite)
+        continue;
+
+      // Accesses to the same element in the same iteration are ordered
+      // correctly in the vector loop too.
+      if (A.IsConsecutive && B.IsConsecutive &&
+          SE->getSCEV(A.Ptr) == SE->getSCEV(B.Ptr))
+        continue;
+
+      // Distinct identified objects never overlap.
+      Value *ObjA = GetUnderlyingObject(A.Ptr, TD);
+      Value *ObjB = GetUnderlyingObject(B.Ptr, TD);
+      if (ObjA != ObjB && isIdentifiedObject(ObjA) && isIdentifiedObject(ObjB))
+        continue;
+
+      if (cast<PointerType>(A.Ptr->getType())->getAddressSpace() !=
+          cast<PointerType>(B.Ptr->getType())->getAddressSpace()) {
+        DEBUG(dbgs() << "LV: Cannot compare pointers in different address "
+                        "spaces.\n");
+        return false;
+      }
+      Checks.push_back(std::make_pair(i, j));
+    }
+
+  if (Checks.size() > MaxRuntimeChecks) {
+    DEBUG(dbgs() << "LV: Too many runtime alias checks needed.\n");
+    return false;
+  }
+  return true;
+}
+
+//===----------------------------------------------------------------------===//
+// LoopVectorizationCostModel
+//===----------------------------------------------------------------------===//
+
+unsigned LoopVectorizationCostModel::selectVectorizationFactor() {
+  if (VectorizationFactor) {
+    if (isPowerOf2_32(VectorizationFactor))
+      return VectorizationFactor;
+    DEBUG(dbgs() << "LV: Ignoring a vector width that is not a power of "
+                    "two.\n");
+  }
+
+  unsigned WidestType = Legal->getWidestType();
+  if (!WidestType)
+    return 1;
+  unsigned MaxVectorSize = TTI->getRegisterBitWidth(true) / WidestType;
+  DEBUG(dbgs() << "LV: The widest type is " << WidestType
+               << " bits; at most " << MaxVectorSize << " lanes fit.\n");
+  if (MaxVectorSize < 2)
+    return 1;
+
+  // Pick the factor with the lowest cost per scalar iteration.
+  unsigned BestVF = 1;
+  unsigned BestCost = expectedCost(1);
+  DEBUG(dbgs() << "LV: Scalar loop costs " << BestCost << ".\n");
+  for (unsigned VF = 2; VF <= MaxVectorSize; VF *= 2) {
+    unsigned Cost = expectedCost(VF);
+    DEBUG(dbgs() << "LV: Vector loop of width " << VF << " costs " << Cost
+                 << ".\n");
+    if (Cost * BestVF < BestCost * VF) {
+      BestVF = VF;
+      BestCost = Cost;
+    }
+  }
+  return BestVF;
+}
+
+unsigned LoopVectorizationCostModel::expectedCost(unsigned VF) {
+  unsigned Cost = 0;
+  BasicBlock *BB = TheLoop->getHeader();
+  for (BasicBlock::iterator it = BB->begin(), e = BB->end(); it != e; ++it)
+    Cost += getInstructionCost(it, VF);
+  return Cost;
+}
+
+unsigned LoopVectorizationCostModel::getInstructionCost(Instruction *I,
+                                                        unsigned VF) {
+  // Address computations and the loop control stay scalar and run once per
+  // iteration of the (vector) loop.
+  if (Legal->isSkipped(I) || isa<TerminatorInst>(I))
+    return 1;
+
+  Type *RetTy = I->getType();
+  Type *VectorTy = RetTy->isVoidTy() ? RetTy : ToVectorTy(RetTy, VF);
+
+  switch (I->getOpcode()) {
+  case Instruction::PHI: {
+    // Reduction PHIs are free; an induction that is used as a value needs
+    // a vector of consecutive values each iteration.
+    PHINode *Phi = cast<PHINode>(I);
+    if (VF > 1 && Legal->getInductionVars().count(Phi))
+      return TTI->getArithmeticInstrCost(Instruction::Add, VectorTy);
+    return 0;
+  }
+  case Instruction::Select: {
+    SelectInst *SI = cast<SelectInst>(I);
+    Type *CondTy = SI->getCondition()->getType();
+    if (!TheLoop->isLoopInvariant(SI->getCondition()))
+      CondTy = ToVectorTy(CondTy, VF);
+    return TTI->getCmpSelInstrCost(I->getOpcode(), VectorTy, CondTy);
+  }
+  case Instruction::ICmp:
+  case Instruction::FCmp: {
+    Type *ValTy = ToVectorTy(I->getOperand(0)->getType(), VF);
+    return TTI->getCmpSelInstrCost(I->getOpcode(), ValTy);
+  }
+  case Instruction::Store: {
+    StoreInst *SI = cast<StoreInst>(I);
+    Type *ValTy = ToVectorTy(SI->getValueOperand()->getType(), VF);
+    return TTI->getMemoryOpCost(I->getOpcode(), ValTy, SI->getAlignment(),
+                                SI->getPointerAddressSpace());
+  }
+  case Instruction::Load: {
+    LoadInst *LI = cast<LoadInst>(I);
+    if (Legal->isUniformPtr(LI->getPointerOperand())) {
+      // A scalar load followed by a broadcast.
+      unsigned Cost = TTI->getMemoryOpCost(I->getOpcode(), RetTy,
+                                           LI->getAlignment(),
+                                           LI->getPointerAddressSpace());
+      if (VF > 1)
+        Cost += TTI->getVectorInstrCost(Instruction::InsertElement,
+                                        VectorTy, 0);
+      return Cost;
+    }
+    return TTI->getMemoryOpCost(I->getOpcode(), VectorTy, LI->getAlignment(),
+                                LI->getPointerAddressSpace());
+  }
+  default:
+    if (I->isBinaryOp())
+      return TTI->getArithmeticInstrCost(I->getOpcode(), VectorTy);
+    if (I->isCast())
+      return TTI->getCastInstrCost(I->getOpcode(), VectorTy,
+                                   ToVectorTy(I->getOperand(0)->getType(),
+                                              VF));
+    // Legality only lets the instructions above through.
+    return VF;
+  }
+}
+
+//===----------------------------------------------------------------------===//
+// InnerLoopVectorizer
+//===----------------------------------------------------------------------===//
+
+/// getReductionOpcode - Return the binary operator that combines partial
+/// results of a reduction of the given kind.
+static Instruction::BinaryOps
+getReductionOpcode(LoopVectorizationLegality::ReductionKind Kind) {
+  switch (Kind) {
+  case LoopVectorizationLegality::IntegerAdd:  return Instruction::Add;
+  case LoopVectorizationLegality::IntegerMult: return Instruction::Mul;
+  case LoopVectorizationLegality::IntegerOr:   return Instruction::Or;
+  case LoopVectorizationLegality::IntegerAnd:  return Instruction::And;
+  case LoopVectorizationLegality::IntegerXor:  return Instruction::Xor;
+  default:
+    llvm_unreachable("Unknown reduction kind");
+  }
+}
+
+/// getReductionIdentity - Return the value that leaves the result of a
+/// reduction of the given kind unchanged.
+static Constant *
+getReductionIdentity(LoopVectorizationLegality::ReductionKind Kind,
+                     Type *Ty) {
+  switch (Kind) {
+  case LoopVectorizationLegality::IntegerAdd:
+  case LoopVectorizationLegality::IntegerOr:
+  case LoopVectorizationLegality::IntegerXor:
+    return ConstantInt::get(Ty, 0);
+  case LoopVectorizationLegality::IntegerMult:
+    return ConstantInt::get(Ty, 1);
+  case LoopVectorizationLegality::IntegerAnd:
+    return ConstantInt::getAllOnesValue(Ty);
+  default:
+    llvm_unreachable("Unknown reduction kind");
+  }
+}
+
+void InnerLoopVectorizer::createEmptyLoop(LoopVectorizationLegality *Legal) {
+  BasicBlock *Header = OrigLoop->getHeader();
+  BypassBlock = OrigLoop->getLoopPreheader();
+  ExitBlock = OrigLoop->getExitBlock();
+  assert(BypassBlock && ExitBlock && "Loop is not in simplified form");
+
+  // Compute the trip count and the number of iterations the vector loop
+  // runs.  If the backedge-taken count is the maximum value of its type,
+  // the trip count wraps to zero and the vector loop is bypassed.
+  const SCEV *BTC = Legal->getBackedgeTakenCount();
+  IntegerType *IdxTy = cast<IntegerType>(BTC->getType());
+  Constant *Zero = ConstantInt::get(IdxTy, 0);
+  Constant *Step = ConstantInt::get(IdxTy, VF);
+
+  Instruction *Loc = BypassBlock->getTerminator();
+  TripCount = Exp.expandCodeFor(SE->getAddExpr(BTC, SE->getConstant(IdxTy, 1)),
+                                IdxTy, Loc);
+  Builder.SetInsertPoint(Loc);
+  Value *Rem = Builder.CreateURem(TripCount, Step, "n.mod.vf");
+  VectorCount = Builder.CreateSub(TripCount, Rem, "n.vec");
+  Value *Bypass = Builder.CreateICmpEQ(VectorCount, Zero, "cmp.zero");
+  if (Value *Conflict = addRuntimeCheck(Legal, Loc)) {
+    Builder.SetInsertPoint(Loc);
+    Bypass = Builder.CreateOr(Bypass, Conflict, "bypass");
+    ++LoopsWithRuntimeChecks;
+  }
+
+  // Compute the values at which the scalar loop resumes the inductions.
+  SmallVector<std::pair<PHINode*, Value*>, 4> EndValues;
+  for (BasicBlock::iterator it = Header->begin(); isa<PHINode>(it); ++it) {
+    PHINode *Phi = cast<PHINode>(it);
+    LoopVectorizationLegality::InductionList::const_iterator II =
+      Legal->getInductionVars().find(Phi);
+    if (II == Legal->getInductionVars().end())
+      continue;
+    IntegerType *PhiTy = cast<IntegerType>(Phi->getType());
+    Value *Count = Builder.CreateZExtOrTrunc(VectorCount, PhiTy);
+    EndValues.push_back(std::make_pair(Phi,
+                          Builder.CreateAdd(II->second, Count, "ind.end")));
+  }
+
+  // Split the preheader into the blocks around the vector loop:
+  //   BypassBlock -> vector.ph -> vector.body -> middle.block -> scalar.ph
+  // The original loop now hangs off scalar.ph.
+  VectorPH = BypassBlock->splitBasicBlock(Loc, "vector.ph");
+  VectorBody = VectorPH->splitBasicBlock(VectorPH->getTerminator(),
+                                         "vector.body");
+  MiddleBlock = VectorBody->splitBasicBlock(VectorBody->getTerminator(),
+                                            "middle.block");
+  ScalarPH = MiddleBlock->splitBasicBlock(MiddleBlock->getTerminator(),
+                                          "scalar.ph");
+
+  // Skip the vector loop if it would not run or if the accesses overlap.
+  BranchInst::Create(ScalarPH, VectorPH, Bypass, BypassBlock->getTerminator());
+  BypassBlock->getTerminator()->eraseFromParent();
+
+  // The vector induction variable counts from zero to VectorCount by VF.
+  Builder.SetInsertPoint(VectorBody, VectorBody->getFirstInsertionPt());
+  Induction = Builder.CreatePHI(IdxTy, 2, "index");
+  Builder.SetInsertPoint(VectorBody->getTerminator());
+  Value *NextIdx = Builder.CreateAdd(Induction, Step, "index.next");
+  Induction->addIncoming(Zero, VectorPH);
+  Induction->addIncoming(NextIdx, VectorBody);
+  Value *Done = Builder.CreateICmpEQ(NextIdx, VectorCount, "cmp.vec");
+  BranchInst::Create(MiddleBlock, VectorBody, Done,
+                     VectorBody->getTerminator());
+  VectorBody->getTerminator()->eraseFromParent();
+  BodyInsertPt = cast<Instruction>(NextIdx);
+
+  // Leave the loop if the vector loop ran all iterations.
+  Builder.SetInsertPoint(MiddleBlock->getTerminator());
+  Value *AllDone = Builder.CreateICmpEQ(TripCount, VectorCount, "cmp.n");
+  BranchInst::Create(ExitBlock, ScalarPH, AllDone,
+                     MiddleBlock->getTerminator());
+  MiddleBlock->getTerminator()->eraseFromParent();
+
+  // Resume the scalar inductions after the last vector iteration.
+  for (unsigned i = 0, e = EndValues.size(); i != e; ++i) {
+    PHINode *Phi = EndValues[i].first;
+    PHINode *Resume = PHINode::Create(Phi->getType(), 2, "resume.val",
+                                      ScalarPH->getTerminator());
+    Resume->addIncoming(EndValues[i].second, MiddleBlock);
+    Resume->addIncoming(Legal->getInductionVars().lookup(Phi), BypassBlock);
+    Phi->setIncomingValue(Phi->getBasicBlockIndex(ScalarPH), Resume);
+  }
+}
+
+Value *InnerLoopVectorizer::addRuntimeCheck(LoopVectorizationLegality *Legal,
+                                            Instruction *Loc) {
+  const SmallVectorImpl<std::pair<unsigned, unsigned> > &Checks =
+    Legal->getRuntimeChecks();
+  if (Checks.empty())
+    return 0;
+
+  // Compute [Start, End) in bytes for every access.
+  const SmallVectorImpl<LoopVectorizationLegality::PointerRange> &Ranges =
+    Legal->getPointerRanges();
+  SmallVector<Value*, 8> Starts, Ends;
+  for (unsigned i = 0, e = Ranges.size(); i != e; ++i) {
+    Type *PtrTy = Ranges[i].Ptr->getType();
+    Type *BytePtrTy =
+      Builder.getInt8PtrTy(cast<PointerType>(PtrTy)->getAddressSpace());
+    Value *Start = Exp.expandCodeFor(Ranges[i].Start, PtrTy, Loc);
+    Value *Last = Exp.expandCodeFor(Ranges[i].Last, PtrTy, Loc);
+    Builder.SetInsertPoint(Loc);
+    Value *End = Builder.CreateConstGEP1_32(Last, 1, "scevgep.end");
+    Starts.push_back(Builder.CreateBitCast(Start, BytePtrTy, "bc"));
+    Ends.push_back(Builder.CreateBitCast(End, BytePtrTy, "bc"));
+  }
+
+  // Two ranges overlap if each one starts before the other one ends.
+  Builder.SetInsertPoint(Loc);
+  Value *Conflict = 0;
+  for (unsigned i = 0, e = Checks.size(); i != e; ++i) {
+    unsigned A = Checks[i].first, B = Checks[i].second;
+    Value *Cmp0 = Builder.CreateICmpULT(Starts[A], Ends[B], "bound0");
+    Value *Cmp1 = Builder.CreateICmpULT(Starts[B], Ends[A], "bound1");
+    Value *IsConflict = Builder.CreateAnd(Cmp0, Cmp1, "found.conflict");
+    Conflict = Conflict ? Builder.CreateOr(Conflict, IsConflict, "conflict.rdx")
+                        : IsConflict;
+  }
+  return Conflict;
+}
+
+Value *InnerLoopVectorizer::getBroadcastInstrs(IRBuilder<> &B, Value *V) {
+  Type *VTy = VectorType::get(V->getType(), VF);
+  Value *Undef = UndefValue::get(VTy);
+  Value *Single = B.CreateInsertElement(Undef, V, B.getInt32(0),
+                                        "broadcast.splatinsert");
+  Constant *Mask = Constant::getNullValue(VectorType::get(B.getInt32Ty(), VF));
+  return B.CreateShuffleVector(Single, Undef, Mask, "broadcast.splat");
+}
+
+Value *InnerLoopVectorizer::getVectorValue(Value *V,
+                                           LoopVectorizationLegality *Legal) {
+  DenseMap<Value*, Value*>::iterator It = WidenMap.find(V);
+  if (It != WidenMap.end())
+    return It->second;
+
+  Value *Vec;
+  PHINode *Phi = dyn_cast<PHINode>(V);
+  if (Phi && OrigLoop->contains(Phi)) {
+    // An induction: broadcast its value in the first lane and add the lane
+    // numbers.
+    Value *Start = Legal->getInductionVars().lookup(Phi);
+    assert(Start && "Found a PHI that was not vectorized");
+    IRBuilder<> B(VectorBody, VectorBody->getFirstInsertionPt());
+    IntegerType *PhiTy = cast<IntegerType>(Phi->getType());
+    Value *Idx = B.CreateZExtOrTrunc(Induction, PhiTy);
+    Value *Scalar = B.CreateAdd(Start, Idx, "offset.idx");
+    SmallVector<Constant*, 8> Lanes;
+    for (unsigned i = 0; i != VF; ++i)
+      Lanes.push_back(ConstantInt::get(PhiTy, i));
+    Vec = B.CreateAdd(getBroadcastInstrs(B, Scalar),
+                      ConstantVector::get(Lanes), "induction");
+  } else {
+    assert(!(isa<Instruction>(V) &&
+             OrigLoop->contains(cast<Instruction>(V))) &&
+           "Loop value was not widened");
+    // A loop invariant value is broadcast once, in the vector preheader.
+    IRBuilder<> B(VectorPH->getTerminator());
+    Vec = getBroadcastInstrs(B, V);
+  }
+  WidenMap[V] = Vec;
+  return Vec;
+}
+
+Value *InnerLoopVectorizer::getConsecutivePointer(Value *Ptr) {
+  const SCEVAddRecExpr *AR = cast<SCEVAddRecExpr>(SE->getSCEV(Ptr));
+  Value *Start = expandInPreheader(AR->getStart(), Ptr->getType());
+  PointerType *PtrTy = cast<PointerType>(Ptr->getType());
+  Type *VecPtrTy = VectorType::get(PtrTy->getElementType(), VF)
+                     ->getPointerTo(PtrTy->getAddressSpace());
+  Value *Lane0 = Builder.CreateGEP(Start, Induction, "gep");
+  return Builder.CreateBitCast(Lane0, VecPtrTy);
+}
+
+void InnerLoopVectorizer::widenInstruction(Instruction *I,
+                                           LoopVectorizationLegality *Legal) {
+  Value *Vec;
+  switch (I->getOpcode()) {
+  case Instruction::Load: {
+    LoadInst *LI = cast<LoadInst>(I);
+    Value *Ptr = LI->getPointerOperand();
+    if (Legal->isUniformPtr(Ptr)) {
+      Value *P = expandInPreheader(SE->getSCEV(Ptr), Ptr->getType());
+      LoadInst *Scalar = Builder.CreateLoad(P);
+      Scalar->setAlignment(LI->getAlignment());
+      Vec = getBroadcastInstrs(Builder, Scalar);
+    } else {
+      LoadInst *NewLI = Builder.CreateLoad(getConsecutivePointer(Ptr),
+                                           "wide.load");
+      NewLI->setAlignment(LI->getAlignment());
+      Vec = NewLI;
+    }
+    break;
+  }
+  case Instruction::Store: {
+    StoreInst *SI = cast<StoreInst>(I);
+    Value *Val = getVectorValue(SI->getValueOperand(), Legal);
+    StoreInst *NewSI =
+      Builder.CreateStore(Val, getConsecutivePointer(SI->getPointerOperand()));
+    NewSI->setAlignment(SI->getAlignment());
+    return;
+  }
+  case Instruction::Select: {
+    SelectInst *SI = cast<SelectInst>(I);
+    // A loop invariant condition selects whole vectors.
+    Value *Cond = SI->getCondition();
+    if (!OrigLoop->isLoopInvariant(Cond))
+      Cond = getVectorValue(Cond, Legal);
+    Vec = Builder.CreateSelect(Cond,
+                               getVectorValue(SI->getTrueValue(), Legal),
+                               getVectorValue(SI->getFalseValue(), Legal));
+    break;
+  }
+  case Instruction::ICmp:
+  case Instruction::FCmp: {
+    CmpInst *Cmp = cast<CmpInst>(I);
+    Value *A = getVectorValue(Cmp->getOperand(0), Legal);
+    Value *B = getVectorValue(Cmp->getOperand(1), Legal);
+    if (isa<ICmpInst>(Cmp))
+      Vec = Builder.CreateICmp(Cmp->getPredicate(), A, B);
+    else
+      Vec = Builder.CreateFCmp(Cmp->getPredicate(), A, B);
+    break;
+  }
+  default:
+    if (BinaryOperator *BinOp = dyn_cast<BinaryOperator>(I)) {
+      Vec = Builder.CreateBinOp(BinOp->getOpcode(),
+                                getVectorValue(BinOp->getOperand(0), Legal),
+                                getVectorValue(BinOp->getOperand(1), Legal));
+      // Each lane computes what the scalar instruction did, so the wrapping
+      // and exactness flags still hold.
+      if (BinaryOperator *VecOp = dyn_cast<BinaryOperator>(Vec)) {
+        if (isa<OverflowingBinaryOperator>(BinOp)) {
+          VecOp->setHasNoSignedWrap(BinOp->hasNoSignedWrap());
+          VecOp->setHasNoUnsignedWrap(BinOp->hasNoUnsignedWrap());
+        }
+        if (isa<PossiblyExactOperator>(BinOp))
+          VecOp->setIsExact(BinOp->isExact());
+      }
+    } else {
+      CastInst *CI = cast<CastInst>(I);
+      Vec = Builder.CreateCast(CI->getOpcode(),
+                               getVectorValue(CI->getOperand(0), Legal),
+                               VectorType::get(CI->getType(), VF));
+    }
+    break;
+  }
+  Vec->takeName(I);
+  WidenMap[I] = Vec;
+}
+
+void InnerLoopVectorizer::vectorizeLoop(LoopVectorizationLegality *Legal) {
+  BasicBlock *Header = OrigLoop->getHeader();
+  const LoopVectorizationLegality::ReductionList &Reductions =
+    Legal->getReductionVars();
+
+  // Create the vector accumulators.  Lane zero starts with the scalar start
+  // value and the other lanes with the identity of the reduction.
+  SmallVector<PHINode*, 4> RdxPhis;
+  for (BasicBlock::iterator it = Header->begin(); isa<PHINode>(it); ++it) {
+    PHINode *Phi = cast<PHINode>(it);
+    LoopVectorizationLegality::ReductionList::const_iterator RI =
+      Reductions.find(Phi);
+    if (RI == Reductions.end())
+      continue;
+
+    Type *VecTy = VectorType::get(Phi->getType(), VF);
+    Constant *Identity = ConstantVector::getSplat(VF,
+      getReductionIdentity(RI->second.Kind, Phi->getType()));
+    Builder.SetInsertPoint(VectorPH->getTerminator());
+    Value *VecStart = Builder.CreateInsertElement(Identity,
+                                                  RI->second.StartValue,
+                                                  Builder.getInt32(0),
+                                                  "rdx.start");
+    PHINode *VecPhi = PHINode::Create(VecTy, 2, "vec.phi",
+                                      VectorBody->getFirstNonPHI());
+    VecPhi->addIncoming(VecStart, VectorPH);
+    WidenMap[Phi] = VecPhi;
+    RdxPhis.push_back(Phi);
+  }
+
+  // Widen the loop body.
+  Builder.SetInsertPoint(BodyInsertPt);
+  for (BasicBlock::iterator it = Header->begin(), e = Header->end();
+       it != e; ++it) {
+    Instruction *I = it;
+    if (isa<PHINode>(I) || isa<TerminatorInst>(I) || Legal->isSkipped(I))
+      continue;
+    widenInstruction(I, Legal);
+  }
+
+  // Close the accumulators and combine their lanes after the loop by
+  // repeatedly folding the upper half of the vector onto the lower half.
+  Builder.SetInsertPoint(MiddleBlock, MiddleBlock->getFirstInsertionPt());
+  for (unsigned i = 0, e = RdxPhis.size(); i != e; ++i) {
+    PHINode *Phi = RdxPhis[i];
+    const LoopVectorizationLegality::ReductionDescriptor &RdxDesc =
+      Reductions.find(Phi)->second;
+    Value *LoopVal = getVectorValue(RdxDesc.LoopExitInstr, Legal);
+    cast<PHINode>(WidenMap[Phi])->addIncoming(LoopVal, VectorBody);
+
+    Instruction::BinaryOps Opcode = getReductionOpcode(RdxDesc.Kind);
+    Value *TmpVec = LoopVal;
+    for (unsigned Width = VF; Width != 1; Width /= 2) {
+      SmallVector<Constant*, 8> ShuffleMask(VF,
+                                            UndefValue::get(Builder.getInt32Ty()));
+      for (unsigned j = 0; j != Width / 2; ++j)
+        ShuffleMask[j] = Builder.getInt32(Width / 2 + j);
+      Value *Shuf = Builder.CreateShuffleVector(TmpVec,
+                                  UndefValue::get(TmpVec->getType()),
+                                  ConstantVector::get(ShuffleMask), "rdx.shuf");
+      TmpVec = Builder.CreateBinOp(Opcode, TmpVec, Shuf, "bin.rdx");
+    }
+    Value *Reduced = Builder.CreateExtractElement(TmpVec, Builder.getInt32(0),
+                                                  "rdx.result");
+    ReducedValues[RdxDesc.LoopExitInstr] = Reduced;
+
+    // The scalar loop continues from the reduced value.
+    PHINode *Resume = PHINode::Create(Phi->getType(), 2, "rdx.resume",
+                                      ScalarPH->getTerminator());
+    Resume->addIncoming(Reduced, MiddleBlock);
+    Resume->addIncoming(RdxDesc.StartValue, BypassBlock);
+    Phi->setIncomingValue(Phi->getBasicBlockIndex(ScalarPH), Resume);
+  }
+
+  // The exit block is now also reached from the middle block.
+  for (BasicBlock::iterator it = ExitBlock->begin(); isa<PHINode>(it); ++it) {
+    PHINode *Phi = cast<PHINode>(it);
+    Value *V = Phi->getIncomingValueForBlock(Header);
+    DenseMap<Value*, Value*>::iterator RI = ReducedValues.find(V);
+    Phi->addIncoming(RI != ReducedValues.end() ? RI->second : V, MiddleBlock);
+  }
+}
+
+void InnerLoopVectorizer::updateAnalysis() {
+  // The original loop is now the scalar epilogue and its header PHIs have
+  // new incoming values.
+  SE->forgetLoop(OrigLoop);
+
+  DT->addNewBlock(VectorPH, BypassBlock);
+  DT->addNewBlock(VectorBody, VectorPH);
+  DT->addNewBlock(MiddleBlock, VectorBody);
+  DT->addNewBlock(ScalarPH, BypassBlock);
+  DT->changeImmediateDominator(OrigLoop->getHeader(), ScalarPH);
+  DT->changeImmediateDominator(ExitBlock, BypassBlock);
+
+  Loop *ParentLoop = OrigLoop->getParentLoop();
+  if (ParentLoop) {
+    ParentLoop->addBasicBlockToLoop(VectorPH, LI->getBase());
+    ParentLoop->addBasicBlockToLoop(MiddleBlock, LI->getBase());
+    ParentLoop->addBasicBlockToLoop(ScalarPH, LI->getBase());
+  }
+
+  Loop *VectorLoop = new Loop();
+  LPM->insertLoop(VectorLoop, ParentLoop);
+  VectorLoop->addBasicBlockToLoop(VectorBody, LI->getBase());
+}
+
+//===----------------------------------------------------------------------===//
+// LoopVectorize pass
+//===----------------------------------------------------------------------===//
+
+namespace {
+/// LoopVectorize - The loop vectorization pass.
+struct LoopVectorize : public LoopPass {
+  static char ID; // Pass identification, replacement for typeid
+
+  LoopVectorize() : LoopPass(ID) {
+    initializeLoopVectorizePass(*PassRegistry::getPassRegistry());
+  }
+
+  virtual bool runOnLoop(Loop *L, LPPassManager &LPM) {
+    // Only innermost loops are vectorized.
+    if (!L->empty())
+      return false;
+
+    TargetData *TD = getAnalysisIfAvailable<TargetData>();
+    if (!TD)
+      return false;
+
+    // Vectors live in floating-point registers on most targets.
+    Function *F = L->getHeader()->getParent();
+    if (F->getFnAttributes().hasNoImplicitFloatAttr() ||
+        F->getFnAttributes().hasOptimizeForSizeAttr())
+      return false;
+
+    ++LoopsAnalyzed;
+    ScalarEvolution *SE = &getAnalysis<ScalarEvolution>();
+    DEBUG(dbgs() << "LV: Checking a loop in \"" << F->getName() << "\"\n");
+
+    LoopVectorizationLegality LVL(L, SE, TD);
+    if (!LVL.canVectorize()) {
+      DEBUG(dbgs() << "LV: Not vectorizing.\n");
+      return false;
+    }
+
+    if (BasicBlock *Exiting = L->getExitingBlock()) {
+      unsigned TC = SE->getSmallConstantTripCount(L, Exiting);
+      if (TC && TC < TinyTripCountThreshold) {
+        DEBUG(dbgs() << "LV: Trip count " << TC << " is too small.\n");
+        return false;
+      }
+    }
+
+    TargetTransformInfo *TTI = &getAnalysis<TargetTransformInfo>();
+    LoopVectorizationCostModel CM(L, SE, &LVL, TTI);
+    unsigned VF = CM.selectVectorizationFactor();
+    if (VF == 1) {
+      DEBUG(dbgs() << "LV: Vectorization is not profitable.\n");
+      return false;
+    }
+
+    DEBUG(dbgs() << "LV: Vectorizing with width " << VF << ".\n");
+    InnerLoopVectorizer LB(L, SE, &getAnalysis<LoopInfo>(),
+                           &getAnalysis<DominatorTree>(), &LPM, VF);
+    LB.vectorize(&LVL);
+    ++LoopsVectorized;
+    return true;
+  }
+
+  virtual void getAnalysisUsage(AnalysisUsage &AU) const {
+    LoopPass::getAnalysisUsage(AU);
+    AU.addRequiredID(LoopSimplifyID);
+    AU.addRequiredID(LCSSAID);
+    AU.addRequired<DominatorTree>();
+    AU.addRequired<LoopInfo>();
+    AU.addRequired<ScalarEvolution>();
+    AU.addRequired<TargetTransformInfo>();
+    AU.addPreserved<DominatorTree>();
+    AU.addPreserved<LoopInfo>();
+  }
+};
+} // end anonymous namespace
+
+char LoopVectorize::ID = 0;
+static const char lv_name[] = "Loop Vectorization";
+INITIALIZE_PASS_BEGIN(LoopVectorize, LV_NAME, lv_name, false, false)
+INITIALIZE_AG_DEPENDENCY(TargetTransformInfo)
+INITIALIZE_PASS_DEPENDENCY(DominatorTree)
+INITIALIZE_PASS_DEPENDENCY(LoopInfo)
+INITIALIZE_PASS_DEPENDENCY(ScalarEvolution)
+INITIALIZE_PASS_DEPENDENCY(LoopSimplify)
+INITIALIZE_PASS_DEPENDENCY(LCSSA)
+INITIALIZE_PASS_END(LoopVectorize, LV_NAME, lv_name, false, false)
+
+Pass *llvm::createLoopVectorizePass() {
+  return new LoopVectorize();
+}
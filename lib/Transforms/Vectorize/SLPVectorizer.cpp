@@ -0,0 +1,890 @@
+//===- SLPVectorizer.cpp - A bottom up SLP Vectorizer ---------------------===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+//
+// This pass implements a bottom-up superword-level parallelism (SLP)
+// vectorizer.  It looks for runs of stores to consecutive addresses in a
+// basic block and tries to replace each run with a single vector store.
+// Starting from the stored values it walks up the use-def chains, grouping
+// isomorphic scalars - instructions with the same opcode in every lane -
+// into bundles.  The bundles form a tree whose leaves are consecutive loads,
+// or values that have to be gathered into a vector one element at a time.
+//
+// A tree is vectorized when the target's cost model (TargetTransformInfo)
+// says that the vector code is cheaper than the scalar code it replaces,
+// including the gathers and the extracts needed by scalars that are still
+// used outside the tree.
+//
+// Unlike BBVectorize, which considers every pair of instructions in a block,
+// the work done here is proportional to the number of stores and to the size
+// of the trees that are built, and the bundles are as wide as the target's
+// vector registers.
+//
+//===----------------------------------------------------------------------===//
+
+#define SV_NAME "slp-vectorizer"
+#define DEBUG_TYPE SV_NAME
+#include "llvm/Constants.h"
+#include "llvm/DerivedTypes.h"
+#include "llvm/Function.h"
+#include "llvm/Instructions.h"
+#include "llvm/IRBuilder.h"
+#include "llvm/Operator.h"
+#include "llvm/Pass.h"
+#include "llvm/ADT/DenseMap.h"
+#include "llvm/ADT/MapVector.h"
+#include "llvm/ADT/SmallPtrSet.h"
+#include "llvm/ADT/SmallVector.h"
+#include "llvm/ADT/Statistic.h"
+#include "llvm/Analysis/AliasAnalysis.h"
+#include "llvm/Analysis/ScalarEvolution.h"
+#include "llvm/Analysis/ScalarEvolutionExpressions.h"
+#include "llvm/Analysis/TargetTransformInfo.h"
+#include "llvm/Analysis/ValueTracking.h"
+#include "llvm/Support/CommandLine.h"
+#include "llvm/Support/Debug.h"
+#include "llvm/Support/MathExtras.h"
+#include "llvm/Support/raw_ostream.h"
+#include "llvm/Target/TargetData.h"
+#include "llvm/Transforms/Vectorize.h"
+#include <algorithm>
+using namespace llvm;
+
+static cl::opt<int>
+SLPCostThreshold("slp-threshold", cl::init(0), cl::Hidden,
+  cl::desc("Only vectorize trees whose vector code is cheaper than the "
+           "scalar code by more than this"));
+
+/// RecursionMaxDepth - Bundles this far above the stores are gathered rather
+/// than followed, which bounds the size of a tree.
+static const unsigned RecursionMaxDepth = 12;
+
+/// StoreLookahead - A store is compared with at most this many of its
+/// neighbours to the same object when looking for consecutive stores, which
+/// keeps the search linear in the number of stores.
+static const unsigned StoreLookahead = 16;
+
+STATISTIC(NumTreesVectorized, "Number of store trees vectorized");
+STATISTIC(NumStoresVectorized, "Number of scalar stores vectorized");
+
+/// isVectorizableType - Return true if Ty can be the element type of the
+/// vectors this pass builds.
+static bool isVectorizableType(Type *Ty) {
+  return Ty->isIntegerTy() || Ty->isFloatTy() || Ty->isDoubleTy();
+}
+
+/// getPointerOperand - Return the address accessed by a simple load or
+/// store, or null if V is neither.
+static Value *getPointerOperand(Value *V) {
+  if (LoadInst *LI = dyn_cast<LoadInst>(V))
+    return LI->isSimple() ? LI->getPointerOperand() : 0;
+  if (StoreInst *SI = dyn_cast<StoreInst>(V))
+    return SI->isSimple() ? SI->getPointerOperand() : 0;
+  return 0;
+}
+
+/// getAlignment - Return the alignment of a load or store.
+static unsigned getAlignment(Value *V) {
+  if (LoadInst *LI = dyn_cast<LoadInst>(V))
+    return LI->getAlignment();
+  return cast<StoreInst>(V)->getAlignment();
+}
+
+/// getOperandBundle - Collect operand OpIdx of every instruction in VL.
+static void getOperandBundle(ArrayRef<Value*> VL, unsigned OpIdx,
+                             SmallVectorImpl<Value*> &Operands) {
+  Operands.clear();
+  for (unsigned i = 0, e = VL.size(); i != e; ++i)
+    Operands.push_back(cast<Instruction>(VL[i])->getOperand(OpIdx));
+}
+
+namespace {
+
+//===----------------------------------------------------------------------===//
+/// BoUpSLP - Builds, costs and vectorizes the tree of bundles that feeds a
+/// run of consecutive stores in one basic block.
+///
+/// Each tree entry is a bundle of scalars, one per lane, that becomes one
+/// vector instruction.  The vector instruction is inserted before the scalar
+/// of the bundle that comes last in the block, so every bundle is moved down
+/// to its last member.  buildTree rejects trees where that would reorder
+/// aliasing memory accesses or move a scalar below one of its users outside
+/// the tree.
+class BoUpSLP {
+public:
+  typedef SmallVector<Value*, 8> ValueList;
+
+  BoUpSLP(BasicBlock *BB, ScalarEvolution *SE, TargetData *TD,
+          TargetTransformInfo *TTI, AliasAnalysis *AA)
+    : BB(BB), SE(SE), TD(TD), TTI(TTI), AA(AA), Builder(BB->getContext()) {
+    numberInstructions();
+  }
+
+  /// isConsecutiveAccess - Return true if the load or store B accesses the
+  /// memory that immediately follows the memory accessed by A.
+  bool isConsecutiveAccess(Value *A, Value *B);
+
+  /// vectorizeStores - Try to replace Stores, which write consecutive
+  /// memory in order, and the tree that feeds them with vector code.
+  /// Returns true if the code was changed.
+  bool vectorizeStores(ArrayRef<StoreInst*> Stores);
+
+private:
+  /// TreeEntry - A bundle of scalars that is vectorized as a unit.
+  struct TreeEntry {
+    TreeEntry() : LastInst(0), VectorizedValue(0) {}
+
+    /// Scalars - The scalar in each lane.
+    ValueList Scalars;
+    /// LastInst - The scalar that comes last in the block.  The vector code
+    /// is inserted right before it.
+    Instruction *LastInst;
+    /// VectorizedValue - The vector that replaces the scalars, once built.
+    Value *VectorizedValue;
+  };
+
+  /// numberInstructions - Record the position of every instruction in BB.
+  void numberInstructions();
+
+  /// buildTree - Build the tree rooted at the bundle of stores in Roots.
+  /// Returns false if the tree cannot be vectorized.
+  bool buildTree(ArrayRef<Value*> Roots);
+
+  /// buildTreeRec - Add the bundle VL and, recursively, its operands to the
+  /// tree, or record it as a gather.  Returns false if the tree cannot be
+  /// vectorized.
+  bool buildTreeRec(ArrayRef<Value*> VL, unsigned Depth);
+
+  /// newTreeEntry - Add a bundle of instructions to the tree.
+  void newTreeEntry(ArrayRef<Value*> VL);
+
+  /// getLastInstruction - Return the member of VL that comes last in BB.
+  Instruction *getLastInstruction(ArrayRef<Value*> VL);
+
+  /// isSafeToSink - Return true if the loads or stores in VL can all be
+  /// moved down to the last of them without passing an access to memory
+  /// that they may alias.
+  bool isSafeToSink(ArrayRef<Value*> VL);
+
+  /// hasValidExternalUses - Return true if every scalar in the tree that is
+  /// used outside the tree is used below the point where it is vectorized,
+  /// so that an extract can feed the use, and no scalar is also gathered.
+  bool hasValidExternalUses();
+
+  /// getTreeCost - Return the cost of the vector code for the tree minus
+  /// the cost of the scalar code it replaces.
+  int getTreeCost();
+
+  /// getEntryCost - Return the cost of vectorizing the bundle E minus the
+  /// cost of its scalars.
+  int getEntryCost(TreeEntry &E);
+
+  /// getGatherCost - Return the cost of building a vector out of VL.
+  int getGatherCost(ArrayRef<Value*> VL);
+
+  /// vectorizeTree - Replace the tree by vector code and erase its scalars.
+  void vectorizeTree();
+
+  /// vectorizeOperand - Return the vector for the bundle VL, which is used by
+  /// the vector instruction inserted before InsertBefore.
+  Value *vectorizeOperand(ArrayRef<Value*> VL, Instruction *InsertBefore);
+
+  /// vectorizeEntry - Emit the vector instruction for Tree[Idx] and its
+  /// operands, and return it.
+  Value *vectorizeEntry(unsigned Idx);
+
+  /// gather - Build a vector out of the scalars in VL before InsertBefore.
+  Value *gather(ArrayRef<Value*> VL, Instruction *InsertBefore);
+
+  /// propagateIRFlags - Set the wrap and exact flags of the vector binary
+  /// operator V to those shared by every scalar in VL.
+  static void propagateIRFlags(Value *V, ArrayRef<Value*> VL);
+
+  BasicBlock *BB;
+  ScalarEvolution *SE;
+  TargetData *TD;
+  TargetTransformInfo *TTI;
+  AliasAnalysis *AA;
+  IRBuilder<> Builder;
+
+  /// InstrIdx - The position of each instruction in BB.
+  DenseMap<Instruction*, unsigned> InstrIdx;
+  /// Tree - The bundles of the current tree; the stores come first.
+  SmallVector<TreeEntry, 8> Tree;
+  /// ScalarToTreeEntry - The index in Tree of the bundle holding a scalar.
+  DenseMap<Value*, unsigned> ScalarToTreeEntry;
+  /// Gathers - The bundles of the current tree that are built element by
+  /// element.
+  SmallVector<ValueList, 8> Gathers;
+};
+
+void BoUpSLP::numberInstructions() {
+  InstrIdx.clear();
+  unsigned Idx = 0;
+  for (BasicBlock::iterator I = BB->begin(), E = BB->end(); I != E; ++I)
+    InstrIdx[I] = Idx++;
+}
+
+bool BoUpSLP::isConsecutiveAccess(Value *A, Value *B) {
+  Value *PtrA = getPointerOperand(A);
+  Value *PtrB = getPointerOperand(B);
+  if (!PtrA || !PtrB || PtrA->getType() != PtrB->getType())
+    return false;
+
+  // B must start where A ends.
+  Type *Ty = cast<PointerType>(PtrA->getType())->getElementType();
+  int64_t Size = TD->getTypeStoreSize(Ty);
+  const SCEV *Offset = SE->getMinusSCEV(SE->getSCEV(PtrB), SE->getSCEV(PtrA));
+  if (const SCEVConstant *C = dyn_cast<SCEVConstant>(Offset))
+    return C->getValue()->getSExtValue() == Size;
+  return false;
+}
+
+Instruction *BoUpSLP::getLastInstruction(ArrayRef<Value*> VL) {
+  Instruction *Last = cast<Instruction>(VL[0]);
+  for (unsigned i = 1, e = VL.size(); i != e; ++i) {
+    Instruction *I = cast<Instruction>(VL[i]);
+    if (InstrIdx[I] > InstrIdx[Last])
+      Last = I;
+  }
+  return Last;
+}
+
+bool BoUpSLP::isSafeToSink(ArrayRef<Value*> VL) {
+  Instruction *First = cast<Instruction>(VL[0]);
+  for (unsigned i = 1, e = VL.size(); i != e; ++i)
+    if (InstrIdx[cast<Instruction>(VL[i])] < InstrIdx[First])
+      First = cast<Instruction>(VL[i]);
+  Instruction *Last = getLastInstruction(VL);
+  bool IsLoad = isa<LoadInst>(First);
+
+  SmallPtrSet<Value*, 8> Bundle(VL.begin(), VL.end());
+  SmallVector<AliasAnalysis::Location, 8> Locs;
+  for (unsigned i = 0, e = VL.size(); i != e; ++i)
+    Locs.push_back(IsLoad ? AA->getLocation(cast<LoadInst>(VL[i]))
+                          : AA->getLocation(cast<StoreInst>(VL[i])));
+
+  for (BasicBlock::iterator I = First; &*I != Last; ++I) {
+    if (Bundle.count(I) || !I->mayReadOrWriteMemory())
+      continue;
+    // Loads may pass other reads; stores may pass nothing they alias.
+    if (IsLoad && !I->mayWriteToMemory())
+      continue;
+    for (unsigned i = 0, e = Locs.size(); i != e; ++i)
+      if (AA->getModRefInfo(I, Locs[i]) != AliasAnalysis::NoModRef)
+        return false;
+  }
+  return true;
+}
+
+void BoUpSLP::newTreeEntry(ArrayRef<Value*> VL) {
+  Tree.push_back(TreeEntry());
+  TreeEntry &E = Tree.back();
+  E.Scalars.append(VL.begin(), VL.end());
+  E.LastInst = getLastInstruction(VL);
+  for (unsigned i = 0, e = VL.size(); i != e; ++i)
+    ScalarToTreeEntry[VL[i]] = Tree.size() - 1;
+}
+
+bool BoUpSLP::buildTree(ArrayRef<Value*> Roots) {
+  Tree.clear();
+  ScalarToTreeEntry.clear();
+  Gathers.clear();
+
+  if (!isSafeToSink(Roots))
+    return false;
+  newTreeEntry(Roots);
+
+  ValueList Operands;
+  getOperandBundle(Roots, 0, Operands);
+  if (!buildTreeRec(Operands, 0))
+    return false;
+
+  return hasValidExternalUses();
+}
+
+bool BoUpSLP::buildTreeRec(ArrayRef<Value*> VL, unsigned Depth) {
+  // Bundles that are already in the tree are shared.  A bundle that only
+  // partially overlaps one would need its lanes both vectorized and kept as
+  // scalars, so give up on the tree.
+  bool InTree = false;
+  for (unsigned i = 0, e = VL.size(); i != e; ++i)
+    InTree |= ScalarToTreeEntry.count(VL[i]);
+  if (InTree) {
+    DenseMap<Value*, unsigned>::iterator It = ScalarToTreeEntry.find(VL[0]);
+    if (It == ScalarToTreeEntry.end())
+      return false;
+    ValueList &Scalars = Tree[It->second].Scalars;
+    return std::equal(VL.begin(), VL.end(), Scalars.begin());
+  }
+
+  // Only follow bundles of distinct instructions of this block that share
+  // an opcode and a type.
+  Instruction *I0 = dyn_cast<Instruction>(VL[0]);
+  bool Isomorphic = Depth < RecursionMaxDepth && I0 && I0->getParent() == BB;
+  SmallPtrSet<Value*, 8> Unique;
+  for (unsigned i = 0, e = VL.size(); Isomorphic && i != e; ++i) {
+    Instruction *I = dyn_cast<Instruction>(VL[i]);
+    Isomorphic = I && I->getParent() == BB &&
+                 I->getOpcode() == I0->getOpcode() &&
+                 I->getType() == I0->getType() && Unique.insert(I);
+  }
+  if (!Isomorphic) {
+    Gathers.push_back(ValueList(VL.begin(), VL.end()));
+    return true;
+  }
+
+  switch (I0->getOpcode()) {
+  case Instruction::Load: {
+    for (unsigned i = 0, e = VL.size() - 1; i != e; ++i)
+      if (!isConsecutiveAccess(VL[i], VL[i + 1])) {
+        Gathers.push_back(ValueList(VL.begin(), VL.end()));
+        return true;
+      }
+    if (!isSafeToSink(VL)) {
+      Gathers.push_back(ValueList(VL.begin(), VL.end()));
+      return true;
+    }
+    newTreeEntry(VL);
+    return true;
+  }
+  case Instruction::ZExt:
+  case Instruction::SExt:
+  case Instruction::FPToUI:
+  case Instruction::FPToSI:
+  case Instruction::FPExt:
+  case Instruction::UIToFP:
+  case Instruction::SIToFP:
+  case Instruction::FPTrunc:
+  case Instruction::Trunc:
+  case Instruction::BitCast: {
+    Type *SrcTy = I0->getOperand(0)->getType();
+    for (unsigned i = 0, e = VL.size(); i != e; ++i)
+      if (cast<Instruction>(VL[i])->getOperand(0)->getType() != SrcTy)
+        SrcTy = 0;
+    if (!SrcTy || !isVectorizableType(SrcTy)) {
+      Gathers.push_back(ValueList(VL.begin(), VL.end()));
+      return true;
+    }
+    break;
+  }
+  case Instruction::ICmp:
+  case Instruction::FCmp: {
+    CmpInst::Predicate P0 = cast<CmpInst>(I0)->getPredicate();
+    Type *OpTy = I0->getOperand(0)->getType();
+    for (unsigned i = 0, e = VL.size(); i != e; ++i) {
+      CmpInst *Cmp = cast<CmpInst>(VL[i]);
+      if (Cmp->getPredicate() != P0 || Cmp->getOperand(0)->getType() != OpTy)
+        OpTy = 0;
+    }
+    if (!OpTy || !isVectorizableType(OpTy)) {
+      Gathers.push_back(ValueList(VL.begin(), VL.end()));
+      return true;
+    }
+    break;
+  }
+  case Instruction::Select:
+  case Instruction::Add:
+  case Instruction::FAdd:
+  case Instruction::Sub:
+  case Instruction::FSub:
+  case Instruction::Mul:
+  case Instruction::FMul:
+  case Instruction::UDiv:
+  case Instruction::SDiv:
+  case Instruction::FDiv:
+  case Instruction::URem:
+  case Instruction::SRem:
+  case Instruction::FRem:
+  case Instruction::Shl:
+  case Instruction::LShr:
+  case Instruction::AShr:
+  case Instruction::And:
+  case Instruction::Or:
+  case Instruction::Xor:
+    break;
+  default:
+    Gathers.push_back(ValueList(VL.begin(), VL.end()));
+    return true;
+  }
+
+  newTreeEntry(VL);
+  ValueList Operands;
+  for (unsigned OpIdx = 0, NumOps = I0->getNumOperands(); OpIdx != NumOps;
+       ++OpIdx) {
+    getOperandBundle(VL, OpIdx, Operands);
+    if (!buildTreeRec(Operands, Depth + 1))
+      return false;
+  }
+  return true;
+}
+
+bool BoUpSLP::hasValidExternalUses() {
+  for (unsigned i = 0, e = Gathers.size(); i != e; ++i)
+    for (unsigned j = 0, je = Gathers[i].size(); j != je; ++j)
+      if (ScalarToTreeEntry.count(Gathers[i][j]))
+        return false;
+
+  for (unsigned i = 0, e = Tree.size(); i != e; ++i) {
+    TreeEntry &E = Tree[i];
+    unsigned InsertIdx = InstrIdx[E.LastInst];
+    for (unsigned Lane = 0, le = E.Scalars.size(); Lane != le; ++Lane) {
+      Value *Scalar = E.Scalars[Lane];
+      for (Value::use_iterator UI = Scalar->use_begin(), UE = Scalar->use_end();
+           UI != UE; ++UI) {
+        Instruction *User = cast<Instruction>(*UI);
+        if (ScalarToTreeEntry.count(User) || isa<PHINode>(User) ||
+            User->getParent() != BB)
+          continue;
+        if (InstrIdx[User] < InsertIdx)
+          return false;
+      }
+    }
+  }
+  return true;
+}
+
+int BoUpSLP::getGatherCost(ArrayRef<Value*> VL) {
+  VectorType *VecTy = VectorType::get(VL[0]->getType(), VL.size());
+
+  bool AllConstant = true, AllSame = true;
+  for (unsigned i = 0, e = VL.size(); i != e; ++i) {
+    AllConstant &= isa<Constant>(VL[i]);
+    AllSame &= VL[i] == VL[0];
+  }
+  if (AllConstant)
+    return 0;
+  if (AllSame)
+    return TTI->getVectorInstrCost(Instruction::InsertElement, VecTy, 0) +
+           TTI->getShuffleCost(TargetTransformInfo::SK_Broadcast, VecTy);
+
+  int Cost = 0;
+  for (unsigned i = 0, e = VL.size(); i != e; ++i)
+    if (!isa<Constant>(VL[i]))
+      Cost += TTI->getVectorInstrCost(Instruction::InsertElement, VecTy, i);
+  return Cost;
+}
+
+int BoUpSLP::getEntryCost(TreeEntry &E) {
+  Instruction *I0 = cast<Instruction>(E.Scalars[0]);
+  unsigned Opcode = I0->getOpcode();
+  int VF = E.Scalars.size();
+  Type *ScalarTy = I0->getType();
+  if (StoreInst *SI = dyn_cast<StoreInst>(I0))
+    ScalarTy = SI->getValueOperand()->getType();
+  VectorType *VecTy = VectorType::get(ScalarTy, VF);
+
+  int Cost = 0;
+  switch (Opcode) {
+  case Instruction::Load:
+  case Instruction::Store: {
+    unsigned AS = cast<PointerType>(getPointerOperand(I0)->getType())
+                    ->getAddressSpace();
+    unsigned Align = getAlignment(I0);
+    Cost = TTI->getMemoryOpCost(Opcode, VecTy, Align, AS) -
+           VF * TTI->getMemoryOpCost(Opcode, ScalarTy, Align, AS);
+    break;
+  }
+  case Instruction::ICmp:
+  case Instruction::FCmp: {
+    Type *OpTy = I0->getOperand(0)->getType();
+    VectorType *VecOpTy = VectorType::get(OpTy, VF);
+    Cost = TTI->getCmpSelInstrCost(Opcode, VecOpTy, VecTy) -
+           VF * TTI->getCmpSelInstrCost(Opcode, OpTy, ScalarTy);
+    break;
+  }
+  case Instruction::Select: {
+    Type *CondTy = I0->getOperand(0)->getType();
+    VectorType *VecCondTy = VectorType::get(CondTy, VF);
+    Cost = TTI->getCmpSelInstrCost(Opcode, VecTy, VecCondTy) -
+           VF * TTI->getCmpSelInstrCost(Opcode, ScalarTy, CondTy);
+    break;
+  }
+  default:
+    if (CastInst *CI = dyn_cast<CastInst>(I0)) {
+      Type *SrcTy = CI->getSrcTy();
+      VectorType *VecSrcTy = VectorType::get(SrcTy, VF);
+      Cost = TTI->getCastInstrCost(Opcode, VecTy, VecSrcTy) -
+             VF * TTI->getCastInstrCost(Opcode, ScalarTy, SrcTy);
+      break;
+    }
+    Cost = TTI->getArithmeticInstrCost(Opcode, VecTy) -
+           VF * TTI->getArithmeticInstrCost(Opcode, ScalarTy);
+    break;
+  }
+
+  // Scalars that are still used outside the tree are extracted.
+  for (int Lane = 0; Lane != VF; ++Lane) {
+    Value *Scalar = E.Scalars[Lane];
+    for (Value::use_iterator UI = Scalar->use_begin(), UE = Scalar->use_end();
+         UI != UE; ++UI)
+      if (!ScalarToTreeEntry.count(*UI)) {
+        Cost += TTI->getVectorInstrCost(Instruction::ExtractElement, VecTy,
+                                        Lane);
+        break;
+      }
+  }
+  return Cost;
+}
+
+int BoUpSLP::getTreeCost() {
+  int Cost = 0;
+  for (unsigned i = 0, e = Tree.size(); i != e; ++i)
+    Cost += getEntryCost(Tree[i]);
+  for (unsigned i = 0, e = Gathers.size(); i != e; ++i)
+    Cost += getGatherCost(Gathers[i]);
+  return Cost;
+}
+
+void BoUpSLP::propagateIRFlags(Value *V, ArrayRef<Value*> VL) {
+  if (isa<OverflowingBinaryOperator>(V)) {
+    bool NSW = true, NUW = true;
+    for (unsigned i = 0, e = VL.size(); i != e; ++i) {
+      OverflowingBinaryOperator *Op = cast<OverflowingBinaryOperator>(VL[i]);
+      NSW &= Op->hasNoSignedWrap();
+      NUW &= Op->hasNoUnsignedWrap();
+    }
+    cast<BinaryOperator>(V)->setHasNoSignedWrap(NSW);
+    cast<BinaryOperator>(V)->setHasNoUnsignedWrap(NUW);
+  } else if (isa<PossiblyExactOperator>(V)) {
+    bool Exact = true;
+    for (unsigned i = 0, e = VL.size(); i != e; ++i)
+      Exact &= cast<PossiblyExactOperator>(VL[i])->isExact();
+    cast<BinaryOperator>(V)->setIsExact(Exact);
+  }
+}
+
+Value *BoUpSLP::gather(ArrayRef<Value*> VL, Instruction *InsertBefore) {
+  Type *ScalarTy = VL[0]->getType();
+  VectorType *VecTy = VectorType::get(ScalarTy, VL.size());
+  Builder.SetInsertPoint(InsertBefore);
+
+  bool AllSame = true;
+  for (unsigned i = 0, e = VL.size(); i != e; ++i)
+    AllSame &= VL[i] == VL[0];
+  if (AllSame && !isa<Constant>(VL[0])) {
+    Value *V = Builder.CreateInsertElement(UndefValue::get(VecTy), VL[0],
+                                           Builder.getInt32(0));
+    Constant *Zeros = ConstantAggregateZero::get(
+        VectorType::get(Builder.getInt32Ty(), VL.size()));
+    return Builder.CreateShuffleVector(V, UndefValue::get(VecTy), Zeros);
+  }
+
+  // Start from the constant lanes and insert the rest.
+  SmallVector<Constant*, 8> Consts;
+  for (unsigned i = 0, e = VL.size(); i != e; ++i)
+    Consts.push_back(isa<Constant>(VL[i]) ? cast<Constant>(VL[i])
+                                          : UndefValue::get(ScalarTy));
+  Value *Vec = ConstantVector::get(Consts);
+  for (unsigned i = 0, e = VL.size(); i != e; ++i)
+    if (!isa<Constant>(VL[i]))
+      Vec = Builder.CreateInsertElement(Vec, VL[i], Builder.getInt32(i));
+  return Vec;
+}
+
+Value *BoUpSLP::vectorizeOperand(ArrayRef<Value*> VL,
+                                 Instruction *InsertBefore) {
+  DenseMap<Value*, unsigned>::iterator It = ScalarToTreeEntry.find(VL[0]);
+  if (It != ScalarToTreeEntry.end())
+    return vectorizeEntry(It->second);
+  return gather(VL, InsertBefore);
+}
+
+Value *BoUpSLP::vectorizeEntry(unsigned Idx) {
+  TreeEntry &E = Tree[Idx];
+  if (E.VectorizedValue)
+    return E.VectorizedValue;
+
+  Instruction *I0 = cast<Instruction>(E.Scalars[0]);
+  unsigned VF = E.Scalars.size();
+
+  // Loads and stores use the address of the first lane for the whole vector;
+  // everything else takes vector operands.
+  ValueList Operands[3];
+  if (!isa<LoadInst>(I0)) {
+    unsigned NumOps = isa<StoreInst>(I0) ? 1 : I0->getNumOperands();
+    for (unsigned OpIdx = 0; OpIdx != NumOps; ++OpIdx)
+      getOperandBundle(E.Scalars, OpIdx, Operands[OpIdx]);
+  }
+
+  Value *V = 0;
+  switch (I0->getOpcode()) {
+  case Instruction::Load: {
+    LoadInst *LI = cast<LoadInst>(I0);
+    VectorType *VecTy = VectorType::get(LI->getType(), VF);
+    unsigned AS = LI->getPointerAddressSpace();
+    unsigned Align = LI->getAlignment();
+    if (!Align)
+      Align = TD->getABITypeAlignment(LI->getType());
+    Builder.SetInsertPoint(E.LastInst);
+    Value *Ptr = Builder.CreateBitCast(LI->getPointerOperand(),
+                                       VecTy->getPointerTo(AS));
+    V = Builder.CreateAlignedLoad(Ptr, Align);
+    break;
+  }
+  case Instruction::Store: {
+    StoreInst *SI = cast<StoreInst>(I0);
+    Value *Val = vectorizeOperand(Operands[0], E.LastInst);
+    unsigned AS = SI->getPointerAddressSpace();
+    unsigned Align = SI->getAlignment();
+    if (!Align)
+      Align = TD->getABITypeAlignment(SI->getValueOperand()->getType());
+    Builder.SetInsertPoint(E.LastInst);
+    Value *Ptr = Builder.CreateBitCast(SI->getPointerOperand(),
+                                       Val->getType()->getPointerTo(AS));
+    V = Builder.CreateAlignedStore(Val, Ptr, Align);
+    break;
+  }
+  case Instruction::ICmp:
+  case Instruction::FCmp: {
+    Value *L = vectorizeOperand(Operands[0], E.LastInst);
+    Value *R = vectorizeOperand(Operands[1], E.LastInst);
+    Builder.SetInsertPoint(E.LastInst);
+    CmpInst::Predicate P = cast<CmpInst>(I0)->getPredicate();
+    if (isa<ICmpInst>(I0))
+      V = Builder.CreateICmp(P, L, R);
+    else
+      V = Builder.CreateFCmp(P, L, R);
+    break;
+  }
+  case Instruction::Select: {
+    Value *Cond = vectorizeOperand(Operands[0], E.LastInst);
+    Value *T = vectorizeOperand(Operands[1], E.LastInst);
+    Value *F = vectorizeOperand(Operands[2], E.LastInst);
+    Builder.SetInsertPoint(E.LastInst);
+    V = Builder.CreateSelect(Cond, T, F);
+    break;
+  }
+  default:
+    if (CastInst *CI = dyn_cast<CastInst>(I0)) {
+      Value *Src = vectorizeOperand(Operands[0], E.LastInst);
+      Builder.SetInsertPoint(E.LastInst);
+      V = Builder.CreateCast(CI->getOpcode(), Src,
+                             VectorType::get(CI->getType(), VF));
+      break;
+    }
+    BinaryOperator *BO = cast<BinaryOperator>(I0);
+    Value *L = vectorizeOperand(Operands[0], E.LastInst);
+    Value *R = vectorizeOperand(Operands[1], E.LastInst);
+    Builder.SetInsertPoint(E.LastInst);
+    V = Builder.CreateBinOp(BO->getOpcode(), L, R);
+    if (isa<BinaryOperator>(V))
+      propagateIRFlags(V, E.Scalars);
+    break;
+  }
+
+  E.VectorizedValue = V;
+  return V;
+}
+
+void BoUpSLP::vectorizeTree() {
+  vectorizeEntry(0);
+
+  // Feed the users outside the tree from the vectors, and erase the scalars.
+  for (unsigned i = 0, e = Tree.size(); i != e; ++i) {
+    TreeEntry &E = Tree[i];
+    for (unsigned Lane = 0, le = E.Scalars.size(); Lane != le; ++Lane) {
+      Value *Scalar = E.Scalars[Lane];
+      SmallVector<User*, 8> ExternalUsers;
+      for (Value::use_iterator UI = Scalar->use_begin(), UE = Scalar->use_end();
+           UI != UE; ++UI)
+        if (!ScalarToTreeEntry.count(*UI))
+          ExternalUsers.push_back(*UI);
+      if (ExternalUsers.empty())
+        continue;
+
+      if (Instruction *VecInst = dyn_cast<Instruction>(E.VectorizedValue))
+        Builder.SetInsertPoint(BB, ++BasicBlock::iterator(VecInst));
+      else
+        Builder.SetInsertPoint(E.LastInst);
+      Value *Ex = Builder.CreateExtractElement(E.VectorizedValue,
+                                               Builder.getInt32(Lane));
+      for (unsigned u = 0, ue = ExternalUsers.size(); u != ue; ++u)
+        ExternalUsers[u]->replaceUsesOfWith(Scalar, Ex);
+    }
+  }
+
+  for (unsigned i = 0, e = Tree.size(); i != e; ++i)
+    for (unsigned Lane = 0, le = Tree[i].Scalars.size(); Lane != le; ++Lane) {
+      Value *Scalar = Tree[i].Scalars[Lane];
+      if (!Scalar->use_empty())
+        Scalar->replaceAllUsesWith(UndefValue::get(Scalar->getType()));
+    }
+  for (unsigned i = 0, e = Tree.size(); i != e; ++i)
+    for (unsigned Lane = 0, le = Tree[i].Scalars.size(); Lane != le; ++Lane)
+      cast<Instruction>(Tree[i].Scalars[Lane])->eraseFromParent();
+}
+
+bool BoUpSLP::vectorizeStores(ArrayRef<StoreInst*> Stores) {
+  ValueList Roots(Stores.begin(), Stores.end());
+  if (!buildTree(Roots)) {
+    DEBUG(dbgs() << "SLP: Cannot vectorize the tree of " << Stores.size()
+                 << " stores starting at " << *Stores[0] << "\n");
+    return false;
+  }
+
+  int Cost = getTreeCost();
+  DEBUG(dbgs() << "SLP: Tree of " << Tree.size() << " bundles and "
+               << Gathers.size() << " gathers costs " << Cost << "\n");
+  if (Cost >= -SLPCostThreshold)
+    return false;
+
+  vectorizeTree();
+  numberInstructions();
+  ++NumTreesVectorized;
+  NumStoresVectorized += Stores.size();
+  return true;
+}
+
+//===----------------------------------------------------------------------===//
+/// SLPVectorizer - The pass: find runs of consecutive stores in each block
+/// and hand them to BoUpSLP.
+struct SLPVectorizer : public FunctionPass {
+  static char ID; // Pass identification, replacement for typeid
+
+  ScalarEvolution *SE;
+  TargetData *TD;
+  TargetTransformInfo *TTI;
+  AliasAnalysis *AA;
+
+  SLPVectorizer() : FunctionPass(ID) {
+    initializeSLPVectorizerPass(*PassRegistry::getPassRegistry());
+  }
+
+  virtual bool runOnFunction(Function &F) {
+    SE = &getAnalysis<ScalarEvolution>();
+    TD = getAnalysisIfAvailable<TargetData>();
+    TTI = &getAnalysis<TargetTransformInfo>();
+    AA = &getAnalysis<AliasAnalysis>();
+
+    // Without TargetData we cannot tell which accesses are consecutive, and
+    // without vector registers there is nothing to do.
+    if (!TD || !TTI->getRegisterBitWidth(true) ||
+        F.getFnAttributes().hasNoImplicitFloatAttr())
+      return false;
+
+    DEBUG(dbgs() << "SLP: Vectorizing " << F.getName() << "\n");
+
+    bool Changed = false;
+    for (Function::iterator BB = F.begin(), E = F.end(); BB != E; ++BB)
+      Changed |= vectorizeBlock(BB);
+    return Changed;
+  }
+
+  virtual void getAnalysisUsage(AnalysisUsage &AU) const {
+    FunctionPass::getAnalysisUsage(AU);
+    AU.addRequired<ScalarEvolution>();
+    AU.addRequired<AliasAnalysis>();
+    AU.addRequired<TargetTransformInfo>();
+    AU.setPreservesCFG();
+  }
+
+private:
+  /// vectorizeBlock - Vectorize the runs of consecutive stores in BB.
+  bool vectorizeBlock(BasicBlock *BB);
+
+  /// vectorizeStoreChain - Try to vectorize Chain, a run of stores to
+  /// consecutive addresses, in pieces as wide as the vector registers, and
+  /// then in narrower pieces.
+  bool vectorizeStoreChain(ArrayRef<StoreInst*> Chain, BoUpSLP &R);
+};
+
+bool SLPVectorizer::vectorizeBlock(BasicBlock *BB) {
+  // Group the simple stores of vectorizable values by the object they write.
+  typedef MapVector<Value*, SmallVector<StoreInst*, 8> > StoreListMap;
+  StoreListMap StoreRefs;
+  unsigned MaxBits = TTI->getRegisterBitWidth(true);
+  for (BasicBlock::iterator I = BB->begin(), E = BB->end(); I != E; ++I) {
+    StoreInst *SI = dyn_cast<StoreInst>(I);
+    if (!SI || !SI->isSimple())
+      continue;
+    Type *Ty = SI->getValueOperand()->getType();
+    uint64_t Bits = TD->getTypeSizeInBits(Ty);
+    if (!isVectorizableType(Ty) || !isPowerOf2_64(Bits) || Bits < 8 ||
+        Bits * 2 > MaxBits || Bits != TD->getTypeStoreSizeInBits(Ty))
+      continue;
+    StoreRefs[GetUnderlyingObject(SI->getPointerOperand(), TD)].push_back(SI);
+  }
+
+  BoUpSLP R(BB, SE, TD, TTI, AA);
+  bool Changed = false;
+  for (StoreListMap::iterator It = StoreRefs.begin(), E = StoreRefs.end();
+       It != E; ++It) {
+    SmallVector<StoreInst*, 8> &Stores = It->second;
+    unsigned NumStores = Stores.size();
+    if (NumStores < 2)
+      continue;
+
+    // Link each store to the one that writes the memory right after it,
+    // looking only at nearby stores.
+    SmallVector<int, 8> Next(NumStores, -1);
+    SmallVector<bool, 8> HasPrev(NumStores, false);
+    for (unsigned i = 0; i != NumStores; ++i) {
+      unsigned Begin = i > StoreLookahead ? i - StoreLookahead : 0;
+      unsigned End = std::min(NumStores, i + StoreLookahead + 1);
+      for (unsigned j = Begin; j != End; ++j)
+        if (j != i && !HasPrev[j] && R.isConsecutiveAccess(Stores[i],
+                                                           Stores[j])) {
+          Next[i] = j;
+          HasPrev[j] = true;
+          break;
+        }
+    }
+
+    // Walk each chain from its lowest address.
+    SmallVector<StoreInst*, 8> Chain;
+    for (unsigned i = 0; i != NumStores; ++i) {
+      if (HasPrev[i] || Next[i] < 0)
+        continue;
+      Chain.clear();
+      for (int j = i; j >= 0; j = Next[j])
+        Chain.push_back(Stores[j]);
+      Changed |= vectorizeStoreChain(Chain, R);
+    }
+  }
+  return Changed;
+}
+
+bool SLPVectorizer::vectorizeStoreChain(ArrayRef<StoreInst*> Chain,
+                                        BoUpSLP &R) {
+  Type *Ty = Chain[0]->getValueOperand()->getType();
+  unsigned VF = TTI->getRegisterBitWidth(true) / TD->getTypeSizeInBits(Ty);
+  SmallVector<bool, 8> Vectorized(Chain.size(), false);
+
+  bool Changed = false;
+  for (; VF >= 2; VF /= 2) {
+    for (unsigned i = 0; i + VF <= Chain.size(); ) {
+      bool Done = false;
+      for (unsigned j = i; j != i + VF; ++j)
+        Done |= Vectorized[j];
+      if (Done || !R.vectorizeStores(Chain.slice(i, VF))) {
+        ++i;
+        continue;
+      }
+      DEBUG(dbgs() << "SLP: Vectorized " << VF << " stores\n");
+      std::fill(Vectorized.begin() + i, Vectorized.begin() + i + VF, true);
+      Changed = true;
+      i += VF;
+    }
+  }
+  return Changed;
+}
+
+} // end anonymous namespace
+
+char SLPVectorizer::ID = 0;
+static const char sv_name[] = "SLP Vectorizer";
+INITIALIZE_PASS_BEGIN(SLPVectorizer, SV_NAME, sv_name, false, false)
+INITIALIZE_AG_DEPENDENCY(AliasAnalysis)
+INITIALIZE_AG_DEPENDENCY(TargetTransformInfo)
+INITIALIZE_PASS_DEPENDENCY(ScalarEvolution)
+INITIALIZE_PASS_END(SLPVectorizer, SV_NAME, sv_name, false, false)
+
+Pass *llvm::createSLPVectorizerPass() {
+  return new SLPVectorizer();
+}
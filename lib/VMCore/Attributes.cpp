@@ -80,6 +80,8 @@ std::string Attributes::getAsString() const {
     Result += "nonlazybind ";
   if (hasAddressSafetyAttr())
     Result += "address_safety ";
+  if (hasColdAttr())
+    Result += "cold ";
   if (hasStackAlignmentAttr()) {
     Result += "alignstack(";
     Result += utostr(getStackAlignment());
@@ -132,9 +134,12 @@ Attributes Attributes::get(LLVMContext &Context, Attributes::Builder &B) {
 
   if (!PA) {
     // If we didn't find any existing attributes of the same shape then create a
-    // new one and insert it.
-    PA = new AttributesImpl(B.Bits);
-    pImpl->AttrsSet.InsertNode(PA, InsertPoint);
+    // new one and insert it.  Another thread may have inserted the same
+    // attributes in the meantime, in which case we use those instead.
+    AttributesImpl *NewPA = new AttributesImpl(B.Bits);
+    PA = pImpl->AttrsSet.GetOrInsertNode(NewPA);
+    if (PA != NewPA)
+      delete NewPA;
   }
 
   // Return the AttributesList that we found or created.
@@ -15,11 +15,11 @@
 #ifndef LLVM_ATTRIBUTESIMPL_H
 #define LLVM_ATTRIBUTESIMPL_H
 
-#include "llvm/ADT/FoldingSet.h"
+#include "llvm/ADT/ConcurrentFoldingSet.h"
 
 namespace llvm {
 
-class AttributesImpl : public FoldingSetNode {
+class AttributesImpl : public ConcurrentFoldingSetNode {
   uint64_t Bits;                // FIXME: We will be expanding this.
 
   void operator=(const AttributesImpl &) LLVM_DELETED_FUNCTION;
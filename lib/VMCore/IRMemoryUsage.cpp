@@ -0,0 +1,276 @@
+//===-- IRMemoryUsage.cpp - Memory footprint of a Module ------------------===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+//
+// This file implements IRMemoryUsage and the -print-ir-memory pass.
+//
+//===----------------------------------------------------------------------===//
+
+#include "llvm/IRMemoryUsage.h"
+#include "LLVMContextImpl.h"
+#include "llvm/Constants.h"
+#include "llvm/Function.h"
+#include "llvm/GlobalAlias.h"
+#include "llvm/GlobalVariable.h"
+#include "llvm/Instructions.h"
+#include "llvm/Module.h"
+#include "llvm/Pass.h"
+#include "llvm/ValueSymbolTable.h"
+#include "llvm/ADT/SmallPtrSet.h"
+#include "llvm/ADT/SmallVector.h"
+#include "llvm/Support/CommandLine.h"
+#include "llvm/Support/ErrorHandling.h"
+#include "llvm/Support/Format.h"
+#include "llvm/Support/raw_ostream.h"
+#include <algorithm>
+using namespace llvm;
+
+static cl::opt<unsigned>
+IRMemoryTopFunctions("print-ir-memory-functions", cl::init(10), cl::Hidden,
+  cl::desc("Number of functions listed by -print-ir-memory"));
+
+/// getInstructionSize - Return the size of the object for I, excluding its
+/// operands.
+static size_t getInstructionSize(const Instruction &I) {
+  switch (I.getOpcode()) {
+  default: llvm_unreachable("Unknown instruction opcode!");
+#define HANDLE_INST(N, OPC, CLASS) \
+  case Instruction::OPC: return sizeof(CLASS);
+#include "llvm/Instruction.def"
+  }
+}
+
+/// getConstantSize - Return the size of the object for C, including any
+/// storage it owns other than its operands.
+static size_t getConstantSize(const Constant &C) {
+  switch (C.getValueID()) {
+  case Value::ConstantIntVal: {
+    const APInt &Val = cast<ConstantInt>(C).getValue();
+    size_t Size = sizeof(ConstantInt);
+    if (Val.getNumWords() > 1)
+      Size += Val.getNumWords() * sizeof(uint64_t);
+    return Size;
+  }
+  case Value::ConstantFPVal:
+    return sizeof(ConstantFP);
+  case Value::ConstantAggregateZeroVal:
+    return sizeof(ConstantAggregateZero);
+  case Value::ConstantPointerNullVal:
+    return sizeof(ConstantPointerNull);
+  case Value::UndefValueVal:
+    return sizeof(UndefValue);
+  case Value::BlockAddressVal:
+    return sizeof(BlockAddress);
+  case Value::ConstantExprVal:
+    return sizeof(ConstantExpr);
+  case Value::ConstantArrayVal:
+    return sizeof(ConstantArray);
+  case Value::ConstantStructVal:
+    return sizeof(ConstantStruct);
+  case Value::ConstantVectorVal:
+    return sizeof(ConstantVector);
+  case Value::ConstantDataArrayVal:
+  case Value::ConstantDataVectorVal:
+    return sizeof(ConstantDataSequential) +
+           cast<ConstantDataSequential>(C).getRawDataValues().size();
+  default:
+    return sizeof(Constant);
+  }
+}
+
+/// getNameSize - Return the size of the symbol table entry holding V's name.
+static size_t getNameSize(const Value &V) {
+  if (!V.hasName())
+    return 0;
+  return sizeof(ValueName) + V.getName().size() + 1;
+}
+
+/// getSymbolTableSize - Return the size of the bucket array of ST.
+static size_t getSymbolTableSize(const ValueSymbolTable &ST) {
+  return ST.getNumBuckets() * (sizeof(StringMapEntryBase*) + sizeof(unsigned));
+}
+
+namespace {
+/// UsageCollector - Walks a module and fills in an IRMemoryUsage.
+class UsageCollector {
+  IRMemoryUsage &Usage;
+  SmallPtrSet<const Constant*, 64> VisitedConstants;
+  SmallVector<std::pair<unsigned, MDNode*>, 4> MDs;
+
+public:
+  explicit UsageCollector(IRMemoryUsage &U) : Usage(U) {}
+
+  /// addOperands - Count the operand array of U and any constants it uses.
+  void addOperands(const User &U) {
+    Usage.Uses += U.getNumOperands() * sizeof(Use);
+    for (User::const_op_iterator I = U.op_begin(), E = U.op_end(); I != E; ++I)
+      if (const Constant *C = dyn_cast_or_null<Constant>(I->get()))
+        addConstant(*C);
+  }
+
+  void addConstant(const Constant &C) {
+    // Globals are counted where they are defined.
+    if (isa<GlobalValue>(C) || !VisitedConstants.insert(&C))
+      return;
+    Usage.Constants += getConstantSize(C) + C.getNumOperands() * sizeof(Use);
+    for (User::const_op_iterator I = C.op_begin(), E = C.op_end(); I != E; ++I)
+      if (const Constant *Op = dyn_cast_or_null<Constant>(I->get()))
+        addConstant(*Op);
+  }
+
+  void addFunction(const Function &F);
+};
+}
+
+void UsageCollector::addFunction(const Function &F) {
+  size_t Before = Usage.Instructions + Usage.Uses + Usage.Globals +
+                  Usage.Metadata + Usage.ValueNames + Usage.SymbolTables;
+  unsigned NumInstructions = 0;
+
+  Usage.Globals += sizeof(Function);
+  Usage.ValueNames += getNameSize(F);
+  for (Function::const_arg_iterator AI = F.arg_begin(), AE = F.arg_end();
+       AI != AE; ++AI) {
+    Usage.Globals += sizeof(Argument);
+    Usage.ValueNames += getNameSize(*AI);
+  }
+
+  for (Function::const_iterator BB = F.begin(), BE = F.end(); BB != BE; ++BB) {
+    Usage.Globals += sizeof(BasicBlock);
+    Usage.ValueNames += getNameSize(*BB);
+    for (BasicBlock::const_iterator I = BB->begin(), IE = BB->end(); I != IE;
+         ++I) {
+      ++NumInstructions;
+      Usage.Instructions += getInstructionSize(*I);
+      Usage.ValueNames += getNameSize(*I);
+      addOperands(*I);
+      // PHI nodes keep their incoming blocks after the operands.
+      if (const PHINode *PN = dyn_cast<PHINode>(I))
+        Usage.Uses += PN->getNumIncomingValues() * sizeof(BasicBlock*);
+
+      if (I->hasMetadataOtherThanDebugLoc()) {
+        I->getAllMetadataOtherThanDebugLoc(MDs);
+        Usage.Metadata += MDs.size() * sizeof(LLVMContextImpl::MDPairTy);
+      }
+    }
+  }
+
+  // Declarations are counted in the totals but not listed.
+  if (F.isDeclaration())
+    return;
+  Usage.SymbolTables += getSymbolTableSize(F.getValueSymbolTable());
+
+  size_t After = Usage.Instructions + Usage.Uses + Usage.Globals +
+                 Usage.Metadata + Usage.ValueNames + Usage.SymbolTables;
+  IRMemoryUsage::FunctionUsage FU = { &F, After - Before, NumInstructions };
+  Usage.Functions.push_back(FU);
+}
+
+namespace {
+struct LargerFunction {
+  bool operator()(const IRMemoryUsage::FunctionUsage &A,
+                  const IRMemoryUsage::FunctionUsage &B) const {
+    return A.Bytes > B.Bytes;
+  }
+};
+}
+
+IRMemoryUsage::IRMemoryUsage(const Module &M)
+  : Instructions(0), Uses(0), Constants(0), Globals(0), Types(0), Metadata(0),
+    ValueNames(0), SymbolTables(0) {
+  UsageCollector Collector(*this);
+
+  for (Module::const_global_iterator I = M.global_begin(), E = M.global_end();
+       I != E; ++I) {
+    Globals += sizeof(GlobalVariable);
+    ValueNames += getNameSize(*I);
+    Collector.addOperands(*I);
+  }
+  for (Module::const_alias_iterator I = M.alias_begin(), E = M.alias_end();
+       I != E; ++I) {
+    Globals += sizeof(GlobalAlias);
+    ValueNames += getNameSize(*I);
+    Collector.addOperands(*I);
+  }
+  for (Module::const_iterator I = M.begin(), E = M.end(); I != E; ++I)
+    Collector.addFunction(*I);
+  SymbolTables += getSymbolTableSize(M.getValueSymbolTable());
+
+  for (Module::const_named_metadata_iterator I = M.named_metadata_begin(),
+         E = M.named_metadata_end(); I != E; ++I)
+    Metadata += sizeof(NamedMDNode) + I->getName().size() +
+                I->getNumOperands() * sizeof(TrackingVH<MDNode>);
+
+  // Types and uniqued metadata belong to the context.
+  const LLVMContextImpl *pImpl = M.getContext().pImpl;
+  Types += pImpl->TypeAllocator.getTotalMemory();
+  Metadata += pImpl->MDNodeBytes + pImpl->MDStringBytes;
+
+  std::stable_sort(Functions.begin(), Functions.end(), LargerFunction());
+}
+
+size_t IRMemoryUsage::getTotal() const {
+  return Instructions + Uses + Constants + Globals + Types + Metadata +
+         ValueNames + SymbolTables;
+}
+
+static void printLine(raw_ostream &OS, size_t Bytes, StringRef What) {
+  OS << format("%12llu", (unsigned long long)Bytes) << "  " << What << '\n';
+}
+
+void IRMemoryUsage::print(raw_ostream &OS, unsigned NumFunctions) const {
+  printLine(OS, Instructions, "instructions");
+  printLine(OS, Uses, "operands");
+  printLine(OS, Constants, "constants");
+  printLine(OS, Globals, "globals, functions, arguments and blocks");
+  printLine(OS, Types, "types (context)");
+  printLine(OS, Metadata, "metadata (context)");
+  printLine(OS, ValueNames, "value names");
+  printLine(OS, SymbolTables, "symbol tables");
+  printLine(OS, getTotal(), "total");
+
+  if (Functions.empty() || NumFunctions == 0)
+    return;
+  OS << "\nLargest functions:\n";
+  for (unsigned i = 0, e = std::min<size_t>(NumFunctions, Functions.size());
+       i != e; ++i) {
+    const FunctionUsage &FU = Functions[i];
+    OS << format("%12llu", (unsigned long long)FU.Bytes) << "  "
+       << format("%7u", FU.NumInstructions) << " instrs  "
+       << FU.F->getName() << '\n';
+  }
+}
+
+namespace {
+  /// IRMemoryUsagePrinter - Print the memory used by the module.
+  class IRMemoryUsagePrinter : public ModulePass {
+    raw_ostream &Out;
+  public:
+    static char ID;
+    IRMemoryUsagePrinter() : ModulePass(ID), Out(errs()) {}
+    explicit IRMemoryUsagePrinter(raw_ostream &OS) : ModulePass(ID), Out(OS) {}
+
+    bool runOnModule(Module &M) {
+      Out << "IR memory usage for '" << M.getModuleIdentifier() << "':\n";
+      IRMemoryUsage(M).print(Out, IRMemoryTopFunctions);
+      return false;
+    }
+
+    virtual void getAnalysisUsage(AnalysisUsage &AU) const {
+      AU.setPreservesAll();
+    }
+  };
+}
+
+char IRMemoryUsagePrinter::ID = 0;
+INITIALIZE_PASS(IRMemoryUsagePrinter, "print-ir-memory",
+                "Print the memory used by the module to stderr", false, true)
+
+ModulePass *llvm::createIRMemoryUsagePrinterPass(raw_ostream &OS) {
+  return new IRMemoryUsagePrinter(OS);
+}
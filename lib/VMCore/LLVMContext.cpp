@@ -160,3 +160,11 @@ void LLVMContext::getMDKindNames(SmallVectorImpl<StringRef> &Names) const {
        E = pImpl->CustomMDKindNames.end(); I != E; ++I)
     Names[I->second] = I->first();
 }
+
+unsigned LLVMContext::purgeUnusedMetadata() {
+  return pImpl->purgeUnusedMetadata();
+}
+
+size_t LLVMContext::getMetadataMemoryUsage() const {
+  return pImpl->MDNodeBytes + pImpl->MDStringBytes;
+}
@@ -38,6 +38,8 @@ LLVMContextImpl::LLVMContextImpl(LLVMContext &C)
   InlineAsmDiagHandler = 0;
   InlineAsmDiagContext = 0;
   NamedStructTypesUniqueID = 0;
+  MDNodeBytes = 0;
+  MDStringBytes = 0;
 }
 
 namespace {
@@ -96,9 +98,11 @@ LLVMContextImpl::~LLVMContextImpl() {
   CDSConstants.clear();
 
   // Destroy attributes.
-  for (FoldingSetIterator<AttributesImpl> I = AttrsSet.begin(),
-         E = AttrsSet.end(); I != E; ++I)
-    delete &*I;
+  for (ConcurrentFoldingSet<AttributesImpl>::iterator I = AttrsSet.begin(),
+         E = AttrsSet.end(); I != E; ) {
+    AttributesImpl *PA = &*I++;
+    delete PA;
+  }
   
   // Destroy MDNodes.  ~MDNode can move and remove nodes between the MDNodeSet
   // and the NonUniquedMDNodes sets, so copy the values out first.
@@ -118,6 +122,95 @@ LLVMContextImpl::~LLVMContextImpl() {
   DeleteContainerSeconds(MDStringCache);
 }
 
+/// getMDNodeSize - Return the size of an MDNode with NumOperands operands.
+static size_t getMDNodeSize(unsigned NumOperands) {
+  // MDNodeOperand is a CallbackVH and has no members of its own.
+  return sizeof(MDNode) + NumOperands * sizeof(CallbackVH);
+}
+
+void *LLVMContextImpl::allocateMDNode(unsigned NumOperands) {
+  size_t Size = getMDNodeSize(NumOperands);
+  MDNodeBytes += Size;
+  if (NumOperands > MaxRecycledMDOperands)
+    return malloc(Size);
+
+  // Reuse the storage of a destroyed node of the same size if there is one.
+  if (NumOperands < MDFreeLists.size() && MDFreeLists[NumOperands]) {
+    void *Mem = MDFreeLists[NumOperands];
+    MDFreeLists[NumOperands] = *static_cast<void**>(Mem);
+    return Mem;
+  }
+  return MDAllocator.Allocate(Size, AlignOf<MDNode>::Alignment);
+}
+
+void LLVMContextImpl::deallocateMDNode(void *Mem, unsigned NumOperands) {
+  MDNodeBytes -= getMDNodeSize(NumOperands);
+  if (NumOperands > MaxRecycledMDOperands) {
+    free(Mem);
+    return;
+  }
+
+  // Once every node is gone, hand the slabs back instead of keeping them on
+  // the free lists.
+  if (MDNodeBytes == 0) {
+    MDFreeLists.clear();
+    MDAllocator.Reset();
+    return;
+  }
+
+  if (NumOperands >= MDFreeLists.size())
+    MDFreeLists.resize(NumOperands + 1);
+  *static_cast<void**>(Mem) = MDFreeLists[NumOperands];
+  MDFreeLists[NumOperands] = Mem;
+}
+
+/// isUnreferencedMDNode - MDNode operands are value handles, so a node that is
+/// an operand of another MDNode, attached to an instruction, in a named
+/// metadata node or used by a DebugLoc always has a use or a value handle.
+/// Temporary nodes are owned by their creator and never considered.
+bool LLVMContextImpl::isUnreferencedMDNode(MDNode *N) const {
+  return N->use_empty() && !N->hasValueHandle() &&
+         (!N->isNotUniqued() || NonUniquedMDNodes.count(N));
+}
+
+unsigned LLVMContextImpl::purgeUnusedMetadata() {
+  SmallVector<MDNode*, 64> Worklist;
+  SmallPtrSet<MDNode*, 64> Queued;
+  for (FoldingSetIterator<MDNode> I = MDNodeSet.begin(), E = MDNodeSet.end();
+       I != E; ++I)
+    if (isUnreferencedMDNode(&*I))
+      Worklist.push_back(&*I);
+  for (SmallPtrSet<MDNode*, 1>::iterator I = NonUniquedMDNodes.begin(),
+         E = NonUniquedMDNodes.end(); I != E; ++I)
+    if (isUnreferencedMDNode(*I))
+      Worklist.push_back(*I);
+  Queued.insert(Worklist.begin(), Worklist.end());
+
+  unsigned NumPurged = 0;
+  SmallVector<MDNode*, 8> Operands;
+  while (!Worklist.empty()) {
+    MDNode *N = Worklist.pop_back_val();
+    for (unsigned i = 0, e = N->getNumOperands(); i != e; ++i)
+      if (MDNode *Op = dyn_cast_or_null<MDNode>(N->getOperand(i)))
+        if (Op != N)
+          Operands.push_back(Op);
+
+    N->destroy();
+    ++NumPurged;
+
+    // Destroying N dropped its handles on its operands, which may have been
+    // the last references to them.
+    while (!Operands.empty()) {
+      MDNode *Op = Operands.pop_back_val();
+      if (!Queued.count(Op) && isUnreferencedMDNode(Op)) {
+        Queued.insert(Op);
+        Worklist.push_back(Op);
+      }
+    }
+  }
+  return NumPurged;
+}
+
 // ConstantsContext anchors
 void UnaryConstantExpr::anchor() { }
 
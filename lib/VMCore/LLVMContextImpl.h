@@ -26,7 +26,9 @@
 #include "llvm/ADT/APFloat.h"
 #include "llvm/ADT/APInt.h"
 #include "llvm/ADT/ArrayRef.h"
+#include "llvm/ADT/ConcurrentFoldingSet.h"
 #include "llvm/ADT/DenseMap.h"
+#include "llvm/ADT/FlatDenseMap.h"
 #include "llvm/ADT/FoldingSet.h"
 #include "llvm/ADT/SmallPtrSet.h"
 #include "llvm/ADT/StringMap.h"
@@ -247,15 +249,15 @@ public:
   LLVMContext::InlineAsmDiagHandlerTy InlineAsmDiagHandler;
   void *InlineAsmDiagContext;
   
-  typedef DenseMap<DenseMapAPIntKeyInfo::KeyTy, ConstantInt*, 
-                         DenseMapAPIntKeyInfo> IntMapTy;
+  typedef HotDenseMap<DenseMapAPIntKeyInfo::KeyTy, ConstantInt*,
+                      DenseMapAPIntKeyInfo>::type IntMapTy;
   IntMapTy IntConstants;
   
-  typedef DenseMap<DenseMapAPFloatKeyInfo::KeyTy, ConstantFP*, 
-                         DenseMapAPFloatKeyInfo> FPMapTy;
+  typedef HotDenseMap<DenseMapAPFloatKeyInfo::KeyTy, ConstantFP*,
+                      DenseMapAPFloatKeyInfo>::type FPMapTy;
   FPMapTy FPConstants;
 
-  FoldingSet<AttributesImpl> AttrsSet;
+  ConcurrentFoldingSet<AttributesImpl> AttrsSet;
   
   StringMap<Value*> MDStringCache;
 
@@ -266,6 +268,35 @@ public:
   // one object can destroy them.  This set allows us to at least destroy them
   // on Context destruction.
   SmallPtrSet<MDNode*, 1> NonUniquedMDNodes;
+
+  /// MDAllocator - MDNodes and their co-allocated operands are allocated from
+  /// this, unless they have more than MaxRecycledMDOperands operands.
+  BumpPtrAllocator MDAllocator;
+
+  /// MDFreeLists - Storage of destroyed MDNodes, indexed by operand count and
+  /// threaded through the first word of each block, for reuse by later nodes
+  /// with the same number of operands.
+  std::vector<void*> MDFreeLists;
+
+  /// MDNodeBytes, MDStringBytes - Bytes currently used by live MDNodes and
+  /// MDStrings in this context.
+  size_t MDNodeBytes, MDStringBytes;
+
+  enum { MaxRecycledMDOperands = 64 };
+
+  /// allocateMDNode - Return storage for an MDNode with NumOperands operands.
+  void *allocateMDNode(unsigned NumOperands);
+
+  /// deallocateMDNode - Release the storage of a destroyed MDNode.
+  void deallocateMDNode(void *Mem, unsigned NumOperands);
+
+  /// isUnreferencedMDNode - Return true if N is a shared MDNode that nothing
+  /// refers to.
+  bool isUnreferencedMDNode(MDNode *N) const;
+
+  /// purgeUnusedMetadata - Destroy every shared MDNode that is not referenced
+  /// by a use, a value handle or another MDNode.
+  unsigned purgeUnusedMetadata();
   
   DenseMap<Type*, ConstantAggregateZero*> CAZConstants;
 
@@ -318,14 +349,15 @@ public:
     
   DenseMap<std::pair<Type *, uint64_t>, ArrayType*> ArrayTypes;
   DenseMap<std::pair<Type *, unsigned>, VectorType*> VectorTypes;
-  DenseMap<Type*, PointerType*> PointerTypes;  // Pointers in AddrSpace = 0
+  // Pointers in AddrSpace = 0
+  HotDenseMap<Type*, PointerType*>::type PointerTypes;
   DenseMap<std::pair<Type*, unsigned>, PointerType*> ASPointerTypes;
 
 
   /// ValueHandles - This map keeps track of all of the value handles that are
   /// watching a Value*.  The Value::HasValueHandle bit is used to know
   // whether or not a value has an entry in this map.
-  typedef DenseMap<Value*, ValueHandleBase*> ValueHandlesTy;
+  typedef HotDenseMap<Value*, ValueHandleBase*>::type ValueHandlesTy;
   ValueHandlesTy ValueHandles;
   
   /// CustomMDKindNames - Map to hold the metadata string to ID mapping.
@@ -336,7 +368,7 @@ public:
 
   /// MetadataStore - Collection of per-instruction metadata used in this
   /// context.
-  DenseMap<const Instruction *, MDMapTy> MetadataStore;
+  HotDenseMap<const Instruction *, MDMapTy>::type MetadataStore;
   
   /// ScopeRecordIdx - This is the index in ScopeRecords for an MDNode scope
   /// entry with no "inlined at" element.
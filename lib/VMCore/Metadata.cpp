@@ -40,7 +40,10 @@ MDString *MDString::get(LLVMContext &Context, StringRef Str) {
   StringMapEntry<Value*> &Entry =
     pImpl->MDStringCache.GetOrCreateValue(Str);
   Value *&S = Entry.getValue();
-  if (!S) S = new MDString(Context);
+  if (!S) {
+    S = new MDString(Context);
+    pImpl->MDStringBytes += sizeof(MDString) + sizeof(Entry) + Str.size() + 1;
+  }
   S->setValueName(&Entry);
   return cast<MDString>(S);
 }
@@ -200,9 +203,11 @@ const Function *MDNode::getFunction() const {
 // destroy - Delete this node.  Only when there are no uses.
 void MDNode::destroy() {
   setValueSubclassData(getSubclassDataFromValue() | DestroyFlag);
-  // Placement delete, then free the memory.
+  LLVMContextImpl *pImpl = getType()->getContext().pImpl;
+  unsigned NumOps = NumOperands;
+  // Placement delete, then return the memory to the context.
   this->~MDNode();
-  free(this);
+  pImpl->deallocateMDNode(this, NumOps);
 }
 
 /// isFunctionLocalValue - Return true if this is a value that would require a
@@ -251,7 +256,7 @@ MDNode *MDNode::getMDNode(LLVMContext &Context, ArrayRef<Value*> Vals,
   }
 
   // Coallocate space for the node and Operands together, then placement new.
-  void *Ptr = malloc(sizeof(MDNode) + Vals.size() * sizeof(MDNodeOperand));
+  void *Ptr = pImpl->allocateMDNode(Vals.size());
   N = new (Ptr) MDNode(Context, Vals, isFunctionLocal);
 
   // Cache the operand hash.
@@ -278,9 +283,8 @@ MDNode *MDNode::getIfExists(LLVMContext &Context, ArrayRef<Value*> Vals) {
 }
 
 MDNode *MDNode::getTemporary(LLVMContext &Context, ArrayRef<Value*> Vals) {
-  MDNode *N =
-    (MDNode *)malloc(sizeof(MDNode) + Vals.size() * sizeof(MDNodeOperand));
-  N = new (N) MDNode(Context, Vals, FL_No);
+  void *Ptr = Context.pImpl->allocateMDNode(Vals.size());
+  MDNode *N = new (Ptr) MDNode(Context, Vals, FL_No);
   N->setValueSubclassData(N->getSubclassDataFromValue() |
                           NotUniquedBit);
   LeakDetector::addGarbageObject(N);
@@ -115,3 +115,23 @@ return:
 }
 
 !2 = metadata !{metadata !"branch_weights", i32 7, i32 6, i32 4, i32 4, i32 64}
+
+define i32 @test5(i32 %x) {
+; CHECK: Printing analysis {{.*}} for function 'test5'
+entry:
+  %cond = icmp eq i32 %x, 0
+  br i1 %cond, label %never, label %exit, !prof !3
+; A zero weight from the profile is as unlikely as an edge into unreachable
+; code.
+; CHECK: edge entry -> never probability is 1 / 1048501
+; CHECK: edge entry -> exit probability is 1048500 / 1048501
+
+never:
+  br label %exit
+
+exit:
+  %result = phi i32 [ 1, %never ], [ 0, %entry ]
+  ret i32 %result
+}
+
+!3 = metadata !{metadata !"branch_weights", i32 0, i32 100}
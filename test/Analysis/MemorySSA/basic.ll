@@ -0,0 +1,89 @@
+; RUN: opt < %s -basicaa -memoryssa -verify-memoryssa -analyze | FileCheck %s
+
+target datalayout = "e-p:64:64:64-i1:8:8-i8:8:8-i16:16:16-i32:32:32-i64:64:64-f32:32:32-f64:64:64-v64:64:64-v128:128:128-a0:0:64-s0:64:64-f80:128:128-n8:16:32:64-S128"
+
+@A = global i32 0
+@B = global i32 0
+
+declare void @f()
+declare i32 @g(i32*) readonly
+
+;; Straight-line code: each write is a new version, reads use the nearest one.
+
+; CHECK: @straight
+; CHECK: ; MemoryUse(liveOnEntry)
+; CHECK-NEXT: %a = load i32* @A
+; CHECK: ; 1 = MemoryDef(liveOnEntry)
+; CHECK-NEXT: store i32 %a, i32* @B
+; CHECK: ; 2 = MemoryDef(1)
+; CHECK-NEXT: call void @f()
+; CHECK: ; MemoryUse(2)
+; CHECK-NEXT: %b = call i32 @g(i32* @B)
+; CHECK: ; MemoryUse(2)
+; CHECK-NEXT: %c = load i32* @B
+
+define i32 @straight() {
+entry:
+  %a = load i32* @A
+  store i32 %a, i32* @B
+  call void @f()
+  %b = call i32 @g(i32* @B)
+  %c = load i32* @B
+  %r = add i32 %b, %c
+  ret i32 %r
+}
+
+;; A phi merges the versions of the two arms of a diamond.
+
+; CHECK: @diamond
+; CHECK: then:
+; CHECK-NEXT: ; 1 = MemoryDef(liveOnEntry)
+; CHECK-NEXT: store i32 1, i32* @A
+; CHECK: join:
+; CHECK-NEXT: ; 2 = MemoryPhi({entry,liveOnEntry},{then,1})
+; CHECK: ; MemoryUse(2)
+; CHECK-NEXT: %a = load i32* @A
+
+define i32 @diamond(i1 %c) {
+entry:
+  br i1 %c, label %then, label %join
+
+then:
+  store i32 1, i32* @A
+  br label %join
+
+join:
+  %a = load i32* @A
+  ret i32 %a
+}
+
+;; The loop header merges the entry version and the version of the latch.
+
+; CHECK: @loop
+; CHECK: loop:
+; CHECK-NEXT: ; 1 = MemoryPhi({entry,liveOnEntry},{loop,2})
+; CHECK: ; MemoryUse(1)
+; CHECK-NEXT: %b = load i32* @B
+; CHECK: ; 2 = MemoryDef(1)
+; CHECK-NEXT: store i32 %b, i32* @A
+; CHECK: exit:
+; CHECK-NOT: Memory
+; CHECK: ; MemoryUse(2)
+; CHECK-NEXT: %a = load i32* @A
+
+define i32 @loop(i32 %n) {
+entry:
+  br label %loop
+
+loop:
+  %i = phi i32 [ 0, %entry ], [ %i.next, %loop ]
+  %b = load i32* @B
+  store i32 %b, i32* @A
+  %i.next = add i32 %i, 1
+  %cond = icmp slt i32 %i.next, %n
+  br i1 %cond, label %loop, label %exit
+
+exit:
+  %a = load i32* @A
+  ret i32 %a
+}
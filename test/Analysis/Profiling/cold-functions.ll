@@ -0,0 +1,25 @@
+; RUN: opt < %s -profile-metadata-loader \
+; RUN:     -profile-file %S/Inputs/cold-functions.prof -S | FileCheck %s
+
+; Functions the profile never entered are marked cold.
+
+define i32 @used(i1 %c) {
+entry:
+  br i1 %c, label %a, label %b
+; CHECK: define i32 @used(i1 %c) {
+; CHECK: br i1 %c, label %a, label %b, !prof !0
+
+a:
+  ret i32 1
+
+b:
+  ret i32 0
+}
+
+define i32 @unused() {
+entry:
+  ret i32 0
+}
+; CHECK: define i32 @unused() cold {
+
+; CHECK: !0 = metadata !{metadata !"branch_weights", i32 3, i32 0}
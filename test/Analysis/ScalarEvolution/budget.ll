@@ -0,0 +1,47 @@
+; RUN: opt < %s -analyze -scalar-evolution -scalar-evolution-max-values=2 \
+; RUN:   | FileCheck %s -check-prefix=VALUES
+; RUN: opt < %s -analyze -scalar-evolution -scalar-evolution-max-depth=1 \
+; RUN:   | FileCheck %s -check-prefix=DEPTH
+
+; Once the per-function budget is spent, the remaining instructions are left
+; unknown instead of being folded into the chain.
+
+; VALUES: @chain
+; VALUES: %a = add i32 %x, 1
+; VALUES-NEXT: -->  (1 + %x)
+; VALUES: %b = add i32 %a, 2
+; VALUES-NEXT: -->  (3 + %x)
+; VALUES: %c = add i32 %b, 3
+; VALUES-NEXT: -->  %c
+
+define i32 @chain(i32 %x) nounwind {
+entry:
+  %a = add i32 %x, 1
+  %b = add i32 %a, 2
+  %c = add i32 %b, 3
+  ret i32 %c
+}
+
+; The latch value of the phi is analyzed below the phi itself, which the
+; depth limit stops.
+
+; DEPTH: @deep
+; DEPTH: %i = phi i32
+; DEPTH-NEXT: -->  %i
+; VALUES: @deep
+; VALUES: %i = phi i32
+; VALUES-NEXT: -->  {0,+,%n}<%loop>
+
+define void @deep(i32 %n) nounwind {
+entry:
+  br label %loop
+
+loop:
+  %i = phi i32 [ 0, %entry ], [ %i.next, %loop ]
+  %i.next = add i32 %i, %n
+  %cond = icmp ult i32 %i.next, 1000
+  br i1 %cond, label %loop, label %exit
+
+exit:
+  ret void
+}
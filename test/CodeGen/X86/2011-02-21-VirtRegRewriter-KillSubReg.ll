@@ -1,4 +1,5 @@
 ; RUN: llc < %s -O2 -march=x86 -mtriple=i386-pc-linux-gnu -relocation-model=pic | FileCheck %s
+; RUN: llc < %s -O2 -mtriple=x86_64-pc-linux-gnu -mcpu=corei7-avx | FileCheck %s -check-prefix=AVX
 ; PR9237: Assertion in VirtRegRewriter.cpp, ResurrectConfirmedKill
 ;         `KillOps[*SR] == KillOp && "invalid subreg kill flags"'
 
@@ -26,6 +27,7 @@ cond.true771:
   br label %cond.end791
 
 ; CHECK: calll __memmove_chk
+; AVX: callq __memmove_chk
 cond.false783:
   %call.i1035 = call i8* @__memmove_chk(i8* %add.ptr768, i8* undef, i32 %call747, i32 undef) nounwind
   br label %cond.end791
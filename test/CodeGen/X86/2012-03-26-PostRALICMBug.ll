@@ -1,5 +1,6 @@
 ; RUN: llc < %s -mtriple=x86_64-apple-darwin10 -stats 2>&1 | \
 ; RUN:   not grep "Number of machine instructions hoisted out of loops post regalloc"
+; RUN: llc < %s -O2 -mtriple=x86_64-apple-darwin10 -mcpu=corei7-avx > /dev/null
 
 ; rdar://11095580
 
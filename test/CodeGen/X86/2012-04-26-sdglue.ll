@@ -5,8 +5,8 @@
 ; It's hard to test for the ISEL condition because CodeGen optimizes
 ; away the bugpointed code. Just ensure the basics are still there.
 ;CHECK: func:
-;CHECK: vxorps
-;CHECK: vinsertf128
+;CHECK: {{vxorps|vpxor}}
+;CHECK: vinsert{{[fi]}}128
 ;CHECK: vpshufd
 ;CHECK: vpshufd
 ;CHECK: vmulps
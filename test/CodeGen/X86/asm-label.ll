@@ -4,8 +4,8 @@
 ; we would print the jump, but not the label because it was considered
 ; a fall through.
 
-; CHECK:        jmp     LBB0_9
-; CHECK: LBB0_9:                                 ## %cleanup
+; CHECK:        jmp     LBB0_5
+; CHECK: LBB0_5:                                 ## %cleanup
 
 define void @foo()  {
 entry:
@@ -63,12 +63,12 @@ define <16 x i16> @vshift07(<16 x i16> %a) nounwind readnone {
 }
 
 ; CHECK: vpsrlw
-; CHECK: pand
-; CHECK: pxor
-; CHECK: psubb
 ; CHECK: vpsrlw
 ; CHECK: pand
+; CHECK: pand
 ; CHECK: pxor
+; CHECK: pxor
+; CHECK: psubb
 ; CHECK: psubb
 define <32 x i8> @vshift09(<32 x i8> %a) nounwind readnone {
   %s = ashr <32 x i8> %a, <i8 2, i8 2, i8 2, i8 2, i8 2, i8 2, i8 2, i8 2, i8 2, i8 2, i8 2, i8 2, i8 2, i8 2, i8 2, i8 2, i8 2, i8 2, i8 2, i8 2, i8 2, i8 2, i8 2, i8 2, i8 2, i8 2, i8 2, i8 2, i8 2, i8 2, i8 2, i8 2>
@@ -84,18 +84,18 @@ define <32 x i8> @vshift10(<32 x i8> %a) nounwind readnone {
 }
 
 ; CHECK: vpsrlw
-; CHECK: pand
 ; CHECK: vpsrlw
 ; CHECK: pand
+; CHECK: pand
 define <32 x i8> @vshift11(<32 x i8> %a) nounwind readnone {
   %s = lshr <32 x i8> %a, <i8 2, i8 2, i8 2, i8 2, i8 2, i8 2, i8 2, i8 2, i8 2, i8 2, i8 2, i8 2, i8 2, i8 2, i8 2, i8 2, i8 2, i8 2, i8 2, i8 2, i8 2, i8 2, i8 2, i8 2, i8 2, i8 2, i8 2, i8 2, i8 2, i8 2, i8 2, i8 2>
   ret <32 x i8> %s
 }
 
 ; CHECK: vpsllw
-; CHECK: pand
 ; CHECK: vpsllw
 ; CHECK: pand
+; CHECK: pand
 define <32 x i8> @vshift12(<32 x i8> %a) nounwind readnone {
   %s = shl <32 x i8> %a, <i8 2, i8 2, i8 2, i8 2, i8 2, i8 2, i8 2, i8 2, i8 2, i8 2, i8 2, i8 2, i8 2, i8 2, i8 2, i8 2, i8 2, i8 2, i8 2, i8 2, i8 2, i8 2, i8 2, i8 2, i8 2, i8 2, i8 2, i8 2, i8 2, i8 2, i8 2, i8 2>
   ret <32 x i8> %s
@@ -105,7 +105,6 @@ define <32 x i8> @vshift12(<32 x i8> %a) nounwind readnone {
 ; CHECK: _vshift08
 ; CHECK: vextractf128 $1
 ; CHECK: vpslld $23
-; CHECK: vextractf128 $1
 ; CHECK: vpslld $23
 define <8 x i32> @vshift08(<8 x i32> %a) nounwind {
   %bitop = shl <8 x i32> <i32 1, i32 1, i32 1, i32 1, i32 1, i32 1, i32 1, i32 1>, %a
@@ -115,9 +114,9 @@ define <8 x i32> @vshift08(<8 x i32> %a) nounwind {
 ;;; Uses shifts for sign extension
 ; CHECK: _sext_v16i16
 ; CHECK: vpsllw
-; CHECK: vpsraw
 ; CHECK: vpsllw
 ; CHECK: vpsraw
+; CHECK: vpsraw
 ; CHECK: vinsertf128
 define <16 x i16> @sext_v16i16(<16 x i16> %a) nounwind {
   %b = trunc <16 x i16> %a to <16 x i8>
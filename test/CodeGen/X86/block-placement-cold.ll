@@ -0,0 +1,83 @@
+; RUN: llc < %s -mtriple=x86_64-pc-linux -enable-cold-block-placement | FileCheck %s
+; RUN: llc < %s -mtriple=x86_64-pc-linux | FileCheck %s -check-prefix=DEFAULT
+
+declare void @work(i32)
+declare void @rare(i32)
+declare i32 @__gxx_personality_v0(...)
+
+define void @never_taken_in_loop(i32 %n) {
+; A block the profile never saw run is moved out of the loop, after the
+; return, instead of being rotated to the top of the loop.
+; CHECK: never_taken_in_loop:
+; CHECK: %body
+; CHECK: %latch
+; CHECK: %exit
+; CHECK: ret
+; CHECK: %never
+; CHECK: jmp
+; DEFAULT: never_taken_in_loop:
+; DEFAULT: %never
+; DEFAULT: %body
+; DEFAULT: %latch
+
+entry:
+  br label %body
+
+body:
+  %i = phi i32 [ 0, %entry ], [ %next, %latch ]
+  %c = icmp eq i32 %i, 12345
+  br i1 %c, label %never, label %latch, !prof !0
+
+never:
+  call void @rare(i32 %i)
+  br label %latch
+
+latch:
+  call void @work(i32 %i)
+  %next = add i32 %i, 1
+  %done = icmp eq i32 %next, %n
+  br i1 %done, label %exit, label %body
+
+exit:
+  call void @work(i32 -1)
+  ret void
+}
+
+define void @landing_pad_in_loop(i32 %n) {
+; Landing pads are cold, even when they branch back into the loop.
+; CHECK: landing_pad_in_loop:
+; CHECK: %loop
+; CHECK: %cont
+; CHECK: %exit
+; CHECK: ret
+; CHECK: %lpad
+; CHECK: jmp
+; DEFAULT: landing_pad_in_loop:
+; DEFAULT: %lpad
+; DEFAULT: %cont
+
+entry:
+  br label %loop
+
+loop:
+  %i = phi i32 [ 0, %entry ], [ %next, %cont ]
+  invoke void @work(i32 %i)
+          to label %cont unwind label %lpad
+
+lpad:
+  %e = landingpad { i8*, i32 } personality i32 (...)* @__gxx_personality_v0
+          catch i8* null
+  call void @rare(i32 %i)
+  br label %cont
+
+cont:
+  %next = add i32 %i, 1
+  %done = icmp eq i32 %next, %n
+  br i1 %done, label %exit, label %loop
+
+exit:
+  call void @work(i32 -1)
+  ret void
+}
+
+!0 = metadata !{metadata !"branch_weights", i32 0, i32 1000}
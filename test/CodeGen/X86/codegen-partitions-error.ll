@@ -0,0 +1,23 @@
+; RUN: not llc < %s -mtriple=x86_64-linux -codegen-partitions=3 -o %t 2>&1 | FileCheck %s
+
+; Every partition hits a fatal error.  The workers must not exit the process
+; under each other's feet; the first error is reported once they are done.
+; CHECK: llc: Cannot select: intrinsic %llvm.x86.xop.vpermil2pd
+; CHECK-NOT: Cannot select
+
+define <2 x double> @a(<2 x double> %x, <2 x double> %y, <2 x double> %z) {
+  %r = call <2 x double> @llvm.x86.xop.vpermil2pd(<2 x double> %x, <2 x double> %y, <2 x double> %z, i8 1)
+  ret <2 x double> %r
+}
+
+define <2 x double> @b(<2 x double> %x, <2 x double> %y, <2 x double> %z) {
+  %r = call <2 x double> @llvm.x86.xop.vpermil2pd(<2 x double> %x, <2 x double> %y, <2 x double> %z, i8 2)
+  ret <2 x double> %r
+}
+
+define <2 x double> @c(<2 x double> %x, <2 x double> %y, <2 x double> %z) {
+  %r = call <2 x double> @llvm.x86.xop.vpermil2pd(<2 x double> %x, <2 x double> %y, <2 x double> %z, i8 3)
+  ret <2 x double> %r
+}
+
+declare <2 x double> @llvm.x86.xop.vpermil2pd(<2 x double>, <2 x double>, <2 x double>, i8) nounwind readnone
@@ -0,0 +1,124 @@
+; RUN: opt < %s -internalize -internalize-public-api-list=main | \
+; RUN:   llc -mtriple=x86_64-linux -codegen-partitions=3 -o %t
+; RUN: FileCheck %s -check-prefix=P0 < %t
+; RUN: FileCheck %s -check-prefix=P1 < %t.1
+; RUN: FileCheck %s -check-prefix=P2 < %t.2
+
+; After internalization every function but main is local.  The local
+; functions and variables that are used by another partition become hidden
+; external symbols, so the call chain is spread over all partitions.  The
+; string is copied into the partitions that use it.
+
+; P0: .hidden f0.llvm.split
+; P0: f0.llvm.split:
+; P0: callq puts
+; P0: callq f1.llvm.split
+; P0: f3.llvm.split:
+; P0: callq f4.llvm.split
+; P0: .Lmsg:
+
+; P1: f4.llvm.split:
+; P1: callq f5
+; P1: f5:
+; P1: callq puts
+; P1: .Lmsg:
+; P1: state.llvm.split:
+
+; P2: f1.llvm.split:
+; P2: callq f2
+; P2: f2:
+; P2: callq f3.llvm.split
+; P2: main:
+; P2: callq f0.llvm.split
+; P2-NOT: .Lmsg
+
+@msg = private unnamed_addr constant [4 x i8] c"abc\00"
+@state = global i32 0
+
+declare i32 @puts(i8*)
+
+define i32 @f0(i32 %x) nounwind {
+entry:
+  %a = mul i32 %x, 3
+  %b = add i32 %a, 7
+  %c = xor i32 %b, %x
+  %s = load i32* @state
+  %d = add i32 %c, %s
+  store i32 %d, i32* @state
+  %p = call i32 @puts(i8* getelementptr inbounds ([4 x i8]* @msg, i64 0, i64 0))
+  %e = add i32 %d, %p
+  %r = call i32 @f1(i32 %e)
+  ret i32 %r
+}
+
+define i32 @f1(i32 %x) nounwind {
+entry:
+  %a = mul i32 %x, 3
+  %b = add i32 %a, 7
+  %c = xor i32 %b, %x
+  %s = load i32* @state
+  %d = add i32 %c, %s
+  store i32 %d, i32* @state
+  %e = add i32 %d, 1
+  %r = call i32 @f2(i32 %e)
+  ret i32 %r
+}
+
+define i32 @f2(i32 %x) nounwind {
+entry:
+  %a = mul i32 %x, 3
+  %b = add i32 %a, 7
+  %c = xor i32 %b, %x
+  %s = load i32* @state
+  %d = add i32 %c, %s
+  store i32 %d, i32* @state
+  %e = add i32 %d, 1
+  %r = call i32 @f3(i32 %e)
+  ret i32 %r
+}
+
+define i32 @f3(i32 %x) nounwind {
+entry:
+  %a = mul i32 %x, 3
+  %b = add i32 %a, 7
+  %c = xor i32 %b, %x
+  %s = load i32* @state
+  %d = add i32 %c, %s
+  store i32 %d, i32* @state
+  %e = add i32 %d, 1
+  %r = call i32 @f4(i32 %e)
+  ret i32 %r
+}
+
+define i32 @f4(i32 %x) nounwind {
+entry:
+  %a = mul i32 %x, 3
+  %b = add i32 %a, 7
+  %c = xor i32 %b, %x
+  %s = load i32* @state
+  %d = add i32 %c, %s
+  store i32 %d, i32* @state
+  %e = add i32 %d, 1
+  %r = call i32 @f5(i32 %e)
+  ret i32 %r
+}
+
+define i32 @f5(i32 %x) nounwind {
+entry:
+  %a = mul i32 %x, 3
+  %b = add i32 %a, 7
+  %c = xor i32 %b, %x
+  %s = load i32* @state
+  %d = add i32 %c, %s
+  store i32 %d, i32* @state
+  %p = call i32 @puts(i8* getelementptr inbounds ([4 x i8]* @msg, i64 0, i64 0))
+  %e = add i32 %d, %p
+  %r = add i32 %e, 2
+  ret i32 %r
+}
+
+define i32 @main() nounwind {
+entry:
+  %r = call i32 @f0(i32 1)
+  ret i32 %r
+}
@@ -0,0 +1,69 @@
+; RUN: llc < %s -mtriple=x86_64-linux -codegen-partitions=2 -o %t
+; RUN: FileCheck %s -check-prefix=P0 < %t
+; RUN: FileCheck %s -check-prefix=P1 < %t.1
+; RUN: not llc < %s -mtriple=x86_64-linux -codegen-partitions=2 2>&1 | FileCheck %s -check-prefix=STDOUT
+
+; The local symbols used by the other partition become hidden external
+; symbols.  The alias stays with its aliasee and the constructor entry with the
+; constructor.  The biggest group goes first.
+; P0: big:
+; P0: callq helper.llvm.split
+; P0: .hidden counter.llvm.split
+; P0: .globl counter.llvm.split
+; P0: counter.llvm.split:
+; P0-NOT: other:
+; P0-NOT: .ctors
+; P0: big_alias = big
+
+; P1: .hidden helper.llvm.split
+; P1: .globl helper.llvm.split
+; P1: helper.llvm.split:
+; P1: counter.llvm.split(%rip)
+; P1: init:
+; P1: other:
+; P1: callq big_alias
+; P1-NOT: big:
+; P1: .section .ctors
+; P1-NEXT: .align 8
+; P1-NEXT: .quad init
+; P1-NOT: big_alias =
+
+; STDOUT: -codegen-partitions needs an output file
+
+@counter = internal global i32 0
+@table = global [4 x i32] [i32 1, i32 2, i32 3, i32 4]
+@llvm.global_ctors = appending global [1 x { i32, void ()* }] [{ i32, void ()* } { i32 65535, void ()* @init }]
+@big_alias = alias i32 (i32)* @big
+
+define internal i32 @helper(i32 %x) nounwind {
+entry:
+  %c = load i32* @counter
+  %inc = add i32 %c, %x
+  store i32 %inc, i32* @counter
+  ret i32 %inc
+}
+
+define i32 @big(i32 %x) nounwind {
+entry:
+  %a = call i32 @helper(i32 %x)
+  %b = mul i32 %a, %x
+  %c = xor i32 %b, 12345
+  %d = add i32 %c, %a
+  %e = shl i32 %d, 3
+  %f = sub i32 %e, %b
+  %g = call i32 @helper(i32 %f)
+  ret i32 %g
+}
+
+define void @init() nounwind {
+entry:
+  store i32 5, i32* getelementptr inbounds ([4 x i32]* @table, i64 0, i64 0)
+  ret void
+}
+
+define i32 @other(i32 %x) nounwind {
+entry:
+  %a = call i32 @big_alias(i32 %x)
+  %b = add i32 %a, 1
+  ret i32 %b
+}
@@ -0,0 +1,46 @@
+; RUN: llvm-as < %s | llc -mtriple=x86_64-pc-linux | FileCheck %s
+; RUN: llc < %s -mtriple=x86_64-pc-linux -ffunction-sections | \
+; RUN:   FileCheck %s -check-prefix=FSECT
+
+; Functions marked cold go to .text.unlikely, and to a uniqued
+; .text.unlikely.<name> section when they are COMDAT or with
+; -ffunction-sections.
+
+declare void @g()
+
+define void @hot() {
+  call void @g()
+  ret void
+}
+; CHECK:      .text
+; CHECK-NOT:  .section
+; CHECK:      hot:
+; FSECT:      .section .text.hot,"ax",@progbits
+; FSECT:      hot:
+
+define void @never_run() cold {
+  call void @g()
+  ret void
+}
+; CHECK:      .section .text.unlikely,"ax",@progbits
+; CHECK-NOT:  .section
+; CHECK:      never_run:
+; FSECT:      .section .text.unlikely.never_run,"ax",@progbits
+; FSECT:      never_run:
+
+define linkonce_odr void @never_run_odr() cold {
+  call void @g()
+  ret void
+}
+; CHECK:      .section .text.unlikely.never_run_odr,"axG",@progbits,never_run_odr,comdat
+; CHECK:      never_run_odr:
+; FSECT:      .section .text.unlikely.never_run_odr,"axG",@progbits,never_run_odr,comdat
+; FSECT:      never_run_odr:
+
+define void @hot2() {
+  call void @g()
+  ret void
+}
+; CHECK:      .text
+; CHECK-NOT:  .section
+; CHECK:      hot2:
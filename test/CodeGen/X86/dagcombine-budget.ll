@@ -0,0 +1,25 @@
+; RUN: llc < %s -mtriple=x86_64-linux | FileCheck %s
+; RUN: llc < %s -mtriple=x86_64-linux -combiner-max-visits=1 | FileCheck %s -check-prefix=BUDGET
+; RUN: llc < %s -mtriple=x86_64-linux -combiner-rule-stats -o /dev/null 2>&1 | FileCheck %s -check-prefix=RULES
+
+; Without a budget the constants are reassociated into a single add.  Once the
+; budget is spent the remaining adds are left alone.
+; CHECK: reassoc:
+; CHECK: leal 6(%rdi), %eax
+; CHECK-NEXT: ret
+; BUDGET: reassoc:
+; BUDGET: leal 1(%rdi), %eax
+; BUDGET-NEXT: addl $2, %eax
+; BUDGET-NEXT: addl $3, %eax
+; BUDGET-NEXT: ret
+
+; RULES: DAG Combine Rule Statistics
+; RULES: Time (s) Visits Hits Rule
+; RULES: {{[0-9]+\.[0-9]+}} {{ *}}5 {{ *}}2 add
+define i32 @reassoc(i32 %x) nounwind readnone {
+entry:
+  %a = add i32 %x, 1
+  %b = add i32 %a, 2
+  %c = add i32 %b, 3
+  ret i32 %c
+}
@@ -0,0 +1,131 @@
+; RUN: llc < %s -O0 -fast-isel -fast-isel-abort -verify-machineinstrs \
+; RUN:   -asm-verbose=0 | FileCheck %s
+; RUN: llc < %s -O0 -fast-isel -fast-isel-report-fallbacks -o /dev/null \
+; RUN:   2>&1 | FileCheck %s -check-prefix=REPORT
+
+target triple = "x86_64-unknown-linux-gnu"
+
+declare i32 @callee(i32)
+declare i32 @__gxx_personality_v0(...)
+declare void @cleanup(i8*, i32)
+declare i32 @llvm.mono.load.i32.p0i32(i32*, i32, i1)
+declare void @llvm.mono.store.i32.p0i32(i32, i32*, i32, i1)
+
+; The call is bracketed by the try range labels, and the landing pad reads
+; the exception pointer and selector from RAX and EDX.
+
+; CHECK: invoke_call:
+; CHECK: .cfi_def_cfa_offset
+; CHECK-NEXT: [[BEGIN:.Ltmp[0-9]+]]:
+; CHECK-NEXT: callq callee
+; CHECK-NEXT: [[END:.Ltmp[0-9]+]]:
+; CHECK: jmp
+; CHECK: [[LPAD:.Ltmp[0-9]+]]:
+; CHECK-NEXT: movq %rax, %rdi
+; CHECK-NEXT: movl %edx, %esi
+; CHECK: callq cleanup
+; CHECK: GCC_except_table0:
+; CHECK: = [[BEGIN]]-.Leh_func_begin0
+; CHECK: = [[END]]-[[BEGIN]]
+; CHECK: = [[LPAD]]-.Leh_func_begin0
+
+define i32 @invoke_call(i32 %x) {
+entry:
+  %r = invoke i32 @callee(i32 %x)
+          to label %cont unwind label %lpad
+
+cont:
+  ret i32 %r
+
+lpad:
+  %lp = landingpad { i8*, i32 } personality i32 (...)* @__gxx_personality_v0
+          cleanup
+  %ptr = extractvalue { i8*, i32 } %lp, 0
+  %sel = extractvalue { i8*, i32 } %lp, 1
+  call void @cleanup(i8* %ptr, i32 %sel)
+  resume { i8*, i32 } %lp
+}
+
+; The Mono intrinsics are plain memory accesses inside a try range.
+
+; CHECK: invoke_mono:
+; CHECK: .Ltmp{{[0-9]+}}:
+; CHECK-NEXT: movl %esi, (%rdi)
+; CHECK-NEXT: .Ltmp{{[0-9]+}}:
+; CHECK: .Ltmp{{[0-9]+}}:
+; CHECK: movl (%rax), %eax
+; CHECK-NEXT: .Ltmp{{[0-9]+}}:
+
+define i32 @invoke_mono(i32* %p, i32 %v) {
+entry:
+  invoke void @llvm.mono.store.i32.p0i32(i32 %v, i32* %p, i32 4, i1 false)
+          to label %cont unwind label %lpad
+
+cont:
+  %r = invoke i32 @llvm.mono.load.i32.p0i32(i32* %p, i32 4, i1 false)
+          to label %done unwind label %lpad
+
+done:
+  ret i32 %r
+
+lpad:
+  %lp = landingpad { i8*, i32 } personality i32 (...)* @__gxx_personality_v0
+          cleanup
+  ret i32 0
+}
+
+; Small switches become a chain of compares.
+
+; CHECK: small_switch:
+; CHECK: cmpl $1, %edi
+; CHECK: je .LBB2_[[ONE:[0-9]+]]
+; CHECK: cmpl $5, %eax
+; CHECK: je .LBB2_
+; CHECK: cmpl $7, %eax
+; CHECK-NEXT: je .LBB2_[[ONE]]
+; CHECK-NEXT: jmp .LBB2_
+
+define i32 @small_switch(i32 %x) {
+entry:
+  switch i32 %x, label %def [
+    i32 1, label %one
+    i32 5, label %five
+    i32 7, label %one
+  ]
+
+one:
+  br label %exit
+
+five:
+  br label %exit
+
+def:
+  br label %exit
+
+exit:
+  %r = phi i32 [ 10, %one ], [ 50, %five ], [ 0, %def ]
+  ret i32 %r
+}
+
+; Larger switches are left to SelectionDAG, which is reported per opcode.
+
+; REPORT-NOT: invoke
+; REPORT: FastISel fallbacks in 'big_switch':
+; REPORT-NEXT: switch: 1 missed, 1 instructions
+
+define i32 @big_switch(i32 %x) {
+entry:
+  switch i32 %x, label %def [
+    i32 1, label %a
+    i32 2, label %a
+    i32 3, label %a
+    i32 4, label %a
+    i32 5, label %a
+  ]
+
+a:
+  ret i32 1
+
+def:
+  ret i32 0
+}
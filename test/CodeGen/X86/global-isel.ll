@@ -0,0 +1,50 @@
+; RUN: llc < %s -O2 -mtriple=x86_64-linux -mcpu=corei7 -global-isel -disable-cgp -verify-machineinstrs | FileCheck %s
+; RUN: llc < %s -O2 -mtriple=x86_64-linux -mcpu=corei7 -global-isel -stats 2>&1 | FileCheck %s -check-prefix=STATS
+; REQUIRES: asserts
+
+; The address computed in the entry block is folded into the loads of the
+; other blocks, without CodeGenPrepare sinking it first.
+; CHECK: cross_block:
+; CHECK: jne
+; CHECK: movl 4(%rdi,%rsi,4), %eax
+; CHECK-NEXT: ret
+; CHECK: movl (%rdi,%rsi,4), %eax
+; CHECK-NEXT: ret
+define i32 @cross_block(i32* %p, i64 %i, i1 %c) nounwind {
+entry:
+  %addr = getelementptr inbounds i32* %p, i64 %i
+  br i1 %c, label %then, label %else
+
+then:
+  %v = load i32* %addr, align 4
+  ret i32 %v
+
+else:
+  %addr1 = getelementptr inbounds i32* %addr, i64 1
+  %w = load i32* %addr1, align 4
+  ret i32 %w
+}
+
+; Scalar floating point is handled.
+; CHECK: scalar_fp:
+; CHECK: mulsd
+; CHECK: addsd
+define double @scalar_fp(double %a, double %b, i32 %n) nounwind {
+entry:
+  %conv = sitofp i32 %n to double
+  %mul = fmul double %a, %conv
+  %add = fadd double %mul, %b
+  ret double %add
+}
+
+; Vector code is left to SelectionDAG for the whole function.
+; CHECK: vector:
+; CHECK: paddd
+define <4 x i32> @vector(<4 x i32> %a, <4 x i32> %b) nounwind {
+entry:
+  %add = add <4 x i32> %a, %b
+  ret <4 x i32> %add
+}
+
+; STATS: 1 isel{{.*}}Number of functions global isel left to the DAG
+; STATS: 2 isel{{.*}}Number of functions selected whole by fast isel
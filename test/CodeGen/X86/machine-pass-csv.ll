@@ -0,0 +1,34 @@
+; RUN: llc < %s -mtriple=x86_64-linux -machine-pass-csv=%t -o /dev/null
+; RUN: FileCheck %s < %t
+
+; Every machine function pass reports the function, the elapsed time and the
+; instruction, virtual register and block counts after it ran.  The virtual
+; registers are gone after rewriting.
+
+; CHECK: function,pass,seconds,instructions,vregs,blocks
+; CHECK: {{^}}diamond,X86 DAG->DAG Instruction Selection,{{[0-9]+\.[0-9]+}},{{[1-9][0-9]*}},{{[1-9][0-9]*}},4{{$}}
+; CHECK: {{^}}diamond,Virtual Register Rewriter,{{[0-9]+\.[0-9]+}},{{[1-9][0-9]*}},0,4{{$}}
+; CHECK: {{^}}"quoted,name",X86 DAG->DAG Instruction Selection,{{[0-9]+\.[0-9]+}},3,1,1{{$}}
+
+define i32 @diamond(i32 %a, i32 %b) nounwind {
+entry:
+  %cmp = icmp slt i32 %a, %b
+  br i1 %cmp, label %then, label %else
+
+then:
+  %x = mul i32 %a, %b
+  br label %exit
+
+else:
+  %y = sub i32 %a, %b
+  br label %exit
+
+exit:
+  %r = phi i32 [ %x, %then ], [ %y, %else ]
+  ret i32 %r
+}
+
+define i32 @"quoted,name"(i32 %a) nounwind {
+entry:
+  ret i32 %a
+}
@@ -0,0 +1,48 @@
+; RUN: llc < %s -mtriple=x86_64-linux -mcpu=corei7-avx -enable-misched \
+; RUN:   -misched-topdown | FileCheck %s -check-prefix=SNB
+; RUN: llc < %s -mtriple=x86_64-linux -mcpu=corei7 -enable-misched \
+; RUN:   -misched-topdown | FileCheck %s -check-prefix=GENERIC
+
+; With the Sandy Bridge machine model, the 5-cycle multiplies make the fmul
+; chain critical, so it is started before the chain of 3-cycle adds.
+; SNB: kernel:
+; SNB: vmulsd
+; SNB-NEXT: vaddsd
+; SNB-NEXT: vaddsd
+; SNB-NEXT: vmulsd
+; SNB-NEXT: vaddsd
+; SNB-NEXT: vaddsd
+
+; Without per-operand latencies the adds go first.
+; GENERIC: kernel:
+; GENERIC: addsd
+; GENERIC-NEXT: mulsd
+; GENERIC-NEXT: addsd
+; GENERIC-NEXT: mulsd
+
+define void @kernel(double* nocapture %a, double* nocapture %b, double* nocapture %c, i64 %n) nounwind {
+entry:
+  %cmp = icmp sgt i64 %n, 0
+  br i1 %cmp, label %loop, label %exit
+
+loop:
+  %i = phi i64 [ 0, %entry ], [ %i.next, %loop ]
+  %pa = getelementptr inbounds double* %a, i64 %i
+  %pb = getelementptr inbounds double* %b, i64 %i
+  %pc = getelementptr inbounds double* %c, i64 %i
+  %x = load double* %pa
+  %y = load double* %pb
+  %a1 = fadd double %x, %y
+  %a2 = fadd double %a1, %x
+  %a3 = fadd double %a2, %y
+  %m1 = fmul double %x, %y
+  %m2 = fmul double %m1, %y
+  %r = fadd double %a3, %m2
+  store double %r, double* %pc
+  %i.next = add i64 %i, 1
+  %done = icmp eq i64 %i.next, %n
+  br i1 %done, label %exit, label %loop
+
+exit:
+  ret void
+}
@@ -0,0 +1,149 @@
+; RUN: llc < %s -mtriple=x86_64-linux -mcpu=corei7-avx -mattr=-avx \
+; RUN:   | FileCheck %s
+; RUN: llc < %s -mtriple=x86_64-linux -mcpu=corei7-avx -mattr=-avx \
+; RUN:   -misched-max-region=20 | FileCheck %s -check-prefix=CAP
+
+; The machine scheduler runs by default on x86-64 CPUs with a machine model.
+; This SSE block exceeds the XMM pressure limit in its original order, and the
+; scheduler brings it back under the limit.
+; CHECK: sse_kernel:
+; CHECK-NOT: Spill
+; CHECK: ret
+
+; Regions larger than -misched-max-region keep their original order.
+; CAP: sse_kernel:
+; CAP: Spill
+; CAP: ret
+
+define void @sse_kernel(<4 x float>* %a, <4 x float>* %out) nounwind {
+entry:
+  %p0 = getelementptr <4 x float>* %a, i64 0
+  %v0 = load <4 x float>* %p0, align 16
+  %p1 = getelementptr <4 x float>* %a, i64 1
+  %v1 = load <4 x float>* %p1, align 16
+  %p2 = getelementptr <4 x float>* %a, i64 2
+  %v2 = load <4 x float>* %p2, align 16
+  %p3 = getelementptr <4 x float>* %a, i64 3
+  %v3 = load <4 x float>* %p3, align 16
+  %p4 = getelementptr <4 x float>* %a, i64 4
+  %v4 = load <4 x float>* %p4, align 16
+  %p5 = getelementptr <4 x float>* %a, i64 5
+  %v5 = load <4 x float>* %p5, align 16
+  %p6 = getelementptr <4 x float>* %a, i64 6
+  %v6 = load <4 x float>* %p6, align 16
+  %p7 = getelementptr <4 x float>* %a, i64 7
+  %v7 = load <4 x float>* %p7, align 16
+  %p8 = getelementptr <4 x float>* %a, i64 8
+  %v8 = load <4 x float>* %p8, align 16
+  %p9 = getelementptr <4 x float>* %a, i64 9
+  %v9 = load <4 x float>* %p9, align 16
+  %p10 = getelementptr <4 x float>* %a, i64 10
+  %v10 = load <4 x float>* %p10, align 16
+  %p11 = getelementptr <4 x float>* %a, i64 11
+  %v11 = load <4 x float>* %p11, align 16
+  %p12 = getelementptr <4 x float>* %a, i64 12
+  %v12 = load <4 x float>* %p12, align 16
+  %p13 = getelementptr <4 x float>* %a, i64 13
+  %v13 = load <4 x float>* %p13, align 16
+  %p14 = getelementptr <4 x float>* %a, i64 14
+  %v14 = load <4 x float>* %p14, align 16
+  %p15 = getelementptr <4 x float>* %a, i64 15
+  %v15 = load <4 x float>* %p15, align 16
+  %p16 = getelementptr <4 x float>* %a, i64 16
+  %v16 = load <4 x float>* %p16, align 16
+  %p17 = getelementptr <4 x float>* %a, i64 17
+  %v17 = load <4 x float>* %p17, align 16
+  %p18 = getelementptr <4 x float>* %a, i64 18
+  %v18 = load <4 x float>* %p18, align 16
+  %p19 = getelementptr <4 x float>* %a, i64 19
+  %v19 = load <4 x float>* %p19, align 16
+  %p20 = getelementptr <4 x float>* %a, i64 20
+  %v20 = load <4 x float>* %p20, align 16
+  %p21 = getelementptr <4 x float>* %a, i64 21
+  %v21 = load <4 x float>* %p21, align 16
+  %p22 = getelementptr <4 x float>* %a, i64 22
+  %v22 = load <4 x float>* %p22, align 16
+  %p23 = getelementptr <4 x float>* %a, i64 23
+  %v23 = load <4 x float>* %p23, align 16
+  %p24 = getelementptr <4 x float>* %a, i64 24
+  %v24 = load <4 x float>* %p24, align 16
+  %p25 = getelementptr <4 x float>* %a, i64 25
+  %v25 = load <4 x float>* %p25, align 16
+  %p26 = getelementptr <4 x float>* %a, i64 26
+  %v26 = load <4 x float>* %p26, align 16
+  %p27 = getelementptr <4 x float>* %a, i64 27
+  %v27 = load <4 x float>* %p27, align 16
+  %v28 = fmul <4 x float> %v27, %v20
+  %v29 = fsub <4 x float> %v20, %v25
+  %v30 = fsub <4 x float> %v29, %v28
+  %v31 = fmul <4 x float> %v7, %v24
+  %v32 = fsub <4 x float> %v4, %v29
+  %v33 = fadd <4 x float> %v16, %v28
+  %v34 = fsub <4 x float> %v13, %v26
+  %v35 = fsub <4 x float> %v8, %v33
+  %v36 = fmul <4 x float> %v1, %v30
+  %v37 = fadd <4 x float> %v15, %v31
+  %v38 = fmul <4 x float> %v12, %v33
+  %v39 = fadd <4 x float> %v11, %v37
+  %v40 = fsub <4 x float> %v4, %v35
+  %v41 = fadd <4 x float> %v11, %v36
+  %v42 = fsub <4 x float> %v8, %v41
+  %v43 = fadd <4 x float> %v40, %v40
+  %v44 = fsub <4 x float> %v42, %v36
+  %v45 = fsub <4 x float> %v23, %v37
+  %v46 = fsub <4 x float> %v43, %v38
+  %v47 = fsub <4 x float> %v35, %v40
+  %v48 = fsub <4 x float> %v31, %v46
+  %v49 = fmul <4 x float> %v23, %v48
+  %v50 = fsub <4 x float> %v12, %v49
+  %v51 = fsub <4 x float> %v31, %v43
+  %v52 = fmul <4 x float> %v13, %v46
+  %v53 = fadd <4 x float> %v50, %v52
+  %v54 = fmul <4 x float> %v0, %v49
+  %v55 = fmul <4 x float> %v9, %v51
+  %v56 = fadd <4 x float> %v0, %v50
+  %v57 = fsub <4 x float> %v38, %v53
+  %v58 = fadd <4 x float> %v10, %v51
+  %v59 = fsub <4 x float> %v37, %v55
+  %v60 = fadd <4 x float> %v50, %v58
+  %v61 = fsub <4 x float> %v45, %v53
+  %v62 = fsub <4 x float> %v30, %v58
+  %v63 = fsub <4 x float> %v13, %v55
+  %v64 = fadd <4 x float> %v52, %v58
+  %v65 = fadd <4 x float> %v18, %v57
+  %v66 = fmul <4 x float> %v4, %v65
+  %v67 = fadd <4 x float> %v13, %v61
+  %v68 = fsub <4 x float> %v32, %v62
+  %v69 = fsub <4 x float> %v14, %v67
+  %v70 = fsub <4 x float> %v29, %v65
+  %v71 = fadd <4 x float> %v14, %v68
+  %v72 = fsub <4 x float> %v68, %v66
+  %v73 = fadd <4 x float> %v71, %v66
+  %v74 = fsub <4 x float> %v53, %v72
+  %v75 = fadd <4 x float> %v13, %v70
+  %v76 = fsub <4 x float> %v36, %v69
+  %v77 = fadd <4 x float> %v10, %v72
+  %v78 = fsub <4 x float> %v5, %v76
+  %v79 = fsub <4 x float> %v36, %v73
+  %v80 = fmul <4 x float> %v72, %v78
+  %v81 = fsub <4 x float> %v31, %v73
+  %v82 = fmul <4 x float> %v57, %v79
+  %v83 = fmul <4 x float> %v15, %v80
+  %q0 = getelementptr <4 x float>* %out, i64 0
+  store <4 x float> %v64, <4 x float>* %q0, align 16
+  %q1 = getelementptr <4 x float>* %out, i64 1
+  store <4 x float> %v47, <4 x float>* %q1, align 16
+  %q2 = getelementptr <4 x float>* %out, i64 2
+  store <4 x float> %v34, <4 x float>* %q2, align 16
+  %q3 = getelementptr <4 x float>* %out, i64 3
+  store <4 x float> %v56, <4 x float>* %q3, align 16
+  %q4 = getelementptr <4 x float>* %out, i64 4
+  store <4 x float> %v36, <4 x float>* %q4, align 16
+  %q5 = getelementptr <4 x float>* %out, i64 5
+  store <4 x float> %v55, <4 x float>* %q5, align 16
+  %q6 = getelementptr <4 x float>* %out, i64 6
+  store <4 x float> %v81, <4 x float>* %q6, align 16
+  %q7 = getelementptr <4 x float>* %out, i64 7
+  store <4 x float> %v67, <4 x float>* %q7, align 16
+  ret void
+}
@@ -10,10 +10,10 @@ define i32 @_rdrand16_step(i16* %random_val) {
   %isvalid = extractvalue {i16, i32} %call, 1
   ret i32 %isvalid
 ; CHECK: _rdrand16_step:
-; CHECK: rdrandw	%ax
-; CHECK: movw	%ax, (%r[[A0:di|cx]])
-; CHECK: movzwl	%ax, %ecx
+; CHECK: rdrandw	%[[T2:[a-z]+]]
+; CHECK: movw	%[[T2]], (%r[[A0:di|cx]])
 ; CHECK: movl	$1, %eax
+; CHECK: movzwl	%[[T2]], %ecx
 ; CHECK: cmovael	%ecx, %eax
 ; CHECK: ret
 }
@@ -26,8 +26,8 @@ define i32 @_rdrand32_step(i32* %random_val) {
   ret i32 %isvalid
 ; CHECK: _rdrand32_step:
 ; CHECK: rdrandl	%e[[T0:[a-z]+]]
-; CHECK: movl	%e[[T0]], (%r[[A0]])
 ; CHECK: movl	$1, %eax
+; CHECK: movl	%e[[T0]], (%r[[A0]])
 ; CHECK: cmovael	%e[[T0]], %eax
 ; CHECK: ret
 }
@@ -40,8 +40,8 @@ define i32 @_rdrand64_step(i64* %random_val) {
   ret i32 %isvalid
 ; CHECK: _rdrand64_step:
 ; CHECK: rdrandq	%r[[T1:[[a-z]+]]
-; CHECK: movq	%r[[T1]], (%r[[A0]])
 ; CHECK: movl	$1, %eax
+; CHECK: movq	%r[[T1]], (%r[[A0]])
 ; CHECK: cmovael	%e[[T1]], %eax
 ; CHECK: ret
 }
@@ -0,0 +1,101 @@
+; RUN: llc < %s -mtriple=x86_64-apple-darwin -regalloc=linearscan -verify-machineinstrs | FileCheck %s
+; RUN: llc < %s -mtriple=i386-apple-darwin -regalloc=linearscan -verify-machineinstrs -verify-regalloc | FileCheck %s -check-prefix=I386
+
+; CHECK: simple:
+; CHECK: addl %esi, %edi
+; CHECK-NEXT: movl %edi, %eax
+; CHECK-NEXT: ret
+define i32 @simple(i32 %a, i32 %b) nounwind readnone {
+entry:
+  %add = add nsw i32 %b, %a
+  ret i32 %add
+}
+
+; Values live across the calls can't stay in the argument registers.
+; CHECK: across_calls:
+; CHECK: movl %edi, [[A:%[a-z0-9]+]]
+; CHECK: callq _g
+; CHECK: callq _g
+; CHECK: addl [[A]], %eax
+; CHECK: ret
+declare i32 @g(i32)
+
+define i32 @across_calls(i32 %a, i32 %b, i32 %c, i32 %d, i32 %e, i32 %f) nounwind {
+entry:
+  %call = tail call i32 @g(i32 %a) nounwind
+  %tobool = icmp eq i32 %call, 0
+  br i1 %tobool, label %if.else, label %if.then
+
+if.then:
+  %add = add nsw i32 %b, %c
+  %add1 = add nsw i32 %add, %d
+  %call2 = tail call i32 @g(i32 %add1) nounwind
+  %add3 = add nsw i32 %call2, %e
+  br label %if.end
+
+if.else:
+  %mul = mul nsw i32 %e, %f
+  %call4 = tail call i32 @g(i32 %mul) nounwind
+  %add5 = add nsw i32 %call4, %b
+  br label %if.end
+
+if.end:
+  %r = phi i32 [ %add3, %if.then ], [ %add5, %if.else ]
+  %add6 = add nsw i32 %r, %a
+  %add7 = add nsw i32 %add6, %f
+  ret i32 %add7
+}
+
+; More values are live around the loop than there are registers on i386.  The
+; ones used in the loop stay in registers and the others are spilled.
+; I386: pressure:
+; I386: Spill
+; I386: %loop
+; I386-NOT: Reload
+; I386: jl
+; I386: Folded Reload
+; I386: ret
+define void @pressure(i32* nocapture %p, i32 %n) nounwind {
+entry:
+  %p1 = getelementptr inbounds i32* %p, i64 1
+  %p2 = getelementptr inbounds i32* %p, i64 2
+  %p3 = getelementptr inbounds i32* %p, i64 3
+  %p4 = getelementptr inbounds i32* %p, i64 4
+  %p5 = getelementptr inbounds i32* %p, i64 5
+  %p6 = getelementptr inbounds i32* %p, i64 6
+  %p7 = getelementptr inbounds i32* %p, i64 7
+  %v0 = load i32* %p, align 4
+  %v1 = load i32* %p1, align 4
+  %v2 = load i32* %p2, align 4
+  %v3 = load i32* %p3, align 4
+  %v4 = load i32* %p4, align 4
+  %v5 = load i32* %p5, align 4
+  %v6 = load i32* %p6, align 4
+  %v7 = load i32* %p7, align 4
+  br label %loop
+
+loop:
+  %i = phi i32 [ 0, %entry ], [ %i.next, %loop ]
+  %s0 = phi i32 [ %v0, %entry ], [ %t0, %loop ]
+  %s1 = phi i32 [ %v1, %entry ], [ %t1, %loop ]
+  %s2 = phi i32 [ %v2, %entry ], [ %t2, %loop ]
+  %s3 = phi i32 [ %v3, %entry ], [ %t3, %loop ]
+  %t0 = add i32 %s0, %s1
+  %t1 = xor i32 %s1, %s2
+  %t2 = mul i32 %s2, %s3
+  %t3 = sub i32 %s3, %s0
+  %i.next = add i32 %i, 1
+  %cmp = icmp slt i32 %i.next, %n
+  br i1 %cmp, label %loop, label %exit
+
+exit:
+  %a0 = add i32 %t0, %v4
+  %a1 = add i32 %t1, %v5
+  %a2 = add i32 %t2, %v6
+  %a3 = add i32 %t3, %v7
+  store i32 %a0, i32* %p, align 4
+  store i32 %a1, i32* %p1, align 4
+  store i32 %a2, i32* %p2, align 4
+  store i32 %a3, i32* %p3, align 4
+  ret void
+}
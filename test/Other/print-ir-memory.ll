@@ -0,0 +1,32 @@
+; RUN: opt < %s -print-ir-memory -disable-output 2>&1 | FileCheck %s
+
+; CHECK: IR memory usage for '<stdin>':
+; CHECK: instructions
+; CHECK: operands
+; CHECK: constants
+; CHECK: types (context)
+; CHECK: metadata (context)
+; CHECK: total
+; CHECK: Largest functions:
+; CHECK-NEXT: 5 instrs  big
+; CHECK-NEXT: 1 instrs  small
+; CHECK-NOT: decl
+
+@g = global [4 x i32] [i32 1, i32 2, i32 3, i32 4]
+
+declare void @decl()
+
+define i32 @big(i32 %a, i32 %b) {
+entry:
+  %x = add i32 %a, %b
+  %y = mul i32 %x, 3
+  %p = getelementptr [4 x i32]* @g, i32 0, i32 1
+  %z = load i32* %p, !tbaa !0
+  ret i32 %z
+}
+
+define void @small() {
+  ret void
+}
+
+!0 = metadata !{metadata !"int"}
@@ -0,0 +1,39 @@
+; RUN: opt < %s -bb-vectorize -bb-vectorize-req-chain-depth=3 -mcpu=corei7 -instcombine -gvn -S | FileCheck %s
+; RUN: opt < %s -bb-vectorize -bb-vectorize-req-chain-depth=3 -bb-vectorize-ignore-target-info -mcpu=corei7 -instcombine -gvn -S | FileCheck %s -check-prefix=IGNORE
+target datalayout = "e-p:64:64:64-i1:8:8-i8:8:8-i16:16:16-i32:32:32-i64:64:64-f32:32:32-f64:64:64-v64:64:64-v128:128:128-a0:0:64-s0:64:64-f80:128:128-n8:16:32:64-S128"
+target triple = "x86_64-unknown-linux-gnu"
+
+; Vector division is scalarized on x86, so pairing the chains is not worth it.
+define i64 @test1(i64 %A1, i64 %A2, i64 %B1, i64 %B2) {
+; CHECK: @test1
+; CHECK-NOT: <2 x i64>
+; CHECK: ret i64
+; IGNORE: @test1
+; IGNORE: sdiv <2 x i64>
+; IGNORE: ret i64
+	%X1 = sdiv i64 %A1, %B1
+	%X2 = sdiv i64 %A2, %B2
+	%Y1 = sdiv i64 %X1, %A1
+	%Y2 = sdiv i64 %X2, %A2
+	%Z1 = sdiv i64 %Y1, %B1
+	%Z2 = sdiv i64 %Y2, %B2
+	%R  = mul i64 %Z1, %Z2
+	ret i64 %R
+}
+
+; SSE2 handles <2 x double> arithmetic directly.
+define double @test2(double %A1, double %A2, double %B1, double %B2) {
+; CHECK: @test2
+; CHECK: fsub <2 x double>
+; CHECK: fmul <2 x double>
+; CHECK: fadd <2 x double>
+; CHECK: ret double
+	%X1 = fsub double %A1, %B1
+	%X2 = fsub double %A2, %B2
+	%Y1 = fmul double %X1, %A1
+	%Y2 = fmul double %X2, %A2
+	%Z1 = fadd double %Y1, %B1
+	%Z2 = fadd double %Y2, %B2
+	%R  = fmul double %Z1, %Z2
+	ret double %R
+}
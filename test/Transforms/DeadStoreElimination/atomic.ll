@@ -1,4 +1,6 @@
 ; RUN: opt -basicaa -dse -S < %s | FileCheck %s
+; RUN: opt -basicaa -dse -enable-dse-memoryssa -verify-memoryssa -S < %s \
+; RUN:   | FileCheck %s
 
 target datalayout = "e-p:64:64:64-i1:8:8-i8:8:8-i16:16:16-i32:32:32-i64:64:64-f32:32:32-f64:64:64-v64:64:64-v128:128:128-a0:0:64-s0:64:64-f80:128:128-n8:16:32:64"
 target triple = "x86_64-apple-macosx10.7.0"
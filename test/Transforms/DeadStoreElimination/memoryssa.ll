@@ -0,0 +1,52 @@
+; RUN: opt < %s -basicaa -dse -enable-dse-memoryssa -verify-memoryssa -S | FileCheck %s
+
+target datalayout = "e-p:64:64:64-i1:8:8-i8:8:8-i16:16:16-i32:32:32-i64:64:64-f32:32:32-f64:64:64-v64:64:64-v128:128:128-a0:0:64-s0:64:64-f80:128:128-n8:16:32:64-S128"
+
+@A = global i32 0
+@B = global i32 0
+
+;; The first store to @A is overwritten; the store to %q and the load of @B in
+;; between do not read it.
+
+; CHECK: @overwritten
+; CHECK-NOT: store i32 1, i32* @A
+; CHECK: store i32 2, i32* %q
+; CHECK: store i32 3, i32* @A
+
+define i32 @overwritten(i32* %q) {
+entry:
+  store i32 1, i32* @A
+  store i32 2, i32* %q
+  %b = load i32* @B
+  store i32 3, i32* @A
+  ret i32 %b
+}
+
+;; The load reads the first store.
+
+; CHECK: @read
+; CHECK: store i32 1, i32* %p
+; CHECK: store i32 3, i32* %p
+
+define i32 @read(i32* %p, i32* %q) {
+entry:
+  store i32 1, i32* %p
+  %l = load i32* %q
+  store i32 3, i32* %p
+  ret i32 %l
+}
+
+;; Storing a value loaded from the same pointer is a no-op.
+
+; CHECK: @store_of_load
+; CHECK-NOT: store
+; CHECK: ret i32 %l
+
+define i32 @store_of_load(i32* %p) {
+entry:
+  %l = load i32* %p
+  %b = load i32* @B
+  store i32 %l, i32* %p
+  %r = add i32 %l, %b
+  ret i32 %l
+}
@@ -0,0 +1,55 @@
+; RUN: opt < %s -order-functions -S | FileCheck %s
+; RUN: opt < %s -profile-loader -profile-info-file=%S/Inputs/basic.prof \
+; RUN:     -order-functions -S | FileCheck %s -check-prefix=PROF
+
+; Without a profile, the call in the loop of @a is the heaviest edge, so @a
+; and @c go first; @b and @d follow, and @e, which calls no function of the
+; module and is not called by one, stays last.
+; CHECK: define void @a
+; CHECK: define void @c
+; CHECK: define void @b
+; CHECK: define void @d
+; CHECK: define void @e
+
+; The profile says the loop of @a ran once and @b ran 1000 times.
+; PROF: define void @b
+; PROF: define void @d
+; PROF: define void @a
+; PROF: define void @c
+; PROF: define void @e
+
+define void @a(i32 %n) {
+entry:
+  br label %loop
+
+loop:
+  %i = phi i32 [ 0, %entry ], [ %next, %loop ]
+  call void @c()
+  %next = add i32 %i, 1
+  %done = icmp eq i32 %next, %n
+  br i1 %done, label %exit, label %loop
+
+exit:
+  ret void
+}
+
+define void @b() {
+entry:
+  call void @d()
+  ret void
+}
+
+define void @c() {
+entry:
+  ret void
+}
+
+define void @d() {
+entry:
+  ret void
+}
+
+define void @e() {
+entry:
+  ret void
+}
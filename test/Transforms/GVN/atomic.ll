@@ -1,4 +1,6 @@
 ; RUN: opt -basicaa -gvn -S < %s | FileCheck %s
+; RUN: opt -basicaa -gvn -enable-gvn-memoryssa -verify-memoryssa -S < %s \
+; RUN:   | FileCheck %s -check-prefix=MSSA
 
 target datalayout = "e-p:64:64:64-i1:8:8-i8:8:8-i16:16:16-i32:32:32-i64:64:64-f32:32:32-f64:64:64-v64:64:64-v128:128:128-a0:0:64-s0:64:64-f80:128:128-n8:16:32:64"
 target triple = "x86_64-apple-macosx10.7.0"
@@ -10,6 +12,8 @@ target triple = "x86_64-apple-macosx10.7.0"
 define i32 @test1() nounwind uwtable ssp {
 ; CHECK: test1
 ; CHECK: add i32 %x, %x
+; MSSA: test1
+; MSSA: add i32 %x, %x
 entry:
   %x = load i32* @y
   store atomic i32 %x, i32* @x unordered, align 4
@@ -22,6 +26,8 @@ entry:
 define i32 @test2() nounwind uwtable ssp {
 ; CHECK: test2
 ; CHECK: add i32 %x, %y
+; MSSA: test2
+; MSSA: add i32 %x, %y
 entry:
   %x = load i32* @y
   store atomic i32 %x, i32* @x seq_cst, align 4
@@ -34,6 +40,8 @@ entry:
 define i32 @test3() nounwind uwtable ssp {
 ; CHECK: test3
 ; CHECK: add i32 %x, %x
+; MSSA: test3
+; MSSA: add i32 %x, %x
 entry:
   %x = load i32* @y
   %y = load atomic i32* @x unordered, align 4
@@ -48,6 +56,9 @@ define i32 @test4() nounwind uwtable ssp {
 ; CHECK: test4
 ; CHECK: load atomic i32* @x
 ; CHECK: load i32* @y
+; MSSA: test4
+; MSSA: load atomic i32* @x
+; MSSA: load i32* @y
 entry:
   %x = load i32* @y
   %y = load atomic i32* @x seq_cst, align 4
@@ -72,6 +83,8 @@ entry:
 define i32 @test6() nounwind uwtable ssp {
 ; CHECK: test6
 ; CHECK: load atomic i32* @x unordered
+; MSSA: test6
+; MSSA: load atomic i32* @x unordered
 entry:
   %x = load i32* @x
   %x2 = load atomic i32* @x unordered, align 4
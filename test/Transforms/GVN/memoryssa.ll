@@ -0,0 +1,96 @@
+; RUN: opt < %s -basicaa -gvn -enable-gvn-memoryssa -verify-memoryssa -S | FileCheck %s
+
+target datalayout = "e-p:64:64:64-i1:8:8-i8:8:8-i16:16:16-i32:32:32-i64:64:64-f32:32:32-f64:64:64-v64:64:64-v128:128:128-a0:0:64-s0:64:64-f80:128:128-n8:16:32:64-S128"
+
+@A = global i32 0
+@B = global i32 0
+
+declare i32 @f(i32*) readonly
+
+;; The stored value is forwarded to the load.
+
+; CHECK: @forward
+; CHECK-NOT: load
+; CHECK: ret i32 %v
+
+define i32 @forward(i32* %p, i32 %v) {
+entry:
+  store i32 %v, i32* %p
+  %l = load i32* %p
+  ret i32 %l
+}
+
+;; The store in the diamond does not clobber @B, so both loads read the same
+;; memory version.
+
+; CHECK: @diamond
+; CHECK: %b1 = load i32* @B
+; CHECK-NOT: load
+; CHECK: %r = add i32 %b1, %b1
+
+define i32 @diamond(i1 %c) {
+entry:
+  %b1 = load i32* @B
+  br i1 %c, label %then, label %join
+
+then:
+  store i32 1, i32* @A
+  br label %join
+
+join:
+  %b2 = load i32* @B
+  %r = add i32 %b1, %b2
+  ret i32 %r
+}
+
+;; Here the store may write the loaded memory.
+
+; CHECK: @clobbered
+; CHECK: %l1 = load i32* %p
+; CHECK: %l2 = load i32* %p
+
+define i32 @clobbered(i32* %p, i32* %q, i1 %c) {
+entry:
+  %l1 = load i32* %p
+  br i1 %c, label %then, label %join
+
+then:
+  store i32 1, i32* %q
+  br label %join
+
+join:
+  %l2 = load i32* %p
+  %r = add i32 %l1, %l2
+  ret i32 %r
+}
+
+;; Read-only calls of the same memory version are redundant.
+
+; CHECK: @calls
+; CHECK: %c1 = call i32 @f(i32* %p)
+; CHECK-NOT: call
+; CHECK: store i32 %c1, i32* @A
+; CHECK: %c3 = call i32 @f(i32* %p)
+
+define i32 @calls(i32* %p) {
+entry:
+  %c1 = call i32 @f(i32* %p)
+  %c2 = call i32 @f(i32* %p)
+  store i32 %c2, i32* @A
+  %c3 = call i32 @f(i32* %p)
+  %r = add i32 %c1, %c3
+  ret i32 %r
+}
+
+;; Nothing has written the local before the load.
+
+; CHECK: @uninitialized
+; CHECK-NOT: load
+; CHECK: ret i32 undef
+
+define i32 @uninitialized() {
+entry:
+  %x = alloca i32
+  %l = load i32* %x
+  ret i32 %l
+}
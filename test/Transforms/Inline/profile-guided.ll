@@ -0,0 +1,225 @@
+; RUN: opt < %s -profile-loader -profile-info-file=%S/Inputs/profile-guided.prof -inline -S | FileCheck %s
+; RUN: opt < %s -inline -S | FileCheck %s -check-prefix=NOPROF
+; RUN: opt < %s -profile-loader -profile-info-file=%S/Inputs/profile-guided.prof -inline -print-inline-decisions -disable-output 2>&1 | FileCheck %s -check-prefix=REPORT
+
+; The profile says the call in %hot runs 100000 times and the calls in %cold
+; run 5 times.  @big is too large for the default threshold but is inlined
+; into the hot call site; @mid is small enough for the default threshold but
+; is not inlined into the cold one.
+
+define i32 @big(i32 %x) {
+entry:
+  %v1 = add i32 %x, %x
+  %v2 = xor i32 %v1, %x
+  %v3 = mul i32 %v2, %x
+  %v4 = add i32 %v3, %x
+  %v5 = xor i32 %v4, %x
+  %v6 = mul i32 %v5, %x
+  %v7 = add i32 %v6, %x
+  %v8 = xor i32 %v7, %x
+  %v9 = mul i32 %v8, %x
+  %v10 = add i32 %v9, %x
+  %v11 = xor i32 %v10, %x
+  %v12 = mul i32 %v11, %x
+  %v13 = add i32 %v12, %x
+  %v14 = xor i32 %v13, %x
+  %v15 = mul i32 %v14, %x
+  %v16 = add i32 %v15, %x
+  %v17 = xor i32 %v16, %x
+  %v18 = mul i32 %v17, %x
+  %v19 = add i32 %v18, %x
+  %v20 = xor i32 %v19, %x
+  %v21 = mul i32 %v20, %x
+  %v22 = add i32 %v21, %x
+  %v23 = xor i32 %v22, %x
+  %v24 = mul i32 %v23, %x
+  %v25 = add i32 %v24, %x
+  %v26 = xor i32 %v25, %x
+  %v27 = mul i32 %v26, %x
+  %v28 = add i32 %v27, %x
+  %v29 = xor i32 %v28, %x
+  %v30 = mul i32 %v29, %x
+  %v31 = add i32 %v30, %x
+  %v32 = xor i32 %v31, %x
+  %v33 = mul i32 %v32, %x
+  %v34 = add i32 %v33, %x
+  %v35 = xor i32 %v34, %x
+  %v36 = mul i32 %v35, %x
+  %v37 = add i32 %v36, %x
+  %v38 = xor i32 %v37, %x
+  %v39 = mul i32 %v38, %x
+  %v40 = add i32 %v39, %x
+  %v41 = xor i32 %v40, %x
+  %v42 = mul i32 %v41, %x
+  %v43 = add i32 %v42, %x
+  %v44 = xor i32 %v43, %x
+  %v45 = mul i32 %v44, %x
+  %v46 = add i32 %v45, %x
+  %v47 = xor i32 %v46, %x
+  %v48 = mul i32 %v47, %x
+  %v49 = add i32 %v48, %x
+  %v50 = xor i32 %v49, %x
+  %v51 = mul i32 %v50, %x
+  %v52 = add i32 %v51, %x
+  %v53 = xor i32 %v52, %x
+  %v54 = mul i32 %v53, %x
+  %v55 = add i32 %v54, %x
+  %v56 = xor i32 %v55, %x
+  %v57 = mul i32 %v56, %x
+  %v58 = add i32 %v57, %x
+  %v59 = xor i32 %v58, %x
+  %v60 = mul i32 %v59, %x
+  %v61 = add i32 %v60, %x
+  %v62 = xor i32 %v61, %x
+  %v63 = mul i32 %v62, %x
+  %v64 = add i32 %v63, %x
+  %v65 = xor i32 %v64, %x
+  %v66 = mul i32 %v65, %x
+  %v67 = add i32 %v66, %x
+  %v68 = xor i32 %v67, %x
+  %v69 = mul i32 %v68, %x
+  %v70 = add i32 %v69, %x
+  %v71 = xor i32 %v70, %x
+  %v72 = mul i32 %v71, %x
+  %v73 = add i32 %v72, %x
+  %v74 = xor i32 %v73, %x
+  %v75 = mul i32 %v74, %x
+  %v76 = add i32 %v75, %x
+  %v77 = xor i32 %v76, %x
+  %v78 = mul i32 %v77, %x
+  %v79 = add i32 %v78, %x
+  %v80 = xor i32 %v79, %x
+  %v81 = mul i32 %v80, %x
+  %v82 = add i32 %v81, %x
+  %v83 = xor i32 %v82, %x
+  %v84 = mul i32 %v83, %x
+  %v85 = add i32 %v84, %x
+  %v86 = xor i32 %v85, %x
+  %v87 = mul i32 %v86, %x
+  %v88 = add i32 %v87, %x
+  %v89 = xor i32 %v88, %x
+  %v90 = mul i32 %v89, %x
+  %v91 = add i32 %v90, %x
+  %v92 = xor i32 %v91, %x
+  %v93 = mul i32 %v92, %x
+  %v94 = add i32 %v93, %x
+  %v95 = xor i32 %v94, %x
+  %v96 = mul i32 %v95, %x
+  %v97 = add i32 %v96, %x
+  %v98 = xor i32 %v97, %x
+  %v99 = mul i32 %v98, %x
+  %v100 = add i32 %v99, %x
+  %v101 = xor i32 %v100, %x
+  %v102 = mul i32 %v101, %x
+  %v103 = add i32 %v102, %x
+  %v104 = xor i32 %v103, %x
+  %v105 = mul i32 %v104, %x
+  %v106 = add i32 %v105, %x
+  %v107 = xor i32 %v106, %x
+  %v108 = mul i32 %v107, %x
+  %v109 = add i32 %v108, %x
+  %v110 = xor i32 %v109, %x
+  %v111 = mul i32 %v110, %x
+  %v112 = add i32 %v111, %x
+  %v113 = xor i32 %v112, %x
+  %v114 = mul i32 %v113, %x
+  %v115 = add i32 %v114, %x
+  %v116 = xor i32 %v115, %x
+  %v117 = mul i32 %v116, %x
+  %v118 = add i32 %v117, %x
+  %v119 = xor i32 %v118, %x
+  %v120 = mul i32 %v119, %x
+  %v121 = add i32 %v120, %x
+  %v122 = xor i32 %v121, %x
+  %v123 = mul i32 %v122, %x
+  %v124 = add i32 %v123, %x
+  %v125 = xor i32 %v124, %x
+  %v126 = mul i32 %v125, %x
+  %v127 = add i32 %v126, %x
+  %v128 = xor i32 %v127, %x
+  %v129 = mul i32 %v128, %x
+  %v130 = add i32 %v129, %x
+  %v131 = xor i32 %v130, %x
+  %v132 = mul i32 %v131, %x
+  %v133 = add i32 %v132, %x
+  %v134 = xor i32 %v133, %x
+  %v135 = mul i32 %v134, %x
+  %v136 = add i32 %v135, %x
+  %v137 = xor i32 %v136, %x
+  %v138 = mul i32 %v137, %x
+  %v139 = add i32 %v138, %x
+  %v140 = xor i32 %v139, %x
+  ret i32 %v140
+}
+
+define i32 @mid(i32 %x) {
+entry:
+  %v1 = add i32 %x, %x
+  %v2 = xor i32 %v1, %x
+  %v3 = mul i32 %v2, %x
+  %v4 = add i32 %v3, %x
+  %v5 = xor i32 %v4, %x
+  %v6 = mul i32 %v5, %x
+  %v7 = add i32 %v6, %x
+  %v8 = xor i32 %v7, %x
+  %v9 = mul i32 %v8, %x
+  %v10 = add i32 %v9, %x
+  %v11 = xor i32 %v10, %x
+  %v12 = mul i32 %v11, %x
+  %v13 = add i32 %v12, %x
+  %v14 = xor i32 %v13, %x
+  %v15 = mul i32 %v14, %x
+  %v16 = add i32 %v15, %x
+  %v17 = xor i32 %v16, %x
+  %v18 = mul i32 %v17, %x
+  %v19 = add i32 %v18, %x
+  %v20 = xor i32 %v19, %x
+  %v21 = mul i32 %v20, %x
+  %v22 = add i32 %v21, %x
+  %v23 = xor i32 %v22, %x
+  %v24 = mul i32 %v23, %x
+  %v25 = add i32 %v24, %x
+  %v26 = xor i32 %v25, %x
+  %v27 = mul i32 %v26, %x
+  %v28 = add i32 %v27, %x
+  %v29 = xor i32 %v28, %x
+  %v30 = mul i32 %v29, %x
+  %v31 = add i32 %v30, %x
+  %v32 = xor i32 %v31, %x
+  %v33 = mul i32 %v32, %x
+  %v34 = add i32 %v33, %x
+  %v35 = xor i32 %v34, %x
+  ret i32 %v35
+}
+
+define i32 @caller(i32 %x, i1 %c) {
+entry:
+  br i1 %c, label %hot, label %cold
+
+hot:
+  %h = call i32 @big(i32 %x)
+  br label %exit
+
+cold:
+  %m = call i32 @mid(i32 %x)
+  br label %exit
+
+exit:
+  %r = phi i32 [ %h, %hot ], [ %m, %cold ]
+  ret i32 %r
+}
+
+; CHECK: define i32 @caller
+; CHECK: hot:
+; CHECK-NOT: call i32 @big
+; CHECK: cold:
+; CHECK: call i32 @mid
+
+; NOPROF: define i32 @caller
+; NOPROF: hot:
+; NOPROF: call i32 @big
+; NOPROF: cold:
+; NOPROF-NOT: call i32 @mid
+
+; REPORT: inline: caller -> big, count=100000 (hot)
+; REPORT: no inline: caller -> mid, count=5 (cold)
@@ -0,0 +1,21 @@
+; RUN: opt < %s -instcombine -S | FileCheck %s
+; RUN: opt < %s -instcombine -instcombine-max-visits=1 -S \
+; RUN:   | FileCheck %s -check-prefix=VISITS
+
+; Without a budget the chain folds to a single add.  With a budget of one
+; visit only the first add is visited, and the chain is left alone.
+
+; CHECK: @chain
+; CHECK-NEXT: %c = add i32 %x, 6
+; CHECK-NEXT: ret i32 %c
+
+; VISITS: @chain
+; VISITS: %b = add i32 %a, 2
+; VISITS: %c = add i32 %b, 3
+
+define i32 @chain(i32 %x) nounwind {
+  %a = add i32 %x, 1
+  %b = add i32 %a, 2
+  %c = add i32 %b, 3
+  ret i32 %c
+}
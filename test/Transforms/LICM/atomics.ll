@@ -1,4 +1,6 @@
 ; RUN: opt < %s -S -basicaa -licm | FileCheck %s
+; RUN: opt < %s -S -basicaa -licm -enable-licm-memoryssa -verify-memoryssa \
+; RUN:   | FileCheck %s -check-prefix=MSSA
 
 ; Check that we can hoist unordered loads
 define i32 @test1(i32* nocapture %y) nounwind uwtable ssp {
@@ -17,6 +19,9 @@ end:
 ; CHECK: define i32 @test1(
 ; CHECK: load atomic
 ; CHECK-NEXT: br label %loop
+; MSSA: define i32 @test1(
+; MSSA: load atomic
+; MSSA-NEXT: br label %loop
 }
 
 ; Check that we don't sink/hoist monotonic loads
@@ -37,6 +42,10 @@ end:
 ; CHECK: load atomic
 ; CHECK-NEXT: %exitcond = icmp ne
 ; CHECK-NEXT: br i1 %exitcond, label %end, label %loop
+; MSSA: define i32 @test2(
+; MSSA: load atomic
+; MSSA-NEXT: %exitcond = icmp ne
+; MSSA-NEXT: br i1 %exitcond, label %end, label %loop
 }
 
 ; Check that we hoist unordered around monotonic.
@@ -57,6 +66,11 @@ end:
 ; CHECK: define i32 @test3(
 ; CHECK: load atomic i32* %x unordered
 ; CHECK-NEXT: br label %loop
+; With MemorySSA, the unordered load is not hoisted past the monotonic one.
+; MSSA: define i32 @test3(
+; MSSA: loop:
+; MSSA-NEXT: load atomic i32* %y monotonic
+; MSSA-NEXT: load atomic i32* %x unordered
 }
 
 ; Don't try to "sink" unordered stores yet; it is legal, but the machinery
@@ -76,4 +90,7 @@ end:
 ; CHECK: define i32 @test4(
 ; CHECK: load atomic i32* %y monotonic
 ; CHECK-NEXT: store atomic
+; MSSA: define i32 @test4(
+; MSSA: load atomic i32* %y monotonic
+; MSSA-NEXT: store atomic
 }
@@ -0,0 +1,81 @@
+; RUN: opt < %s -basicaa -licm -S | FileCheck %s -check-prefix=AST
+; RUN: opt < %s -basicaa -licm -enable-licm-memoryssa -verify-memoryssa -S | FileCheck %s
+
+target datalayout = "e-p:64:64:64-i1:8:8-i8:8:8-i16:16:16-i32:32:32-i64:64:64-f32:32:32-f64:64:64-v64:64:64-v128:128:128-a0:0:64-s0:64:64-f80:128:128-n8:16:32:64-S128"
+
+@A = global i32 0
+@B = global i32 0
+
+;; The load of %p may alias both @A and @B, which puts all three in the alias
+;; set of the store.  Memory SSA sees that only the store to @A is written in
+;; the loop, so the load of @B is invariant.
+
+; AST: @transitive
+; AST: loop:
+; AST: %b = load i32* @B
+
+; CHECK: @transitive
+; CHECK: entry:
+; CHECK: %b = load i32* @B
+; CHECK: loop:
+; CHECK: %x = load i32* %p
+
+define void @transitive(i32* %p, i32 %n) {
+entry:
+  br label %loop
+
+loop:
+  %i = phi i32 [ 0, %entry ], [ %i.next, %loop ]
+  %x = load i32* %p
+  %b = load i32* @B
+  %v = add i32 %x, %b
+  store i32 %v, i32* @A
+  %i.next = add i32 %i, 1
+  %cond = icmp slt i32 %i.next, %n
+  br i1 %cond, label %loop, label %exit
+
+exit:
+  ret void
+}
+
+;; The first loop promotes @A, after which memory SSA is rebuilt for the
+;; second loop.
+
+; CHECK: @promoted
+; CHECK: entry:
+; CHECK: %A.promoted = load i32* @A
+; CHECK: loop1:
+; CHECK-NOT: load
+; CHECK: loop2.preheader:
+; CHECK: %b = load i32* @B
+; CHECK: loop2:
+; CHECK: store i32 %v, i32* %p
+
+define void @promoted(i32* noalias %p, i32 %n) {
+entry:
+  br label %loop1
+
+loop1:
+  %i = phi i32 [ 0, %entry ], [ %i.next, %loop1 ]
+  %a = load i32* @A
+  %a.next = add i32 %a, 1
+  store i32 %a.next, i32* @A
+  %i.next = add i32 %i, 1
+  %cond1 = icmp slt i32 %i.next, %n
+  br i1 %cond1, label %loop1, label %loop2.preheader
+
+loop2.preheader:
+  br label %loop2
+
+loop2:
+  %j = phi i32 [ 0, %loop2.preheader ], [ %j.next, %loop2 ]
+  %b = load i32* @B
+  %v = add i32 %b, %j
+  store i32 %v, i32* %p
+  %j.next = add i32 %j, 1
+  %cond2 = icmp slt i32 %j.next, %n
+  br i1 %cond2, label %loop2, label %exit
+
+exit:
+  ret void
+}
@@ -0,0 +1,96 @@
+; RUN: opt < %s -basicaa -loop-distribute -S | FileCheck %s
+
+target datalayout = "e-p:64:64:64-i1:8:8-i8:8:8-i16:16:16-i32:32:32-i64:64:64-f32:32:32-f64:64:64-v64:64:64-v128:128:128-a0:0:64-s0:64:64-f80:128:128-n8:16:32:64-S128"
+
+@A = common global [1001 x i32] zeroinitializer, align 16
+@B = common global [1001 x i32] zeroinitializer, align 16
+@C = common global [1001 x i32] zeroinitializer, align 16
+@D = common global [1001 x i32] zeroinitializer, align 16
+
+;; The recurrence through A is split from the vectorizable statement.
+;;
+;; for (i = 0; i < 1000; i++) {
+;;   A[i + 1] = A[i] * k;
+;;   C[i] = B[i] + D[i];
+;; }
+
+; CHECK: @recurrence
+; CHECK: entry:
+; CHECK-NEXT: br label %for.body.ldist
+; CHECK: for.body.ldist:
+; CHECK-NEXT: %i.ldist = phi i64 [ 0, %entry ], [ %i.next.ldist, %for.body.ldist ]
+; CHECK: store i32 %mul.ldist, i32* %a.next.addr.ldist
+; CHECK-NOT: store
+; CHECK: br i1 %exitcond.ldist, label %for.body.ldist.ph, label %for.body.ldist
+; CHECK: for.body.ldist.ph:
+; CHECK-NEXT: br label %for.body
+; CHECK: for.body:
+; CHECK-NEXT: %i = phi i64 [ 0, %for.body.ldist.ph ], [ %i.next, %for.body ]
+; CHECK-NOT: @A
+; CHECK: store i32 %add, i32* %c.addr
+; CHECK-NEXT: %exitcond = icmp eq i64 %i.next, 1000
+; CHECK-NEXT: br i1 %exitcond, label %for.end, label %for.body
+; CHECK: for.end:
+
+define void @recurrence(i32 %k) nounwind {
+entry:
+  br label %for.body
+
+for.body:
+  %i = phi i64 [ 0, %entry ], [ %i.next, %for.body ]
+  %a.addr = getelementptr inbounds [1001 x i32]* @A, i64 0, i64 %i
+  %a = load i32* %a.addr, align 4
+  %mul = mul nsw i32 %a, %k
+  %i.next = add nsw i64 %i, 1
+  %a.next.addr = getelementptr inbounds [1001 x i32]* @A, i64 0, i64 %i.next
+  store i32 %mul, i32* %a.next.addr, align 4
+  %b.addr = getelementptr inbounds [1001 x i32]* @B, i64 0, i64 %i
+  %b = load i32* %b.addr, align 4
+  %d.addr = getelementptr inbounds [1001 x i32]* @D, i64 0, i64 %i
+  %d = load i32* %d.addr, align 4
+  %add = add nsw i32 %b, %d
+  %c.addr = getelementptr inbounds [1001 x i32]* @C, i64 0, i64 %i
+  store i32 %add, i32* %c.addr, align 4
+  %exitcond = icmp eq i64 %i.next, 1000
+  br i1 %exitcond, label %for.end, label %for.body
+
+for.end:
+  ret void
+}
+
+;; The second statement reads C[i + 1] before the first one overwrites it in
+;; the next iteration, so the loop cannot be distributed.
+;;
+;; for (i = 0; i < 1000; i++) {
+;;   C[i] = B[i];
+;;   A[i + 1] = A[i] + C[i + 1];
+;; }
+
+; CHECK: @backward_dependence
+; CHECK-NOT: ldist
+; CHECK: ret void
+
+define void @backward_dependence() nounwind {
+entry:
+  br label %for.body
+
+for.body:
+  %i = phi i64 [ 0, %entry ], [ %i.next, %for.body ]
+  %b.addr = getelementptr inbounds [1001 x i32]* @B, i64 0, i64 %i
+  %b = load i32* %b.addr, align 4
+  %c.addr = getelementptr inbounds [1001 x i32]* @C, i64 0, i64 %i
+  store i32 %b, i32* %c.addr, align 4
+  %i.next = add nsw i64 %i, 1
+  %a.addr = getelementptr inbounds [1001 x i32]* @A, i64 0, i64 %i
+  %a = load i32* %a.addr, align 4
+  %c.next.addr = getelementptr inbounds [1001 x i32]* @C, i64 0, i64 %i.next
+  %c = load i32* %c.next.addr, align 4
+  %add = add nsw i32 %a, %c
+  %a.next.addr = getelementptr inbounds [1001 x i32]* @A, i64 0, i64 %i.next
+  store i32 %add, i32* %a.next.addr, align 4
+  %exitcond = icmp eq i64 %i.next, 1000
+  br i1 %exitcond, label %for.end, label %for.body
+
+for.end:
+  ret void
+}
@@ -0,0 +1,126 @@
+; RUN: opt -loop-idiom -mcpu=corei7 < %s -S | FileCheck %s
+; RUN: opt -loop-idiom -mcpu=core2 < %s -S | FileCheck %s -check-prefix=NOPOPCNT
+; RUN: opt -loop-idiom -loop-deletion -mcpu=corei7 < %s -S | FileCheck %s -check-prefix=DELETE
+target datalayout = "e-p:64:64:64-i1:8:8-i8:8:8-i16:16:16-i32:32:32-i64:64:64-f32:32:32-f64:64:64-v64:64:64-v128:128:128-a0:0:64-s0:64:64-f80:128:128-n8:16:32:64-S128"
+target triple = "x86_64-apple-macosx10.8.0"
+
+;; int popcount(unsigned long long x) {
+;;   int n = 0;
+;;   while (x) {
+;;     x &= x - 1;
+;;     ++n;
+;;   }
+;;   return n;
+;; }
+
+; CHECK: @popcount
+; CHECK: while.body.preheader:
+; CHECK-NEXT: %popcnt = call i64 @llvm.ctpop.i64(i64 %x)
+; CHECK-NEXT: %0 = trunc i64 %popcnt to i32
+; CHECK-NEXT: %inc.final = add i32 0, %0
+; CHECK: while.body:
+; CHECK-NEXT: %tcphi = phi i64 [ %popcnt, %while.body.preheader ], [ %tcdec, %while.body ]
+; CHECK: %tcdec = add i64 %tcphi, -1
+; CHECK-NEXT: %tobool = icmp eq i64 %tcdec, 0
+; CHECK: %inc.lcssa = phi i32 [ %inc.final, %while.body ]
+
+; NOPOPCNT: @popcount
+; NOPOPCNT-NOT: ctpop
+; NOPOPCNT: ret i32
+
+; DELETE: @popcount
+; DELETE: %inc.final = add i32 0, %0
+; DELETE-NEXT: br label %while.end.loopexit
+; DELETE-NOT: while.body:
+; DELETE: ret i32
+
+define i32 @popcount(i64 %x) nounwind readnone ssp {
+entry:
+  %tobool3 = icmp eq i64 %x, 0
+  br i1 %tobool3, label %while.end, label %while.body.preheader
+
+while.body.preheader:
+  br label %while.body
+
+while.body:
+  %n.05 = phi i32 [ %inc, %while.body ], [ 0, %while.body.preheader ]
+  %x.addr.04 = phi i64 [ %and, %while.body ], [ %x, %while.body.preheader ]
+  %sub = add i64 %x.addr.04, -1
+  %and = and i64 %sub, %x.addr.04
+  %inc = add nsw i32 %n.05, 1
+  %tobool = icmp eq i64 %and, 0
+  br i1 %tobool, label %while.end.loopexit, label %while.body
+
+while.end.loopexit:
+  %inc.lcssa = phi i32 [ %inc, %while.body ]
+  br label %while.end
+
+while.end:
+  %n.0.lcssa = phi i32 [ 0, %entry ], [ %inc.lcssa, %while.end.loopexit ]
+  ret i32 %n.0.lcssa
+}
+
+;; int bits(unsigned x) {
+;;   int n = 0;
+;;   while (x) {
+;;     x >>= 1;
+;;     ++n;
+;;   }
+;;   return n;
+;; }
+
+; CHECK: @bits
+; CHECK: while.body.preheader:
+; CHECK-NEXT: %ctlz = call i32 @llvm.ctlz.i32(i32 %x, i1 true)
+; CHECK-NEXT: %bits = sub i32 32, %ctlz
+
+; NOPOPCNT: @bits
+; NOPOPCNT: @llvm.ctlz.i32
+
+define i32 @bits(i32 %x) nounwind readnone ssp {
+entry:
+  %tobool3 = icmp eq i32 %x, 0
+  br i1 %tobool3, label %while.end, label %while.body.preheader
+
+while.body.preheader:
+  br label %while.body
+
+while.body:
+  %n.05 = phi i32 [ %inc, %while.body ], [ 0, %while.body.preheader ]
+  %x.addr.04 = phi i32 [ %shr, %while.body ], [ %x, %while.body.preheader ]
+  %shr = lshr i32 %x.addr.04, 1
+  %inc = add nsw i32 %n.05, 1
+  %tobool = icmp eq i32 %shr, 0
+  br i1 %tobool, label %while.end.loopexit, label %while.body
+
+while.end.loopexit:
+  %inc.lcssa = phi i32 [ %inc, %while.body ]
+  br label %while.end
+
+while.end:
+  %n.0.lcssa = phi i32 [ 0, %entry ], [ %inc.lcssa, %while.end.loopexit ]
+  ret i32 %n.0.lcssa
+}
+
+;; The loop is entered for zero, in which case it runs once.
+
+; CHECK: @unguarded
+; CHECK-NOT: ctpop
+; CHECK: ret i32
+
+define i32 @unguarded(i64 %x) nounwind readnone ssp {
+entry:
+  br label %while.body
+
+while.body:
+  %n.05 = phi i32 [ %inc, %while.body ], [ 0, %entry ]
+  %x.addr.04 = phi i64 [ %and, %while.body ], [ %x, %entry ]
+  %sub = add i64 %x.addr.04, -1
+  %and = and i64 %sub, %x.addr.04
+  %inc = add nsw i32 %n.05, 1
+  %tobool = icmp eq i64 %and, 0
+  br i1 %tobool, label %while.end, label %while.body
+
+while.end:
+  ret i32 %inc
+}
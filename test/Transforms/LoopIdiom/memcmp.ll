@@ -0,0 +1,199 @@
+; RUN: opt -loop-idiom < %s -S | FileCheck %s
+; RUN: opt -loop-idiom -loop-deletion < %s -S | FileCheck %s -check-prefix=DELETE
+target datalayout = "e-p:64:64:64-i1:8:8-i8:8:8-i16:16:16-i32:32:32-i64:64:64-f32:32:32-f64:64:64-v64:64:64-v128:128:128-a0:0:64-s0:64:64-f80:128:128-n8:16:32:64-S128"
+target triple = "x86_64-apple-macosx10.8.0"
+
+;; int a[16], b[16];
+;; for (i = 0; i != 16; ++i)
+;;   if (a[i] != b[i])
+;;     return 0;
+;; return 1;
+
+@ga = global [16 x i32] zeroinitializer, align 16
+@gb = global [16 x i32] zeroinitializer, align 16
+
+; CHECK: @equal
+; CHECK: entry:
+; CHECK: %memcmp = call i32 @memcmp(i8* bitcast ([16 x i32]* @ga to i8*), i8* bitcast ([16 x i32]* @gb to i8*), i64 64)
+; CHECK-NEXT: %memcmp.eq = icmp eq i32 %memcmp, 0
+; CHECK-NEXT: %0 = select i1 %memcmp.eq, i32 1, i32 0
+; CHECK: for.body:
+; CHECK: br label %for.inc
+; CHECK: return:
+; CHECK-NEXT: ret i32 %0
+
+; DELETE: @equal
+; DELETE-NOT: for.body:
+; DELETE: ret i32 %0
+
+define i32 @equal() nounwind readonly ssp {
+entry:
+  br label %for.body
+
+for.body:
+  %i = phi i64 [ 0, %entry ], [ %inc, %for.inc ]
+  %arrayidx = getelementptr inbounds [16 x i32]* @ga, i64 0, i64 %i
+  %0 = load i32* %arrayidx, align 4
+  %arrayidx1 = getelementptr inbounds [16 x i32]* @gb, i64 0, i64 %i
+  %1 = load i32* %arrayidx1, align 4
+  %cmp = icmp eq i32 %0, %1
+  br i1 %cmp, label %for.inc, label %return
+
+for.inc:
+  %inc = add i64 %i, 1
+  %exitcond = icmp eq i64 %inc, 16
+  br i1 %exitcond, label %return, label %for.body
+
+return:
+  %retval = phi i32 [ 0, %for.body ], [ 1, %for.inc ]
+  ret i32 %retval
+}
+
+;; The loop stops at the first mismatch, so the arrays need not be n elements
+;; long.  memcmp could read past their end.
+
+; CHECK: @unknown_length
+; CHECK-NOT: @memcmp
+; CHECK: ret i32
+
+define i32 @unknown_length(i32* %a, i32* %b, i64 %n) nounwind readonly ssp {
+entry:
+  br label %for.body
+
+for.body:
+  %i = phi i64 [ 0, %entry ], [ %inc, %for.inc ]
+  %arrayidx = getelementptr inbounds i32* %a, i64 %i
+  %0 = load i32* %arrayidx, align 4
+  %arrayidx1 = getelementptr inbounds i32* %b, i64 %i
+  %1 = load i32* %arrayidx1, align 4
+  %cmp = icmp eq i32 %0, %1
+  br i1 %cmp, label %for.inc, label %return
+
+for.inc:
+  %inc = add i64 %i, 1
+  %exitcond = icmp eq i64 %inc, %n
+  br i1 %exitcond, label %return, label %for.body
+
+return:
+  %retval = phi i32 [ 0, %for.body ], [ 1, %for.inc ]
+  ret i32 %retval
+}
+
+;; A constant trip count is not enough if the objects are unknown.
+
+; CHECK: @unknown_object
+; CHECK-NOT: @memcmp
+; CHECK: ret i32
+
+define i32 @unknown_object(i32* %a, i32* %b) nounwind readonly ssp {
+entry:
+  br label %for.body
+
+for.body:
+  %i = phi i64 [ 0, %entry ], [ %inc, %for.inc ]
+  %arrayidx = getelementptr inbounds i32* %a, i64 %i
+  %0 = load i32* %arrayidx, align 4
+  %arrayidx1 = getelementptr inbounds i32* %b, i64 %i
+  %1 = load i32* %arrayidx1, align 4
+  %cmp = icmp eq i32 %0, %1
+  br i1 %cmp, label %for.inc, label %return
+
+for.inc:
+  %inc = add i64 %i, 1
+  %exitcond = icmp eq i64 %inc, 16
+  br i1 %exitcond, label %return, label %for.body
+
+return:
+  %retval = phi i32 [ 0, %for.body ], [ 1, %for.inc ]
+  ret i32 %retval
+}
+
+;; @gshort only has 8 elements.  The loop must find a mismatch before reading
+;; past them, but memcmp of 16 elements would not stop there.
+
+@gshort = global [8 x i32] zeroinitializer, align 16
+
+; CHECK: @short_object
+; CHECK-NOT: @memcmp
+; CHECK: ret i32
+
+define i32 @short_object() nounwind readonly ssp {
+entry:
+  br label %for.body
+
+for.body:
+  %i = phi i64 [ 0, %entry ], [ %inc, %for.inc ]
+  %arrayidx = getelementptr inbounds [16 x i32]* @ga, i64 0, i64 %i
+  %0 = load i32* %arrayidx, align 4
+  %arrayidx1 = getelementptr inbounds [8 x i32]* @gshort, i64 0, i64 %i
+  %1 = load i32* %arrayidx1, align 4
+  %cmp = icmp eq i32 %0, %1
+  br i1 %cmp, label %for.inc, label %return
+
+for.inc:
+  %inc = add i64 %i, 1
+  %exitcond = icmp eq i64 %inc, 16
+  br i1 %exitcond, label %return, label %for.body
+
+return:
+  %retval = phi i32 [ 0, %for.body ], [ 1, %for.inc ]
+  ret i32 %retval
+}
+
+;; Equal floating point values need not have equal bytes.
+
+; CHECK: @fp
+; CHECK-NOT: @memcmp
+; CHECK: ret i32
+
+define i32 @fp(float* %a, float* %b, i64 %n) nounwind readonly ssp {
+entry:
+  br label %for.body
+
+for.body:
+  %i = phi i64 [ 0, %entry ], [ %inc, %for.inc ]
+  %arrayidx = getelementptr inbounds float* %a, i64 %i
+  %0 = load float* %arrayidx, align 4
+  %arrayidx1 = getelementptr inbounds float* %b, i64 %i
+  %1 = load float* %arrayidx1, align 4
+  %cmp = fcmp une float %0, %1
+  br i1 %cmp, label %return, label %for.inc
+
+for.inc:
+  %inc = add i64 %i, 1
+  %exitcond = icmp eq i64 %inc, %n
+  br i1 %exitcond, label %return, label %for.body
+
+return:
+  %retval = phi i32 [ 0, %for.body ], [ 1, %for.inc ]
+  ret i32 %retval
+}
+
+;; The index of the first mismatch is returned.
+
+; CHECK: @mismatch
+; CHECK-NOT: @memcmp
+; CHECK: ret i64
+
+define i64 @mismatch(i8* %a, i8* %b, i64 %n) nounwind readonly ssp {
+entry:
+  br label %for.body
+
+for.body:
+  %i = phi i64 [ 0, %entry ], [ %inc, %for.inc ]
+  %arrayidx = getelementptr inbounds i8* %a, i64 %i
+  %0 = load i8* %arrayidx, align 1
+  %arrayidx1 = getelementptr inbounds i8* %b, i64 %i
+  %1 = load i8* %arrayidx1, align 1
+  %cmp = icmp ne i8 %0, %1
+  br i1 %cmp, label %return, label %for.inc
+
+for.inc:
+  %inc = add i64 %i, 1
+  %exitcond = icmp eq i64 %inc, %n
+  br i1 %exitcond, label %return, label %for.body
+
+return:
+  %retval = phi i64 [ %i, %for.body ], [ %n, %for.inc ]
+  ret i64 %retval
+}
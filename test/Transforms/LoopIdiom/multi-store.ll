@@ -0,0 +1,112 @@
+; RUN: opt -basicaa -loop-idiom < %s -S | FileCheck %s
+target datalayout = "e-p:64:64:64-i1:8:8-i8:8:8-i16:16:16-i32:32:32-i64:64:64-f32:32:32-f64:64:64-v64:64:64-v128:128:128-a0:0:64-s0:64:64-f80:128:128-n8:16:32:64"
+target triple = "x86_64-apple-darwin10.0.0"
+
+%complex = type { float, float }
+%triple = type { i32, i16, i16 }
+
+;; for (i) { P[i].re = 0; P[i].im = 0; }
+define void @complex_zero(%complex* %P, i64 %Size) nounwind ssp {
+entry:
+  br label %for.body
+
+for.body:
+  %indvar = phi i64 [ 0, %entry ], [ %indvar.next, %for.body ]
+  %re = getelementptr %complex* %P, i64 %indvar, i32 0
+  store float 0.000000e+00, float* %re, align 4
+  %im = getelementptr %complex* %P, i64 %indvar, i32 1
+  store float 0.000000e+00, float* %im, align 4
+  %indvar.next = add i64 %indvar, 1
+  %exitcond = icmp eq i64 %indvar.next, %Size
+  br i1 %exitcond, label %for.end, label %for.body
+
+for.end:
+  ret void
+; CHECK: @complex_zero
+; CHECK: %0 = mul i64 %Size, 8
+; CHECK: call void @llvm.memset.p0i8.i64(i8* %P1, i8 0, i64 %0, i32 4, i1 false)
+; CHECK-NOT: store
+; CHECK: ret void
+}
+
+;; The stores of different sizes are written in any order.
+;; for (i) { P[i].b = Q[i].b; P[i].a = Q[i].a; P[i].c = Q[i].c; }
+define void @triple_copy(%triple* noalias %P, %triple* noalias %Q, i64 %Size) nounwind ssp {
+entry:
+  br label %for.body
+
+for.body:
+  %indvar = phi i64 [ 0, %entry ], [ %indvar.next, %for.body ]
+  %q.b = getelementptr %triple* %Q, i64 %indvar, i32 1
+  %b = load i16* %q.b, align 4
+  %p.b = getelementptr %triple* %P, i64 %indvar, i32 1
+  store i16 %b, i16* %p.b, align 4
+  %q.a = getelementptr %triple* %Q, i64 %indvar, i32 0
+  %a = load i32* %q.a, align 4
+  %p.a = getelementptr %triple* %P, i64 %indvar, i32 0
+  store i32 %a, i32* %p.a, align 4
+  %q.c = getelementptr %triple* %Q, i64 %indvar, i32 2
+  %c = load i16* %q.c, align 2
+  %p.c = getelementptr %triple* %P, i64 %indvar, i32 2
+  store i16 %c, i16* %p.c, align 2
+  %indvar.next = add i64 %indvar, 1
+  %exitcond = icmp eq i64 %indvar.next, %Size
+  br i1 %exitcond, label %for.end, label %for.body
+
+for.end:
+  ret void
+; CHECK: @triple_copy
+; CHECK: call void @llvm.memcpy.p0i8.p0i8.i64(i8* %P1, i8* %Q2, i64 %0, i32 4, i1 false)
+; CHECK-NOT: store
+; CHECK: ret void
+}
+
+;; The second half of each element is not written.
+;; for (i) { P[i].a = 0; P[i].b = 0; }
+define void @gap(%triple* %P, i64 %Size) nounwind ssp {
+entry:
+  br label %for.body
+
+for.body:
+  %indvar = phi i64 [ 0, %entry ], [ %indvar.next, %for.body ]
+  %p.a = getelementptr %triple* %P, i64 %indvar, i32 0
+  store i32 0, i32* %p.a, align 4
+  %p.b = getelementptr %triple* %P, i64 %indvar, i32 1
+  store i16 0, i16* %p.b, align 4
+  %indvar.next = add i64 %indvar, 1
+  %exitcond = icmp eq i64 %indvar.next, %Size
+  br i1 %exitcond, label %for.end, label %for.body
+
+for.end:
+  ret void
+; CHECK: @gap
+; CHECK-NOT: memset
+; CHECK: store i32 0
+; CHECK: store i16 0
+; CHECK: ret void
+}
+
+;; The stored values differ, so this is neither a memset nor a memcpy.
+;; for (i) { P[i].re = 0; P[i].im = 1; }
+define void @complex_mixed(%complex* %P, i64 %Size) nounwind ssp {
+entry:
+  br label %for.body
+
+for.body:
+  %indvar = phi i64 [ 0, %entry ], [ %indvar.next, %for.body ]
+  %re = getelementptr %complex* %P, i64 %indvar, i32 0
+  store float 0.000000e+00, float* %re, align 4
+  %im = getelementptr %complex* %P, i64 %indvar, i32 1
+  store float 1.000000e+00, float* %im, align 4
+  %indvar.next = add i64 %indvar, 1
+  %exitcond = icmp eq i64 %indvar.next, %Size
+  br i1 %exitcond, label %for.end, label %for.body
+
+for.end:
+  ret void
+; CHECK: @complex_mixed
+; CHECK-NOT: memset
+; CHECK: store float 0.000000e+00
+; CHECK: store float 1.000000e+00
+; CHECK: ret void
+}
@@ -0,0 +1,93 @@
+; RUN: opt -loop-idiom < %s -S | FileCheck %s
+; RUN: opt -loop-idiom -loop-deletion < %s -S | FileCheck %s -check-prefix=DELETE
+target datalayout = "e-p:64:64:64-i1:8:8-i8:8:8-i16:16:16-i32:32:32-i64:64:64-f32:32:32-f64:64:64-v64:64:64-v128:128:128-a0:0:64-s0:64:64-f80:128:128-n8:16:32:64-S128"
+target triple = "x86_64-apple-macosx10.8.0"
+
+;; size_t n = 0;
+;; while (s[n])
+;;   n++;
+;; return n;
+
+; CHECK: @index
+; CHECK: entry:
+; CHECK-NEXT: %strlen = call i64 @strlen(i8* %s)
+; CHECK: %tcphi = phi i64 [ %0, %entry ], [ %tcdec, %while.cond ]
+; CHECK: %tobool = icmp eq i64 %tcdec, 0
+; CHECK: %n.lcssa = phi i64 [ %strlen, %while.cond ]
+
+; DELETE: @index
+; DELETE: entry:
+; DELETE-NEXT: %strlen = call i64 @strlen(i8* %s)
+; DELETE-NOT: while.cond:
+; DELETE: %n.lcssa = phi i64 [ %strlen, %entry ]
+
+define i64 @index(i8* %s) nounwind readonly ssp {
+entry:
+  br label %while.cond
+
+while.cond:
+  %n = phi i64 [ 0, %entry ], [ %inc, %while.cond ]
+  %arrayidx = getelementptr inbounds i8* %s, i64 %n
+  %c = load i8* %arrayidx, align 1
+  %tobool = icmp eq i8 %c, 0
+  %inc = add i64 %n, 1
+  br i1 %tobool, label %while.end, label %while.cond
+
+while.end:
+  %n.lcssa = phi i64 [ %n, %while.cond ]
+  ret i64 %n.lcssa
+}
+
+;; const char *p;
+;; for (p = s; *p; ++p)
+;;   ;
+;; return p - s;
+
+; CHECK: @pointer
+; CHECK: %strlen = call i64 @strlen(i8* %s)
+; CHECK: %scevgep = getelementptr i8* %s, i64 %strlen
+; CHECK: %p.lcssa = phi i8* [ %scevgep, %for.cond ]
+
+define i64 @pointer(i8* %s) nounwind readonly ssp {
+entry:
+  br label %for.cond
+
+for.cond:
+  %p = phi i8* [ %s, %entry ], [ %incdec.ptr, %for.cond ]
+  %c = load i8* %p, align 1
+  %tobool = icmp eq i8 %c, 0
+  %incdec.ptr = getelementptr inbounds i8* %p, i64 1
+  br i1 %tobool, label %for.end, label %for.cond
+
+for.end:
+  %p.lcssa = phi i8* [ %p, %for.cond ]
+  %sub.ptr.lhs.cast = ptrtoint i8* %p.lcssa to i64
+  %sub.ptr.rhs.cast = ptrtoint i8* %s to i64
+  %sub.ptr.sub = sub i64 %sub.ptr.lhs.cast, %sub.ptr.rhs.cast
+  ret i64 %sub.ptr.sub
+}
+
+;; The loop also writes to memory.
+
+; CHECK: @copy
+; CHECK-NOT: @strlen
+; CHECK: ret i64
+
+define i64 @copy(i8* %s, i8* %d) nounwind ssp {
+entry:
+  br label %while.cond
+
+while.cond:
+  %n = phi i64 [ 0, %entry ], [ %inc, %while.cond ]
+  %arrayidx = getelementptr inbounds i8* %s, i64 %n
+  %c = load i8* %arrayidx, align 1
+  %dst = getelementptr inbounds i8* %d, i64 %n
+  store i8 %c, i8* %dst, align 1
+  %tobool = icmp eq i8 %c, 0
+  %inc = add i64 %n, 1
+  br i1 %tobool, label %while.end, label %while.cond
+
+while.end:
+  %n.lcssa = phi i64 [ %n, %while.cond ]
+  ret i64 %n.lcssa
+}
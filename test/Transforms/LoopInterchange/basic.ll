@@ -0,0 +1,182 @@
+; RUN: opt < %s -basicaa -loop-interchange -S | FileCheck %s
+
+target datalayout = "e-p:64:64:64-i1:8:8-i8:8:8-i16:16:16-i32:32:32-i64:64:64-f32:32:32-f64:64:64-v64:64:64-v128:128:128-a0:0:64-s0:64:64-f80:128:128-n8:16:32:64-S128"
+
+@A = common global [100 x [200 x i32]] zeroinitializer, align 16
+@B = common global [100 x [200 x i32]] zeroinitializer, align 16
+
+;; for (j = 0; j < 200; j++)
+;;   for (i = 0; i < 100; i++)
+;;     A[i][j] = A[i][j] + B[i][j];
+
+; CHECK: @column_major
+; CHECK: for.cond1.preheader:
+; CHECK-NEXT: %j = phi i64 [ 0, %entry ], [ %j.next, %for.inc ]
+; CHECK: for.body3:
+; CHECK-NEXT: %i = phi i64 [ 0, %for.cond1.preheader ], [ %i.next, %for.body3 ]
+; CHECK-NEXT: %a.addr = getelementptr inbounds [100 x [200 x i32]]* @A, i64 0, i64 %j, i64 %i
+; CHECK-NEXT: %b.addr = getelementptr inbounds [100 x [200 x i32]]* @B, i64 0, i64 %j, i64 %i
+; CHECK: %exitcond = icmp eq i64 %i.next, 200
+; CHECK-NEXT: br i1 %exitcond, label %for.inc, label %for.body3
+; CHECK: %exitcond7 = icmp eq i64 %j.next, 100
+; CHECK-NEXT: br i1 %exitcond7, label %for.end, label %for.cond1.preheader
+; CHECK: ret void
+
+define void @column_major() nounwind {
+entry:
+  br label %for.cond1.preheader
+
+for.cond1.preheader:
+  %j = phi i64 [ 0, %entry ], [ %j.next, %for.inc ]
+  br label %for.body3
+
+for.body3:
+  %i = phi i64 [ 0, %for.cond1.preheader ], [ %i.next, %for.body3 ]
+  %a.addr = getelementptr inbounds [100 x [200 x i32]]* @A, i64 0, i64 %i, i64 %j
+  %b.addr = getelementptr inbounds [100 x [200 x i32]]* @B, i64 0, i64 %i, i64 %j
+  %a = load i32* %a.addr, align 4
+  %b = load i32* %b.addr, align 4
+  %add = add nsw i32 %a, %b
+  store i32 %add, i32* %a.addr, align 4
+  %i.next = add nsw i64 %i, 1
+  %exitcond = icmp eq i64 %i.next, 100
+  br i1 %exitcond, label %for.inc, label %for.body3
+
+for.inc:
+  %j.next = add nsw i64 %j, 1
+  %exitcond7 = icmp eq i64 %j.next, 200
+  br i1 %exitcond7, label %for.end, label %for.cond1.preheader
+
+for.end:
+  ret void
+}
+
+;; The outer header computes an index, which is sunk into the inner loop, and
+;; the outer loop exits when its test is false.
+;;
+;; for (j = 0; j < n; j++)
+;;   for (i = 0; i < 100; i++)
+;;     B[i][j] = A[i][j];
+
+; CHECK: @sunk_index
+; CHECK: for.cond1.preheader:
+; CHECK-NEXT: %j = phi i32 [ 0, %entry ], [ %j.next, %for.inc ]
+; CHECK-NEXT: br label %for.body3
+; CHECK: for.body3:
+; CHECK-NEXT: %i = phi i32 [ 0, %for.cond1.preheader ], [ %i.next, %for.body3 ]
+; CHECK-NEXT: %idxprom = sext i32 %i to i64
+; CHECK-NEXT: %idxprom4 = sext i32 %j to i64
+; CHECK: %i.next = add nsw i32 %i, 1
+; CHECK-NEXT: %cmp = icmp slt i32 %i.next, %n
+; CHECK-NEXT: br i1 %cmp, label %for.body3, label %for.inc
+; CHECK: %j.next = add nsw i32 %j, 1
+; CHECK-NEXT: %cmp2 = icmp eq i32 %j.next, 100
+; CHECK-NEXT: br i1 %cmp2, label %for.end, label %for.cond1.preheader
+
+define void @sunk_index(i32 %n) nounwind {
+entry:
+  br label %for.cond1.preheader
+
+for.cond1.preheader:
+  %j = phi i32 [ 0, %entry ], [ %j.next, %for.inc ]
+  %idxprom = sext i32 %j to i64
+  br label %for.body3
+
+for.body3:
+  %i = phi i32 [ 0, %for.cond1.preheader ], [ %i.next, %for.body3 ]
+  %idxprom4 = sext i32 %i to i64
+  %a.addr = getelementptr inbounds [100 x [200 x i32]]* @A, i64 0, i64 %idxprom4, i64 %idxprom
+  %a = load i32* %a.addr, align 4
+  %b.addr = getelementptr inbounds [100 x [200 x i32]]* @B, i64 0, i64 %idxprom4, i64 %idxprom
+  store i32 %a, i32* %b.addr, align 4
+  %i.next = add nsw i32 %i, 1
+  %cmp = icmp eq i32 %i.next, 100
+  br i1 %cmp, label %for.inc, label %for.body3
+
+for.inc:
+  %j.next = add nsw i32 %j, 1
+  %cmp2 = icmp slt i32 %j.next, %n
+  br i1 %cmp2, label %for.cond1.preheader, label %for.end
+
+for.end:
+  ret void
+}
+
+;; The rows are already walked in order.
+;;
+;; for (i = 0; i < 100; i++)
+;;   for (j = 0; j < 200; j++)
+;;     A[i][j] = B[i][j];
+
+; CHECK: @row_major
+; CHECK: getelementptr inbounds [100 x [200 x i32]]* @B, i64 0, i64 %i, i64 %j
+; CHECK: %exitcond = icmp eq i64 %j.next, 200
+; CHECK: %exitcond7 = icmp eq i64 %i.next, 100
+
+define void @row_major() nounwind {
+entry:
+  br label %for.cond1.preheader
+
+for.cond1.preheader:
+  %i = phi i64 [ 0, %entry ], [ %i.next, %for.inc ]
+  br label %for.body3
+
+for.body3:
+  %j = phi i64 [ 0, %for.cond1.preheader ], [ %j.next, %for.body3 ]
+  %b.addr = getelementptr inbounds [100 x [200 x i32]]* @B, i64 0, i64 %i, i64 %j
+  %b = load i32* %b.addr, align 4
+  %a.addr = getelementptr inbounds [100 x [200 x i32]]* @A, i64 0, i64 %i, i64 %j
+  store i32 %b, i32* %a.addr, align 4
+  %j.next = add nsw i64 %j, 1
+  %exitcond = icmp eq i64 %j.next, 200
+  br i1 %exitcond, label %for.inc, label %for.body3
+
+for.inc:
+  %i.next = add nsw i64 %i, 1
+  %exitcond7 = icmp eq i64 %i.next, 100
+  br i1 %exitcond7, label %for.end, label %for.cond1.preheader
+
+for.end:
+  ret void
+}
+
+;; Iteration (j, i) reads the element written by iteration (j + 1, i - 1),
+;; which the interchange would run first.
+;;
+;; for (j = 0; j < 199; j++)
+;;   for (i = 1; i < 100; i++)
+;;     A[i][j] = A[i - 1][j + 1];
+
+; CHECK: @reversed_dependence
+; CHECK: %src.addr = getelementptr inbounds [100 x [200 x i32]]* @A, i64 0, i64 %i.prev, i64 %j.succ
+; CHECK: %exitcond = icmp eq i64 %i.next, 100
+; CHECK: %exitcond7 = icmp eq i64 %j.next, 199
+
+define void @reversed_dependence() nounwind {
+entry:
+  br label %for.cond1.preheader
+
+for.cond1.preheader:
+  %j = phi i64 [ 0, %entry ], [ %j.next, %for.inc ]
+  %j.succ = add nsw i64 %j, 1
+  br label %for.body3
+
+for.body3:
+  %i = phi i64 [ 1, %for.cond1.preheader ], [ %i.next, %for.body3 ]
+  %i.prev = add nsw i64 %i, -1
+  %src.addr = getelementptr inbounds [100 x [200 x i32]]* @A, i64 0, i64 %i.prev, i64 %j.succ
+  %src = load i32* %src.addr, align 4
+  %dst.addr = getelementptr inbounds [100 x [200 x i32]]* @A, i64 0, i64 %i, i64 %j
+  store i32 %src, i32* %dst.addr, align 4
+  %i.next = add nsw i64 %i, 1
+  %exitcond = icmp eq i64 %i.next, 100
+  br i1 %exitcond, label %for.inc, label %for.body3
+
+for.inc:
+  %j.next = add nsw i64 %j, 1
+  %exitcond7 = icmp eq i64 %j.next, 199
+  br i1 %exitcond7, label %for.end, label %for.cond1.preheader
+
+for.end:
+  ret void
+}
@@ -0,0 +1,35 @@
+; RUN: opt < %s -loop-vectorize -mtriple=x86_64-apple-macosx10.8.0 -mcpu=corei7-avx -dce -instcombine -S | FileCheck %s
+; RUN: opt < %s -loop-vectorize -mtriple=x86_64-apple-macosx10.8.0 -mcpu=corei7 -dce -instcombine -S | FileCheck %s -check-prefix=SSE
+
+target datalayout = "e-p:64:64:64-i1:8:8-i8:8:8-i16:16:16-i32:32:32-i64:64:64-f32:32:32-f64:64:64-v64:64:64-v128:128:128-a0:0:64-s0:64:64-f80:128:128-n8:16:32:64-S128"
+target triple = "x86_64-apple-macosx10.8.0"
+
+@a = common global [2048 x float] zeroinitializer, align 16
+@b = common global [2048 x float] zeroinitializer, align 16
+
+; The widest legal vector register decides the vector width: 256 bits with
+; AVX and 128 bits with SSE.
+;CHECK: @scale
+;CHECK: fmul <8 x float>
+;CHECK: ret void
+;SSE: @scale
+;SSE: fmul <4 x float>
+;SSE: ret void
+define void @scale(float %x) nounwind uwtable ssp {
+  br label %1
+
+; <label>:1                                       ; preds = %1, %0
+  %indvars.iv = phi i64 [ 0, %0 ], [ %indvars.iv.next, %1 ]
+  %2 = getelementptr inbounds [2048 x float]* @b, i64 0, i64 %indvars.iv
+  %3 = load float* %2, align 4
+  %4 = fmul float %3, %x
+  %5 = getelementptr inbounds [2048 x float]* @a, i64 0, i64 %indvars.iv
+  store float %4, float* %5, align 4
+  %indvars.iv.next = add i64 %indvars.iv, 1
+  %lftr.wideiv = trunc i64 %indvars.iv.next to i32
+  %exitcond = icmp eq i32 %lftr.wideiv, 1024
+  br i1 %exitcond, label %6, label %1
+
+; <label>:6                                       ; preds = %1
+  ret void
+}
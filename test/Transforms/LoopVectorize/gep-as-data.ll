@@ -0,0 +1,28 @@
+; RUN: opt < %s -loop-vectorize -force-vector-width=2 -S | FileCheck %s
+
+; A GEP that is stored to memory is data, not an address, and the vectorizer
+; does not widen pointers.  This used to assert in widenInstruction.
+
+;CHECK: @store_gep
+;CHECK-NOT: <2 x
+;CHECK-NOT: <4 x
+;CHECK: ret void
+target datalayout = "e-p:64:64:64-i1:8:8-i8:8:8-i16:16:16-i32:32:32-i64:64:64-f32:32:32-f64:64:64-v64:64:64-v128:128:128-a0:0:64-s0:64:64-f80:128:128-n8:16:32:64-S128"
+target triple = "x86_64-apple-macosx10.8.0"
+
+define void @store_gep(i32** noalias nocapture %dst, i32* %a) nounwind uwtable ssp {
+entry:
+  br label %for.body
+
+for.body:
+  %i = phi i64 [ 0, %entry ], [ %i.next, %for.body ]
+  %p = getelementptr inbounds i32* %a, i64 %i
+  %slot = getelementptr inbounds i32** %dst, i64 %i
+  store i32* %p, i32** %slot, align 8
+  %i.next = add i64 %i, 1
+  %exitcond = icmp eq i64 %i.next, 256
+  br i1 %exitcond, label %for.end, label %for.body
+
+for.end:
+  ret void
+}
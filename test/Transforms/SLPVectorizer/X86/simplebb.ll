@@ -0,0 +1,91 @@
+; RUN: opt < %s -basicaa -slp-vectorizer -dce -S -mtriple=x86_64-apple-macosx10.8.0 -mcpu=corei7-avx | FileCheck %s
+
+target datalayout = "e-p:64:64:64-i1:8:8-i8:8:8-i16:16:16-i32:32:32-i64:64:64-f32:32:32-f64:64:64-v64:64:64-v128:128:128-a0:0:64-s0:64:64-f80:128:128-n8:16:32:64-S128"
+target triple = "x86_64-apple-macosx10.8.0"
+
+; Two consecutive stores of products of consecutive loads.
+; CHECK: @test1
+; CHECK: load <2 x double>
+; CHECK: load <2 x double>
+; CHECK: fmul <2 x double>
+; CHECK: store <2 x double>
+; CHECK: ret
+define void @test1(double* noalias %a, double* noalias %b, double* noalias %c) {
+entry:
+  %i0 = load double* %a, align 8
+  %i1 = load double* %b, align 8
+  %mul = fmul double %i0, %i1
+  %arrayidx3 = getelementptr inbounds double* %a, i64 1
+  %i3 = load double* %arrayidx3, align 8
+  %arrayidx4 = getelementptr inbounds double* %b, i64 1
+  %i4 = load double* %arrayidx4, align 8
+  %mul5 = fmul double %i3, %i4
+  store double %mul, double* %c, align 8
+  %arrayidx5 = getelementptr inbounds double* %c, i64 1
+  store double %mul5, double* %arrayidx5, align 8
+  ret void
+}
+
+; The stores may alias the loads they would be moved past.
+; CHECK: @test2
+; CHECK-NOT: <2 x double>
+; CHECK: ret
+define void @test2(double* %a, double* %b, double* %c) {
+entry:
+  %i0 = load double* %a, align 8
+  %i1 = load double* %b, align 8
+  %mul = fmul double %i0, %i1
+  store double %mul, double* %c, align 8
+  %arrayidx3 = getelementptr inbounds double* %a, i64 1
+  %i3 = load double* %arrayidx3, align 8
+  %arrayidx4 = getelementptr inbounds double* %b, i64 1
+  %i4 = load double* %arrayidx4, align 8
+  %mul5 = fmul double %i3, %i4
+  %arrayidx5 = getelementptr inbounds double* %c, i64 1
+  store double %mul5, double* %arrayidx5, align 8
+  ret void
+}
+
+; A product that is also used after the stores is extracted from the vector.
+; CHECK: @test3
+; CHECK: fmul <2 x double>
+; CHECK: extractelement <2 x double>
+; CHECK: store <2 x double>
+; CHECK: ret double
+define double @test3(double* noalias %a, double* noalias %b, double* noalias %c) {
+entry:
+  %i0 = load double* %a, align 8
+  %i1 = load double* %b, align 8
+  %mul = fmul double %i0, %i1
+  %arrayidx3 = getelementptr inbounds double* %a, i64 1
+  %i3 = load double* %arrayidx3, align 8
+  %arrayidx4 = getelementptr inbounds double* %b, i64 1
+  %i4 = load double* %arrayidx4, align 8
+  %mul5 = fmul double %i3, %i4
+  store double %mul, double* %c, align 8
+  %arrayidx5 = getelementptr inbounds double* %c, i64 1
+  store double %mul5, double* %arrayidx5, align 8
+  ret double %mul5
+}
+
+; Values that are not loads are gathered into a vector.
+; CHECK: @test4
+; CHECK: insertelement <2 x double>
+; CHECK: insertelement <2 x double>
+; CHECK: fadd <2 x double>
+; CHECK: store <2 x double>
+; CHECK: ret
+define void @test4(double %x, double %y, double* noalias %b, double* noalias %c) {
+entry:
+  %i1 = load double* %b, align 8
+  %mul = fmul double %i1, %x
+  %add = fadd double %mul, %i1
+  %arrayidx4 = getelementptr inbounds double* %b, i64 1
+  %i4 = load double* %arrayidx4, align 8
+  %mul5 = fmul double %i4, %y
+  %add5 = fadd double %mul5, %i4
+  store double %add, double* %c, align 8
+  %arrayidx5 = getelementptr inbounds double* %c, i64 1
+  store double %add5, double* %arrayidx5, align 8
+  ret void
+}
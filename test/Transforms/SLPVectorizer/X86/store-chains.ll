@@ -0,0 +1,93 @@
+; RUN: opt < %s -basicaa -slp-vectorizer -dce -S -mtriple=x86_64-apple-macosx10.8.0 -mcpu=corei7 | FileCheck %s
+
+target datalayout = "e-p:64:64:64-i1:8:8-i8:8:8-i16:16:16-i32:32:32-i64:64:64-f32:32:32-f64:64:64-v64:64:64-v128:128:128-a0:0:64-s0:64:64-f80:128:128-n8:16:32:64-S128"
+target triple = "x86_64-apple-macosx10.8.0"
+
+; Stores written in reverse order still form one chain of four i32 lanes,
+; and the nsw flag shared by every lane is kept.
+; CHECK: @reversed
+; CHECK: load <4 x i32>* {{.*}}, align 4
+; CHECK: add nsw <4 x i32>
+; CHECK: store <4 x i32> {{.*}}, align 4
+; CHECK-NOT: store i32
+; CHECK: ret
+define void @reversed(i32* noalias %dst, i32* noalias %src) {
+entry:
+  %s3p = getelementptr inbounds i32* %src, i64 3
+  %s3 = load i32* %s3p, align 4
+  %a3 = add nsw i32 %s3, 3
+  %d3p = getelementptr inbounds i32* %dst, i64 3
+  store i32 %a3, i32* %d3p, align 4
+  %s2p = getelementptr inbounds i32* %src, i64 2
+  %s2 = load i32* %s2p, align 4
+  %a2 = add nsw i32 %s2, 2
+  %d2p = getelementptr inbounds i32* %dst, i64 2
+  store i32 %a2, i32* %d2p, align 4
+  %s1p = getelementptr inbounds i32* %src, i64 1
+  %s1 = load i32* %s1p, align 4
+  %a1 = add nsw i32 %s1, 1
+  %d1p = getelementptr inbounds i32* %dst, i64 1
+  store i32 %a1, i32* %d1p, align 4
+  %s0 = load i32* %src, align 4
+  %a0 = add nsw i32 %s0, 0
+  store i32 %a0, i32* %dst, align 4
+  ret void
+}
+
+; Loads that are not consecutive are gathered; storing four unrelated scalars
+; is cheaper than building the vector, so nothing changes.
+; CHECK: @scattered
+; CHECK-NOT: <4 x i32>
+; CHECK: ret
+define void @scattered(i32* noalias %dst, i32 %a, i32 %b, i32 %c, i32 %d) {
+entry:
+  store i32 %a, i32* %dst, align 4
+  %d1p = getelementptr inbounds i32* %dst, i64 1
+  store i32 %b, i32* %d1p, align 4
+  %d2p = getelementptr inbounds i32* %dst, i64 2
+  store i32 %c, i32* %d2p, align 4
+  %d3p = getelementptr inbounds i32* %dst, i64 3
+  store i32 %d, i32* %d3p, align 4
+  ret void
+}
+
+; Six stores form one chain; the first four are vectorized with four lanes
+; and the remaining two with two lanes.
+; CHECK: @six
+; CHECK: fadd <4 x float>
+; CHECK: store <4 x float>
+; CHECK: fadd <2 x float>
+; CHECK: store <2 x float>
+; CHECK: ret
+define void @six(float* noalias %dst, float* noalias %src) {
+entry:
+  %s0 = load float* %src, align 4
+  %a0 = fadd float %s0, %s0
+  store float %a0, float* %dst, align 4
+  %s1p = getelementptr inbounds float* %src, i64 1
+  %s1 = load float* %s1p, align 4
+  %a1 = fadd float %s1, %s1
+  %d1p = getelementptr inbounds float* %dst, i64 1
+  store float %a1, float* %d1p, align 4
+  %s2p = getelementptr inbounds float* %src, i64 2
+  %s2 = load float* %s2p, align 4
+  %a2 = fadd float %s2, %s2
+  %d2p = getelementptr inbounds float* %dst, i64 2
+  store float %a2, float* %d2p, align 4
+  %s3p = getelementptr inbounds float* %src, i64 3
+  %s3 = load float* %s3p, align 4
+  %a3 = fadd float %s3, %s3
+  %d3p = getelementptr inbounds float* %dst, i64 3
+  store float %a3, float* %d3p, align 4
+  %s4p = getelementptr inbounds float* %src, i64 4
+  %s4 = load float* %s4p, align 4
+  %a4 = fadd float %s4, %s4
+  %d4p = getelementptr inbounds float* %dst, i64 4
+  store float %a4, float* %d4p, align 4
+  %s5p = getelementptr inbounds float* %src, i64 5
+  %s5 = load float* %s5p, align 4
+  %a5 = fadd float %s5, %s5
+  %d5p = getelementptr inbounds float* %dst, i64 5
+  store float %a5, float* %d5p, align 4
+  ret void
+}
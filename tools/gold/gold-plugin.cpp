@@ -80,6 +80,8 @@ namespace options {
   static std::string extra_library_path;
   static std::string triple;
   static std::string mcpu;
+  // Number of object files to generate code into in parallel.
+  static unsigned partitions = 1;
   // Additional options to pass into the code generator.
   // Note: This array will contain all plugin options which are not claimed
   // as plugin exclusive to pass to the code generator.
@@ -101,6 +103,10 @@ namespace options {
       extra_library_path = opt.substr(strlen("extra_library_path="));
     } else if (opt.startswith("mtriple=")) {
       triple = opt.substr(strlen("mtriple="));
+    } else if (opt.startswith("partitions=")) {
+      if (opt.substr(strlen("partitions=")).getAsInteger(10, partitions) ||
+          partitions == 0)
+        (*message)(LDPL_FATAL, "Invalid number of partitions: %s", opt_);
     } else if (opt.startswith("obj-path=")) {
       obj_path = opt.substr(strlen("obj-path="));
     } else if (opt == "emit-llvm") {
@@ -433,9 +439,22 @@ static ld_plugin_status all_symbols_read_hook(void) {
     if (options::generate_bc_file == options::BC_ONLY)
       exit(0);
   }
-  const char *objPath;
-  if (lto_codegen_compile_to_file(code_gen, &objPath)) {
-    (*message)(LDPL_ERROR, "Could not produce a combined object file\n");
+  // The names are owned by code_gen, so copy them before disposing of it.
+  std::vector<std::string> objPaths;
+  if (options::partitions > 1) {
+    const char **objNames;
+    unsigned numObjs;
+    if (lto_codegen_compile_to_files(code_gen, options::partitions,
+                                     &objNames, &numObjs))
+      (*message)(LDPL_ERROR, "Could not produce the object files\n");
+    else
+      objPaths.assign(objNames, objNames + numObjs);
+  } else {
+    const char *objPath;
+    if (lto_codegen_compile_to_file(code_gen, &objPath))
+      (*message)(LDPL_ERROR, "Could not produce a combined object file\n");
+    else
+      objPaths.push_back(objPath);
   }
 
   lto_codegen_dispose(code_gen);
@@ -447,11 +466,12 @@ static ld_plugin_status all_symbols_read_hook(void) {
     }
   }
 
-  if ((*add_input_file)(objPath) != LDPS_OK) {
-    (*message)(LDPL_ERROR, "Unable to add .o file to the link.");
-    (*message)(LDPL_ERROR, "File left behind in: %s", objPath);
-    return LDPS_ERR;
-  }
+  for (unsigned i = 0, e = objPaths.size(); i != e; ++i)
+    if ((*add_input_file)(objPaths[i].c_str()) != LDPS_OK) {
+      (*message)(LDPL_ERROR, "Unable to add .o file to the link.");
+      (*message)(LDPL_ERROR, "File left behind in: %s", objPaths[i].c_str());
+      return LDPS_ERR;
+    }
 
   if (!options::extra_library_path.empty() &&
       set_extra_library_path(options::extra_library_path.c_str()) != LDPS_OK) {
@@ -460,7 +480,8 @@ static ld_plugin_status all_symbols_read_hook(void) {
   }
 
   if (options::obj_path.empty())
-    Cleanup.push_back(sys::Path(objPath));
+    for (unsigned i = 0, e = objPaths.size(); i != e; ++i)
+      Cleanup.push_back(sys::Path(objPaths[i]));
 
   return LDPS_OK;
 }
@@ -17,11 +17,15 @@
 #include "llvm/Module.h"
 #include "llvm/PassManager.h"
 #include "llvm/Pass.h"
+#include "llvm/ADT/STLExtras.h"
+#include "llvm/ADT/StringExtras.h"
 #include "llvm/ADT/Triple.h"
 #include "llvm/Assembly/PrintModulePass.h"
 #include "llvm/Support/IRReader.h"
 #include "llvm/CodeGen/LinkAllAsmWriterComponents.h"
 #include "llvm/CodeGen/LinkAllCodegenComponents.h"
+#include "llvm/CodeGen/MachinePassListener.h"
+#include "llvm/CodeGen/ParallelCodeGen.h"
 #include "llvm/MC/SubtargetFeature.h"
 #include "llvm/Support/CommandLine.h"
 #include "llvm/Support/Debug.h"
@@ -268,6 +272,18 @@ static cl::opt<std::string> StartAfter("start-after",
   cl::value_desc("pass-name"),
   cl::init(""));
 
+static cl::opt<std::string>
+MachinePassCSV("machine-pass-csv", cl::Hidden,
+  cl::desc("Write the compile time and size of every function after every "
+           "machine function pass to a CSV file"),
+  cl::value_desc("filename"));
+
+static cl::opt<unsigned>
+CodeGenPartitions("codegen-partitions", cl::init(1),
+  cl::desc("Split the module and generate code for the parts on this many "
+           "threads.  Part N > 0 is written to <output>.N"),
+  cl::value_desc("N"));
+
 static cl::opt<unsigned>
 SSPBufferSize("stack-protector-buffer-size", cl::init(8),
               cl::desc("Lower bound for a buffer to be considered for "
@@ -290,6 +306,8 @@ GetFileNameRoot(const std::string &InputFilename) {
   return outputFilename;
 }
 
+static tool_output_file *OpenOutputFile(const std::string &Filename);
+
 static tool_output_file *GetOutputStream(const char *TargetName,
                                          Triple::OSType OS,
                                          const char *ProgName) {
@@ -325,6 +343,12 @@ static tool_output_file *GetOutputStream(const char *TargetName,
     }
   }
 
+  return OpenOutputFile(OutputFilename);
+}
+
+// OpenOutputFile - Open a file for the output of FileType, or print an error
+// and return null.
+static tool_output_file *OpenOutputFile(const std::string &Filename) {
   // Decide if we need "binary" output.
   bool Binary = false;
   switch (FileType) {
@@ -340,7 +364,7 @@ static tool_output_file *GetOutputStream(const char *TargetName,
   std::string error;
   unsigned OpenFlags = 0;
   if (Binary) OpenFlags |= raw_fd_ostream::F_Binary;
-  tool_output_file *FDOut = new tool_output_file(OutputFilename.c_str(), error,
+  tool_output_file *FDOut = new tool_output_file(Filename.c_str(), error,
                                                  OpenFlags);
   if (!error.empty()) {
     errs() << error << '\n';
@@ -351,6 +375,100 @@ static tool_output_file *GetOutputStream(const char *TargetName,
   return FDOut;
 }
 
+// CreateTargetMachine - Create a target machine configured by the command line.
+static TargetMachine *CreateTargetMachine(const Target *TheTarget,
+                                          const Triple &TheTriple,
+                                          const std::string &FeaturesStr,
+                                          const TargetOptions &Options,
+                                          CodeGenOpt::Level OLvl) {
+  TargetMachine *TM =
+    TheTarget->createTargetMachine(TheTriple.getTriple(), MCPU, FeaturesStr,
+                                   Options, RelocModel, CMModel, OLvl);
+  assert(TM && "Could not allocate target machine!");
+
+  if (DisableDotLoc)
+    TM->setMCUseLoc(false);
+
+  if (DisableCFI)
+    TM->setMCUseCFI(false);
+
+  if (EnableDwarfDirectory)
+    TM->setMCUseDwarfDirectory(true);
+
+  // Disable .loc support for older OS X versions.
+  if (TheTriple.isMacOSX() &&
+      TheTriple.isMacOSXVersionLT(10, 6))
+    TM->setMCUseLoc(false);
+
+  // Override default to generate verbose assembly.
+  TM->setAsmVerbosityDefault(true);
+
+  if (RelaxAll && FileType == TargetMachine::CGFT_ObjectFile)
+    TM->setMCRelaxAll(true);
+
+  return TM;
+}
+
+// CompilePartitions - Generate code for M with CodeGenPartitions threads.
+// TM generates the first part, which is written to Out.  Returns true and
+// prints an error on failure.
+static bool CompilePartitions(Module &M, TargetMachine &TM,
+                              const Target *TheTarget, const Triple &TheTriple,
+                              const std::string &FeaturesStr,
+                              const TargetOptions &Options,
+                              CodeGenOpt::Level OLvl, tool_output_file &Out,
+                              const char *ProgName) {
+  if (!StartAfter.empty() || !StopAfter.empty()) {
+    errs() << ProgName << ": -codegen-partitions cannot be used with "
+           << "-start-after or -stop-after.\n";
+    return true;
+  }
+  if (OutputFilename == "-") {
+    errs() << ProgName << ": -codegen-partitions needs an output file.\n";
+    return true;
+  }
+
+  std::vector<TargetMachine*> TMs;
+  std::vector<tool_output_file*> Files;
+  bool Failed = false;
+  for (unsigned i = 1; i != CodeGenPartitions; ++i) {
+    tool_output_file *File = OpenOutputFile(OutputFilename + "." + utostr(i));
+    if (!File) {
+      Failed = true;
+      break;
+    }
+    Files.push_back(File);
+    TMs.push_back(CreateTargetMachine(TheTarget, TheTriple, FeaturesStr,
+                                      Options, OLvl));
+    TMs.back()->setMachinePassListener(TM.getMachinePassListener());
+  }
+
+  if (!Failed) {
+    std::vector<TargetMachine*> AllTMs(1, &TM);
+    AllTMs.insert(AllTMs.end(), TMs.begin(), TMs.end());
+    std::vector<formatted_raw_ostream*> Outs;
+    Outs.push_back(new formatted_raw_ostream(Out.os()));
+    for (unsigned i = 0, e = Files.size(); i != e; ++i)
+      Outs.push_back(new formatted_raw_ostream(Files[i]->os()));
+
+    // Before executing passes, print the final values of the LLVM options.
+    cl::PrintOptionValues();
+
+    std::string Error;
+    Failed = splitCodeGen(M, AllTMs, Outs, FileType, NoVerify, Error);
+    if (Failed)
+      errs() << ProgName << ": " << Error << "\n";
+    DeleteContainerPointers(Outs);
+  }
+
+  if (!Failed)
+    for (unsigned i = 0, e = Files.size(); i != e; ++i)
+      Files[i]->keep();
+  DeleteContainerPointers(Files);
+  DeleteContainerPointers(TMs);
+  return Failed;
+}
+
 // main - Entry point for the llc compiler.
 //
 int main(int argc, char **argv) {
@@ -467,35 +585,47 @@ int main(int argc, char **argv) {
   Options.SSPBufferSize = SSPBufferSize;
 
   std::auto_ptr<TargetMachine>
-    target(TheTarget->createTargetMachine(TheTriple.getTriple(),
-                                          MCPU, FeaturesStr, Options,
-                                          RelocModel, CMModel, OLvl));
-  assert(target.get() && "Could not allocate target machine!");
+    target(CreateTargetMachine(TheTarget, TheTriple, FeaturesStr, Options,
+                               OLvl));
   assert(mod && "Should have exited after outputting help!");
   TargetMachine &Target = *target.get();
 
-  if (DisableDotLoc)
-    Target.setMCUseLoc(false);
-
-  if (DisableCFI)
-    Target.setMCUseCFI(false);
-
-  if (EnableDwarfDirectory)
-    Target.setMCUseDwarfDirectory(true);
-
   if (GenerateSoftFloatCalls)
     FloatABIForCalls = FloatABI::Soft;
 
-  // Disable .loc support for older OS X versions.
-  if (TheTriple.isMacOSX() &&
-      TheTriple.isMacOSXVersionLT(10, 6))
-    Target.setMCUseLoc(false);
+  if (RelaxAll && FileType != TargetMachine::CGFT_ObjectFile)
+    errs() << argv[0]
+           << ": warning: ignoring -mc-relax-all because filetype != obj";
 
   // Figure out where we are going to send the output.
   OwningPtr<tool_output_file> Out
     (GetOutputStream(TheTarget->getName(), TheTriple.getOS(), argv[0]));
   if (!Out) return 1;
 
+  // Profile the machine function passes if requested.
+  OwningPtr<tool_output_file> CSVOut;
+  OwningPtr<CSVMachinePassListener> CSVListener;
+  if (!MachinePassCSV.empty()) {
+    std::string error;
+    CSVOut.reset(new tool_output_file(MachinePassCSV.c_str(), error));
+    if (!error.empty()) {
+      errs() << error << '\n';
+      return 1;
+    }
+    CSVListener.reset(new CSVMachinePassListener(CSVOut->os()));
+    Target.setMachinePassListener(CSVListener.get());
+  }
+
+  if (CodeGenPartitions > 1) {
+    if (CompilePartitions(*mod, Target, TheTarget, TheTriple, FeaturesStr,
+                          Options, OLvl, *Out, argv[0]))
+      return 1;
+    Out->keep();
+    if (CSVOut)
+      CSVOut->keep();
+    return 0;
+  }
+
   // Build up all of the passes that we want to do to the module.
   PassManager PM;
 
@@ -511,17 +641,6 @@ int main(int argc, char **argv) {
   else
     PM.add(new TargetData(mod));
 
-  // Override default to generate verbose assembly.
-  Target.setAsmVerbosityDefault(true);
-
-  if (RelaxAll) {
-    if (FileType != TargetMachine::CGFT_ObjectFile)
-      errs() << argv[0]
-             << ": warning: ignoring -mc-relax-all because filetype != obj";
-    else
-      Target.setMCRelaxAll(true);
-  }
-
   {
     formatted_raw_ostream FOS(Out->os());
 
@@ -561,6 +680,8 @@ int main(int argc, char **argv) {
 
   // Declare success.
   Out->keep();
+  if (CSVOut)
+    CSVOut->keep();
 
   return 0;
 }
@@ -23,6 +23,7 @@
 #include "llvm/Analysis/Passes.h"
 #include "llvm/Analysis/Verifier.h"
 #include "llvm/Bitcode/ReaderWriter.h"
+#include "llvm/CodeGen/ParallelCodeGen.h"
 #include "llvm/Config/config.h"
 #include "llvm/MC/MCAsmInfo.h"
 #include "llvm/MC/MCContext.h"
@@ -43,6 +44,7 @@
 #include "llvm/Support/TargetRegistry.h"
 #include "llvm/Support/TargetSelect.h"
 #include "llvm/Support/system_error.h"
+#include "llvm/ADT/STLExtras.h"
 #include "llvm/ADT/StringExtras.h"
 using namespace llvm;
 
@@ -187,6 +189,77 @@ bool LTOCodeGenerator::compile_to_file(const char** name, std::string& errMsg) {
   return false;
 }
 
+bool LTOCodeGenerator::compile_to_files(unsigned partitions,
+                                        const char ***names, unsigned *count,
+                                        std::string &errMsg) {
+  if (partitions == 0)
+    partitions = 1;
+  if (this->optimize(errMsg))
+    return true;
+
+  // make a unique temp .o file and a target machine for each partition
+  std::vector<TargetMachine*> targets;
+  std::vector<tool_output_file*> objFiles;
+  std::vector<formatted_raw_ostream*> outs;
+  _nativeObjectPaths.clear();
+  _nativeObjectNames.clear();
+  bool failed = false;
+  for (unsigned i = 0; i != partitions; ++i) {
+    sys::PathWithStatus uniqueObjPath("lto-llvm.o");
+    if (uniqueObjPath.createTemporaryFileOnDisk(false, &errMsg)) {
+      uniqueObjPath.eraseFromDisk();
+      failed = true;
+      break;
+    }
+    sys::RemoveFileOnSignal(uniqueObjPath);
+    _nativeObjectPaths.push_back(uniqueObjPath.str());
+    objFiles.push_back(new tool_output_file(uniqueObjPath.c_str(), errMsg));
+    if (!errMsg.empty()) {
+      failed = true;
+      break;
+    }
+    outs.push_back(new formatted_raw_ostream(objFiles.back()->os()));
+    TargetMachine *target = i == 0 ? _target : createTargetMachine(errMsg);
+    if (target == NULL) {
+      failed = true;
+      break;
+    }
+    targets.push_back(target);
+  }
+
+  // generate the object files
+  if (!failed)
+    failed = splitCodeGen(*_linker.getModule(), targets, outs,
+                          TargetMachine::CGFT_ObjectFile, true, errMsg);
+
+  DeleteContainerPointers(outs);
+  for (unsigned i = 0, e = objFiles.size(); i != e; ++i) {
+    objFiles[i]->os().close();
+    if (objFiles[i]->os().has_error()) {
+      objFiles[i]->os().clear_error();
+      failed = true;
+    }
+    objFiles[i]->keep();
+  }
+  DeleteContainerPointers(objFiles);
+  if (!targets.empty())
+    targets.erase(targets.begin());
+  DeleteContainerPointers(targets);
+
+  if (failed) {
+    for (unsigned i = 0, e = _nativeObjectPaths.size(); i != e; ++i)
+      sys::Path(_nativeObjectPaths[i]).eraseFromDisk();
+    _nativeObjectPaths.clear();
+    return true;
+  }
+
+  for (unsigned i = 0, e = _nativeObjectPaths.size(); i != e; ++i)
+    _nativeObjectNames.push_back(_nativeObjectPaths[i].c_str());
+  *names = &_nativeObjectNames[0];
+  *count = _nativeObjectNames.size();
+  return false;
+}
+
 const void* LTOCodeGenerator::compile(size_t* length, std::string& errMsg) {
   const char *name;
   if (compile_to_file(&name, errMsg))
@@ -218,6 +291,13 @@ bool LTOCodeGenerator::determineTarget(std::string& errMsg) {
   if (_target != NULL)
     return false;
 
+  _target = createTargetMachine(errMsg);
+  return _target == NULL;
+}
+
+/// createTargetMachine - Create a target machine for the merged modules, or
+/// return null and set errMsg.
+TargetMachine *LTOCodeGenerator::createTargetMachine(std::string &errMsg) {
   std::string Triple = _linker.getModule()->getTargetTriple();
   if (Triple.empty())
     Triple = sys::getDefaultTargetTriple();
@@ -225,7 +305,7 @@ bool LTOCodeGenerator::determineTarget(std::string& errMsg) {
   // create target machine from info for merged modules
   const Target *march = TargetRegistry::lookupTarget(Triple, errMsg);
   if (march == NULL)
-    return true;
+    return NULL;
 
   // The relocation model is actually a static member of TargetMachine and
   // needs to be set before the TargetMachine is instantiated.
@@ -248,10 +328,9 @@ bool LTOCodeGenerator::determineTarget(std::string& errMsg) {
   std::string FeatureStr = Features.getString();
   TargetOptions Options;
   LTOModule::getTargetOptions(Options);
-  _target = march->createTargetMachine(Triple, _mCpu, FeatureStr, Options,
-                                       RelocModel, CodeModel::Default,
-                                       CodeGenOpt::Aggressive);
-  return false;
+  return march->createTargetMachine(Triple, _mCpu, FeatureStr, Options,
+                                    RelocModel, CodeModel::Default,
+                                    CodeGenOpt::Aggressive);
 }
 
 void LTOCodeGenerator::
@@ -340,8 +419,7 @@ void LTOCodeGenerator::applyScopeRestrictions() {
 }
 
 /// Optimize merged modules using various IPO passes
-bool LTOCodeGenerator::generateObjectFile(raw_ostream &out,
-                                          std::string &errMsg) {
+bool LTOCodeGenerator::optimize(std::string &errMsg) {
   if (this->determineTarget(errMsg))
     return true;
 
@@ -364,6 +442,9 @@ bool LTOCodeGenerator::generateObjectFile(raw_ostream &out,
   // Add an appropriate TargetData instance for this module...
   passes.add(new TargetData(*_target->getTargetData()));
 
+  // Let the optimizations use the target's cost model.
+  _target->addAnalysisPasses(passes);
+
   // Enabling internalize here would use its AllButMain variant. It
   // keeps only main if it exists and does nothing for libraries. Instead
   // we create the pass ourselves with the symbol list provided by the linker.
@@ -374,6 +455,17 @@ bool LTOCodeGenerator::generateObjectFile(raw_ostream &out,
   // Make sure everything is still good.
   passes.add(createVerifierPass());
 
+  // Run our queue of passes all at once now, efficiently.
+  passes.run(*mergedModule);
+  return false;
+}
+
+bool LTOCodeGenerator::generateObjectFile(raw_ostream &out,
+                                          std::string &errMsg) {
+  if (this->optimize(errMsg))
+    return true;
+
+  Module* mergedModule = _linker.getModule();
   FunctionPassManager *codeGenPasses = new FunctionPassManager(mergedModule);
 
   codeGenPasses->add(new TargetData(*_target->getTargetData()));
@@ -386,9 +478,6 @@ bool LTOCodeGenerator::generateObjectFile(raw_ostream &out,
     return true;
   }
 
-  // Run our queue of passes all at once now, efficiently.
-  passes.run(*mergedModule);
-
   // Run the code generator, and write assembly file
   codeGenPasses->doInitialization();
 
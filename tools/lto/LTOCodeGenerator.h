@@ -51,10 +51,13 @@ struct LTOCodeGenerator {
 
   bool writeMergedModules(const char *path, std::string &errMsg);
   bool compile_to_file(const char **name, std::string &errMsg);
+  bool compile_to_files(unsigned partitions, const char ***names,
+                        unsigned *count, std::string &errMsg);
   const void *compile(size_t *length, std::string &errMsg);
   void setCodeGenDebugOptions(const char *opts);
 
 private:
+  bool optimize(std::string &errMsg);
   bool generateObjectFile(llvm::raw_ostream &out, std::string &errMsg);
   void applyScopeRestrictions();
   void applyRestriction(llvm::GlobalValue &GV,
@@ -62,6 +65,7 @@ private:
                         llvm::SmallPtrSet<llvm::GlobalValue*, 8> &asmUsed,
                         llvm::Mangler &mangler);
   bool determineTarget(std::string &errMsg);
+  llvm::TargetMachine *createTargetMachine(std::string &errMsg);
 
   typedef llvm::StringMap<uint8_t> StringSet;
 
@@ -77,6 +81,8 @@ private:
   std::vector<char*>          _codegenOptions;
   std::string                 _mCpu;
   std::string                 _nativeObjectPath;
+  std::vector<std::string>    _nativeObjectPaths;
+  std::vector<const char*>    _nativeObjectNames;
 };
 
 #endif // LTO_CODE_GENERATOR_H
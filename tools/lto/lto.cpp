@@ -207,6 +207,15 @@ bool lto_codegen_compile_to_file(lto_code_gen_t cg, const char **name) {
   return cg->compile_to_file(name, sLastErrorString);
 }
 
+/// lto_codegen_compile_to_files - Generates code for all added modules into the
+/// given number of native object files, on as many threads. The names of the
+/// files are written to names and their number to count. Returns true on
+/// error.
+bool lto_codegen_compile_to_files(lto_code_gen_t cg, unsigned partitions,
+                                  const char ***names, unsigned *count) {
+  return cg->compile_to_files(partitions, names, count, sLastErrorString);
+}
+
 /// lto_codegen_debug_options - Used to pass extra options to the code
 /// generator.
 void lto_codegen_debug_options(lto_code_gen_t cg, const char *opt) {
@@ -28,6 +28,7 @@
 #include "llvm/Target/TargetMachine.h"
 #include "llvm/ADT/StringSet.h"
 #include "llvm/ADT/Triple.h"
+#include "llvm/MC/SubtargetFeature.h"
 #include "llvm/Support/PassNameParser.h"
 #include "llvm/Support/Signals.h"
 #include "llvm/Support/Debug.h"
@@ -36,6 +37,8 @@
 #include "llvm/Support/PluginLoader.h"
 #include "llvm/Support/PrettyStackTrace.h"
 #include "llvm/Support/SystemUtils.h"
+#include "llvm/Support/TargetRegistry.h"
+#include "llvm/Support/TargetSelect.h"
 #include "llvm/Support/ToolOutputFile.h"
 #include "llvm/LinkAllPasses.h"
 #include "llvm/LinkAllVMCore.h"
@@ -125,6 +128,18 @@ OptLevelO3("O3",
 static cl::opt<std::string>
 TargetTriple("mtriple", cl::desc("Override target triple for module"));
 
+static cl::opt<std::string>
+MCPU("mcpu",
+  cl::desc("Target a specific cpu type for the cost model"),
+  cl::value_desc("cpu-name"),
+  cl::init(""));
+
+static cl::list<std::string>
+MAttrs("mattr",
+  cl::CommaSeparated,
+  cl::desc("Target specific attributes for the cost model"),
+  cl::value_desc("a1,+a2,-a3,..."));
+
 static cl::opt<bool>
 UnitAtATime("funit-at-a-time",
             cl::desc("Enable IPO. This is same as llvm-gcc's -funit-at-a-time"),
@@ -479,6 +494,33 @@ static void AddStandardLinkPasses(PassManagerBase &PM) {
 }
 
 
+/// GetTargetMachine - Create a target machine for the module's triple so that
+/// transformations can use the target's cost model.  Returns null if the
+/// module has no triple or the target is not linked in, in which case the
+/// conservative default cost model is used.
+static TargetMachine *GetTargetMachine(const Triple &TheTriple) {
+  if (TheTriple.getTriple().empty())
+    return 0;
+
+  std::string Error;
+  const Target *TheTarget = TargetRegistry::lookupTarget(TheTriple.getTriple(),
+                                                         Error);
+  if (!TheTarget)
+    return 0;
+
+  // Package up features to be passed to target/subtarget
+  std::string FeaturesStr;
+  if (MAttrs.size()) {
+    SubtargetFeatures Features;
+    for (unsigned i = 0; i != MAttrs.size(); ++i)
+      Features.AddFeature(MAttrs[i]);
+    FeaturesStr = Features.getString();
+  }
+
+  return TheTarget->createTargetMachine(TheTriple.getTriple(), MCPU,
+                                        FeaturesStr, TargetOptions());
+}
+
 //===----------------------------------------------------------------------===//
 // main for opt
 //
@@ -492,6 +534,9 @@ int main(int argc, char **argv) {
   llvm_shutdown_obj Y;  // Call llvm_shutdown() on exit.
   LLVMContext &Context = getGlobalContext();
 
+  InitializeAllTargets();
+  InitializeAllTargetMCs();
+
   // Initialize passes
   PassRegistry &Registry = *PassRegistry::getPassRegistry();
   initializeCore(Registry);
@@ -579,11 +624,18 @@ int main(int argc, char **argv) {
   if (TD)
     Passes.add(TD);
 
+  // Add the target's cost model, if the target is available.
+  OwningPtr<TargetMachine> TM(GetTargetMachine(Triple(M->getTargetTriple())));
+  if (TM.get())
+    TM->addAnalysisPasses(Passes);
+
   OwningPtr<FunctionPassManager> FPasses;
   if (OptLevelO1 || OptLevelO2 || OptLevelOs || OptLevelOz || OptLevelO3) {
     FPasses.reset(new FunctionPassManager(M.get()));
     if (TD)
       FPasses->add(new TargetData(*TD));
+    if (TM.get())
+      TM->addAnalysisPasses(*FPasses);
   }
 
   if (PrintBreakpoints) {
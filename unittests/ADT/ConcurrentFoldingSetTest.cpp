@@ -0,0 +1,136 @@
+//===- llvm/unittest/ADT/ConcurrentFoldingSetTest.cpp ---------------------===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+//
+// ConcurrentFoldingSet unit tests.
+//
+//===----------------------------------------------------------------------===//
+
+#include "gtest/gtest.h"
+#include "llvm/ADT/ConcurrentFoldingSet.h"
+#include "llvm/Support/Threading.h"
+#include "llvm/Config/config.h"
+#include <vector>
+#ifdef HAVE_PTHREAD_H
+#include <pthread.h>
+#endif
+
+using namespace llvm;
+
+namespace {
+
+struct IntNode : public ConcurrentFoldingSetNode {
+  unsigned Value;
+  explicit IntNode(unsigned V) : Value(V) {}
+  void Profile(FoldingSetNodeID &ID) const { ID.AddInteger(Value); }
+};
+
+typedef ConcurrentFoldingSet<IntNode> IntSet;
+
+static void deleteAll(IntSet &Set) {
+  for (IntSet::iterator I = Set.begin(), E = Set.end(); I != E; ) {
+    IntNode *N = &*I++;
+    delete N;
+  }
+  Set.clear();
+}
+
+TEST(ConcurrentFoldingSetTest, InsertAndFind) {
+  IntSet Set;
+  EXPECT_TRUE(Set.empty());
+
+  FoldingSetNodeID ID;
+  ID.AddInteger(42U);
+  void *InsertPos;
+  EXPECT_EQ(0, Set.FindNodeOrInsertPos(ID, InsertPos));
+  EXPECT_TRUE(InsertPos != 0);
+
+  IntNode *N = new IntNode(42);
+  Set.InsertNode(N, InsertPos);
+  EXPECT_EQ(1U, Set.size());
+  EXPECT_EQ(N, Set.FindNodeOrInsertPos(ID, InsertPos));
+  EXPECT_EQ(ID.ComputeHash(), N->getHashValue());
+
+  IntNode Dup(42);
+  EXPECT_EQ(N, Set.GetOrInsertNode(&Dup));
+  EXPECT_EQ(1U, Set.size());
+
+  deleteAll(Set);
+  EXPECT_TRUE(Set.empty());
+}
+
+TEST(ConcurrentFoldingSetTest, GrowRemoveAndIterate) {
+  // Two shards with a small initial table so that both grow several times.
+  IntSet Set(6, 1);
+  std::vector<IntNode*> Nodes;
+  for (unsigned i = 0; i != 1000; ++i) {
+    Nodes.push_back(new IntNode(i));
+    EXPECT_EQ(Nodes.back(), Set.GetOrInsertNode(Nodes.back()));
+  }
+  EXPECT_EQ(1000U, Set.size());
+
+  // Every node is still found after the rehashes.
+  for (unsigned i = 0; i != 1000; ++i) {
+    FoldingSetNodeID ID;
+    ID.AddInteger(i);
+    void *InsertPos;
+    EXPECT_EQ(Nodes[i], Set.FindNodeOrInsertPos(ID, InsertPos));
+  }
+
+  // Remove the odd values.
+  for (unsigned i = 1; i < 1000; i += 2) {
+    EXPECT_TRUE(Set.RemoveNode(Nodes[i]));
+    EXPECT_FALSE(Set.RemoveNode(Nodes[i]));
+  }
+  EXPECT_EQ(500U, Set.size());
+
+  unsigned Count = 0;
+  for (IntSet::iterator I = Set.begin(), E = Set.end(); I != E; ++I) {
+    EXPECT_EQ(0U, I->Value % 2);
+    ++Count;
+  }
+  EXPECT_EQ(500U, Count);
+
+  for (unsigned i = 1; i < 1000; i += 2)
+    delete Nodes[i];
+  deleteAll(Set);
+}
+
+#ifdef HAVE_PTHREAD_H
+namespace test1 {
+  IntSet *Set;
+
+  // Each thread inserts the same values, so every insertion races with an
+  // equal one in the other threads.
+  void *helper(void*) {
+    for (unsigned i = 0; i != 2000; ++i) {
+      IntNode *N = new IntNode(i);
+      if (Set->GetOrInsertNode(N) != N)
+        delete N;
+    }
+    return NULL;
+  }
+}
+
+TEST(ConcurrentFoldingSetTest, MultipleThreads) {
+  llvm_start_multithreaded();
+  IntSet Set;
+  test1::Set = &Set;
+  pthread_t Threads[4];
+  for (unsigned i = 0; i != 4; ++i)
+    pthread_create(&Threads[i], NULL, test1::helper, NULL);
+  for (unsigned i = 0; i != 4; ++i)
+    pthread_join(Threads[i], NULL);
+  llvm_stop_multithreaded();
+
+  EXPECT_EQ(2000U, Set.size());
+  deleteAll(Set);
+}
+#endif
+
+} // anonymous namespace
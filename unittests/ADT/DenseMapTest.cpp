@@ -9,6 +9,7 @@
 
 #include "gtest/gtest.h"
 #include "llvm/ADT/DenseMap.h"
+#include "llvm/ADT/FlatDenseMap.h"
 #include <map>
 #include <set>
 
@@ -103,7 +104,11 @@ typedef ::testing::Types<DenseMap<uint32_t, uint32_t>,
                          SmallDenseMap<uint32_t, uint32_t>,
                          SmallDenseMap<uint32_t *, uint32_t *>,
                          SmallDenseMap<CtorTester, CtorTester, 4,
-                                       CtorTesterMapInfo>
+                                       CtorTesterMapInfo>,
+                         FlatDenseMap<uint32_t, uint32_t>,
+                         FlatDenseMap<uint32_t *, uint32_t *>,
+                         FlatDenseMap<CtorTester, CtorTester,
+                                      CtorTesterMapInfo>
                          > DenseMapTestTypes;
 TYPED_TEST_CASE(DenseMapTest, DenseMapTestTypes);
 
@@ -330,4 +335,46 @@ TEST(DenseMapCustomTest, FindAsTest) {
   EXPECT_TRUE(map.find_as("d") == map.end());
 }
 
+// FlatDenseMap find_as() tests
+TEST(DenseMapCustomTest, FlatFindAsTest) {
+  FlatDenseMap<unsigned, unsigned, TestDenseMapInfo> map;
+  map[0] = 1;
+  map[1] = 2;
+  map[2] = 3;
+
+  EXPECT_EQ(3u, map.size());
+  EXPECT_EQ(1u, map.find_as("a")->second);
+  EXPECT_EQ(2u, map.find_as("b")->second);
+  EXPECT_EQ(3u, map.find_as("c")->second);
+  EXPECT_TRUE(map.find_as("d") == map.end());
+}
+
+// Interleave insertions and erasures so that FlatDenseMap has to deal with
+// tombstones, in-place rehashing and growth, and check it against std::map.
+TEST(DenseMapCustomTest, FlatEraseChurnTest) {
+  FlatDenseMap<unsigned, unsigned> map;
+  std::map<unsigned, unsigned> ref;
+
+  for (unsigned i = 0; i != 5000; ++i) {
+    unsigned Key = (i * 7919U) % 1031;
+    if (i % 3 == 0) {
+      EXPECT_EQ(ref.erase(Key) != 0, map.erase(Key));
+    } else {
+      ref[Key] = i;
+      map[Key] = i;
+    }
+    ASSERT_EQ(ref.size(), map.size());
+  }
+
+  for (std::map<unsigned, unsigned>::iterator I = ref.begin(), E = ref.end();
+       I != E; ++I)
+    EXPECT_EQ(I->second, map.lookup(I->first));
+
+  unsigned NumVisited = 0;
+  for (FlatDenseMap<unsigned, unsigned>::iterator I = map.begin(),
+       E = map.end(); I != E; ++I, ++NumVisited)
+    EXPECT_EQ(ref[I->first], I->second);
+  EXPECT_EQ(ref.size(), NumVisited);
+}
+
 }
@@ -10,6 +10,7 @@
 #include "gtest/gtest.h"
 #include "llvm/ADT/StringMap.h"
 #include "llvm/Support/DataTypes.h"
+#include <vector>
 using namespace llvm;
 
 namespace {
@@ -220,4 +221,43 @@ TEST_F(StringMapTest, InsertTest) {
   assertSingleItemMap();
 }
 
+// Test the lookup methods that take a precomputed hash.
+TEST_F(StringMapTest, PrecomputedHashTest) {
+  unsigned FullHashValue = StringMapImpl::hash(testKey);
+  EXPECT_EQ(0u, testMap.count(testKey, FullHashValue));
+
+  testMap.GetOrCreateValueWithHash(testKey, FullHashValue, testValue);
+  assertSingleItemMap();
+  EXPECT_EQ(1u, testMap.count(testKeyStr, FullHashValue));
+  EXPECT_TRUE(testMap.find(testKey, FullHashValue) == testMap.begin());
+  EXPECT_EQ(testValue, testMap.lookup(testKey, FullHashValue));
+}
+
+// Test reserve() and range insert().
+TEST_F(StringMapTest, ReserveAndRangeInsertTest) {
+  testMap.reserve(100);
+  unsigned NumBuckets = testMap.getNumBuckets();
+  EXPECT_LE(100u * 4, NumBuckets * 3);
+
+  std::vector<std::string> Keys;
+  for (unsigned i = 0; i != 100; ++i)
+    Keys.push_back("key" + std::string(1, char('A' + i % 26)) +
+                   std::string(i / 26 + 1, 'x'));
+
+  std::vector<std::pair<StringRef, uint32_t> > Pairs;
+  for (unsigned i = 0; i != 100; ++i)
+    Pairs.push_back(std::make_pair(StringRef(Keys[i]), i));
+  testMap.insert(Pairs.begin(), Pairs.end());
+
+  // The table was big enough, so it must not have been rehashed.
+  EXPECT_EQ(NumBuckets, testMap.getNumBuckets());
+  EXPECT_EQ(100u, testMap.size());
+  for (unsigned i = 0; i != 100; ++i)
+    EXPECT_EQ(i, testMap.lookup(Keys[i]));
+
+  // Existing keys keep their values.
+  testMap.insert(Pairs.begin(), Pairs.begin() + 1);
+  EXPECT_EQ(100u, testMap.size());
+}
+
 } // end anonymous namespace
@@ -127,6 +127,29 @@ TEST_F(MDNodeTest, Delete) {
   delete I;
 }
 
+TEST_F(MDNodeTest, PurgeUnused) {
+  Value *const C = ConstantInt::get(Type::getInt32Ty(Context), 1);
+  MDNode *Leaf = MDNode::get(Context, C);
+  Value *const L = Leaf;
+  MDNode *Dead = MDNode::get(Context, L);
+  (void)Dead;
+
+  Value *const C2 = ConstantInt::get(Type::getInt32Ty(Context), 2);
+  MDNode *Kept = MDNode::get(Context, C2);
+  Module M("PurgeModule", Context);
+  M.getOrInsertNamedMetadata("llvm.keep")->addOperand(Kept);
+
+  size_t Before = Context.getMetadataMemoryUsage();
+  EXPECT_NE(0u, Before);
+
+  // Dead is unreferenced, and only Dead refers to Leaf.
+  EXPECT_EQ(2u, Context.purgeUnusedMetadata());
+  EXPECT_GT(Before, Context.getMetadataMemoryUsage());
+  EXPECT_EQ((MDNode*)0, MDNode::getIfExists(Context, C));
+  EXPECT_EQ(Kept, MDNode::getIfExists(Context, C2));
+  EXPECT_EQ(0u, Context.purgeUnusedMetadata());
+}
+
 TEST(NamedMDNodeTest, Search) {
   LLVMContext Context;
   Constant *C = ConstantInt::get(Type::getInt32Ty(Context), 1);